@@ -22,6 +22,10 @@ BinLoaderView::BinLoaderView(QWidget* _parent, Qt::WindowFlags _flags)
     m_histogramScale = false;
     m_filteringEnabled = false;
     m_currentHeap = (uint64_t)-1;
+    m_analyzedStages = 0;
+    m_updating = false;
+    for (int i = 0; i < 4; ++i)
+        m_analyzeProgress[i] = 0.0f;
 
     m_tab = findChild<QTabWidget*>("tabWidget");
     m_treeMap = m_tab->findChild<TreeMapWidget*>("treeMapWidget");
@@ -32,6 +36,9 @@ BinLoaderView::BinLoaderView(QWidget* _parent, Qt::WindowFlags _flags)
     m_operationListInvalid = findChild<OperationsList*>("invalidOpsWidget");
     m_operationListInvalid->setSearchVisible(false);
 
+    for (int i = 0; i < m_tab->count(); ++i)
+        m_tabTitles.append(m_tab->tabText(i));
+
     connect(m_groupList,
             SIGNAL(setStackTrace(rtm::StackTrace**, int)),
             this,
@@ -87,7 +94,13 @@ void BinLoaderView::changeEvent(QEvent* _event)
 {
     QWidget::changeEvent(_event);
     if (_event->type() == QEvent::LanguageChange)
+    {
         ui.retranslateUi(this);
+
+        for (int i = 0; i < m_tab->count(); ++i)
+            m_tabTitles[i] = m_tab->tabText(i);
+        updateTabs();
+    }
 }
 
 BinLoaderView::~BinLoaderView()
@@ -98,17 +111,131 @@ BinLoaderView::~BinLoaderView()
 void BinLoaderView::setContext(CaptureContext* _context)
 {
     m_context = _context;
-    m_treeMap->setContext(_context);
-    m_stackTree->setContext(_context);
-    m_operationList->setContext(_context, true);
-    m_operationListInvalid->setContext(_context, false);
-    m_groupList->setContext(_context);
+    m_analyzedStages = 0;
     m_minTime = m_context->m_capture->getMinTime();
     m_maxTime = m_context->m_capture->getMaxTime();
+    setAnalyzedStages(m_context->m_capture->getAnalyzedStages());
+}
+
+void BinLoaderView::setAnalyzeProgress(uint32_t _stages, float _progress)
+{
+    for (int i = 0; i < 4; ++i)
+        if (_stages & (1 << i))
+            m_analyzeProgress[i] = _progress;
+
+    // stage is done only once the capture says so, progress may reach 100 before that
+    setAnalyzedStages(m_context->m_capture->getAnalyzedStages());
+}
+
+//--------------------------------------------------------------------------
+/// Sets up views for analysis stages that finished since the last call
+//--------------------------------------------------------------------------
+void BinLoaderView::setAnalyzedStages(uint32_t _stages)
+{
+    const uint32_t prevStages = m_analyzedStages;
+    m_analyzedStages |= _stages;
+
+    // true if stages the page needs were all done by this call
+    auto becameReady = [this, prevStages](QWidget* _page)
+    {
+        const uint32_t stages = getTabStages(_page);
+        return ((prevStages & stages) != stages) && ((m_analyzedStages & stages) == stages);
+    };
+
+    if (becameReady(ui.CallStackTree))
+    {
+        m_treeMap->setContext(m_context);
+        m_stackTree->setContext(m_context);
+    }
+
+    if (becameReady(ui.Operations))
+    {
+        m_operationList->setContext(m_context, true);
+        m_operationListInvalid->setContext(m_context, false);
+    }
+
+    if (becameReady(ui.GroupedView))
+        m_groupList->setContext(m_context);
+
+    updateTabs();
+
+    if (m_analyzedStages != prevStages)
+        emit analyzedStagesChanged(m_analyzedStages & ~prevStages);
+}
+
+//--------------------------------------------------------------------------
+/// Returns analysis stages a tab needs before it can show anything
+//--------------------------------------------------------------------------
+uint32_t BinLoaderView::getTabStages(QWidget* _page) const
+{
+    // operation lists filter and show operations by tag
+    if ((_page == ui.Operations) || (_page == ui.invalidOpsWidget_2))
+        return rtm::Capture::AnalyzeTags | rtm::Capture::AnalyzeSymbols;
+
+    if ((_page == ui.CallStackTree) || (_page == ui.TreeMap))
+        return rtm::Capture::AnalyzeSymbols | rtm::Capture::AnalyzeStackTree;
+
+    // group list shows heap names, hotspots are made of sorted groups
+    return rtm::Capture::AnalyzeTags | rtm::Capture::AnalyzeGroups | rtm::Capture::AnalyzeSymbols;
+}
+
+bool BinLoaderView::isOverview() const
+{
+    return m_context && m_context->m_capture->isOverview();
+}
+
+//--------------------------------------------------------------------------
+/// Views of a capture that is being updated neither repaint nor take input,
+/// they keep showing the previous state until the update is done
+//--------------------------------------------------------------------------
+void BinLoaderView::setUpdating(bool _updating)
+{
+    m_updating = _updating;
+    if (_updating)
+    {
+        setUpdatesEnabled(false);
+        setEnabled(false);
+    }
+    else
+    {
+        setEnabled(true);
+        setUpdatesEnabled(true);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Tabs waiting for analysis are disabled and show its progress
+//--------------------------------------------------------------------------
+void BinLoaderView::updateTabs()
+{
+    const bool overview = isOverview();
+    for (int i = 0; i < m_tab->count(); ++i)
+    {
+        const uint32_t pending = getTabStages(m_tab->widget(i)) & ~m_analyzedStages;
+
+        QString title = m_tabTitles[i];
+        if (pending && !overview)
+        {
+            // slowest of the stages tab is waiting for
+            float progress = 100.0f;
+            for (int s = 0; s < 4; ++s)
+                if (pending & (1 << s))
+                    progress = qMin(progress, m_analyzeProgress[s]);
+
+            title += QString(" (%1%)").arg(qMin((int)progress, 99));
+        }
+
+        m_tab->setTabEnabled(i, pending == 0);
+        m_tab->setTabText(i, title);
+    }
 }
 
 void BinLoaderView::setFilteringEnabled(bool _filter)
 {
+    // filtering goes over analysis data, it can't run while that is being built or updated
+    if (!isAnalyzed() || m_updating)
+        return;
+
     m_filteringEnabled = _filter;
     m_context->m_capture->setFilteringEnabled(_filter);
     m_operationList->setFilteringState(_filter, m_operationList->isLeaksOnlyChecked());
@@ -39,6 +39,10 @@ private:
     bool m_histogramPeaks;
     bool m_histogramScale;
     bool m_filteringEnabled;
+    uint32_t m_analyzedStages;   ///< Analysis stages the views were set up with
+    bool m_updating;             ///< Capture is being changed on another thread, views don't touch it
+    float m_analyzeProgress[4];  ///< Progress of each analysis stage, indexed by stage bit
+    QStringList m_tabTitles;
 
 public:
     BinLoaderView(QWidget* _parent = 0, Qt::WindowFlags _flags = (Qt::WindowFlags)0);
@@ -50,6 +54,21 @@ public:
     }
     void setContext(CaptureContext* _context);
 
+    /// Views fill in as analysis stages of the capture finish, called on the UI thread
+    void setAnalyzeProgress(uint32_t _stages, float _progress);
+    bool isAnalyzed() const
+    {
+        return m_analyzedStages == rtm::Capture::AnalyzeAll;
+    }
+    /// Overview capture is never analyzed, it only has global stats and usage graph
+    bool isOverview() const;
+    /// Freezes views while a live capture is updated on a worker thread
+    void setUpdating(bool _updating);
+    bool isUpdating() const
+    {
+        return m_updating;
+    }
+
     rtm::StackTrace** getSavedStackTraces()
     {
         return m_savedStackTraces;
@@ -141,8 +160,13 @@ Q_SIGNALS:
     void highlightTime(uint64_t);
     void highlightRange(uint64_t, uint64_t);
     void selectRange(uint64_t, uint64_t);
+    void analyzedStagesChanged(uint32_t);
 
 private:
+    void setAnalyzedStages(uint32_t _stages);
+    uint32_t getTabStages(QWidget* _page) const;
+    void updateTabs();
+
     Ui::BinLoaderView ui;
 };
 
@@ -5,30 +5,91 @@
 
 #include <MTuner_pch.h>
 #include <MTuner/src/capturecontext.h>
+#include <MTuner/src/symbolservice.h>
+#include <rbase/inc/hash.h>
 #include <rbase/inc/winchar.h>
 #include <rdebug/inc/rdebug.h>
 
 CaptureContext::CaptureContext()
 {
-    m_symbolResolver = 0;
+    m_symbolsHash = 0;
     m_capture = new rtm::Capture();
+    m_symbolService = new SymbolService(&m_symbols);
     m_toolchain = rmem::ToolChain::Unknown;
     m_binLoaderView = 0;
+    m_symbolSourceSelected = false;
+    m_preloadedHash = 0;
 }
 
 CaptureContext::~CaptureContext()
 {
-    if (m_symbolResolver)
-    {
-        rdebug::symbolResolverDelete((uintptr_t)m_symbolResolver);
-        m_symbolResolver = 0;
-    }
+    if (m_symbolLoader.joinable())
+        m_symbolLoader.join();
+
+    delete m_symbolService;
+    m_symbols.save();
+}
+
+void CaptureContext::waitForSymbols()
+{
+    if (m_symbolLoader.joinable())
+        m_symbolLoader.join();
+
+    m_symbols.save();
+}
+
+static void appendFileInfo(QByteArray& _inputs, const char* _path)
+{
+    QFileInfo info(QString::fromUtf8(_path));
+    const qint64 size = info.exists() ? info.size() : 0;
+    const qint64 time = info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0;
+
+    _inputs.append(_path);
+    _inputs.append((const char*)&size, sizeof(size));
+    _inputs.append((const char*)&time, sizeof(time));
 }
 
-void CaptureContext::setupResolver(rdebug::Toolchain& _tc,
-                                   std::string& _executable,
+void CaptureContext::preloadSymbols(const rdebug::Toolchain& _tc,
+                                    const std::string& _executable,
+                                    const std::vector<rdebug::ModuleInfo>& _modules,
+                                    rdebug::module_load_cb _callback,
+                                    void* _data)
+{
+    if (m_symbolLoader.joinable())
+        m_symbolLoader.join();
+
+    m_symbolSourceSelected = true;
+    m_symbolToolchain = _tc;
+    m_symbolExecutable = _executable;
+    setSymbolStore(_tc);
+
+    m_symbolLoader = std::thread(
+        [this, _tc, _executable, _modules, _callback, _data]()
+        {
+            initSymbols(_tc, _executable, _modules, _callback, _data);
+            m_preloadedHash = getSymbolsHash(_tc, _executable, _modules);
+            m_symbols.preload();
+        });
+}
+
+void CaptureContext::setupResolver(const rdebug::Toolchain& _tc,
+                                   const std::string& _executable,
                                    rdebug::module_load_cb _callback,
                                    void* _data)
+{
+    if (m_symbolLoader.joinable())
+        m_symbolLoader.join();
+
+    setSymbolStore(_tc);
+
+    // modules loaded while the capture was running aren't known to the symbol loader
+    const std::vector<rdebug::ModuleInfo>& modules = m_capture->getModuleInfos();
+    m_symbolsHash = getSymbolsHash(_tc, _executable, modules);
+    if (m_symbolsHash != m_preloadedHash)
+        initSymbols(_tc, _executable, modules, _callback, _data);
+}
+
+void CaptureContext::setSymbolStore(const rdebug::Toolchain& _tc)
 {
     switch (_tc.m_type)
     {
@@ -64,16 +125,77 @@ void CaptureContext::setupResolver(rdebug::Toolchain& _tc,
         case rdebug::Toolchain::Unknown:
             break;
     };
+}
+
+uint64_t CaptureContext::getSymbolsHash(const rdebug::Toolchain& _tc,
+                                        const std::string& _executable,
+                                        const std::vector<rdebug::ModuleInfo>& _modules)
+{
+    // symbols resolved later depend on the toolchain, symbol source and binaries of loaded modules
+    QByteArray symbolInputs;
+    symbolInputs.append((const char*)&_tc.m_type, sizeof(_tc.m_type));
+    symbolInputs.append(_tc.m_toolchainPath);
+    symbolInputs.append(_tc.m_toolchainPrefix);
+    appendFileInfo(symbolInputs, _executable.c_str());
+
+    for (size_t i = 0; i < _modules.size(); ++i)
+    {
+        symbolInputs.append((const char*)&_modules[i].m_baseAddress, sizeof(_modules[i].m_baseAddress));
+        symbolInputs.append((const char*)&_modules[i].m_size, sizeof(_modules[i].m_size));
+        appendFileInfo(symbolInputs, _modules[i].m_modulePath);
+    }
+
+    return rtm::hashCity64(symbolInputs.constData(), (uint32_t)symbolInputs.size());
+}
+
+/// Removes module symbol files not used for a while and the least recently used
+/// ones while the directory is over its size limit, loading a file touches it
+static void pruneSymbolCache(const QString& _dir)
+{
+    const qint64 maxAgeDays = 30;
+    const qint64 maxTotalSize = 512 * 1024 * 1024;
+
+    const QDateTime oldest = QDateTime::currentDateTime().addDays(-maxAgeDays);
+    const QStringList filters = QStringList() << "*.mtsym" << "*.mtsym.tmp";
+    const QFileInfoList files = QDir(_dir).entryInfoList(filters, QDir::Files, QDir::Time);
+
+    qint64 totalSize = 0;
+    for (int i = 0; i < files.size(); ++i)
+        totalSize += files[i].size();
+
+    // sorted most recently used first
+    for (int i = files.size() - 1; i >= 0; --i)
+    {
+        const QFileInfo& file = files[i];
+        if ((file.lastModified() >= oldest) && (totalSize <= maxTotalSize))
+            break;
+
+        if (QFile::remove(file.absoluteFilePath()))
+            totalSize -= file.size();
+    }
+}
+
+void CaptureContext::initSymbols(const rdebug::Toolchain& _tc,
+                                 const std::string& _executable,
+                                 const std::vector<rdebug::ModuleInfo>& _modules,
+                                 rdebug::module_load_cb _callback,
+                                 void* _data)
+{
+    // symbol cache is shared by all captures, resolver is only created if a symbol isn't cached
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (!cacheDir.isEmpty())
+    {
+        cacheDir += "/MTuner/symbols";
+        if (QDir().mkpath(cacheDir))
+            pruneSymbolCache(cacheDir);
+        else
+            cacheDir.clear();
+    }
 
-    m_symbolResolver = rdebug::symbolResolverCreate(m_capture->getModuleInfos().data(),
-                                                    (uint32_t)m_capture->getModuleInfos().size(),
-                                                    _executable.c_str(),
-                                                    _callback,
-                                                    _data);
+    m_symbols.init(_tc, _executable, _modules, cacheDir.toStdString(), _callback, _data);
 }
 
 void CaptureContext::resolveStackFrame(uint64_t _address, rdebug::StackFrame& _frame)
 {
-    if (m_symbolResolver)
-        rdebug::symbolResolverGetFrame(m_symbolResolver, _address, &_frame);
+    m_symbols.getFrame(_address, _frame);
 }
@@ -7,26 +7,63 @@
 #define RTM_MTUNER_CAPTURE_CONTEXT_H
 
 #include <MTuner/src/loader/capture.h>
+#include <MTuner/src/loader/symbolcache.h>
+
+#include <thread>
 
 class BinLoaderView;
+class SymbolService;
 
 struct CaptureContext
 {
     rtm::Capture* m_capture;
-    uintptr_t m_symbolResolver;
+    rtm::SymbolCache m_symbols;  ///< Resolves symbols, keeps them on disk for next opens of the same binaries
+    SymbolService* m_symbolService;  ///< Resolves frames shown in views in the background
+    uint64_t m_symbolsHash;  ///< Identifies symbol inputs of the resolver, keys cached analysis data
     std::string m_symbolStoreDName;
     rmem::ToolChain::Enum m_toolchain;
     BinLoaderView* m_binLoaderView;
+    bool m_symbolSourceSelected;  ///< Toolchain and executable below were picked while the capture was loading
+    rdebug::Toolchain m_symbolToolchain;
+    std::string m_symbolExecutable;
+    std::thread m_symbolLoader;  ///< Loads symbols of modules known from the capture header
+    uint64_t m_preloadedHash;    ///< Symbol inputs the symbol loader was started with, 0 if none
 
     CaptureContext();
     ~CaptureContext();
 
-    void setupResolver(rdebug::Toolchain& _tc, std::string& _executable, rdebug::module_load_cb _callback, void* _data);
+    /// Starts loading symbols of the given modules in the background, while the rest of the
+    /// capture is still being loaded; setupResolver picks them up if the modules didn't change
+    void preloadSymbols(const rdebug::Toolchain& _tc,
+                        const std::string& _executable,
+                        const std::vector<rdebug::ModuleInfo>& _modules,
+                        rdebug::module_load_cb _callback,
+                        void* _data);
+
+    /// Waits for the symbol loader and writes resolved symbols, can be called from
+    /// any thread so deleting the context afterwards doesn't block
+    void waitForSymbols();
+
+    void setupResolver(const rdebug::Toolchain& _tc,
+                       const std::string& _executable,
+                       rdebug::module_load_cb _callback,
+                       void* _data);
     std::string getSymbolStoreDir() const
     {
         return m_symbolStoreDName;
     }
     void resolveStackFrame(uint64_t _address, rdebug::StackFrame& ioFrame);
+
+private:
+    void setSymbolStore(const rdebug::Toolchain& _tc);
+    uint64_t getSymbolsHash(const rdebug::Toolchain& _tc,
+                            const std::string& _executable,
+                            const std::vector<rdebug::ModuleInfo>& _modules);
+    void initSymbols(const rdebug::Toolchain& _tc,
+                     const std::string& _executable,
+                     const std::vector<rdebug::ModuleInfo>& _modules,
+                     rdebug::module_load_cb _callback,
+                     void* _data);
 };
 
 #endif  // RTM_MTUNER_CAPTURE_CONTEXT_H
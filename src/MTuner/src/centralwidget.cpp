@@ -92,7 +92,7 @@ void CentralWidget::tabSelectionChanged(int _tabIndex)
     if (view)
     {
         emit setStackTrace(view->getSavedStackTraces(), view->getSavedStackTracesCount());
-        emit setFilteringEnabled(view->getFilteringEnabled(), true);
+        emit setFilteringEnabled(view->getFilteringEnabled(), view->isAnalyzed());
     }
     else
     {
@@ -104,6 +104,12 @@ void CentralWidget::tabSelectionChanged(int _tabIndex)
 void CentralWidget::tabClose(int _tabIndex)
 {
     QWidget* widget = m_tabWidget->widget(_tabIndex);
+
+    // capture is still being analyzed or updated on another thread
+    BinLoaderView* view = qobject_cast<BinLoaderView*>(widget);
+    if (view && (view->isUpdating() || (!view->isAnalyzed() && !view->isOverview())))
+        return;
+
     m_tabWidget->removeTab(_tabIndex);
     delete widget;
 }
@@ -65,8 +65,6 @@ void GraphCurve::paint(QPainter* _painter, const QStyleOptionGraphicsItem* _opti
     uint64_t minTime = m_graphWidget->minTime();
     uint64_t maxTime = m_graphWidget->maxTime();
 
-    uint64_t displayTime = maxTime - minTime;
-
     int xcoord = left;
     rtm::GraphEntry entry;
     ctx->m_capture->getGraphAtTime(minTime, entry);
@@ -95,29 +93,21 @@ void GraphCurve::paint(QPainter* _painter, const QStyleOptionGraphicsItem* _opti
             minLive = 0;
         }
 
-        index = 0;
-        double timeDelta = double(displayTime) / double(right - left);
-        double time = double(minTime);
+        // one min/max range per pixel, short spikes between samples are not lost
+        ctx->m_capture->getGraphRange(minTime, maxTime, (uint32_t)m_graphValues.size(), m_graphValues.data());
 
-        for (; xcoord < right;)
+        if (autoZoom)
         {
-            ctx->m_capture->getGraphAtTime((uint64_t)time, entry);
-
-            m_graphValues[index++] = entry;
-
-            if (autoZoom)
+            for (size_t i = 0; i < m_graphValues.size(); ++i)
             {
-                peakUsage = qMax(entry.m_usage, peakUsage);
-                minUsage = qMin(entry.m_usage, minUsage);
+                const rtm::GraphBucket& bucket = m_graphValues[i];
 
-                peakLive = qMax(entry.m_numLiveBlocks, peakLive);
-                minLive = qMin(entry.m_numLiveBlocks, minLive);
-            }
+                peakUsage = qMax(bucket.m_maxUsage, peakUsage);
+                minUsage = qMin(bucket.m_minUsage, minUsage);
 
-            xcoord += 1;
-            time += timeDelta;
-            if (time > maxTime)
-                time = maxTime;
+                peakLive = qMax((uint64_t)bucket.m_maxLiveBlocks, peakLive);
+                minLive = qMin((uint64_t)bucket.m_minLiveBlocks, minLive);
+            }
         }
 
         m_prevPeakUsage = peakUsage;
@@ -167,13 +157,30 @@ void GraphCurve::paint(QPainter* _painter, const QStyleOptionGraphicsItem* _opti
 
     for (; xcoord < right;)
     {
-        rtm::GraphEntry& entry_graph = m_graphValues[index++];
+        const rtm::GraphBucket& bucket = m_graphValues[index++];
+
+        // vertical span over all values inside the pixel, then continue from the last one
+        int yUsageMax = bottom - ((bucket.m_maxUsage - minUsage) * (bottom - top)) / peakUsage;
+        int yUsageMin = bottom - ((bucket.m_minUsage - minUsage) * (bottom - top)) / peakUsage;
+        yUsage = bottom - ((bucket.m_lastUsage - minUsage) * (bottom - top)) / peakUsage;
 
-        yUsage = bottom - ((entry_graph.m_usage - minUsage) * (bottom - top)) / peakUsage;
-        yLive = bottom - ((entry_graph.m_numLiveBlocks - minLive) * (bottom - top)) / peakLive;
+        int yLiveMax = bottom - ((bucket.m_maxLiveBlocks - minLive) * (bottom - top)) / peakLive;
+        int yLiveMin = bottom - ((bucket.m_minLiveBlocks - minLive) * (bottom - top)) / peakLive;
+        yLive = bottom - ((bucket.m_lastLiveBlocks - minLive) * (bottom - top)) / peakLive;
 
-        pathUsageCurve.lineTo(xcoord, yUsage);
-        pathLiveCurve.lineTo(xcoord, yLive);
+        pathUsageCurve.lineTo(xcoord, yUsageMax);
+        if (yUsageMin != yUsageMax)
+        {
+            pathUsageCurve.lineTo(xcoord, yUsageMin);
+            pathUsageCurve.lineTo(xcoord, yUsage);
+        }
+
+        pathLiveCurve.lineTo(xcoord, yLiveMax);
+        if (yLiveMin != yLiveMax)
+        {
+            pathLiveCurve.lineTo(xcoord, yLiveMin);
+            pathLiveCurve.lineTo(xcoord, yLive);
+        }
 
         xcoord += 1;
     }
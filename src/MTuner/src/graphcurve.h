@@ -12,7 +12,7 @@ class GraphWidget;
 class GraphCurve : public QGraphicsItem
 {
 private:
-    typedef std::vector<rtm::GraphEntry> GraphVec;
+    typedef std::vector<rtm::GraphBucket> GraphVec;
 
     Graph* m_graph;
     GraphWidget* m_graphWidget;
@@ -83,14 +83,16 @@ static bool __uncaught_exception()
 struct pSortType
 {
     std::vector<rtm::MemoryOperationGroup*>* m_allGroups;
-    pSortType(std::vector<rtm::MemoryOperationGroup*>& _groups)
+    const rtm::MemoryOperations* m_ops;
+    pSortType(std::vector<rtm::MemoryOperationGroup*>& _groups, const rtm::MemoryOperations* _ops)
         : m_allGroups(&_groups)
+        , m_ops(_ops)
     {
     }
 
     inline uint8_t operator()(const uint32_t _val) const
     {
-        return (*m_allGroups)[_val]->m_operations[0]->m_operationType;
+        return m_ops->getType((*m_allGroups)[_val]->m_operations[0]);
     }
 };
 
@@ -98,14 +100,16 @@ struct pSortType
 struct pSortHeap
 {
     std::vector<rtm::MemoryOperationGroup*>* m_allGroups;
-    pSortHeap(std::vector<rtm::MemoryOperationGroup*>& _groups)
+    const rtm::Capture* m_capture;
+    pSortHeap(std::vector<rtm::MemoryOperationGroup*>& _groups, const rtm::Capture* _capture)
         : m_allGroups(&_groups)
+        , m_capture(_capture)
     {
     }
 
     inline uint64_t operator()(const uint32_t _val) const
     {
-        return (*m_allGroups)[_val]->m_operations[0]->m_allocatorHandle;
+        return m_capture->getHeapHandle((*m_allGroups)[_val]->m_operations[0]);
     }
 };
 
@@ -177,14 +181,16 @@ struct pSortCountPeakPercent
 struct pSortAlignment
 {
     std::vector<rtm::MemoryOperationGroup*>* m_allGroups;
-    pSortAlignment(std::vector<rtm::MemoryOperationGroup*>& _groups)
+    const rtm::MemoryOperations* m_ops;
+    pSortAlignment(std::vector<rtm::MemoryOperationGroup*>& _groups, const rtm::MemoryOperations* _ops)
         : m_allGroups(&_groups)
+        , m_ops(_ops)
     {
     }
 
     inline uint8_t operator()(const uint32_t _val) const
     {
-        return (*m_allGroups)[_val]->m_operations[0]->m_alignment;
+        return m_ops->m_alignment[(*m_allGroups)[_val]->m_operations[0]];
     }
 };
 
@@ -281,30 +287,34 @@ struct pSetGroupMappings
 struct pSortTypeNVC
 {
     std::vector<rtm::MemoryOperationGroup*>* m_allGroups;
-    pSortTypeNVC(std::vector<rtm::MemoryOperationGroup*>& _groups)
+    const rtm::MemoryOperations* m_ops;
+    pSortTypeNVC(std::vector<rtm::MemoryOperationGroup*>& _groups, const rtm::MemoryOperations* _ops)
         : m_allGroups(&_groups)
+        , m_ops(_ops)
     {
     }
 
     inline bool operator()(const uint32_t _val1, const uint32_t _val2) const
     {
-        return (*m_allGroups)[_val1]->m_operations[0]->m_operationType <
-               (*m_allGroups)[_val2]->m_operations[0]->m_operationType;
+        return m_ops->getType((*m_allGroups)[_val1]->m_operations[0]) <
+               m_ops->getType((*m_allGroups)[_val2]->m_operations[0]);
     }
 };
 
 struct pSortHeapNVC
 {
     std::vector<rtm::MemoryOperationGroup*>* m_allGroups;
-    pSortHeapNVC(std::vector<rtm::MemoryOperationGroup*>& _groups)
+    const rtm::Capture* m_capture;
+    pSortHeapNVC(std::vector<rtm::MemoryOperationGroup*>& _groups, const rtm::Capture* _capture)
         : m_allGroups(&_groups)
+        , m_capture(_capture)
     {
     }
 
     inline bool operator()(const uint32_t _val1, const uint32_t _val2) const
     {
-        return (*m_allGroups)[_val1]->m_operations[0]->m_allocatorHandle <
-               (*m_allGroups)[_val2]->m_operations[0]->m_allocatorHandle;
+        return m_capture->getHeapHandle((*m_allGroups)[_val1]->m_operations[0]) <
+               m_capture->getHeapHandle((*m_allGroups)[_val2]->m_operations[0]);
     }
 };
 
@@ -371,15 +381,17 @@ struct pSortCountPeakPercentNVC
 struct pSortAlignmentNVC
 {
     std::vector<rtm::MemoryOperationGroup*>* m_allGroups;
-    pSortAlignmentNVC(std::vector<rtm::MemoryOperationGroup*>& _groups)
+    const rtm::MemoryOperations* m_ops;
+    pSortAlignmentNVC(std::vector<rtm::MemoryOperationGroup*>& _groups, const rtm::MemoryOperations* _ops)
         : m_allGroups(&_groups)
+        , m_ops(_ops)
     {
     }
 
     inline bool operator()(const uint32_t _val1, const uint32_t _val2) const
     {
-        return (*m_allGroups)[_val1]->m_operations[0]->m_alignment <
-               (*m_allGroups)[_val2]->m_operations[0]->m_alignment;
+        return m_ops->m_alignment[(*m_allGroups)[_val1]->m_operations[0]] <
+               m_ops->m_alignment[(*m_allGroups)[_val2]->m_operations[0]];
     }
 };
 
@@ -515,6 +527,7 @@ void GroupTableSource::prepareData()
         m_groupMappings[i].m_sortedIdx.resize(numItems);
         m_groupMappings[i].m_columnIndex = i;
         m_groupMappings[i].m_allGroups = &m_allGroups;
+        m_groupMappings[i].m_capture = m_context->m_capture;
     }
 
     uint32_t* dst = m_groupMappings[0].m_sortedIdx.data();
@@ -527,12 +540,12 @@ void GroupTableSource::prepareData()
         // sort index arrays
 #if RTM_PLATFORM_WINDOWS && RTM_COMPILER_MSVC
 
-    pSortType psType(m_allGroups);
+    pSortType psType(m_allGroups, &m_context->m_capture->getMemoryOps());
     concurrency::parallel_radixsort(m_groupMappings[GroupColumn::Type].m_sortedIdx.begin(),
                                     m_groupMappings[GroupColumn::Type].m_sortedIdx.end(),
                                     psType);
 
-    pSortHeap psHeap(m_allGroups);
+    pSortHeap psHeap(m_allGroups, m_context->m_capture);
     concurrency::parallel_radixsort(m_groupMappings[GroupColumn::Heap].m_sortedIdx.begin(),
                                     m_groupMappings[GroupColumn::Heap].m_sortedIdx.end(),
                                     psHeap);
@@ -557,7 +570,7 @@ void GroupTableSource::prepareData()
                                     m_groupMappings[GroupColumn::CountPeakPercent].m_sortedIdx.end(),
                                     psCountPeakPercent);
 
-    pSortAlignment psAlignment(m_allGroups);
+    pSortAlignment psAlignment(m_allGroups, &m_context->m_capture->getMemoryOps());
     concurrency::parallel_radixsort(m_groupMappings[GroupColumn::Alignment].m_sortedIdx.begin(),
                                     m_groupMappings[GroupColumn::Alignment].m_sortedIdx.end(),
                                     psAlignment);
@@ -592,11 +605,11 @@ void GroupTableSource::prepareData()
 #else
     std::stable_sort(m_groupMappings[GroupColumn::Type].m_sortedIdx.begin(),
                      m_groupMappings[GroupColumn::Type].m_sortedIdx.end(),
-                     pSortTypeNVC(m_allGroups));
+                     pSortTypeNVC(m_allGroups, &m_context->m_capture->getMemoryOps()));
 
     std::stable_sort(m_groupMappings[GroupColumn::Heap].m_sortedIdx.begin(),
                      m_groupMappings[GroupColumn::Heap].m_sortedIdx.end(),
-                     pSortHeapNVC(m_allGroups));
+                     pSortHeapNVC(m_allGroups, m_context->m_capture));
 
     std::stable_sort(m_groupMappings[GroupColumn::Size].m_sortedIdx.begin(),
                      m_groupMappings[GroupColumn::Size].m_sortedIdx.end(),
@@ -616,7 +629,7 @@ void GroupTableSource::prepareData()
 
     std::stable_sort(m_groupMappings[GroupColumn::Alignment].m_sortedIdx.begin(),
                      m_groupMappings[GroupColumn::Alignment].m_sortedIdx.end(),
-                     pSortAlignmentNVC(m_allGroups));
+                     pSortAlignmentNVC(m_allGroups, &m_context->m_capture->getMemoryOps()));
 
     std::stable_sort(m_groupMappings[GroupColumn::GroupSize].m_sortedIdx.begin(),
                      m_groupMappings[GroupColumn::GroupSize].m_sortedIdx.end(),
@@ -688,17 +701,18 @@ QString GroupTableSource::getItem(uint32_t _index, int32_t _column, QColor*, boo
                                                                   QObject::tr("Realloc"),
                                                                   QObject::tr("Realloc aligned")};
 
-            return typeName[group->m_operations[0]->m_operationType];
+            return typeName[m_context->m_capture->getMemoryOps().getType(group->m_operations[0])];
         }
 
         case GroupColumn::Heap:
         {
             rtm::HeapsType& heaps = m_context->m_capture->getHeaps();
-            rtm::HeapsType::iterator it = heaps.find(group->m_operations[0]->m_allocatorHandle);
+            const uint64_t handle = m_context->m_capture->getHeapHandle(group->m_operations[0]);
+            rtm::HeapsType::iterator it = heaps.find(handle);
             if (it != heaps.end())
                 return it->second.c_str();
             else
-                return QString("0x") + QString::number(group->m_operations[0]->m_allocatorHandle, 16);
+                return QString("0x") + QString::number(handle, 16);
         }
 
         case GroupColumn::Size:
@@ -711,17 +725,18 @@ QString GroupTableSource::getItem(uint32_t _index, int32_t _column, QColor*, boo
             return formatPercentageView(group->m_count, m_stats->m_numberOfOperations);
 
         case GroupColumn::CountPeak:
-            return locale.toString(group->m_liveCountPeak);
+            return locale.toString(qulonglong(group->m_liveCountPeak));
 
         case GroupColumn::CountPeakPercent:
             return formatPercentageView(group->m_liveCountPeak, group->m_liveCountPeakGlobal, false);
 
         case GroupColumn::Alignment:
         {
-            if (group->m_operations[0]->m_alignment == 255)
+            const uint8_t alignment = m_context->m_capture->getMemoryOps().m_alignment[group->m_operations[0]];
+            if (alignment == 255)
                 return QObject::tr("Default");
             else
-                return QString::number(1 << group->m_operations[0]->m_alignment);
+                return QString::number(1 << alignment);
         }
 
         case GroupColumn::GroupSize:
@@ -803,6 +818,7 @@ GroupList::GroupList(QWidget* _parent, Qt::WindowFlags _flags)
     m_enableFiltering = false;
     m_lastRange[0] = 0;
     m_lastRange[1] = 1;
+    m_currentTrace = NULL;
     m_groupList = findChild<BigTable*>("bigTableWidget");
     connect(m_groupList, SIGNAL(itemSelected(void*)), this, SLOT(selectionChanged(void*)));
     connect(m_groupList,
@@ -892,20 +908,22 @@ void GroupList::saveState(QSettings& _settings)
 void GroupList::selectionChanged(void* _item)
 {
     rtm::MemoryOperationGroup* group = (rtm::MemoryOperationGroup*)_item;
+    const rtm::MemoryOperations& ops = m_context->m_capture->getMemoryOps();
 
     if (group->m_count == 1)
     {
-        emit highlightTime(group->m_operations[0]->m_operationTime);
+        emit highlightTime(ops.m_time[group->m_operations[0]]);
     }
     else
     {
         size_t len = group->m_operations.size();
-        uint64_t mn = group->m_operations[0]->m_operationTime;
-        uint64_t mx = group->m_operations[len - 1]->m_operationTime;
+        uint64_t mn = ops.m_time[group->m_operations[0]];
+        uint64_t mx = ops.m_time[group->m_operations[len - 1]];
         emit highlightRange(mn, mx);
     }
 
-    emit setStackTrace(&(group->m_operations[0]->m_stackTrace), 1);
+    m_currentTrace = m_context->m_capture->getStackTrace(ops.m_stackTrace[group->m_operations[0]]);
+    emit setStackTrace(&m_currentTrace, 1);
 }
 
 void GroupList::groupRightClick(void* _item, const QPoint& _pos)
@@ -914,8 +932,9 @@ void GroupList::groupRightClick(void* _item, const QPoint& _pos)
     size_t last = group->m_operations.size();
     if (last > 0)
         --last;
-    m_lastRange[0] = group->m_operations[0]->m_operationTime;
-    m_lastRange[1] = group->m_operations[last]->m_operationTime;
+    const rtm::MemoryOperations& ops = m_context->m_capture->getMemoryOps();
+    m_lastRange[0] = ops.m_time[group->m_operations[0]];
+    m_lastRange[1] = ops.m_time[group->m_operations[last]];
 
     m_selectAction = new QAction(QString(tr("Select group range")), this);
     connect(m_selectAction, SIGNAL(triggered()), this, SLOT(selectTriggered()));
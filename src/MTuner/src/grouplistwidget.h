@@ -15,6 +15,7 @@ struct GroupMapping
 {
     uint32_t m_columnIndex;
     std::vector<rtm::MemoryOperationGroup*>* m_allGroups;
+    const rtm::Capture* m_capture;
     std::vector<uint32_t> m_sortedIdx;
 };
 
@@ -28,6 +29,7 @@ private:
     GroupTableSource* m_tableSource;
     bool m_enableFiltering;
     uint64_t m_lastRange[2];
+    rtm::StackTrace* m_currentTrace;
     QAction* m_selectAction;
     QMenu* m_contextMenu;
 
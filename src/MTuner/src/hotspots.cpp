@@ -16,6 +16,7 @@ HotspotsWidget::HotspotsWidget(QWidget* _parent, Qt::WindowFlags _flags)
     m_usageMapping = NULL;
     m_peakUsageMapping = NULL;
     m_leaksMapping = NULL;
+    m_currentTrace = NULL;
 
     m_usageTable = findChild<QTableWidget*>("tableUsage");
     m_peakUsageTable = findChild<QTableWidget*>("tablePeak");
@@ -69,6 +70,7 @@ static rtm::MemoryOperationGroup* getGroupFromMapping(GroupMapping* _group, int
 
 void HotspotsWidget::usageSortingDone(GroupMapping* _group)
 {
+    const rtm::MemoryOperations& ops = _group->m_capture->getMemoryOps();
     m_usageMapping = _group;
 
     int rows = m_usageTable->rowCount();
@@ -89,7 +91,7 @@ void HotspotsWidget::usageSortingDone(GroupMapping* _group)
 
         m_usageTable->insertRow(i);
 
-        m_usageTable->setItem(i, 0, new QTableWidgetItem(s_typeName[group->m_operations[0]->m_operationType]));
+        m_usageTable->setItem(i, 0, new QTableWidgetItem(s_typeName[ops.getType(group->m_operations[0])]));
 
         QString size;
         if (group->m_maxSize != group->m_minSize)
@@ -100,10 +102,10 @@ void HotspotsWidget::usageSortingDone(GroupMapping* _group)
         m_usageTable->setItem(i, 1, new QTableWidgetItem(size));
         m_usageTable->setItem(i,
                               2,
-                              new QTableWidgetItem((group->m_operations[0]->m_alignment == 255)
+                              new QTableWidgetItem((ops.m_alignment[group->m_operations[0]] == 255)
                                                        ? QString("Default")
-                                                       : QString::number(1 << group->m_operations[0]->m_alignment)));
-        m_usageTable->setItem(i, 3, new QTableWidgetItem(locale.toString(group->m_liveCount)));
+                                                       : QString::number(1 << ops.m_alignment[group->m_operations[0]])));
+        m_usageTable->setItem(i, 3, new QTableWidgetItem(locale.toString(qulonglong(group->m_liveCount))));
         m_usageTable->setItem(i, 4, new QTableWidgetItem(locale.toString((qlonglong)group->m_liveSize)));
 
         for (int j = 0; j < 5; ++j)
@@ -113,6 +115,7 @@ void HotspotsWidget::usageSortingDone(GroupMapping* _group)
 
 void HotspotsWidget::peakUsageSortingDone(GroupMapping* _group)
 {
+    const rtm::MemoryOperations& ops = _group->m_capture->getMemoryOps();
     m_peakUsageMapping = _group;
 
     int rows = m_peakUsageTable->rowCount();
@@ -132,7 +135,7 @@ void HotspotsWidget::peakUsageSortingDone(GroupMapping* _group)
             break;
 
         m_peakUsageTable->insertRow(i);
-        m_peakUsageTable->setItem(i, 0, new QTableWidgetItem(s_typeName[group->m_operations[0]->m_operationType]));
+        m_peakUsageTable->setItem(i, 0, new QTableWidgetItem(s_typeName[ops.getType(group->m_operations[0])]));
 
         QString size;
         if (group->m_maxSize != group->m_minSize)
@@ -144,10 +147,10 @@ void HotspotsWidget::peakUsageSortingDone(GroupMapping* _group)
         m_peakUsageTable->setItem(i,
                                   2,
                                   new QTableWidgetItem(
-                                      (group->m_operations[0]->m_alignment == 255)
+                                      (ops.m_alignment[group->m_operations[0]] == 255)
                                           ? QString("Default")
-                                          : QString::number(1 << group->m_operations[0]->m_alignment)));
-        m_peakUsageTable->setItem(i, 3, new QTableWidgetItem(locale.toString(group->m_liveCountPeak)));
+                                          : QString::number(1 << ops.m_alignment[group->m_operations[0]])));
+        m_peakUsageTable->setItem(i, 3, new QTableWidgetItem(locale.toString(qulonglong(group->m_liveCountPeak))));
         m_peakUsageTable->setItem(i, 4, new QTableWidgetItem(locale.toString((qlonglong)group->m_peakSize)));
 
         for (int j = 0; j < 5; ++j)
@@ -157,6 +160,7 @@ void HotspotsWidget::peakUsageSortingDone(GroupMapping* _group)
 
 void HotspotsWidget::peakCountSortingDone(GroupMapping* _group)
 {
+    const rtm::MemoryOperations& ops = _group->m_capture->getMemoryOps();
     m_peakCountUsageMapping = _group;
 
     int rows = m_peakCountTable->rowCount();
@@ -175,7 +179,7 @@ void HotspotsWidget::peakCountSortingDone(GroupMapping* _group)
             break;
 
         m_peakCountTable->insertRow(i);
-        m_peakCountTable->setItem(i, 0, new QTableWidgetItem(s_typeName[group->m_operations[0]->m_operationType]));
+        m_peakCountTable->setItem(i, 0, new QTableWidgetItem(s_typeName[ops.getType(group->m_operations[0])]));
 
         QString size;
         if (group->m_maxSize != group->m_minSize)
@@ -186,10 +190,10 @@ void HotspotsWidget::peakCountSortingDone(GroupMapping* _group)
         m_peakCountTable->setItem(i,
                                   2,
                                   new QTableWidgetItem(
-                                      (group->m_operations[0]->m_alignment == 255)
+                                      (ops.m_alignment[group->m_operations[0]] == 255)
                                           ? QString("Default")
-                                          : QString::number(1 << group->m_operations[0]->m_alignment)));
-        m_peakCountTable->setItem(i, 3, new QTableWidgetItem(locale.toString(group->m_liveCountPeak)));
+                                          : QString::number(1 << ops.m_alignment[group->m_operations[0]])));
+        m_peakCountTable->setItem(i, 3, new QTableWidgetItem(locale.toString(qulonglong(group->m_liveCountPeak))));
         m_peakCountTable->setItem(i, 4, new QTableWidgetItem(locale.toString((qlonglong)group->m_peakSize)));
 
         for (int j = 0; j < 5; ++j)
@@ -199,6 +203,7 @@ void HotspotsWidget::peakCountSortingDone(GroupMapping* _group)
 
 void HotspotsWidget::leaksSortingDone(GroupMapping* _group)
 {
+    const rtm::MemoryOperations& ops = _group->m_capture->getMemoryOps();
     m_leaksMapping = _group;
 
     int rows = m_leaksTable->rowCount();
@@ -213,11 +218,11 @@ void HotspotsWidget::leaksSortingDone(GroupMapping* _group)
 
         rtm::MemoryOperationGroup* group = getGroupFromMapping(_group, i);
 
-        if (group->m_liveCount * group->m_operations[0]->m_allocSize == 0)
+        if (group->m_liveCount * ops.m_allocSize[group->m_operations[0]] == 0)
             break;
 
         m_leaksTable->insertRow(i);
-        m_leaksTable->setItem(i, 0, new QTableWidgetItem(s_typeName[group->m_operations[0]->m_operationType]));
+        m_leaksTable->setItem(i, 0, new QTableWidgetItem(s_typeName[ops.getType(group->m_operations[0])]));
 
         QString size;
         if (group->m_maxSize != group->m_minSize)
@@ -228,10 +233,10 @@ void HotspotsWidget::leaksSortingDone(GroupMapping* _group)
         m_leaksTable->setItem(i, 1, new QTableWidgetItem(size));
         m_leaksTable->setItem(i,
                               2,
-                              new QTableWidgetItem((group->m_operations[0]->m_alignment == 255)
+                              new QTableWidgetItem((ops.m_alignment[group->m_operations[0]] == 255)
                                                        ? QString("Default")
-                                                       : QString::number(1 << group->m_operations[0]->m_alignment)));
-        m_leaksTable->setItem(i, 3, new QTableWidgetItem(locale.toString(group->m_liveCount)));
+                                                       : QString::number(1 << ops.m_alignment[group->m_operations[0]])));
+        m_leaksTable->setItem(i, 3, new QTableWidgetItem(locale.toString(qulonglong(group->m_liveCount))));
         m_leaksTable->setItem(i, 4, new QTableWidgetItem(locale.toString((qlonglong)group->m_liveSize)));
 
         for (int j = 0; j < 5; ++j)
@@ -248,19 +253,21 @@ void HotspotsWidget::updateStackTrace(QTableWidget* _table)
 {
     QTableWidget* w = _table;
     int row = w->currentItem()->row();
-    rtm::MemoryOperationGroup* group = 0;
+    GroupMapping* mapping = 0;
 
     if (w == m_usageTable)
-        group = getGroupFromMapping(m_usageMapping, row);
+        mapping = m_usageMapping;
 
     if (w == m_peakUsageTable)
-        group = getGroupFromMapping(m_peakUsageMapping, row);
+        mapping = m_peakUsageMapping;
 
     if (w == m_peakCountTable)
-        group = getGroupFromMapping(m_peakCountUsageMapping, row);
+        mapping = m_peakCountUsageMapping;
 
     if (w == m_leaksTable)
-        group = getGroupFromMapping(m_leaksMapping, row);
+        mapping = m_leaksMapping;
+
+    rtm::MemoryOperationGroup* group = mapping ? getGroupFromMapping(mapping, row) : 0;
 
     if (w != m_usageTable)
         m_usageTable->clearSelection();
@@ -273,11 +280,14 @@ void HotspotsWidget::updateStackTrace(QTableWidget* _table)
 
     if (group)
     {
-        emit setStackTrace(&(group->m_operations[0]->m_stackTrace), 1);
+        const rtm::MemoryOperations& ops = mapping->m_capture->getMemoryOps();
+
+        m_currentTrace = mapping->m_capture->getStackTrace(ops.m_stackTrace[group->m_operations[0]]);
+        emit setStackTrace(&m_currentTrace, 1);
 
         size_t len = group->m_operations.size();
-        uint64_t mn = group->m_operations[0]->m_operationTime;
-        uint64_t mx = group->m_operations[len - 1]->m_operationTime;
+        uint64_t mn = ops.m_time[group->m_operations[0]];
+        uint64_t mx = ops.m_time[group->m_operations[len - 1]];
         emit highlightRange(mn, mx);
     }
 }
@@ -50,6 +50,7 @@ class HotspotsWidget : public QWidget
     QTableWidget* m_leaksTable;
     GroupMapping* m_leaksMapping;
     TableKeyWatcher* m_tableKeyWatch;
+    rtm::StackTrace* m_currentTrace;
 
 public:
     HotspotsWidget(QWidget* _parent = 0, Qt::WindowFlags _flags = (Qt::WindowFlags)0);
@@ -0,0 +1,271 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/addr2line.h>
+
+namespace rtm
+{
+/// Reads ELF header of a module, only ELF modules can be symbolized by addr2line
+static bool getModuleType(const char* _modulePath, bool& _relative)
+{
+    QFile file(QString::fromUtf8(_modulePath));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    uint8_t header[18];
+    if (file.read((char*)header, sizeof(header)) != (qint64)sizeof(header))
+        return false;
+
+    if ((header[0] != 0x7f) || (header[1] != 'E') || (header[2] != 'L') || (header[3] != 'F'))
+        return false;
+
+    // e_type follows 16 bytes of e_ident, EI_DATA tells the byte order
+    const bool bigEndian = header[5] == 2;
+    const uint16_t type = bigEndian ? (uint16_t)((header[16] << 8) | header[17])
+                                    : (uint16_t)((header[17] << 8) | header[16]);
+
+    // ET_DYN covers shared objects and position independent executables
+    _relative = type == 3;
+    return true;
+}
+
+Addr2Line::Addr2Line()
+    : m_quit(false)
+{
+}
+
+Addr2Line::~Addr2Line()
+{
+    clear();
+}
+
+bool Addr2Line::init(const rdebug::Toolchain& _toolchain)
+{
+    clear();
+
+    if (_toolchain.m_type != rdebug::Toolchain::GCC)
+        return false;
+
+#if RTM_PLATFORM_WINDOWS
+    const char* toolName = "addr2line.exe";
+#else
+    const char* toolName = "addr2line";
+#endif
+
+    // toolchain path may or may not end with the prefix already
+    const std::string path = _toolchain.m_toolchainPath;
+    const std::string candidates[] = {path + _toolchain.m_toolchainPrefix + toolName, path + toolName};
+    for (const std::string& candidate : candidates)
+    {
+        if (QFileInfo(QString::fromUtf8(candidate.c_str())).isFile())
+        {
+            m_tool = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Addr2Line::clear()
+{
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_jobAdded.notify_one();
+        m_thread.join();
+        m_quit = false;
+    }
+
+    m_tool.clear();
+}
+
+bool Addr2Line::resolve(const char* _modulePath,
+                        uint64_t _baseAddress,
+                        const uint64_t* _addresses,
+                        size_t _count,
+                        rdebug::StackFrame* _frames)
+{
+    if (!isValid())
+        return false;
+
+    Job job;
+    job.m_modulePath = _modulePath;
+    job.m_baseAddress = _baseAddress;
+    job.m_addresses = _addresses;
+    job.m_count = _count;
+    job.m_frames = _frames;
+    job.m_result = false;
+    job.m_done = false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_thread.joinable())
+        m_thread = std::thread(&Addr2Line::run, this);
+
+    m_jobs.push_back(&job);
+    m_jobAdded.notify_one();
+    m_jobDone.wait(lock, [&job] { return job.m_done; });
+    return job.m_result;
+}
+
+void Addr2Line::run()
+{
+    for (;;)
+    {
+        Job* job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobAdded.wait(lock, [this] { return m_quit || !m_jobs.empty(); });
+            if (m_quit)
+                break;
+
+            job = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        const bool result = runJob(*job);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            job->m_result = result;
+            job->m_done = true;
+        }
+        m_jobDone.notify_all();
+    }
+
+    // processes belong to this thread, closing the input ends them
+    for (auto& it : m_processes)
+    {
+        QProcess* process = it.second.m_process;
+        if (!process)
+            continue;
+
+        process->closeWriteChannel();
+        if (!process->waitForFinished(1000))
+            process->kill();
+        delete process;
+    }
+    m_processes.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Job* job : m_jobs)
+        job->m_done = true;
+    m_jobs.clear();
+    m_jobDone.notify_all();
+}
+
+bool Addr2Line::runJob(Job& _job)
+{
+    Process& process = getProcess(_job.m_modulePath);
+    if (process.m_failed)
+        return false;
+
+    QByteArray input;
+    char buffer[32];
+    for (size_t i = 0; i < _job.m_count; ++i)
+    {
+        uint64_t address = _job.m_addresses[i];
+        if (process.m_relative)
+            address -= _job.m_baseAddress;
+
+        snprintf(buffer, sizeof(buffer), "0x%llx\n", (unsigned long long)address);
+        input.append(buffer);
+    }
+    process.m_process->write(input);
+
+    const char* moduleName = rtm::pathGetFileName(_job.m_modulePath);
+
+    // every address is answered with three lines: the address, function and file:line
+    size_t frame = 0;
+    int line = 0;
+    while (frame < _job.m_count)
+    {
+        if (!process.m_process->canReadLine() && !process.m_process->waitForReadyRead(Timeout))
+            break;
+
+        while ((frame < _job.m_count) && process.m_process->canReadLine())
+        {
+            const QByteArray text = process.m_process->readLine().trimmed();
+            rdebug::StackFrame& stackFrame = _job.m_frames[frame];
+
+            switch (line)
+            {
+                case 0:
+                    if (!text.startsWith("0x"))
+                        frame = _job.m_count + 1;
+                    break;
+
+                case 1:
+                    rtm::strlCpy(stackFrame.m_moduleName, RTM_NUM_ELEMENTS(stackFrame.m_moduleName), moduleName);
+                    rtm::strlCpy(stackFrame.m_func, RTM_NUM_ELEMENTS(stackFrame.m_func), text.constData());
+                    break;
+
+                case 2:
+                {
+                    QByteArray location = text;
+                    const int discriminator = location.indexOf(" (discriminator");
+                    if (discriminator != -1)
+                        location.truncate(discriminator);
+
+                    const int colon = location.lastIndexOf(':');
+                    const QByteArray file = colon == -1 ? location : location.left(colon);
+                    rtm::strlCpy(stackFrame.m_file, RTM_NUM_ELEMENTS(stackFrame.m_file), file.constData());
+                    stackFrame.m_line = colon == -1 ? 0 : location.mid(colon + 1).toUInt();
+                    ++frame;
+                }
+                break;
+            };
+
+            line = (line + 1) % 3;
+        }
+    }
+
+    if (frame == _job.m_count)
+        return true;
+
+    // out of sync or not answering, frames of the module are left to the symbol resolver
+    process.m_process->kill();
+    process.m_process->waitForFinished(1000);
+    delete process.m_process;
+    process.m_process = NULL;
+    process.m_failed = true;
+    return false;
+}
+
+Addr2Line::Process& Addr2Line::getProcess(const char* _modulePath)
+{
+    std::pair<robin_hood::unordered_map<std::string, Process>::iterator, bool> it =
+        m_processes.insert(std::make_pair(std::string(_modulePath), Process()));
+
+    Process& process = it.first->second;
+    if (!it.second)
+        return process;
+
+    process.m_process = NULL;
+    process.m_relative = false;
+    process.m_failed = !getModuleType(_modulePath, process.m_relative);
+    if (process.m_failed)
+        return process;
+
+    process.m_process = new QProcess();
+    process.m_process->setStandardErrorFile(QProcess::nullDevice());
+    process.m_process->start(QString::fromUtf8(m_tool.c_str()),
+                             QStringList() << "-a" << "-f" << "-C" << "-e" << QString::fromUtf8(_modulePath));
+
+    if (!process.m_process->waitForStarted(Timeout))
+    {
+        delete process.m_process;
+        process.m_process = NULL;
+        process.m_failed = true;
+    }
+
+    return process;
+}
+
+}  // namespace rtm
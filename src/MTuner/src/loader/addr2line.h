@@ -0,0 +1,91 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_ADDR2LINE_H__
+#define __RTM_MTUNER_ADDR2LINE_H__
+
+#include <MTuner/src/loader/mtunerlib.h>
+#include <rdebug/inc/rdebug.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+class QProcess;
+
+namespace rtm
+{
+//--------------------------------------------------------------------------
+/// Resolves frames of ELF modules built with GCC or Clang through addr2line.
+/// Each module gets one addr2line process that is kept running, addresses
+/// are written to it in batches and the answers are parsed in bulk, instead
+/// of starting the tool for every lookup. A process can only be used by the
+/// thread that started it, so all processes belong to one thread and callers
+/// wait for it to finish their batches.
+//--------------------------------------------------------------------------
+class Addr2Line
+{
+    enum
+    {
+        Timeout = 60 * 1000  ///< Longest wait for an answer in ms, large debug info takes a while to load
+    };
+
+    struct Process
+    {
+        QProcess* m_process;
+        bool m_relative;  ///< Position independent module, addresses are passed as offsets from its base
+        bool m_failed;
+    };
+
+    struct Job
+    {
+        const char* m_modulePath;
+        uint64_t m_baseAddress;
+        const uint64_t* m_addresses;
+        size_t m_count;
+        rdebug::StackFrame* m_frames;
+        bool m_result;
+        bool m_done;
+    };
+
+    std::string m_tool;
+    robin_hood::unordered_map<std::string, Process> m_processes;  ///< Key is a module path, owned by the thread
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_jobAdded;
+    std::condition_variable m_jobDone;
+    std::deque<Job*> m_jobs;
+    bool m_quit;
+
+public:
+    Addr2Line();
+    ~Addr2Line();
+
+    /// Looks for addr2line of the toolchain, returns false if it can't be used
+    bool init(const rdebug::Toolchain& _toolchain);
+
+    /// Stops all addr2line processes
+    void clear();
+
+    bool isValid() const { return !m_tool.empty(); }
+
+    /// Resolves addresses that belong to a module loaded at the given base address,
+    /// returns false if the module can't be symbolized this way
+    bool resolve(const char* _modulePath,
+                 uint64_t _baseAddress,
+                 const uint64_t* _addresses,
+                 size_t _count,
+                 rdebug::StackFrame* _frames);
+
+private:
+    void run();
+    bool runJob(Job& _job);
+    Process& getProcess(const char* _modulePath);
+};
+
+}  // namespace rtm
+
+#endif  // __RTM_MTUNER_ADDR2LINE_H__
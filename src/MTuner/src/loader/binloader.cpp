@@ -11,147 +11,628 @@
 #define LZ4_DISABLE_DEPRECATE_WARNINGS
 #include <lz4/lz4.h>
 
+#if RTM_PLATFORM_WINDOWS
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #if RTM_COMPILER_MSVC
 #pragma intrinsic(memcpy)
 #endif  // RTM_COMPILER_MSVC
 
 namespace rtm
 {
-BinLoader::BinLoader(FILE* _file, bool _compressed)
+/// Mapped files are consumed in windows of this size so that readahead hints
+/// can be issued for the data that follows the one being parsed
+static const uint64_t s_mapWindowSize = 64 * 1024 * 1024;
+
+/// Upper bound on threads decompressing chunks ahead of the parser
+static const uint32_t s_maxDecompressThreads = 8;
+
+static inline uint64_t getFilePosition(FILE* _file)
+{
+#if RTM_PLATFORM_WINDOWS
+    uint64_t pos = (uint64_t)_ftelli64(_file);
+#elif RTM_PLATFORM_LINUX
+    uint64_t pos = (uint64_t)ftello64(_file);
+#elif RTM_PLATFORM_OSX
+    uint64_t pos = (uint64_t)ftello(_file);
+#endif
+    return pos;
+}
+
+//--------------------------------------------------------------------------
+/// Decompresses a chunk, growing the destination buffer if needed
+//--------------------------------------------------------------------------
+static int32_t decompressChunk(const uint8_t* _srcData, uint32_t _srcSize, uint8_t*& _data, uint32_t& _dataSize)
+{
+    // LZ4 sizes are int, a larger chunk means corrupted data
+    if (_srcSize > (uint32_t)LZ4_MAX_INPUT_SIZE)
+        return -1;
+
+    for (;;)
+    {
+        int32_t dataAvailable =
+            LZ4_decompress_safe((const char*)_srcData, (char*)_data, (int)_srcSize, (int)_dataSize);
+        if (dataAvailable >= 0)
+            return dataAvailable;
+
+        // LZ4 can't expand input more than 255 times, failing beyond that means corrupted data
+        if (((uint64_t)_dataSize > (uint64_t)_srcSize * 255 + 16) || (_dataSize >= (uint32_t)INT32_MAX))
+            return -1;
+
+        delete[] _data;
+        _dataSize = (uint32_t)std::min((uint64_t)_dataSize * 2, (uint64_t)INT32_MAX);
+        _data = new uint8_t[_dataSize];
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Reads and decompresses chunks on worker threads ahead of the parser.
+/// Workers claim chunks in file order, decompress them into a ring of reusable
+/// slots and the parser consumes slots strictly in sequence.
+//--------------------------------------------------------------------------
+struct ChunkPipeline
+{
+    enum State
+    {
+        Free,
+        Busy,
+        Ready,
+        End
+    };
+
+    struct Slot
+    {
+        uint8_t* m_srcBuffer;
+        uint32_t m_srcBufferSize;
+        uint8_t* m_data;
+        uint32_t m_dataSize;
+        int32_t m_dataAvailable;
+        uint64_t m_fileStart;
+        uint64_t m_fileEnd;
+        uint64_t m_sequence;
+        State m_state;
+    };
+
+    BinLoader* m_loader;
+    std::vector<Slot> m_slots;
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_slotFreed;
+    std::condition_variable m_slotDone;
+    uint64_t m_nextRead;
+    uint64_t m_nextConsume;
+    Slot* m_current;
+    bool m_endReached;
+    bool m_stop;
+
+    ChunkPipeline(BinLoader* _loader, uint32_t _numWorkers)
+        : m_loader(_loader)
+        , m_nextRead(0)
+        , m_nextConsume(0)
+        , m_current(0)
+        , m_endReached(false)
+        , m_stop(false)
+    {
+        m_slots.resize(_numWorkers * 4);
+        for (size_t i = 0; i < m_slots.size(); ++i)
+        {
+            Slot& slot = m_slots[i];
+            slot.m_srcBuffer = 0;
+            slot.m_srcBufferSize = 0;
+            slot.m_data = new uint8_t[rmem::MemoryHook::BufferSize];
+            slot.m_dataSize = rmem::MemoryHook::BufferSize;
+            slot.m_dataAvailable = 0;
+            slot.m_fileStart = 0;
+            slot.m_fileEnd = 0;
+            slot.m_sequence = (uint64_t)-1;
+            slot.m_state = Free;
+        }
+
+        for (uint32_t i = 0; i < _numWorkers; ++i)
+            m_workers.emplace_back(&ChunkPipeline::worker, this);
+    }
+
+    ~ChunkPipeline()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_slotFreed.notify_all();
+
+        for (size_t i = 0; i < m_workers.size(); ++i)
+            m_workers[i].join();
+
+        for (size_t i = 0; i < m_slots.size(); ++i)
+        {
+            delete[] m_slots[i].m_srcBuffer;
+            delete[] m_slots[i].m_data;
+        }
+    }
+
+    void worker()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            m_slotFreed.wait(lock, [this] {
+                return m_stop || m_endReached || (m_slots[m_nextRead % m_slots.size()].m_state == Free);
+            });
+
+            if (m_stop || m_endReached)
+                return;
+
+            const uint64_t sequence = m_nextRead++;
+            Slot& slot = m_slots[sequence % m_slots.size()];
+            slot.m_sequence = sequence;
+            slot.m_state = Busy;
+
+            // reading has to follow file order, so it is done under the lock
+            const uint8_t* srcData;
+            uint32_t srcSize;
+            if (!m_loader->readChunk(
+                    srcData, srcSize, slot.m_fileStart, slot.m_fileEnd, slot.m_srcBuffer, slot.m_srcBufferSize))
+            {
+                m_endReached = true;
+                slot.m_state = End;
+                m_slotFreed.notify_all();
+                m_slotDone.notify_all();
+                return;
+            }
+
+            lock.unlock();
+            slot.m_dataAvailable = decompressChunk(srcData, srcSize, slot.m_data, slot.m_dataSize);
+            lock.lock();
+
+            if (slot.m_dataAvailable < 0)
+            {
+                m_endReached = true;
+                slot.m_state = End;
+                m_slotFreed.notify_all();
+            }
+            else
+                slot.m_state = Ready;
+
+            m_slotDone.notify_all();
+        }
+    }
+
+    /// Releases the chunk being parsed and waits for the next one in file order
+    Slot* next()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (m_current)
+        {
+            if (m_current->m_state == End)
+                return 0;
+            m_current->m_state = Free;
+            m_current = 0;
+            m_slotFreed.notify_all();
+        }
+
+        const uint64_t sequence = m_nextConsume;
+        Slot& slot = m_slots[sequence % m_slots.size()];
+        m_slotDone.wait(lock, [&slot, sequence] {
+            return (slot.m_sequence == sequence) && ((slot.m_state == Ready) || (slot.m_state == End));
+        });
+
+        m_current = &slot;
+        if (slot.m_state == End)
+            return 0;
+
+        ++m_nextConsume;
+        return &slot;
+    }
+};
+
+BinLoader::BinLoader(FILE* _file, bool _compressed, bool _decompressAhead)
     : m_file(_file)
 {
     m_compressed = _compressed;
-    m_bytesRead = 0;
     m_srcData = new uint8_t[rmem::MemoryHook::BufferSize];
     m_srcDataSize = rmem::MemoryHook::BufferSize;
     m_data = new uint8_t[rmem::MemoryHook::BufferSize];
-    m_dataPos = 0;
     m_dataSize = rmem::MemoryHook::BufferSize;
-    m_dataAvailable = 0;
+    m_readPtr = m_data;
+    m_readEnd = m_data;
+    m_bufferBase = m_data;
+    m_bufferOffset = 0;
+    m_mapData = 0;
+    m_mapSize = 0;
+    m_mapPos = 0;
+    m_mapHandle = 0;
+    m_mapOwned = false;
+    m_chunkFileStart = 0;
+    m_chunkFileEnd = 0;
+    m_pipeline = 0;
+
+    if (mapFile() && !_compressed)
+    {
+        // the whole file is a single buffer, windows only bound the readahead
+        m_bufferBase = m_mapData;
+        m_readPtr = m_mapData + m_mapPos;
+        m_readEnd = m_readPtr;
+        nextBuffer();
+        return;
+    }
+
+    if (_compressed)
+    {
+        // keep one core for the parser, decompression runs ahead of it
+        const uint32_t numCores = std::thread::hardware_concurrency();
+        if (_decompressAhead && (numCores > 1))
+        {
+            uint32_t numWorkers = numCores - 1;
+            if (numWorkers > s_maxDecompressThreads)
+                numWorkers = s_maxDecompressThreads;
+            m_pipeline = new ChunkPipeline(this, numWorkers);
+        }
+        loadChunk();
+    }
+    else
+        m_bufferOffset = getFilePosition(m_file);
+}
+
+BinLoader::BinLoader(const uint8_t* _data, uint64_t _size, bool _compressed)
+    : m_file(0)
+{
+    m_compressed = _compressed;
+    m_srcData = new uint8_t[rmem::MemoryHook::BufferSize];
+    m_srcDataSize = rmem::MemoryHook::BufferSize;
+    m_data = new uint8_t[rmem::MemoryHook::BufferSize];
+    m_dataSize = rmem::MemoryHook::BufferSize;
+    m_bufferOffset = 0;
+    m_mapData = _data;
+    m_mapSize = _size;
+    m_mapPos = 0;
+    m_mapHandle = 0;
+    m_mapOwned = false;
+    m_chunkFileStart = 0;
+    m_chunkFileEnd = 0;
+    m_pipeline = 0;
 
+    // same as a mapped file, chunks are decompressed inline
     if (_compressed)
+    {
+        m_readPtr = m_data;
+        m_readEnd = m_data;
+        m_bufferBase = m_data;
         loadChunk();
+    }
+    else
+    {
+        m_bufferBase = m_mapData;
+        m_readPtr = m_mapData;
+        m_readEnd = m_mapData + m_mapSize;
+    }
 }
 
 BinLoader::~BinLoader()
 {
+    delete m_pipeline;
+    unmapFile();
     delete[] m_data;
     delete[] m_srcData;
 }
 
 bool BinLoader::eof()
 {
-    if (m_compressed)
-        return (m_dataPos == m_dataAvailable);
+    if (m_readPtr != m_readEnd)
+        return false;
 
-    return (feof(m_file) != 0);
+    return !nextBuffer();
 }
 
 uint64_t BinLoader::tell()
 {
-    if (m_compressed)
-        return m_bytesRead + m_dataPos;
-    else
-        return fileTell();
+    return m_bufferOffset + (uint64_t)(m_readPtr - m_bufferBase);
 }
 
 uint64_t BinLoader::fileTell()
 {
-#if RTM_PLATFORM_WINDOWS
-    uint64_t pos = (uint64_t)_ftelli64(m_file);
-#elif RTM_PLATFORM_LINUX
-    uint64_t pos = (uint64_t)ftello64(m_file);
-#elif RTM_PLATFORM_OSX
-    uint64_t pos = (uint64_t)ftello(m_file);
-#endif
-    return pos;
+    // uncompressed data is read through a buffer, the logical position is what matters
+    if (!m_compressed)
+        return tell();
+
+    return m_chunkFileEnd;
 }
 
-int BinLoader::read(void* _ptr, size_t _size)
+int BinLoader::readSlow(void* _ptr, size_t _size)
 {
-    if (!m_compressed)
-        return (int)fread(_ptr, _size, 1, m_file);
-
-    const int32_t bytesLeft = m_dataAvailable - m_dataPos;
+    uint8_t* dst = (uint8_t*)_ptr;
 
-    if (bytesLeft > (int32_t)_size)
+    while (_size)
     {
-        memcpy(_ptr, &m_data[m_dataPos], _size);
-        m_dataPos += (int32_t)_size;
-        return 1;
-    }
-    else
-    {
-        uint8_t* dst = (uint8_t*)_ptr;
-        if (bytesLeft)
+        size_t bytesLeft = (size_t)(m_readEnd - m_readPtr);
+        if (bytesLeft == 0)
         {
-            memcpy(dst, &m_data[m_dataPos], bytesLeft);
-            m_dataPos += bytesLeft;
+            if (!nextBuffer())
+                return 0;
+            continue;
         }
 
+        if (bytesLeft > _size)
+            bytesLeft = _size;
+
+        memcpy(dst, m_readPtr, bytesLeft);
+        m_readPtr += bytesLeft;
         dst += bytesLeft;
+        _size -= bytesLeft;
+    }
 
-        const int32_t remaining = (int32_t)_size - bytesLeft;
+    return 1;
+}
 
-        if (m_dataPos == m_dataAvailable)
+bool BinLoader::skip(size_t _size)
+{
+    while (_size)
+    {
+        size_t bytesLeft = (size_t)(m_readEnd - m_readPtr);
+        if (bytesLeft == 0)
         {
-            m_bytesRead += m_dataAvailable;
-            if (!loadChunk())
-                return (remaining == 0) ? 1 : 0;
-            m_dataPos = 0;
+            if (!nextBuffer())
+                return false;
+            continue;
         }
 
-        if (remaining > 0)
+        if (bytesLeft > _size)
+            bytesLeft = _size;
+
+        m_readPtr += bytesLeft;
+        _size -= bytesLeft;
+    }
+
+    return true;
+}
+
+const uint8_t* BinLoader::getDataSlow(size_t _size)
+{
+    RTM_ASSERT(_size <= sizeof(m_staging), "Record too large for staging buffer");
+    if (_size > sizeof(m_staging))
+        return 0;
+
+    if (readSlow(m_staging, _size) != 1)
+        return 0;
+
+    return m_staging;
+}
+
+bool BinLoader::nextBuffer()
+{
+    if (m_mapData && !m_compressed)
+    {
+        const uint8_t* mapEnd = m_mapData + m_mapSize;
+        if (m_readEnd == mapEnd)
+            return false;
+
+        uint64_t window = (uint64_t)(mapEnd - m_readEnd);
+        if (window > s_mapWindowSize)
+            window = s_mapWindowSize;
+        m_readEnd += window;
+
+        // ask for the window after this one while the current one is parsed
+        if (m_readEnd != mapEnd)
         {
-            memcpy(dst, &m_data[m_dataPos], remaining);
-            m_dataPos += remaining;
+            uint64_t nextWindow = (uint64_t)(mapEnd - m_readEnd);
+            adviseWindow(m_readEnd, nextWindow > s_mapWindowSize ? s_mapWindowSize : nextWindow);
         }
-        return 1;
+        return true;
     }
+
+    m_bufferOffset += (uint64_t)(m_readEnd - m_bufferBase);
+
+    if (m_compressed)
+        return loadChunk();
+
+    size_t bytesRead = fread(m_data, 1, (size_t)m_dataSize, m_file);
+    m_bufferBase = m_data;
+    m_readPtr = m_data;
+    m_readEnd = m_data + bytesRead;
+    return bytesRead != 0;
 }
 
-bool BinLoader::loadChunk()
+//--------------------------------------------------------------------------
+/// Reads the next compressed chunk, _buffer holds the data if file is not mapped
+//--------------------------------------------------------------------------
+bool BinLoader::readChunk(const uint8_t*& _srcData,
+                          uint32_t& _srcSize,
+                          uint64_t& _fileStart,
+                          uint64_t& _fileEnd,
+                          uint8_t*& _buffer,
+                          uint32_t& _bufferSize)
 {
     uint32_t sig, size;
-    size_t e = fread(&sig, sizeof(uint32_t), 1, m_file);
-    if (e != 1)
-        return false;
 
-    if (!((sig == 0x23234646) || sig == Endian::swap(uint32_t(0x23234646))))
-        return false;
+    if (m_mapData)
+    {
+        if (m_mapSize - m_mapPos < sizeof(uint32_t) * 2)
+            return false;
 
-    e = fread(&size, sizeof(uint32_t), 1, m_file);
-    if (e == 0)
+        _fileStart = m_mapPos;
+        memcpy(&sig, m_mapData + m_mapPos, sizeof(uint32_t));
+        memcpy(&size, m_mapData + m_mapPos + sizeof(uint32_t), sizeof(uint32_t));
+    }
+    else
+    {
+        _fileStart = getFilePosition(m_file);
+
+        size_t e = fread(&sig, sizeof(uint32_t), 1, m_file);
+        if (e != 1)
+            return false;
+
+        e = fread(&size, sizeof(uint32_t), 1, m_file);
+        if (e == 0)
+            return false;
+    }
+
+    if (!((sig == 0x23234646) || sig == Endian::swap(uint32_t(0x23234646))))
         return false;
 
     if (sig == Endian::swap(uint32_t(0x23234646)))
         size = Endian::swap(size);
 
-    if (m_srcDataSize < (int32_t)size)
+    if (m_mapData)
     {
-        delete[] m_srcData;
-        m_srcData = new uint8_t[size];
-        m_srcDataSize = size;
+        if (m_mapSize - m_mapPos - sizeof(uint32_t) * 2 < (uint64_t)size)
+            return false;
+
+        _srcData = m_mapData + m_mapPos + sizeof(uint32_t) * 2;
+        m_mapPos += sizeof(uint32_t) * 2 + size;
+        _fileEnd = m_mapPos;
     }
+    else
+    {
+        if (_bufferSize < size)
+        {
+            delete[] _buffer;
+            _buffer = new uint8_t[size];
+            _bufferSize = size;
+        }
+
+        size_t e = fread(_buffer, 1, size, m_file);
+
+        if (e != size)
+            return false;
 
-    e = fread(m_srcData, 1, size, m_file);
+        _srcData = _buffer;
+        _fileEnd = getFilePosition(m_file);
+    }
 
-    if (e != size)
+    _srcSize = size;
+    return true;
+}
+
+bool BinLoader::loadChunk()
+{
+    if (m_pipeline)
+    {
+        ChunkPipeline::Slot* slot = m_pipeline->next();
+        if (!slot)
+            return false;
+
+        m_chunkFileStart = slot->m_fileStart;
+        m_chunkFileEnd = slot->m_fileEnd;
+        m_bufferBase = slot->m_data;
+        m_readPtr = slot->m_data;
+        m_readEnd = slot->m_data + slot->m_dataAvailable;
+        return true;
+    }
+
+    const uint8_t* srcData;
+    uint32_t srcSize;
+    if (!readChunk(srcData, srcSize, m_chunkFileStart, m_chunkFileEnd, m_srcData, m_srcDataSize))
         return false;
 
-    m_dataAvailable = -1;
-    while (m_dataAvailable < 0)
+    int32_t dataAvailable = decompressChunk(srcData, srcSize, m_data, m_dataSize);
+    if (dataAvailable < 0)
+        return false;
+
+    m_bufferBase = m_data;
+    m_readPtr = m_data;
+    m_readEnd = m_data + dataAvailable;
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Maps the file into memory, reading falls back to stdio if this fails
+//--------------------------------------------------------------------------
+bool BinLoader::mapFile()
+{
+    const uint64_t startPos = getFilePosition(m_file);
+
+#if RTM_PLATFORM_WINDOWS
+    HANDLE file = (HANDLE)_get_osfhandle(_fileno(m_file));
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || (fileSize.QuadPart == 0))
+        return false;
+
+    if ((uint64_t)fileSize.QuadPart > (uint64_t)SIZE_MAX)
+        return false;
+
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping)
+        return false;
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data)
     {
-        m_dataAvailable = LZ4_decompress_safe((const char*)m_srcData, (char*)m_data, size, m_dataSize);
-        if (m_dataAvailable < 0)
-        {
-            delete[] m_data;
-            m_dataSize *= 2;
-            m_data = new uint8_t[m_dataSize];
-        }
+        CloseHandle(mapping);
+        return false;
     }
 
+    m_mapHandle = (uintptr_t)mapping;
+    m_mapSize = (uint64_t)fileSize.QuadPart;
+#else
+    int fd = fileno(m_file);
+
+    struct stat fileStat;
+    if ((fstat(fd, &fileStat) != 0) || (fileStat.st_size <= 0))
+        return false;
+
+    if ((uint64_t)fileStat.st_size > (uint64_t)SIZE_MAX)
+        return false;
+
+    void* data = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+        return false;
+
+    m_mapSize = (uint64_t)fileStat.st_size;
+
+#if RTM_PLATFORM_LINUX
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    madvise(data, (size_t)m_mapSize, MADV_SEQUENTIAL);
+#endif
+
+    m_mapData = (const uint8_t*)data;
+    m_mapPos = startPos < m_mapSize ? startPos : m_mapSize;
+    m_mapOwned = true;
     return true;
 }
 
+void BinLoader::unmapFile()
+{
+    if (!m_mapOwned)
+        return;
+
+#if RTM_PLATFORM_WINDOWS
+    UnmapViewOfFile(m_mapData);
+    CloseHandle((HANDLE)m_mapHandle);
+#else
+    munmap((void*)m_mapData, (size_t)m_mapSize);
+#endif
+
+    m_mapData = 0;
+    m_mapHandle = 0;
+    m_mapOwned = false;
+}
+
+void BinLoader::adviseWindow(const uint8_t* _start, uint64_t _size)
+{
+#if RTM_PLATFORM_WINDOWS
+    RTM_UNUSED(_start);
+    RTM_UNUSED(_size);
+#else
+    static const uintptr_t pageMask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+    const uintptr_t offset = (uintptr_t)(_start - m_mapData);
+    const uintptr_t alignedOffset = offset & ~pageMask;
+    madvise((void*)(m_mapData + alignedOffset), (size_t)(_size + offset - alignedOffset), MADV_WILLNEED);
+#endif
+}
+
 }  // namespace rtm
@@ -8,26 +8,76 @@
 
 namespace rtm {
 
+struct ChunkPipeline;
+
 class BinLoader
 {
-	uint8_t*	m_srcData;
-	uint8_t*	m_data;
-	int32_t		m_srcDataSize;
-	int32_t		m_dataSize;
-	int32_t		m_dataAvailable;
-	int32_t		m_dataPos;
-	uint64_t	m_bytesRead;
-	FILE*		m_file;
-	bool		m_compressed;
+	friend struct ChunkPipeline;
+
+	uint8_t*		m_srcData;
+	uint8_t*		m_data;
+	const uint8_t*	m_readPtr;		///< Current read position inside the active buffer
+	const uint8_t*	m_readEnd;		///< End of the active buffer
+	const uint8_t*	m_bufferBase;	///< Start of the active buffer
+	uint64_t		m_bufferOffset;	///< Stream offset of the active buffer start
+	const uint8_t*	m_mapData;		///< Mapped file contents, NULL when reading through stdio
+	uint64_t		m_mapSize;
+	uint64_t		m_mapPos;		///< Position of the next compressed chunk inside the mapping
+	uintptr_t		m_mapHandle;
+	bool			m_mapOwned;		///< Mapping was created by the loader, false for data in memory
+	uint64_t		m_chunkFileStart;	///< File offset of the compressed chunk being read
+	uint64_t		m_chunkFileEnd;	///< File offset just past the compressed chunk being read
+	ChunkPipeline*	m_pipeline;		///< Decompresses chunks ahead of the parser, NULL if not used
+	uint8_t			m_staging[64];	///< Holds a record that straddles two buffers
+	uint32_t		m_srcDataSize;
+	uint32_t		m_dataSize;
+	FILE*			m_file;
+	bool			m_compressed;
 
 public:
-	BinLoader(FILE* _file, bool _compressed);
+	BinLoader(FILE* _file, bool _compressed, bool _decompressAhead = true);
+
+	/// Reads capture data already in memory, offsets are relative to _data
+	BinLoader(const uint8_t* _data, uint64_t _size, bool _compressed);
 	~BinLoader();
 
 	bool eof();
 	uint64_t tell();
 	uint64_t fileTell();
-	int read(void* _ptr, size_t _size);
+	bool isMapped() const { return m_mapData != 0; }
+	bool isCompressed() const { return m_compressed; }
+
+	/// File offset of the active compressed chunk header
+	uint64_t chunkFileOffset() const { return m_chunkFileStart; }
+
+	/// Read position inside the active decompressed chunk
+	uint32_t chunkTell() const { return (uint32_t)(m_readPtr - m_bufferBase); }
+
+	inline int read(void* _ptr, size_t _size)
+	{
+		if ((size_t)(m_readEnd - m_readPtr) >= _size)
+		{
+			memcpy(_ptr, m_readPtr, _size);
+			m_readPtr += _size;
+			return 1;
+		}
+		return readSlow(_ptr, _size);
+	}
+
+	/// Returns a pointer to _size contiguous bytes and advances past them, NULL at end of data
+	inline const uint8_t* getData(size_t _size)
+	{
+		if ((size_t)(m_readEnd - m_readPtr) >= _size)
+		{
+			const uint8_t* data = m_readPtr;
+			m_readPtr += _size;
+			return data;
+		}
+		return getDataSlow(_size);
+	}
+
+	/// Skips _size bytes, returns false if data ends before that
+	bool skip(size_t _size);
 
 	template <typename T>
 	int readVar(T& _var)
@@ -36,7 +86,14 @@ public:
 	}
 
 private:
+	int readSlow(void* _ptr, size_t _size);
+	const uint8_t* getDataSlow(size_t _size);
+	bool nextBuffer();
 	bool loadChunk();
+	bool readChunk(const uint8_t*& _srcData, uint32_t& _srcSize, uint64_t& _fileStart, uint64_t& _fileEnd, uint8_t*& _buffer, uint32_t& _bufferSize);
+	bool mapFile();
+	void unmapFile();
+	void adviseWindow(const uint8_t* _start, uint64_t _size);
 };
 
 } // namespace rtm
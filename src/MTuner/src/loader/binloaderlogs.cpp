@@ -5,6 +5,7 @@
 
 #include <MTuner_pch.h>
 #include <MTuner/src/loader/capture.h>
+#include <MTuner/src/loader/symbolcache.h>
 #include <MTuner/src/loader/util.h>
 #include <rdebug/inc/rdebug.h>
 
@@ -87,6 +88,35 @@ static inline void WriteStackFrame(FILE* inFile, rdebug::StackFrame& inSt)
 		fprintf(inFile, "\n");
 }
 
+//--------------------------------------------------------------------------
+/// Resolves frames of all addresses up front, logs then read them from memory
+//--------------------------------------------------------------------------
+static void resolveFrames(std::vector<uint64_t>& _addresses, SymbolCache* _symbols)
+{
+	std::sort(_addresses.begin(), _addresses.end());
+	_addresses.erase(std::unique(_addresses.begin(), _addresses.end()), _addresses.end());
+	_symbols->resolveFrames(_addresses.data(), _addresses.size());
+}
+
+//--------------------------------------------------------------------------
+static void resolveFrames(const Capture& _capture, const std::vector<MemoryOperationGroup*>& _groups, SymbolCache* _symbols)
+{
+	const MemoryOperations& ops = _capture.getMemoryOps();
+
+	std::vector<uint64_t> addresses;
+	for (size_t i=0; i<_groups.size(); i++)
+	{
+		StackTrace* trace = _capture.getStackTrace(ops.m_stackTrace[_groups[i]->m_operations[0]]);
+		if (!trace)
+			continue;
+
+		for (const StackTraceNode* frame=trace->m_frame; frame; frame=frame->m_parent)
+			addresses.push_back(frame->m_address);
+	}
+
+	resolveFrames(addresses, _symbols);
+}
+
 //--------------------------------------------------------------------------
 /// Writes global stats information to the file
 //--------------------------------------------------------------------------
@@ -95,6 +125,9 @@ void	Capture::writeGlobalStats( FILE* inFile )
 	char buffer[128];
 
 	fprintf(inFile,"----------------------------------------\n");
+	if (isPreview())
+		fprintf(inFile,"Preview of every %u. chunk, stats are scaled and approximate,\n"
+					   "groups are from loaded chunks only\n", m_sampleStep);
 	fprintf(inFile,"Memory usage            : %s\n", FormatNumber(m_statsGlobal.m_memoryUsage,buffer));
 	fprintf(inFile,"Memory usage at peak    : %s\n", FormatNumber(m_statsGlobal.m_memoryUsagePeak,buffer));
 	fprintf(inFile,"Overhead                : %s\n", FormatNumber(m_statsGlobal.m_overhead,buffer));
@@ -110,7 +143,7 @@ void	Capture::writeGlobalStats( FILE* inFile )
 //--------------------------------------------------------------------------
 /// Saves information about all memory operations to the file
 //--------------------------------------------------------------------------
-bool Capture::saveLog(const char* _path, uintptr_t _symResolver )
+bool Capture::saveLog(const char* _path, SymbolCache* _symbols )
 {
 	FILE* f = fopen(_path, "wt");
 	if (!f)
@@ -118,19 +151,27 @@ bool Capture::saveLog(const char* _path, uintptr_t _symResolver )
 
 	fprintf(f,"%s",g_LogBanner);
 
-	uint32_t size = (uint32_t)m_operations.size();
+	size_t size = m_operations.size();
+
+	std::vector<uint64_t> addresses;
+	addresses.reserve(m_stackFrames.getNumNodes());
+	for (size_t i=0; i<m_stackFrames.getNumNodes(); i++)
+		addresses.push_back(m_stackFrames.getNode(i)->m_address);
+	resolveFrames(addresses, _symbols);
 
 	writeGlobalStats(f);
 
 	// write ops
-	for (uint32_t i=0; i<size; i++)
+	for (size_t i=0; i<size; i++)
 	{
-		MemoryOperation* opEx = m_operations[i];
-		const char* opType = gGetStringFromOperation(opEx->m_operationType);
+		if (!m_operations.isValid(i))
+			continue;
 
-		fprintf(f, "\n%s  size: %d\n", opType, opEx->m_allocSize);
+		const char* opType = gGetStringFromOperation(m_operations.getType(i));
 
-		StackTrace* trace = opEx->m_stackTrace;
+		fprintf(f, "\n%s  size: %u\n", opType, m_operations.m_allocSize[i]);
+
+		StackTrace* trace = m_stackTraces[m_operations.m_stackTrace[i]];
 	
 		if (!trace)
 		{
@@ -138,11 +179,10 @@ bool Capture::saveLog(const char* _path, uintptr_t _symResolver )
 			continue;
 		}
 
-		uint32_t numFrames = (uint32_t)trace->m_numFrames;
-		for (uint32_t e=0; e<numFrames; e++)
+		for (const StackTraceNode* frame=trace->m_frame; frame; frame=frame->m_parent)
 		{
 			rdebug::StackFrame st;
-			symbolResolverGetFrame(_symResolver, trace->m_frames[e], &st);
+			_symbols->getFrame(frame->m_address, st);
 			WriteStackFrame(f, st);
 		}
 	}
@@ -152,6 +192,40 @@ bool Capture::saveLog(const char* _path, uintptr_t _symResolver )
 }
 
 
+//--------------------------------------------------------------------------
+/// Saves global stats and size histogram, overview of a capture has nothing more
+//--------------------------------------------------------------------------
+bool Capture::saveOverviewLog(const char* _path)
+{
+	FILE* f = fopen(_path, "wt");
+	if (!f)
+		return false;
+
+	fprintf(f,"%s",g_LogBanner);
+
+	writeGlobalStats(f);
+
+	char count[128], countPeak[128], size[128], sizePeak[128];
+
+	fprintf(f,"Block size     Live blocks      Peak      Live size           Peak\n");
+	for (uint32_t i=0; i<MemoryStats::NUM_HISTOGRAM_BINS; i++)
+	{
+		const HistogramBin& bin = m_statsGlobal.m_histogram[i];
+		const uint32_t binSize = (uint32_t)MemoryStats::MIN_HISTOGRAM_SIZE << i;
+
+		fprintf(f, "%s%-10u %12s %9s %14s %14s\n",
+				i == MemoryStats::NUM_HISTOGRAM_BINS - 1 ? ">" : "<=",
+				i == MemoryStats::NUM_HISTOGRAM_BINS - 1 ? binSize / 2 : binSize,
+				FormatNumber(bin.m_count, count),
+				FormatNumber(bin.m_countPeak, countPeak),
+				FormatNumber(bin.m_size, size),
+				FormatNumber(bin.m_sizePeak, sizePeak));
+	}
+
+	fclose(f);
+	return true;
+}
+
 static inline bool sortGroupByCount( const MemoryOperationGroup* _g1, const MemoryOperationGroup* _g2)
 {
 	return (_g1->m_operations.size() > _g2->m_operations.size());
@@ -172,7 +246,7 @@ static inline bool sortGroupByTotal( const MemoryOperationGroup* _g1, const Memo
 //--------------------------------------------------------------------------
 /// Saves information about all memory operations to the file
 //--------------------------------------------------------------------------
-bool Capture::saveGroupsLog(const char* _path, eGroupSort _sorting, uintptr_t _symResolver )
+bool Capture::saveGroupsLog(const char* _path, eGroupSort _sorting, SymbolCache* _symbols )
 {
 	std::vector<MemoryOperationGroup*> sortedGroups;
 	sortedGroups.reserve(m_operationGroups.size());
@@ -204,22 +278,24 @@ bool Capture::saveGroupsLog(const char* _path, eGroupSort _sorting, uintptr_t _s
 
 	uint32_t size = (uint32_t)sortedGroups.size();
 
+	resolveFrames(*this, sortedGroups, _symbols);
+
 	writeGlobalStats(f);
 
 	// write ops
-	for (uint32_t i=0; i<size; i++)
+	for (size_t i=0; i<size; i++)
 	{
 		MemoryOperationGroup* group = sortedGroups[i];
 
-		MemoryOperation* opEx = group->m_operations[0];
-		const char* opType = gGetStringFromOperation(opEx->m_operationType);
+		const uint32_t op = group->m_operations[0];
+		const char* opType = gGetStringFromOperation(m_operations.getType(op));
 
 		if (group->m_minSize != group->m_maxSize)
-			fprintf(f, "\n%s  size: %d-%d   group operations: %d\n", opType, group->m_minSize, group->m_maxSize, group->m_count);
+			fprintf(f, "\n%s  size: %u-%u   group operations: %llu\n", opType, group->m_minSize, group->m_maxSize, (unsigned long long)group->m_count);
 		else
-			fprintf(f, "\n%s  size: %d   group operations: %d\n", opType, group->m_minSize, group->m_count);
+			fprintf(f, "\n%s  size: %u   group operations: %llu\n", opType, group->m_minSize, (unsigned long long)group->m_count);
 
-		StackTrace* trace = opEx->m_stackTrace;
+		StackTrace* trace = m_stackTraces[m_operations.m_stackTrace[op]];
 	
 		if (!trace)
 		{
@@ -227,11 +303,10 @@ bool Capture::saveGroupsLog(const char* _path, eGroupSort _sorting, uintptr_t _s
 			continue;
 		}
 
-		uint32_t numFrames = (uint32_t)trace->m_numFrames;
-		for (uint32_t e=0; e<numFrames; e++)
+		for (const StackTraceNode* frame=trace->m_frame; frame; frame=frame->m_parent)
 		{
 			rdebug::StackFrame st;
-			symbolResolverGetFrame(_symResolver, trace->m_frames[e], &st);
+			_symbols->getFrame(frame->m_address, st);
 			WriteStackFrame(f, st);
 		}
 	}
@@ -243,7 +318,7 @@ bool Capture::saveGroupsLog(const char* _path, eGroupSort _sorting, uintptr_t _s
 //--------------------------------------------------------------------------
 /// Saves information about all memory operations to the file
 //--------------------------------------------------------------------------
-bool Capture::saveGroupsLogXML(const char* _path, eGroupSort _sorting, uintptr_t _symResolver)
+bool Capture::saveGroupsLogXML(const char* _path, eGroupSort _sorting, SymbolCache* _symbols)
 {
 	std::vector<MemoryOperationGroup*> sortedGroups;
 	sortedGroups.reserve(m_operationGroups.size());
@@ -318,31 +393,32 @@ bool Capture::saveGroupsLogXML(const char* _path, eGroupSort _sorting, uintptr_t
 
 	uint32_t size = (uint32_t)sortedGroups.size();
 
+	resolveFrames(*this, sortedGroups, _symbols);
+
 	// write ops
-	for (uint32_t i=0; i<size; i++)
+	for (size_t i=0; i<size; i++)
 	{
 		MemoryOperationGroup* group = sortedGroups[i];
 
-		MemoryOperation* opEx = group->m_operations[0];
-		const char* opType = gGetStringFromOperation(opEx->m_operationType);
+		const uint32_t op = group->m_operations[0];
+		const char* opType = gGetStringFromOperation(m_operations.getType(op));
 
 		fprintf(f, "    <Group>\n");
 		fprintf(f, "        <Type>%s</Type>\n",opType);
-		fprintf(f, "        <SizeMin>%d</SizeMin>\n", group->m_minSize);
-		fprintf(f, "        <SizeMax>%d</SizeMax>\n", group->m_maxSize);
-		fprintf(f, "        <Operations>%d</Operations>\n", group->m_count);
+		fprintf(f, "        <SizeMin>%u</SizeMin>\n", group->m_minSize);
+		fprintf(f, "        <SizeMax>%u</SizeMax>\n", group->m_maxSize);
+		fprintf(f, "        <Operations>%llu</Operations>\n", (unsigned long long)group->m_count);
 		fprintf(f, "        <Leaked>%" PRIx64 "</Leaked>\n", group->m_liveSize);
 
-		StackTrace* trace = opEx->m_stackTrace;
+		StackTrace* trace = m_stackTraces[m_operations.m_stackTrace[op]];
 
 		if (!trace)
 			continue;
 
-		uint32_t numFrames = (uint32_t)trace->m_numFrames;
-		for (uint32_t e=0; e<numFrames; e++)
+		for (const StackTraceNode* frame=trace->m_frame; frame; frame=frame->m_parent)
 		{
 			rdebug::StackFrame st;
-			symbolResolverGetFrame(_symResolver, trace->m_frames[e], &st);
+			_symbols->getFrame(frame->m_address, st);
 
 			fprintf(f, "        <Frame>\n");
 			fprintf(f, "            <Module>%s</Module>\n", st.m_moduleName);
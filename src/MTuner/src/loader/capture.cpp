@@ -6,46 +6,50 @@
 #include <MTuner_pch.h>
 #include <MTuner/src/loader/capture.h>
 #include <MTuner/src/loader/binloader.h>
+#include <MTuner/src/loader/capturestream.h>
+#include <MTuner/src/loader/opsort.h>
+#include <MTuner/src/loader/parallel.h>
+#include <MTuner/src/loader/symbolcache.h>
 #include <MTuner/src/loader/util.h>
 #include <rbase/inc/endianswap.h>
 #include <rbase/inc/path.h>
 #include <rbase/inc/winchar.h>
 #include <rdebug/inc/rdebug.h>
 
+#include <atomic>
+#include <queue>
+#include <thread>
 #include <type_traits>
 
-#if RTM_PLATFORM_WINDOWS && RTM_COMPILER_MSVC
+namespace rtm
+{
+/// Upper bound on threads parsing a capture in parallel
+static const uint32_t s_maxLoadThreads = 32;
 
-#pragma warning(push)
-#pragma warning(disable : 4530)  // exceptions not used
-#pragma warning(disable : 4211)  // redefined extern to static
+/// Below this many operations linking is done on a single thread
+static const uint32_t s_minParallelLink = 64 * 1024;
 
-static bool __uncaught_exception()
+static FILE* openCaptureFile(const char* _path)
 {
-    return true;
+#if RTM_PLATFORM_WINDOWS
+    rtm::MultiToWide path(_path);
+    return _wfopen(path.m_ptr, L"rb");
+#else
+    return fopen(_path, "r");
+#endif
 }
-#include <ppl.h>
 
-struct pSortOpsTime
+static void seekCaptureFile(FILE* _file, uint64_t _offset)
 {
-    std::vector<rtm::MemoryOperation*>* m_allOps;
-    pSortOpsTime(std::vector<rtm::MemoryOperation*>& _ops)
-        : m_allOps(&_ops)
-    {
-    }
-
-    inline uint64_t operator()(const rtm::MemoryOperation* _val) const
-    {
-        return _val->m_operationTime;
-    }
-};
-
-#pragma warning(pop)
-
-#endif  // RTM_PLATFORM_WINDOWS && RTM_COMPILER_MSVC
+#if RTM_PLATFORM_WINDOWS
+    _fseeki64(_file, (int64_t)_offset, SEEK_SET);
+#elif RTM_PLATFORM_LINUX
+    fseeko64(_file, (off64_t)_offset, SEEK_SET);
+#elif RTM_PLATFORM_OSX
+    fseeko(_file, (off_t)_offset, SEEK_SET);
+#endif
+}
 
-namespace rtm
-{
 static inline uint64_t stackTraceGetHash(uint64_t* _backTrace, uint32_t _numEntries)
 {
     return rtm::hashCity64(_backTrace, _numEntries * sizeof(uint64_t));
@@ -69,12 +73,78 @@ static uint32_t getGranularityMask(uint64_t _ops)
         granularity = 4096;
     if (_ops > 10 * 1024 * 1024)
         granularity = 8192;
+    // keeps timed stats of captures with billions of operations in a few hundred MB
+    if (_ops > 256 * 1024 * 1024)
+        granularity = 16384;
     return granularity - 1;
 }
 
-inline bool psTime(MemoryOperation* inOp1, MemoryOperation* inOp2)
+/// Usage graph pyramid resolution limits for level 0
+static const uint64_t s_minGraphBuckets = 1024;
+static const uint64_t s_maxGraphBuckets = 1024 * 1024;
+
+static inline void initGraphBucket(GraphBucket& _bucket, uint64_t _usage, uint64_t _liveBlocks)
+{
+    _bucket.m_minUsage = _bucket.m_maxUsage = _bucket.m_lastUsage = _usage;
+    _bucket.m_minLiveBlocks = _bucket.m_maxLiveBlocks = _bucket.m_lastLiveBlocks = _liveBlocks;
+}
+
+static inline void addToGraphBucket(GraphBucket& _bucket, uint64_t _usage, uint64_t _liveBlocks)
+{
+    _bucket.m_minUsage = qMin(_bucket.m_minUsage, _usage);
+    _bucket.m_maxUsage = qMax(_bucket.m_maxUsage, _usage);
+    _bucket.m_lastUsage = _usage;
+    _bucket.m_minLiveBlocks = qMin(_bucket.m_minLiveBlocks, _liveBlocks);
+    _bucket.m_maxLiveBlocks = qMax(_bucket.m_maxLiveBlocks, _liveBlocks);
+    _bucket.m_lastLiveBlocks = _liveBlocks;
+}
+
+/// Merges ranges of two buckets, last values are taken from the later one
+static inline void mergeGraphBuckets(GraphBucket& _bucket, const GraphBucket& _next)
+{
+    _bucket.m_minUsage = qMin(_bucket.m_minUsage, _next.m_minUsage);
+    _bucket.m_maxUsage = qMax(_bucket.m_maxUsage, _next.m_maxUsage);
+    _bucket.m_lastUsage = _next.m_lastUsage;
+    _bucket.m_minLiveBlocks = qMin(_bucket.m_minLiveBlocks, _next.m_minLiveBlocks);
+    _bucket.m_maxLiveBlocks = qMax(_bucket.m_maxLiveBlocks, _next.m_maxLiveBlocks);
+    _bucket.m_lastLiveBlocks = _next.m_lastLiveBlocks;
+}
+
+/// Sampled preview stands for the whole capture, usage of loaded chunks is scaled up
+static inline void scaleGraphBucket(GraphBucket& _bucket, double _scale)
 {
-    return inOp1->m_operationTime < inOp2->m_operationTime;
+    _bucket.m_minUsage = (uint64_t)(_bucket.m_minUsage * _scale + 0.5);
+    _bucket.m_maxUsage = (uint64_t)(_bucket.m_maxUsage * _scale + 0.5);
+    _bucket.m_lastUsage = (uint64_t)(_bucket.m_lastUsage * _scale + 0.5);
+    _bucket.m_minLiveBlocks = (uint64_t)(_bucket.m_minLiveBlocks * _scale + 0.5);
+    _bucket.m_maxLiveBlocks = (uint64_t)(_bucket.m_maxLiveBlocks * _scale + 0.5);
+    _bucket.m_lastLiveBlocks = (uint64_t)(_bucket.m_lastLiveBlocks * _scale + 0.5);
+}
+
+/// Applies operation to memory usage and live blocks, same as global stats do
+static inline void applyGraphOperation(const MemoryOperations& _ops, size_t _op, uint64_t& _usage, uint64_t& _liveBlocks)
+{
+    switch (_ops.getType(_op))
+    {
+        case rmem::LogMarkers::OpAlloc:
+        case rmem::LogMarkers::OpCalloc:
+        case rmem::LogMarkers::OpAllocAligned:
+            _usage += _ops.m_allocSize[_op];
+            ++_liveBlocks;
+            break;
+        case rmem::LogMarkers::OpRealloc:
+        case rmem::LogMarkers::OpReallocAligned:
+            _usage += _ops.m_allocSize[_op];
+            if (_ops.m_chainPrev[_op] != MemoryOperations::NoOperation)
+                _usage -= _ops.m_allocSize[_ops.m_chainPrev[_op]];
+            else if (_ops.m_pointer[_op] != 0)
+                ++_liveBlocks;
+            break;
+        case rmem::LogMarkers::OpFree:
+            _usage -= _ops.m_allocSize[_op];
+            --_liveBlocks;
+            break;
+    };
 }
 
 template <uint32_t Len>
@@ -123,9 +193,9 @@ inline uint32_t ReadString(char16_t _string[Len], BinLoader& _loader, bool _swap
     return sizeof(len);
 }
 
-static inline uintptr_t calcGroupHash(MemoryOperation* _op)
+static inline uint32_t calcGroupHash(const MemoryOperations& _ops, uint32_t _op)
 {
-    return (uintptr_t)_op->m_stackTrace;
+    return _ops.m_stackTrace[_op];
 }
 
 static inline void addHeap(HeapsType& _heaps, uint64_t _heap)
@@ -134,18 +204,34 @@ static inline void addHeap(HeapsType& _heaps, uint64_t _heap)
         _heaps[_heap] = "";
 }
 
-static inline bool isLeaked(MemoryOperation* _op)
+/// Names allocator by its handle unless it was already named
+static inline void addDefaultHeapName(HeapsType& _heaps, uint64_t _handle)
+{
+    HeapsType::iterator it = _heaps.find(_handle);
+    if (it == _heaps.end())
+    {
+        char buff[512];
+#if RTM_COMPILER_MSVC
+        sprintf(buff, "0x%llx", _handle);
+#else
+        snprintf(buff, 512, "0x%llux", _handle);
+#endif
+        _heaps[_handle] = buff;
+    }
+}
+
+static inline bool isLeaked(const MemoryOperations& _ops, uint32_t _op)
 {
-    bool isFreed = _op->m_operationType == rmem::LogMarkers::OpFree;
-    isFreed = isFreed || ((_op->m_operationType == rmem::LogMarkers::OpRealloc) && (_op->m_allocSize == 0));
-    isFreed = isFreed ||
-              ((_op->m_operationType == rmem::LogMarkers::OpReallocAligned) && (_op->m_allocSize == 0));
+    const uint8_t type = _ops.getType(_op);
+    bool isFreed = type == rmem::LogMarkers::OpFree;
+    isFreed = isFreed || ((type == rmem::LogMarkers::OpRealloc) && (_ops.m_allocSize[_op] == 0));
+    isFreed = isFreed || ((type == rmem::LogMarkers::OpReallocAligned) && (_ops.m_allocSize[_op] == 0));
     return !isFreed;
 }
 
-static inline void updateLiveBlocks(MemoryOperation* _op, uint64_t& _liveBlocks)
+static inline void updateLiveBlocks(const MemoryOperations& _ops, uint32_t _op, uint64_t& _liveBlocks)
 {
-    switch (_op->m_operationType)
+    switch (_ops.getType(_op))
     {
         case rmem::LogMarkers::OpAlloc:
         case rmem::LogMarkers::OpCalloc:
@@ -154,7 +240,7 @@ static inline void updateLiveBlocks(MemoryOperation* _op, uint64_t& _liveBlocks)
             break;
         case rmem::LogMarkers::OpRealloc:
         case rmem::LogMarkers::OpReallocAligned:
-            if (_op->m_previousPointer == 0)
+            if (_ops.m_chainPrev[_op] == MemoryOperations::NoOperation)
                 ++_liveBlocks;
             break;
         case rmem::LogMarkers::OpFree:
@@ -163,27 +249,249 @@ static inline void updateLiveBlocks(MemoryOperation* _op, uint64_t& _liveBlocks)
     };
 }
 
-static inline void updateLiveSize(MemoryOperation* _op, uint64_t& _liveSize)
+static inline void updateLiveSize(const MemoryOperations& _ops, uint32_t _op, uint64_t& _liveSize)
 {
-    switch (_op->m_operationType)
+    const uint32_t prev = _ops.m_chainPrev[_op];
+    switch (_ops.getType(_op))
     {
         case rmem::LogMarkers::OpAlloc:
         case rmem::LogMarkers::OpCalloc:
         case rmem::LogMarkers::OpAllocAligned:
-            _liveSize += _op->m_allocSize;
+            _liveSize += _ops.m_allocSize[_op];
             break;
         case rmem::LogMarkers::OpRealloc:
         case rmem::LogMarkers::OpReallocAligned:
-            _liveSize += _op->m_allocSize;
-            if (_op->m_previousPointer)
-                _liveSize -= _op->m_chainPrev->m_allocSize;
+            _liveSize += _ops.m_allocSize[_op];
+            if (prev != MemoryOperations::NoOperation)
+                _liveSize -= _ops.m_allocSize[prev];
             break;
         case rmem::LogMarkers::OpFree:
-            _liveSize -= _op->m_chainPrev->m_allocSize;
+            _liveSize -= _ops.m_allocSize[prev];
             break;
     };
 }
 
+//--------------------------------------------------------------------------
+/// Decodes memory operation records. Record layout is fixed for a given
+/// pointer size, endianness and operation type so each record is decoded
+/// from a single contiguous block at constant offsets.
+//--------------------------------------------------------------------------
+template <bool Is64, bool Swap>
+struct OpDecoder
+{
+    typedef typename std::conditional<Is64, uint64_t, uint32_t>::type Pointer;
+
+    template <typename T>
+    static inline T field(const uint8_t* _data)
+    {
+        T value;
+        memcpy(&value, _data, sizeof(T));
+        return Swap ? Endian::swap(value) : value;
+    }
+
+    template <uint8_t Marker>
+    struct Layout
+    {
+        static const bool HasPrevious =
+            (Marker == rmem::LogMarkers::OpRealloc) || (Marker == rmem::LogMarkers::OpReallocAligned);
+        static const bool HasAlignment =
+            (Marker == rmem::LogMarkers::OpAllocAligned) || (Marker == rmem::LogMarkers::OpReallocAligned);
+        static const bool HasSize = Marker != rmem::LogMarkers::OpFree;
+
+        static const size_t HandleOffset = 0;
+        static const size_t ThreadOffset = HandleOffset + sizeof(uint64_t);
+        static const size_t PointerOffset = ThreadOffset + sizeof(uint64_t);
+        static const size_t PreviousOffset = PointerOffset + sizeof(Pointer);
+        static const size_t TimeOffset = PreviousOffset + (HasPrevious ? sizeof(Pointer) : 0);
+        static const size_t AlignmentOffset = TimeOffset + sizeof(uint64_t);
+        static const size_t SizeOffset = AlignmentOffset + (HasAlignment ? sizeof(uint8_t) : 0);
+        static const size_t OverheadOffset = SizeOffset + sizeof(uint32_t);
+        static const size_t RecordSize = HasSize ? OverheadOffset + sizeof(uint32_t) : AlignmentOffset;
+    };
+
+    template <uint8_t Marker>
+    static inline bool decode(BinLoader& _loader, MemoryOperation& _op, uint64_t& _handle, uint64_t& _threadID)
+    {
+        typedef Layout<Marker> L;
+
+        const uint8_t* data = _loader.getData(L::RecordSize);
+        if (!data)
+            return false;
+
+        _handle = field<uint64_t>(data + L::HandleOffset);
+        _threadID = field<uint64_t>(data + L::ThreadOffset);
+        _op.m_pointer = field<Pointer>(data + L::PointerOffset);
+        _op.m_previousPointer = L::HasPrevious ? field<Pointer>(data + L::PreviousOffset) : 0;
+        _op.m_operationTime = field<uint64_t>(data + L::TimeOffset);
+        _op.m_alignment = L::HasAlignment ? data[L::AlignmentOffset] : 255;
+        _op.m_allocSize = L::HasSize ? field<uint32_t>(data + L::SizeOffset) : 0;
+        _op.m_overhead = L::HasSize ? field<uint32_t>(data + L::OverheadOffset) : 0;
+        _op.m_operationType = Marker;
+        return true;
+    }
+};
+
+//--------------------------------------------------------------------------
+/// State kept between loads of a capture that is still being written. Parsing
+/// resumes at the first record that wasn't complete, linking and analysis
+/// continue from where the previous load left them.
+//--------------------------------------------------------------------------
+struct Capture::LiveLoad
+{
+    uint64_t m_fileOffset;      ///< Chunk header offset, or record offset for uncompressed files
+    uint32_t m_recordOffset;    ///< Offset of the next record inside decompressed chunk data
+    uint64_t m_fileSize;        ///< Capture size at the last load
+    bool m_compressed;
+    ThreadTagStacks m_tagStacks;
+    robin_hood::unordered_map<uint64_t, uint32_t> m_opMap;  ///< Indices of operations on live blocks, key is a pointer
+    SymbolCache* m_symbols;     ///< Set once analysis data is built
+    uint64_t m_liveBlocks;
+    uint64_t m_liveSize;
+    MemoryTagTree* m_prevTag;
+    CaptureStream* m_stream;    ///< Source of records for a streamed capture, NULL for files
+    std::vector<bool> m_untagged;  ///< Operations parsed without a tag, analysis inherits one along chains
+    std::vector<std::pair<uint32_t, uint64_t>> m_previousPointers;  ///< Previous pointers of reallocs as parsed
+    std::vector<std::pair<uint32_t, uint64_t>> m_clampedTimes;      ///< Parsed times of operations that arrived late
+
+    LiveLoad(bool _compressed)
+        : m_fileOffset(0)
+        , m_recordOffset(0)
+        , m_fileSize(0)
+        , m_compressed(_compressed)
+        , m_symbols(NULL)
+        , m_liveBlocks(0)
+        , m_liveSize(0)
+        , m_prevTag(NULL)
+        , m_stream(NULL)
+    {
+    }
+
+    /// Keeps what linking and analysis change about operations starting with _first,
+    /// they are linked again once the capture ends
+    void keepUnlinked(const MemoryOperations& _ops, size_t _first)
+    {
+        const size_t numOps = _ops.size();
+        m_untagged.resize(numOps);
+        for (size_t i = _first; i < numOps; ++i)
+        {
+            m_untagged[i] = _ops.m_tag[i] == 0;
+
+            const uint64_t previousPointer = _ops.getPreviousPointer(i);
+            if (previousPointer)
+                m_previousPointers.push_back(std::make_pair((uint32_t)i, previousPointer));
+        }
+    }
+};
+
+//--------------------------------------------------------------------------
+/// Load filter state while parsing. Operations before the time range only
+/// update the last known state of the addresses they touch, blocks that are
+/// still allocated at the start of the range are added once parsing is done.
+/// State is kept by operation time, so records don't have to be in order.
+//--------------------------------------------------------------------------
+struct Capture::FilterLoad
+{
+    struct AddressState
+    {
+        MemoryOperation m_op;  ///< Operation that allocated the block
+        uint64_t m_time;
+        bool m_live;           ///< False if the block was freed
+    };
+
+    uint64_t m_minTime;
+    uint64_t m_maxTime;
+    uint64_t m_endOffset;  ///< Records starting here and later are past the time range
+    robin_hood::unordered_set<uint64_t> m_threads;
+    robin_hood::unordered_set<uint64_t> m_heaps;
+    robin_hood::unordered_map<uint64_t, AddressState> m_addresses;
+
+    FilterLoad(const LoadFilter& _filter, uint64_t _cpuFrequency)
+        : m_minTime(0)
+        , m_maxTime((uint64_t)-1)
+        , m_endOffset((uint64_t)-1)
+        , m_threads(_filter.m_threads.begin(), _filter.m_threads.end())
+        , m_heaps(_filter.m_heaps.begin(), _filter.m_heaps.end())
+    {
+        // rounded, times made from clock values have to convert back to the same clocks
+        if (_filter.m_minTime >= 0.0)
+            m_minTime = (uint64_t)(_filter.m_minTime * (double)_cpuFrequency + 0.5);
+        if (_filter.m_maxTime >= 0.0)
+            m_maxTime = (uint64_t)(_filter.m_maxTime * (double)_cpuFrequency + 0.5);
+    }
+
+    /// Returns false if operation is dropped or only updates address state
+    inline bool keep(const Capture* _capture, const MemoryOperation& _op)
+    {
+        if (_op.m_operationTime > m_maxTime)
+            return false;
+
+        if (!m_heaps.empty() && (m_heaps.find(_capture->m_heapHandles.m_values[_op.m_heapIndex]) == m_heaps.end()))
+            return false;
+
+        // blocks belong to the thread that allocated them, frees and reallocs
+        // from other threads stay until it's known whose block they touch
+        const bool isRealloc = (_op.m_operationType == rmem::LogMarkers::OpRealloc) ||
+                               (_op.m_operationType == rmem::LogMarkers::OpReallocAligned);
+        if (!m_threads.empty() && isAlloc(_op.m_operationType) && !isRealloc &&
+            (m_threads.find(_capture->m_threadIDs.m_values[_op.m_threadIndex]) == m_threads.end()))
+            return false;
+
+        if (_op.m_operationTime >= m_minTime)
+            return true;
+
+        const uint64_t time = _op.m_operationTime;
+        if (_op.m_operationType == rmem::LogMarkers::OpFree)
+        {
+            setAddress(_op.m_pointer, NULL, time);
+            return false;
+        }
+
+        if (isRealloc && _op.m_previousPointer)
+            setAddress(_op.m_previousPointer, NULL, time);
+        setAddress(_op.m_pointer, &_op, time);
+        return false;
+    }
+
+    inline void setAddress(uint64_t _pointer, const MemoryOperation* _op, uint64_t _time)
+    {
+        AddressState newState;
+        if (_op)
+            newState.m_op = *_op;
+        newState.m_time = _time;
+        newState.m_live = _op != NULL;
+
+        std::pair<robin_hood::unordered_map<uint64_t, AddressState>::iterator, bool> it =
+            m_addresses.insert(std::make_pair(_pointer, newState));
+        if (it.second)
+            return;
+
+        // state of the address is already known at a later time
+        AddressState& state = it.first->second;
+        if (state.m_time > _time)
+            return;
+
+        state = newState;
+    }
+
+    /// Adds blocks allocated before the time range that are live at its start
+    void addLiveBlocks(MemoryOperations& _operations)
+    {
+        robin_hood::unordered_map<uint64_t, AddressState>::iterator it = m_addresses.begin();
+        for (; it != m_addresses.end(); ++it)
+        {
+            if (!it->second.m_live)
+                continue;
+
+            // block the realloc came from is not loaded
+            MemoryOperation& op = it->second.m_op;
+            op.m_previousPointer = 0;
+            _operations.add(op);
+        }
+
+        m_addresses.clear();
+    }
+};
+
 //--------------------------------------------------------------------------
 /// Capture constructor
 //--------------------------------------------------------------------------
@@ -191,6 +499,14 @@ Capture::Capture()
 {
     m_loadProgressCallback = NULL;
     m_loadProgressCustomData = NULL;
+    m_live = NULL;
+    m_filterLoad = NULL;
+    m_loadCancelled = false;
+    m_analyzeProgressCallback = NULL;
+    m_analyzeProgressCustomData = NULL;
+    m_modulesLoadedCallback = NULL;
+    m_modulesLoadedCustomData = NULL;
+    m_cacheEnabled = false;
 
     clearData();
 }
@@ -208,15 +524,18 @@ Capture::~Capture()
 //--------------------------------------------------------------------------
 void Capture::clearData()
 {
+    waitForCacheWriter();
+
     m_filteringEnabled = false;
     m_swapEndian = false;
     m_64bit = false;
 
     m_loadedFile.clear();
-    m_operationPool.reset();
     m_stackPool.reset();
     m_operations.clear();
     m_operationsInvalid.clear();
+    m_threadIDs.clear();
+    m_heapHandles.clear();
     m_statsGlobal.reset();
     m_statsSnapshot.reset();
 
@@ -227,7 +546,9 @@ void Capture::clearData()
     // -----
 
     m_stackTracesHash.clear();
+    m_stackTracesByFrame.clear();
     m_stackTraces.clear();
+    m_stackFrames.clear();
     m_timedStats.clear();
 
     m_minTime = 0;
@@ -241,6 +562,18 @@ void Capture::clearData()
     m_filter.m_leakedOnly = false;
 
     m_usageGraph.clear();
+    m_usageBucketTime = 1;
+    m_timedStatsMask = 0;
+    m_index.clear();
+    m_cacheValid = false;
+    m_analyzedStages = 0;
+    delete m_live;
+    m_live = NULL;
+    delete m_filterLoad;
+    m_filterLoad = NULL;
+    m_overview = false;
+    m_sampleStep = 1;
+    m_sampleScale = 1.0;
 
     m_memoryMarkers.clear();
     m_memoryMarkerTimes.clear();
@@ -253,43 +586,31 @@ void Capture::clearData()
     destroyStackTree(m_stackTraceTree);
 }
 
-inline static uint32_t getStackTraceAndFramesSize(uint32_t numFrames)
-{
-    return (uint32_t)(sizeof(StackTrace) + (numFrames * 2 - 1) * sizeof(uint64_t));
-}
-
-inline static uint32_t getStackTraceIndexArraySize(uint32_t numFrames)
-{
-    return (uint32_t)((numFrames * 2) * sizeof(uint16_t));
-}
-
-inline static uint32_t getStackTraceNextArraySize(uint32_t numFrames)
-{
-    return (uint32_t)(sizeof(StackTrace*) * (numFrames + 1));
-}
-
-inline uint32_t StackTrace::calculateSize(uint32_t numFrames)
+uint32_t StackTrace::calculateSize(uint32_t numFrames)
 {
-    return getStackTraceAndFramesSize(numFrames) + getStackTraceIndexArraySize(numFrames) +
-           getStackTraceNextArraySize(numFrames);
+    return (uint32_t)(sizeof(StackTrace) + numFrames * sizeof(StackTrace*));
 }
 
-inline void StackTrace::init(StackTrace* st, uint32_t numFrames)
+void StackTrace::init(StackTrace* st, StackTraceNode* _frame)
 {
-    memset(StackTrace::getNextArray(st), 0, sizeof(StackTrace*) * (numFrames));
-    st->m_numFrames = (uint64_t)numFrames;
+    st->m_frame = _frame;
+    st->m_numFrames = _frame ? _frame->m_depth : 0;
+    st->m_addedToTree[StackTrace::Global] = 0;
+    st->m_addedToTree[StackTrace::Filtered] = 0;
+    memset(st->m_next, 0, sizeof(StackTrace*) * (st->m_numFrames + 1));
 }
 
-inline uint16_t* StackTrace::getIndexArray(StackTrace* st)
+StackTrace** StackTrace::getNextArray(StackTrace* st)
 {
-    uint32_t offset = getStackTraceAndFramesSize(st->m_numFrames);
-    return (uint16_t*)(((uint8_t*)(st)) + offset);
+    return st->m_next;
 }
 
-StackTrace** StackTrace::getNextArray(StackTrace* st)
+const StackTraceNode* StackTrace::getFrame(const StackTrace* st, uint32_t _depth)
 {
-    uint32_t offset = getStackTraceAndFramesSize(st->m_numFrames) + getStackTraceIndexArraySize(st->m_numFrames);
-    return (StackTrace**)(((uint8_t*)(st)) + offset);
+    const StackTraceNode* frame = st->m_frame;
+    for (uint32_t i = _depth; i < st->m_numFrames; ++i)
+        frame = frame->m_parent;
+    return frame;
 }
 
 //--------------------------------------------------------------------------
@@ -307,137 +628,33 @@ StackTrace** StackTrace::getNextArray(StackTrace* st)
         break;               \
     }
 
-Capture::LoadResult Capture::loadBin(const char* _path)
+//--------------------------------------------------------------------------
+/// Parses records from the current loader position until the end of data or
+/// until the sink stops it. Decoded operations, stack traces and events are
+/// handed to the sink which either applies them to the capture directly or
+/// keeps them to be merged later when parsing in parallel.
+//--------------------------------------------------------------------------
+template <bool Is64, bool Swap, typename Sink>
+static bool parseRecords(BinLoader& loader, Sink& _sink)
 {
-    clearData();
-
-    m_loadedFile = _path;
-
-#if RTM_PLATFORM_WINDOWS
-    rtm::MultiToWide path(_path);
-    FILE* f = _wfopen(path.m_ptr, L"rb");
-#else
-    FILE* f = fopen(_path, "r");
-#endif
-
-    if (!f)
-        return Capture::LoadFail;
-
-#if RTM_PLATFORM_WINDOWS
-    _fseeki64(f, 0, SEEK_END);
-    uint64_t fileSize = (uint64_t)_ftelli64(f);
-    _fseeki64(f, 0, SEEK_SET);
-#elif RTM_PLATFORM_LINUX
-    fseeko64(f, 0, SEEK_END);
-    uint64_t fileSize = (uint64_t)ftello64(f);
-    fseeko64(f, 0, SEEK_SET);
-#elif RTM_PLATFORM_OSX
-    fseeko(f, 0, SEEK_END);
-    uint64_t fileSize = (uint64_t)ftello(f);
-    fseeko(f, 0, SEEK_SET);
-#else
-#error "Not implemented for target platform!"
-#endif
-
-    uint32_t compressSignature;
-    if (!fread(&compressSignature, 1, sizeof(uint32_t), f))
-        return Capture::LoadFail;
-
-#if RTM_PLATFORM_WINDOWS
-    _fseeki64(f, 0, SEEK_SET);
-#elif RTM_PLATFORM_LINUX
-    fseeko64(f, 0, SEEK_SET);
-#endif
-
-    bool isCompressed =
-        ((compressSignature == 0x23234646) || compressSignature == Endian::swap(uint32_t(0x23234646)));
-
-    BinLoader loader(f, isCompressed);
-
-    uint64_t fileSizeOver100 = fileSize / 100;
-
-    uint8_t endianess;
-    uint8_t pointerSize;
-    uint8_t verHigh;
-    uint8_t verLow;
-    uint8_t toolChain;
-    uint64_t cpuFrequency;
-
-    size_t headerItems = 0;
-    headerItems += loader.readVar(endianess);
-    headerItems += loader.readVar(pointerSize);
-    headerItems += loader.readVar(verHigh);
-    headerItems += loader.readVar(verLow);
-    headerItems += loader.readVar(toolChain);
-    headerItems += loader.readVar(cpuFrequency);
-
-    if (headerItems != 6)
-        return Capture::LoadFail;
-
-    if (verHigh > 1)
-        return Capture::LoadFail;
-
-    if (verLow > 2)
-        return Capture::LoadFail;
-
-#if RTM_LITTLE_ENDIAN
-    m_swapEndian = (endianess == 0xff) ? true : false;
-#else
-    m_swapEndian = (endianess == 0xff) ? false : true;
-#endif
+    typedef OpDecoder<Is64, Swap> Decoder;
 
-    m_64bit = (pointerSize == 64) ? true : false;
-    m_toolchain = (rmem::ToolChain::Enum)toolChain;
-
-    if (m_swapEndian)
-        cpuFrequency = Endian::swap(cpuFrequency);
-    m_CPUFrequency = cpuFrequency;
-
-    printf("Load bin:\n  version %d.%d\n  %s endian\n  %sbit\n",
-           verHigh,
-           verLow,
-           m_swapEndian ? "Big" : "Little",
-           m_64bit ? "64" : "32");
-
-    if (!loadModuleInfo(loader, fileSize))
-    {
-        clearData();
-        return Capture::LoadFail;
-    }
+    ThreadTagStacks& perThreadTagStack = _sink.getTagStacks();
 
     bool loadSuccess = true;
 
-    robin_hood::unordered_map<uint64_t, std::vector<uint32_t>> perThreadTagStack;
-
-    uint64_t minMarkerTime = (uint64_t)-1;
-    int64_t filePos = 0;
-    uint64_t fileEntries = 0;
-    uint64_t fileProgress = 1;
-
     for (; loadSuccess;)
     {
         if (loader.eof())
             break;
 
-        ++fileEntries;
-        uint64_t newFileProgress = fileEntries >> 16;
+        if (!_sink.beginRecord(loader))
+            break;
 
         uint8_t marker;
         if (loader.readVar(marker) == 0)
             break;
 
-        if (newFileProgress != fileProgress)
-        {
-            fileProgress = newFileProgress;
-
-            filePos = (int64_t)loader.fileTell();
-            if (m_loadProgressCallback)
-            {
-                float percent = float(filePos) / fileSizeOver100;
-                m_loadProgressCallback(m_loadProgressCustomData, percent, "Loading capture file...");
-            }
-        }
-
         switch (marker)
         {
             case rmem::LogMarkers::OpAlloc:
@@ -448,151 +665,40 @@ Capture::LoadResult Capture::loadBin(const char* _path)
             case rmem::LogMarkers::OpReallocAligned:
             {
                 // read memory op
-                MemoryOperation* op = m_operationPool.alloc();
-
-                if (loader.readVar(op->m_allocatorHandle) != 1)
-                {
-                    loadSuccess = false;
-                    break;
-                }
-
-                op->m_operationType = marker;
-                op->m_alignment = 255;
-
-                uint8_t bitIndex;
-                size_t itemsRead = 0;
+                MemoryOperation op;
+                uint64_t handle = 0;
+                uint64_t threadID = 0;
 
                 switch (marker)
                 {
                     case rmem::LogMarkers::OpAlloc:
+                        loadSuccess = Decoder::template decode<rmem::LogMarkers::OpAlloc>(loader, op, handle, threadID);
+                        break;
+                    case rmem::LogMarkers::OpAllocAligned:
+                        loadSuccess = Decoder::template decode<rmem::LogMarkers::OpAllocAligned>(loader, op, handle, threadID);
+                        break;
                     case rmem::LogMarkers::OpCalloc:
-                        itemsRead += loader.readVar(op->m_threadID);
-                        if (m_64bit)
-                            itemsRead += loader.readVar(op->m_pointer);
-                        else
-                        {
-                            uint32_t ptr;
-                            itemsRead += loader.readVar(ptr);
-                            op->m_pointer = ptr;
-                        }
-                        itemsRead += loader.readVar(op->m_operationTime);
-                        itemsRead += loader.readVar(op->m_allocSize);
-                        itemsRead += loader.readVar(op->m_overhead);
-
-                        loadSuccess = itemsRead == 5;
+                        loadSuccess = Decoder::template decode<rmem::LogMarkers::OpCalloc>(loader, op, handle, threadID);
+                        break;
+                    case rmem::LogMarkers::OpFree:
+                        loadSuccess = Decoder::template decode<rmem::LogMarkers::OpFree>(loader, op, handle, threadID);
                         break;
-
                     case rmem::LogMarkers::OpRealloc:
-                        itemsRead += loader.readVar(op->m_threadID);
-                        if (m_64bit)
-                        {
-                            itemsRead += loader.readVar(op->m_pointer);
-                            itemsRead += loader.readVar(op->m_previousPointer);
-                        }
-                        else
-                        {
-                            uint32_t ptr;
-                            itemsRead += loader.readVar(ptr);
-                            op->m_pointer = ptr;
-                            itemsRead += loader.readVar(ptr);
-                            op->m_previousPointer = ptr;
-                        }
-                        itemsRead += loader.readVar(op->m_operationTime);
-                        itemsRead += loader.readVar(op->m_allocSize);
-                        itemsRead += loader.readVar(op->m_overhead);
-
-                        loadSuccess = itemsRead == 6;
-                        break;
-
-                    case rmem::LogMarkers::OpAllocAligned:
-                        itemsRead += loader.readVar(op->m_threadID);
-                        if (m_64bit)
-                            itemsRead += loader.readVar(op->m_pointer);
-                        else
-                        {
-                            uint32_t ptr;
-                            itemsRead += loader.readVar(ptr);
-                            op->m_pointer = ptr;
-                        }
-                        itemsRead += loader.readVar(op->m_operationTime);
-                        itemsRead += loader.readVar(bitIndex);
-                        op->m_alignment = bitIndex;
-                        itemsRead += loader.readVar(op->m_allocSize);
-                        itemsRead += loader.readVar(op->m_overhead);
-
-                        loadSuccess = itemsRead == 6;
-                        break;
-
-                    case rmem::LogMarkers::OpFree:
-                        itemsRead += loader.readVar(op->m_threadID);
-                        if (m_64bit)
-                            itemsRead += loader.readVar(op->m_pointer);
-                        else
-                        {
-                            uint32_t ptr;
-                            itemsRead += loader.readVar(ptr);
-                            op->m_pointer = ptr;
-                        }
-                        itemsRead += loader.readVar(op->m_operationTime);
-
-                        loadSuccess = itemsRead == 3;
+                        loadSuccess = Decoder::template decode<rmem::LogMarkers::OpRealloc>(loader, op, handle, threadID);
                         break;
-
                     case rmem::LogMarkers::OpReallocAligned:
-                        itemsRead += loader.readVar(op->m_threadID);
-                        if (m_64bit)
-                        {
-                            itemsRead += loader.readVar(op->m_pointer);
-                            itemsRead += loader.readVar(op->m_previousPointer);
-                        }
-                        else
-                        {
-                            uint32_t ptr;
-                            itemsRead += loader.readVar(ptr);
-                            op->m_pointer = ptr;
-                            itemsRead += loader.readVar(ptr);
-                            op->m_previousPointer = ptr;
-                        }
-                        itemsRead += loader.readVar(op->m_operationTime);
-                        itemsRead += loader.readVar(bitIndex);
-                        itemsRead += loader.readVar(op->m_allocSize);
-                        itemsRead += loader.readVar(op->m_overhead);
-
-                        op->m_alignment = bitIndex;
-                        loadSuccess = itemsRead == 7;
+                        loadSuccess = Decoder::template decode<rmem::LogMarkers::OpReallocAligned>(loader, op, handle, threadID);
                         break;
                 };
 
                 if (!loadSuccess)
                     break;
 
-                if (m_swapEndian)
-                {
-                    op->m_allocatorHandle = Endian::swap(op->m_allocatorHandle);
-                    op->m_threadID = Endian::swap(op->m_threadID);
-                    op->m_operationTime = Endian::swap(op->m_operationTime);
-                    op->m_allocSize = Endian::swap(op->m_allocSize);
-                    op->m_overhead = Endian::swap(op->m_overhead);
-
-                    if (m_64bit)
-                    {
-                        op->m_pointer = Endian::swap(op->m_pointer);
-                        op->m_previousPointer = Endian::swap(op->m_previousPointer);
-                    }
-                    else
-                    {
-                        uint32_t actualPtr = (uint32_t)op->m_pointer;
-                        actualPtr = Endian::swap(actualPtr);
-                        op->m_pointer = (uint64_t)actualPtr;
-
-                        actualPtr = (uint32_t)op->m_previousPointer;
-                        actualPtr = Endian::swap(actualPtr);
-                        op->m_previousPointer = (uint64_t)actualPtr;
-                    }
-                }
+                op.m_threadIndex = _sink.internThread(threadID);
+                op.m_heapIndex = _sink.internHeap(handle);
 
-                uint64_t backTrace64[512];
-                uint32_t backTrace32[512];
+                uint64_t backTrace64[StackTrace::MaxFrames];
+                uint32_t backTrace32[StackTrace::MaxFrames];
 
                 //
                 // handle stack trace compression/hashing
@@ -620,52 +726,42 @@ Capture::LoadResult Capture::loadBin(const char* _path)
                     break;
                 }
 
-                if (m_swapEndian)
+                if (Swap)
                     numFrames16 = Endian::swap(numFrames16);
 
                 numFrames32 = numFrames16;
-                if (numFrames32 > 512)
+                if (numFrames32 > StackTrace::MaxFrames)
                 {
                     loadSuccess = false;
                     break;
                 }
 
-                if (m_swapEndian && stackTraceHash)
+                if (Swap && stackTraceHash)
                     stackTraceHash = Endian::swap(stackTraceHash);
 
-                StackTrace* st = NULL;
-
                 if (stackTraceTag == rmem::EntryTags::Add)
                 {
-                    if (m_64bit)
+                    if (Is64)
                     {
-                        for (uint32_t i = 0; i < numFrames32; ++i)
-                            if (loader.readVar(backTrace64[i]) != 1)
-                            {
-                                loadSuccess = false;
-                                break;
-                            }
-
-                        if (!loadSuccess)
+                        if (loader.read(backTrace64, numFrames32 * sizeof(uint64_t)) != 1)
+                        {
+                            loadSuccess = false;
                             break;
+                        }
 
-                        if (m_swapEndian)
+                        if (Swap)
                             for (uint32_t i = 0; i < numFrames32; i++)
                                 backTrace64[i] = Endian::swap(backTrace64[i]);
                     }
                     else
                     {
-                        for (uint32_t i = 0; i < numFrames32; ++i)
-                            if (loader.readVar(backTrace32[i]) != 1)
-                            {
-                                loadSuccess = false;
-                                break;
-                            }
-
-                        if (!loadSuccess)
+                        if (loader.read(backTrace32, numFrames32 * sizeof(uint32_t)) != 1)
+                        {
+                            loadSuccess = false;
                             break;
+                        }
 
-                        if (m_swapEndian)
+                        if (Swap)
                             for (uint32_t i = 0; i < numFrames32; i++)
                                 backTrace32[i] = Endian::swap(backTrace32[i]);
 
@@ -676,70 +772,30 @@ Capture::LoadResult Capture::loadBin(const char* _path)
                     if (!stackTraceHash)
                         stackTraceHash = (uint32_t)stackTraceGetHash(backTrace64, numFrames32);
 
-                    bool allocateAndAdd = true;
-
-                    StackTraceHashType::iterator it = m_stackTracesHash.find(stackTraceHash);
-                    if (it != m_stackTracesHash.end())
-                    {
-                        StackTrace* s = it->second;
-                        if (stackTraceCompare(s->m_frames, s->m_numFrames, backTrace64, numFrames32))
-                        {
-                            allocateAndAdd = false;
-                            st = s;
-                        }
-                    }
-
-                    if (allocateAndAdd)
-                    {
-                        st = (StackTrace*)m_stackPool.alloc(StackTrace::calculateSize(numFrames32));
-                        StackTrace::init(st, numFrames32);
-                        memcpy(&st->m_frames[0], backTrace64, numFrames32 * sizeof(uint64_t));
-                        m_stackTracesHash[stackTraceHash] = st;
-                        m_stackTraces.push_back(st);
-                    }
+                    loadSuccess = _sink.addStackTrace(op, stackTraceHash, backTrace64, numFrames32);
                 }
                 else
                 {
                     // Stack trace exists
-                    st = m_stackTracesHash[stackTraceHash];
+                    loadSuccess = _sink.findStackTrace(op, stackTraceHash);
                 }
 
-                if (!st)
-                {
-                    loadSuccess = false;
+                if (!loadSuccess)
                     break;
-                }
 
                 // get tag for this operation
                 uint32_t tag = 0;
-                if (isAlloc(op->m_operationType))
+                if (isAlloc(op.m_operationType))
                 {
-                    std::vector<uint32_t>& tagStack = perThreadTagStack[op->m_threadID];
+                    std::vector<uint32_t>& tagStack = perThreadTagStack[threadID];
                     const size_t ss = tagStack.size();
                     if (ss)
                         tag = tagStack[ss - 1];
                 }
 
-                // fill the rest of mem op struct
-                op->m_stackTrace = st;
-                op->m_chainPrev = NULL;
-                op->m_chainNext = NULL;
-                op->m_tag = tag;
-                op->m_isValid = 1;
-
-                m_operations.push_back(op);
+                op.m_tag = tag;
 
-                HeapsType::iterator it = m_Heaps.find(op->m_allocatorHandle);
-                if (it == m_Heaps.end())
-                {
-                    char buff[512];
-#if RTM_COMPILER_MSVC
-                    sprintf(buff, "0x%llx", op->m_allocatorHandle);
-#else
-                    snprintf(buff, 512, "0x%llux", op->m_allocatorHandle);
-#endif
-                    m_Heaps[op->m_allocatorHandle] = buff;
-                }
+                loadSuccess = _sink.addOperation(op);
             }
             break;
 
@@ -750,21 +806,21 @@ Capture::LoadResult Capture::loadBin(const char* _path)
                 uint32_t tagHash;
                 uint32_t tagParentHash = 0;
 
-                ReadString<1024>(tagName, loader, m_swapEndian);
-                ReadString<1024>(tagParentName, loader, m_swapEndian);
+                ReadString<1024>(tagName, loader, Swap);
+                ReadString<1024>(tagParentName, loader, Swap);
                 VERIFY_READ_SIZE(tagHash)
                 if (strlen(tagParentName) != 0)
                 {
                     VERIFY_READ_SIZE(tagParentHash)
                 }
 
-                if (m_swapEndian)
+                if (Swap)
                 {
                     tagHash = Endian::swap(tagHash);
                     tagParentHash = Endian::swap(tagParentHash);
                 }
 
-                addMemoryTag(tagName, tagHash, tagParentHash);
+                _sink.addMemoryTag(tagName, tagHash, tagParentHash);
             }
             break;
 
@@ -776,7 +832,7 @@ Capture::LoadResult Capture::loadBin(const char* _path)
                 VERIFY_READ_SIZE(tagHash)
                 VERIFY_READ_SIZE(threadID)
 
-                if (m_swapEndian)
+                if (Swap)
                 {
                     tagHash = Endian::swap(tagHash);
                     threadID = Endian::swap(threadID);
@@ -795,7 +851,7 @@ Capture::LoadResult Capture::loadBin(const char* _path)
                 VERIFY_READ_SIZE(tagHash)
                 VERIFY_READ_SIZE(threadID)
 
-                if (m_swapEndian)
+                if (Swap)
                 {
                     tagHash = Endian::swap(tagHash);
                     threadID = Endian::swap(threadID);
@@ -812,21 +868,17 @@ Capture::LoadResult Capture::loadBin(const char* _path)
                 uint32_t markerNameHash;
                 uint32_t markerColor;
 
-                ReadString<1024>(markerName, loader, m_swapEndian);
+                ReadString<1024>(markerName, loader, Swap);
                 VERIFY_READ_SIZE(markerNameHash)
                 VERIFY_READ_SIZE(markerColor)
 
-                if (m_swapEndian)
+                if (Swap)
                 {
                     markerNameHash = Endian::swap(markerNameHash);
                     markerColor = Endian::swap(markerColor);
                 }
 
-                MemoryMarkerEvent me;
-                me.m_color = markerColor;
-                me.m_name = markerName;
-                me.m_nameHash = markerNameHash;
-                m_memoryMarkers[markerNameHash] = me;
+                _sink.addMemoryMarker(markerName, markerNameHash, markerColor);
             }
             break;
 
@@ -840,28 +892,53 @@ Capture::LoadResult Capture::loadBin(const char* _path)
                 VERIFY_READ_SIZE(threadID)
                 VERIFY_READ_SIZE(time)
 
-                if (m_swapEndian)
+                if (Swap)
                 {
                     markerNameHash = Endian::swap(markerNameHash);
                     threadID = Endian::swap(threadID);
                     time = Endian::swap(time);
                 }
 
-                if (minMarkerTime > time)
-                    minMarkerTime = time;
+                _sink.addMemoryMarkerTime(markerNameHash, threadID, time);
+            }
+            break;
+
+            case rmem::LogMarkers::Module:
+            {
+                uint8_t sz;
+                uint64_t modBase;
+                uint32_t modSize;
+                uint64_t time;
+                VERIFY_READ_SIZE(sz);
+                char modName[1024];
+                if (sz == 1)
+                {
+                    ReadString<1024>(modName, loader, Swap);
+                }
+                else
+                {
+                    char16_t modNameC[1024];
+                    ReadString<1024>(modNameC, loader, Swap);
+                    rtm::strlCpy(modName,
+                                 RTM_NUM_ELEMENTS(modName),
+                                 QString::fromUtf16(modNameC).toUtf8().constData());
+                }
+
+                VERIFY_READ_SIZE(modBase);
+                VERIFY_READ_SIZE(modSize);
+                VERIFY_READ_SIZE(time)
 
-                MemoryMarkerEvent* evt = &m_memoryMarkers[markerNameHash];
-                RTM_ASSERT(evt != NULL, "");
+                if (Swap)
+                {
+                    modBase = Endian::swap(modBase);
+                    modSize = Endian::swap(modSize);
+                }
 
-                MemoryMarkerTime mt;
-                mt.m_threadID = threadID;
-                mt.m_event = evt;
-                mt.m_time = time;
-                m_memoryMarkerTimes.push_back(mt);
+                _sink.addModule(modName, modBase, modSize, time);
             }
             break;
 
-            case rmem::LogMarkers::Module:
+            case rmem::LogMarkers::ModuleUnload:
             {
                 uint8_t sz;
                 uint64_t modBase;
@@ -871,145 +948,2023 @@ Capture::LoadResult Capture::loadBin(const char* _path)
                 char modName[1024];
                 if (sz == 1)
                 {
-                    ReadString<1024>(modName, loader, m_swapEndian);
+                    ReadString<1024>(modName, loader, Swap);
                 }
                 else
                 {
                     char16_t modNameC[1024];
-                    ReadString<1024>(modNameC, loader, m_swapEndian);
+                    ReadString<1024>(modNameC, loader, Swap);
                     rtm::strlCpy(modName,
                                  RTM_NUM_ELEMENTS(modName),
                                  QString::fromUtf16(modNameC).toUtf8().constData());
                 }
 
-                VERIFY_READ_SIZE(modBase);
-                VERIFY_READ_SIZE(modSize);
-                VERIFY_READ_SIZE(time)
+                VERIFY_READ_SIZE(modBase);
+                VERIFY_READ_SIZE(modSize);
+                VERIFY_READ_SIZE(time)
+
+                if (Swap)
+                {
+                    modBase = Endian::swap(modBase);
+                    modSize = Endian::swap(modSize);
+                }
+
+                _sink.removeModule(modName, modBase, modSize, time);
+            }
+            break;
+
+            case rmem::LogMarkers::Allocator:
+            {
+                char allocatorName[1024];
+                uint64_t allocatorHandle;
+
+                ReadString<1024>(allocatorName, loader, Swap);
+                VERIFY_READ_SIZE(allocatorHandle);
+                if (Swap)
+                    allocatorHandle = Endian::swap(allocatorHandle);
+
+                _sink.addAllocator(allocatorName, allocatorHandle);
+            }
+            break;
+
+            default:
+                loadSuccess = false;
+                break;
+        };
+    }
+
+    return loadSuccess;
+}
+
+//--------------------------------------------------------------------------
+/// Applies parsed records directly to the capture, builds the chunk index
+/// and reports progress when parsing sequentially
+//--------------------------------------------------------------------------
+struct Capture::LoadSink
+{
+    Capture* m_capture;
+    CaptureIndex* m_index;
+    LiveLoad* m_live;
+    FilterLoad* m_filter;
+    ThreadTagStacks m_tagStacks;
+    uint64_t m_minMarkerTime;
+    uint64_t m_fileSizeOver100;
+    uint64_t m_fileEntries;
+    uint64_t m_fileProgress;
+    uint64_t m_indexKey;
+
+    LoadSink(Capture* _capture, CaptureIndex* _index, uint64_t _fileSize)
+        : m_capture(_capture)
+        , m_index(_index)
+        , m_live(_capture->m_live)
+        , m_filter(_capture->m_filterLoad)
+        , m_minMarkerTime((uint64_t)-1)
+        , m_fileSizeOver100(_fileSize / 100)
+        , m_fileEntries(0)
+        , m_fileProgress(1)
+        , m_indexKey((uint64_t)-1)
+    {
+    }
+
+    ThreadTagStacks& getTagStacks()
+    {
+        // live capture keeps tag stacks for records appended later
+        return m_live ? m_live->m_tagStacks : m_tagStacks;
+    }
+
+    inline bool beginRecord(BinLoader& _loader)
+    {
+        // remember where the record starts, parsing resumes here if it's incomplete
+        if (m_live)
+        {
+            if (m_live->m_compressed)
+            {
+                m_live->m_fileOffset = _loader.chunkFileOffset();
+                m_live->m_recordOffset = _loader.chunkTell();
+            }
+            else
+                m_live->m_fileOffset = _loader.tell();
+        }
+
+        // rest of the capture is past the time range of a filtered load
+        if (m_filter)
+        {
+            const bool isCompressed = _loader.isCompressed();
+            const uint64_t offset = isCompressed ? _loader.chunkFileOffset() : _loader.tell();
+            if (offset >= m_filter->m_endOffset)
+                return false;
+        }
+
+        // start a new index entry with the first record in each chunk or region
+        if (m_index)
+        {
+            const bool isCompressed = _loader.isCompressed();
+            const uint64_t key =
+                isCompressed ? _loader.chunkFileOffset() : _loader.tell() / CaptureIndex::RegionSize;
+            if (key != m_indexKey)
+            {
+                m_indexKey = key;
+                if (isCompressed)
+                    m_index->addEntry(_loader.chunkFileOffset(), _loader.chunkTell(), m_tagStacks);
+                else
+                    m_index->addEntry(_loader.tell(), 0, m_tagStacks);
+            }
+        }
+
+        ++m_fileEntries;
+        uint64_t newFileProgress = m_fileEntries >> 16;
+
+        if (newFileProgress != m_fileProgress)
+        {
+            m_fileProgress = newFileProgress;
+
+            if (m_capture->m_loadCancelled.load(std::memory_order_relaxed))
+                return false;
+
+            int64_t filePos = (int64_t)_loader.fileTell();
+            if (m_capture->m_loadProgressCallback)
+            {
+                float percent = float(filePos) / m_fileSizeOver100;
+                m_capture->m_loadProgressCallback(
+                    m_capture->m_loadProgressCustomData, percent, "Loading capture file...");
+            }
+        }
+
+        return true;
+    }
+
+    inline uint32_t internThread(uint64_t _threadID)
+    {
+        return m_capture->m_threadIDs.intern(_threadID);
+    }
+
+    inline uint32_t internHeap(uint64_t _handle)
+    {
+        InternTable& heaps = m_capture->m_heapHandles;
+        const size_t numHeaps = heaps.m_values.size();
+        const uint32_t index = heaps.intern(_handle);
+        if (heaps.m_values.size() != numHeaps)
+            addDefaultHeapName(m_capture->m_Heaps, _handle);
+        return index;
+    }
+
+    inline bool addStackTrace(MemoryOperation& _op, uint32_t _hash, uint64_t* _frames, uint32_t _numFrames)
+    {
+        _op.m_stackTrace = m_capture->addStackTrace(_hash, _frames, _numFrames);
+        return true;
+    }
+
+    inline bool findStackTrace(MemoryOperation& _op, uint32_t _hash)
+    {
+        StackTraceHashType::iterator it = m_capture->m_stackTracesHash.find(_hash);
+        if (it == m_capture->m_stackTracesHash.end())
+            return false;
+        _op.m_stackTrace = it->second;
+        return true;
+    }
+
+    /// Returns false once operations can't be indexed with 32 bits
+    inline bool addOperation(const MemoryOperation& _op)
+    {
+        if (m_index)
+            m_index->addOperation(_op.m_operationTime);
+
+        if (m_filter && !m_filter->keep(m_capture, _op))
+            return true;
+
+        if (m_capture->m_operations.size() >= MemoryOperations::MaxOperations)
+            return false;
+
+        m_capture->m_operations.add(_op);
+        return true;
+    }
+
+    void addMemoryTag(char* _name, uint32_t _hash, uint32_t _parentHash)
+    {
+        m_capture->addMemoryTag(_name, _hash, _parentHash);
+    }
+
+    void addMemoryMarker(const char* _name, uint32_t _hash, uint32_t _color)
+    {
+        m_capture->addMemoryMarker(_name, _hash, _color);
+    }
+
+    void addMemoryMarkerTime(uint32_t _hash, uint64_t _threadID, uint64_t _time)
+    {
+        if (m_filter && ((_time < m_filter->m_minTime) || (_time > m_filter->m_maxTime)))
+            return;
+
+        if (m_minMarkerTime > _time)
+            m_minMarkerTime = _time;
+        m_capture->addMemoryMarkerTime(_hash, _threadID, _time);
+    }
+
+    void addModule(const char* _name, uint64_t _base, uint32_t _size, uint64_t _time)
+    {
+        m_capture->addModule(_name, _base, _size, _time);
+    }
+
+    void removeModule(const char* _name, uint64_t _base, uint32_t _size, uint64_t _time)
+    {
+        m_capture->removeModule(_name, _base, _size, _time);
+    }
+
+    void addAllocator(const char* _name, uint64_t _handle)
+    {
+        m_capture->m_Heaps[_handle] = _name;
+    }
+};
+
+//--------------------------------------------------------------------------
+/// Parses all records following the module info, or the records appended to
+/// a live capture, on the calling thread
+//--------------------------------------------------------------------------
+template <bool Is64, bool Swap>
+bool Capture::loadOperations(BinLoader& _loader, uint64_t _fileSize, uint64_t& _minMarkerTime, CaptureIndex* _index)
+{
+    LoadSink sink(this, _index, _fileSize);
+    bool loadSuccess = parseRecords<Is64, Swap>(_loader, sink);
+    _minMarkerTime = sink.m_minMarkerTime;
+
+    // all data was parsed, records appended later start right after it
+    if (m_live && loadSuccess && sink.m_fileEntries)
+    {
+        m_live->m_fileOffset = _loader.fileTell();
+        m_live->m_recordOffset = 0;
+    }
+
+    return loadSuccess;
+}
+
+/// Records an overview keeps waiting for earlier ones before it applies them anyway
+static const size_t s_maxOverviewWindow = 1024 * 1024;
+
+//--------------------------------------------------------------------------
+/// Computes global stats and usage graph while parsing, no memory operation
+/// is kept. Records are decoded into a single operation and wait in a small
+/// form in a window ordered by time, the ones leaving the window are linked
+/// against live blocks and applied right away. With the capture index only
+/// records that a later one can still precede wait in the window; without it
+/// a record arriving after the window moved past its time is applied at that
+/// time, same as operations appended to a live capture.
+//--------------------------------------------------------------------------
+struct Capture::OverviewSink : public Capture::LoadSink
+{
+    struct Record
+    {
+        uint64_t m_time;
+        uint64_t m_sequence;  ///< Position in capture, keeps order of operations with the same time
+        uint64_t m_pointer;
+        uint64_t m_previousPointer;
+        uint32_t m_allocSize;
+        uint32_t m_overhead;
+        uint8_t m_operationType;
+    };
+
+    struct RecordLater
+    {
+        inline bool operator()(const Record& _r1, const Record& _r2) const
+        {
+            return (_r1.m_time > _r2.m_time) ||
+                   ((_r1.m_time == _r2.m_time) && (_r1.m_sequence > _r2.m_sequence));
+        }
+    };
+
+    struct Block
+    {
+        uint32_t m_allocSize;
+        uint32_t m_overhead;
+    };
+
+    enum
+    {
+        PrevOp,  ///< Block the applied realloc or free is linked to
+        CurrentOp  ///< Record being applied to stats
+    };
+
+    MemoryOperations m_ops;  ///< Scratch operations stats are filled from
+    std::priority_queue<Record, std::vector<Record>, RecordLater> m_window;
+    robin_hood::unordered_map<uint64_t, Block> m_blocks;  ///< Live blocks, key is a pointer
+    const std::vector<CaptureIndex::Entry>* m_entries;    ///< Entries of loaded index, NULL without one
+    std::vector<uint64_t> m_releaseTimes;  ///< Earliest operation time in an index entry and the ones after
+    size_t m_nextEntry;
+    uint64_t m_releaseTime;  ///< Records up to this time can't be preceded by the ones to be parsed
+    uint64_t m_sequence;
+    uint64_t m_lastTime;
+    uint64_t m_numApplied;
+    uint64_t m_bucketTime;
+    GraphBucket m_bucket;  ///< Open level 0 bucket, the closed ones are in usage graph
+
+    OverviewSink(Capture* _capture, CaptureIndex* _index, uint64_t _fileSize)
+        : LoadSink(_capture, _index, _fileSize)
+        , m_entries(NULL)
+        , m_nextEntry(0)
+        , m_releaseTime(0)
+        , m_sequence(0)
+        , m_lastTime(0)
+        , m_numApplied(0)
+        , m_bucketTime(1)
+    {
+        m_ops.resize(2);
+        initGraphBucket(m_bucket, 0, 0);
+    }
+
+    /// Index of a complete parse tells how much later records can go back in time
+    void setIndex(const CaptureIndex& _index)
+    {
+        m_entries = &_index.getEntries();
+        m_releaseTimes.resize(m_entries->size());
+
+        uint64_t minTime = (uint64_t)-1;
+        for (size_t i = m_entries->size(); i > 0; --i)
+        {
+            minTime = qMin(minTime, (*m_entries)[i - 1].m_minTime);
+            m_releaseTimes[i - 1] = minTime;
+        }
+    }
+
+    inline bool beginRecord(BinLoader& _loader)
+    {
+        if (!LoadSink::beginRecord(_loader))
+            return false;
+
+        if (m_entries)
+        {
+            const uint64_t offset = _loader.isCompressed() ? _loader.chunkFileOffset() : _loader.tell();
+            for (; (m_nextEntry < m_entries->size()) && (offset >= (*m_entries)[m_nextEntry].m_fileOffset);
+                 ++m_nextEntry)
+                m_releaseTime = m_releaseTimes[m_nextEntry];
+        }
+
+        return true;
+    }
+
+    inline bool addStackTrace(MemoryOperation& _op, uint32_t, uint64_t*, uint32_t)
+    {
+        _op.m_stackTrace = 0;
+        return true;
+    }
+
+    inline bool findStackTrace(MemoryOperation& _op, uint32_t)
+    {
+        _op.m_stackTrace = 0;
+        return true;
+    }
+
+    inline bool addOperation(const MemoryOperation& _op)
+    {
+        if (m_index)
+            m_index->addOperation(_op.m_operationTime);
+
+        Record record;
+        record.m_time = _op.m_operationTime;
+        record.m_sequence = m_sequence++;
+        record.m_pointer = _op.m_pointer;
+        record.m_previousPointer = _op.m_previousPointer;
+        record.m_allocSize = _op.m_allocSize;
+        record.m_overhead = _op.m_overhead;
+        record.m_operationType = _op.m_operationType;
+        m_window.push(record);
+
+        while (!m_window.empty() &&
+               ((m_window.top().m_time <= m_releaseTime) || (m_window.size() > s_maxOverviewWindow)))
+        {
+            apply(m_window.top());
+            m_window.pop();
+        }
+        return true;
+    }
+
+    /// Links the record against live blocks, returns false for invalid operations
+    inline bool link(const Record& _record)
+    {
+        m_ops.m_chainPrev[CurrentOp] = MemoryOperations::NoOperation;
+
+        switch (_record.m_operationType)
+        {
+            case rmem::LogMarkers::OpAlloc:
+            case rmem::LogMarkers::OpCalloc:
+            case rmem::LogMarkers::OpAllocAligned:
+            {
+                Block block = {_record.m_allocSize, _record.m_overhead};
+                return m_blocks.insert(std::make_pair(_record.m_pointer, block)).second;
+            }
+
+            case rmem::LogMarkers::OpRealloc:
+            case rmem::LogMarkers::OpReallocAligned:
+            {
+                bool valid = true;
+                if (_record.m_previousPointer)
+                {
+                    robin_hood::unordered_map<uint64_t, Block>::iterator it =
+                        m_blocks.find(_record.m_previousPointer);
+                    if (it == m_blocks.end())
+                        valid = false;
+                    else
+                    {
+                        m_ops.m_allocSize[PrevOp] = it->second.m_allocSize;
+                        m_ops.m_overhead[PrevOp] = it->second.m_overhead;
+                        m_ops.m_chainPrev[CurrentOp] = PrevOp;
+                        m_blocks.erase(it);
+                    }
+                }
+                else
+                    valid = m_blocks.find(_record.m_pointer) == m_blocks.end();
+
+                // address is taken over even by an invalid realloc, same as when linking operations
+                Block block = {_record.m_allocSize, _record.m_overhead};
+                m_blocks[_record.m_pointer] = block;
+                return valid;
+            }
+
+            case rmem::LogMarkers::OpFree:
+            {
+                robin_hood::unordered_map<uint64_t, Block>::iterator it = m_blocks.find(_record.m_pointer);
+                if (it == m_blocks.end())
+                    return false;
+
+                m_ops.m_allocSize[CurrentOp] = it->second.m_allocSize;
+                m_ops.m_overhead[CurrentOp] = it->second.m_overhead;
+                m_blocks.erase(it);
+                return true;
+            }
+        };
+
+        return false;
+    }
+
+    void apply(Record _record)
+    {
+        Capture* capture = m_capture;
+        std::vector<GraphBucket>& level0 = capture->m_usageGraph[0];
+
+        if (m_numApplied++ == 0)
+            m_lastTime = _record.m_time;
+
+        if (_record.m_time < m_lastTime)
+            _record.m_time = m_lastTime;
+        m_lastTime = _record.m_time;
+
+        m_ops.m_pointer[CurrentOp] = _record.m_pointer;
+        m_ops.m_allocSize[CurrentOp] = _record.m_allocSize;
+        m_ops.m_overhead[CurrentOp] = _record.m_overhead;
+        if (!link(_record))
+            return;
+
+        // time range is set by valid operations, same as when linking operations
+        MemoryStats& stats = capture->m_statsGlobal;
+        if (stats.m_numberOfOperations++ == 0)
+            capture->m_minTime = qMin(_record.m_time, m_minMarkerTime);
+        capture->m_maxTime = _record.m_time;
+
+        switch (_record.m_operationType)
+        {
+            case rmem::LogMarkers::OpAlloc:
+            case rmem::LogMarkers::OpCalloc:
+            case rmem::LogMarkers::OpAllocAligned:
+                fillStats_Alloc(m_ops, CurrentOp, stats);
+                break;
+
+            case rmem::LogMarkers::OpRealloc:
+            case rmem::LogMarkers::OpReallocAligned:
+                fillStats_ReAlloc(m_ops, CurrentOp, stats);
+                break;
+
+            case rmem::LogMarkers::OpFree:
+                fillStats_Free(m_ops, CurrentOp, stats);
+                break;
+        };
+
+        // keep level 0 size bounded by merging pairs of buckets as the time range grows,
+        // with an odd number of closed buckets the last one goes into the open bucket
+        uint64_t opBucket = (_record.m_time - capture->m_minTime) / m_bucketTime;
+        while (opBucket >= s_maxGraphBuckets)
+        {
+            const size_t numClosed = level0.size();
+            for (size_t i = 0; i + 1 < numClosed; i += 2)
+            {
+                GraphBucket merged = level0[i];
+                mergeGraphBuckets(merged, level0[i + 1]);
+                level0[i / 2] = merged;
+            }
+
+            if (numClosed & 1)
+            {
+                GraphBucket merged = level0[numClosed - 1];
+                mergeGraphBuckets(merged, m_bucket);
+                m_bucket = merged;
+            }
+
+            level0.resize(numClosed / 2);
+            m_bucketTime *= 2;
+            opBucket = (_record.m_time - capture->m_minTime) / m_bucketTime;
+        }
+
+        // close buckets before this operation, empty ones keep the last values
+        while (level0.size() < opBucket)
+        {
+            level0.push_back(m_bucket);
+            initGraphBucket(m_bucket, m_bucket.m_lastUsage, m_bucket.m_lastLiveBlocks);
+        }
+        addToGraphBucket(m_bucket, stats.m_memoryUsage, stats.m_numberOfLiveBlocks);
+    }
+
+    /// Applies records left in the window and closes the usage graph, returns false if there were none
+    bool finish()
+    {
+        while (!m_window.empty())
+        {
+            apply(m_window.top());
+            m_window.pop();
+        }
+
+        if (!m_capture->m_statsGlobal.m_numberOfOperations)
+            return false;
+
+        Capture* capture = m_capture;
+        capture->m_usageGraph[0].push_back(m_bucket);
+        capture->m_usageBucketTime = m_bucketTime;
+        capture->buildGraphLevels(0);
+
+        capture->m_filter.m_minTimeSnapshot = capture->m_minTime;
+        capture->m_filter.m_maxTimeSnapshot = capture->m_maxTime;
+        capture->m_statsSnapshot = capture->m_statsGlobal;
+        return true;
+    }
+};
+
+//--------------------------------------------------------------------------
+/// Collects records from a range of index entries on a worker thread. Stack
+/// traces are interned locally; traces registered in earlier ranges are kept
+/// as unresolved hashes and looked up when ranges are merged in file order.
+//--------------------------------------------------------------------------
+struct RangeSink
+{
+    enum
+    {
+        Unresolved = 0xffffffff,
+        ProgressStep = 64 * 1024
+    };
+
+    struct Trace
+    {
+        uint32_t m_hash;
+        uint32_t m_numFrames;  ///< Unresolved if trace was added in an earlier range
+        size_t m_frameOffset;
+    };
+
+    struct Event
+    {
+        uint8_t m_marker;
+        uint32_t m_hash;     ///< Tag or marker name hash
+        uint32_t m_value32;  ///< Parent tag hash, marker color or module size
+        uint64_t m_value64;  ///< Thread ID, module base or allocator handle
+        uint64_t m_time;
+        std::string m_name;
+    };
+
+    const CaptureIndex::Entry* m_entry;  ///< First index entry of the range
+    uint64_t m_endOffset;                ///< File offset where the next range starts
+    MemoryOperations* m_operations;      ///< Capture operations, slots of this range are preallocated
+    uint64_t m_firstOperation;           ///< Index of the first slot of this range
+    uint64_t m_numOperations;
+    uint64_t m_maxOperations;
+    std::vector<uint64_t> m_previousPointers;  ///< Previous pointers of reallocs with local indices
+    uint32_t m_previousBase;                   ///< Offset of local previous pointers in capture operations
+    std::vector<uint32_t> m_opTraces;  ///< Local trace index of each operation
+    std::vector<Trace> m_traces;
+    std::vector<uint64_t> m_frames;
+    robin_hood::unordered_map<uint32_t, uint32_t> m_traceHash;
+    std::vector<uint32_t> m_resolved;
+    std::vector<Event> m_events;
+    InternTable m_threadIDs;             ///< Thread IDs with local indices
+    InternTable m_heapHandles;           ///< Allocator handles with local indices
+    std::vector<uint32_t> m_threadRemap; ///< Local to capture thread index
+    std::vector<uint32_t> m_heapRemap;   ///< Local to capture heap index
+    ThreadTagStacks m_tagStacks;
+    uint64_t m_minMarkerTime;
+
+    const std::atomic<bool>* m_cancelled;
+
+    // progress is reported only by ranges parsed on the calling thread
+    std::atomic<uint64_t>* m_progress;
+    uint64_t m_totalOperations;
+    LoadProgress m_progressCallback;
+    void* m_progressData;
+
+    RangeSink()
+        : m_entry(NULL)
+        , m_endOffset((uint64_t)-1)
+        , m_operations(NULL)
+        , m_firstOperation(0)
+        , m_numOperations(0)
+        , m_maxOperations(0)
+        , m_previousBase(0)
+        , m_minMarkerTime((uint64_t)-1)
+        , m_cancelled(NULL)
+        , m_progress(NULL)
+        , m_totalOperations(0)
+        , m_progressCallback(NULL)
+        , m_progressData(NULL)
+    {
+    }
+
+    ThreadTagStacks& getTagStacks()
+    {
+        return m_tagStacks;
+    }
+
+    inline bool beginRecord(BinLoader& _loader)
+    {
+        if (((m_numOperations % ProgressStep) == 0) && m_cancelled->load(std::memory_order_relaxed))
+            return false;
+
+        // records starting in the next range belong to it
+        if (_loader.isCompressed())
+            return _loader.chunkFileOffset() < m_endOffset;
+        return _loader.tell() < m_endOffset;
+    }
+
+    inline uint32_t internThread(uint64_t _threadID)
+    {
+        return m_threadIDs.intern(_threadID);
+    }
+
+    inline uint32_t internHeap(uint64_t _handle)
+    {
+        return m_heapHandles.intern(_handle);
+    }
+
+    inline bool addStackTrace(MemoryOperation& _op, uint32_t _hash, uint64_t* _frames, uint32_t _numFrames)
+    {
+        RTM_UNUSED(_op);
+
+        robin_hood::unordered_map<uint32_t, uint32_t>::iterator it = m_traceHash.find(_hash);
+        if (it != m_traceHash.end())
+        {
+            const Trace& trace = m_traces[it->second];
+            if ((trace.m_numFrames == _numFrames) &&
+                stackTraceCompare(&m_frames[trace.m_frameOffset], _numFrames, _frames, _numFrames))
+            {
+                m_opTraces.push_back(it->second);
+                return true;
+            }
+        }
+
+        Trace trace;
+        trace.m_hash = _hash;
+        trace.m_numFrames = _numFrames;
+        trace.m_frameOffset = m_frames.size();
+        m_frames.insert(m_frames.end(), _frames, _frames + _numFrames);
+
+        const uint32_t index = (uint32_t)m_traces.size();
+        m_traces.push_back(trace);
+        m_traceHash[_hash] = index;
+        m_opTraces.push_back(index);
+        return true;
+    }
+
+    inline bool findStackTrace(MemoryOperation& _op, uint32_t _hash)
+    {
+        RTM_UNUSED(_op);
+
+        robin_hood::unordered_map<uint32_t, uint32_t>::iterator it = m_traceHash.find(_hash);
+        if (it != m_traceHash.end())
+        {
+            m_opTraces.push_back(it->second);
+            return true;
+        }
+
+        Trace trace;
+        trace.m_hash = _hash;
+        trace.m_numFrames = Unresolved;
+        trace.m_frameOffset = 0;
+
+        const uint32_t index = (uint32_t)m_traces.size();
+        m_traces.push_back(trace);
+        m_traceHash[_hash] = index;
+        m_opTraces.push_back(index);
+        return true;
+    }
+
+    /// Returns false if the range holds more operations than the index says
+    inline bool addOperation(const MemoryOperation& _op)
+    {
+        if (m_numOperations == m_maxOperations)
+            return false;
+
+        const size_t index = (size_t)(m_firstOperation + m_numOperations++);
+        m_operations->set(index, _op);
+        if (_op.m_previousPointer)
+        {
+            m_operations->m_chainPrev[index] = (uint32_t)m_previousPointers.size();
+            m_previousPointers.push_back(_op.m_previousPointer);
+        }
+
+        if ((m_numOperations % ProgressStep) == 0)
+        {
+            const uint64_t done = m_progress->fetch_add(ProgressStep) + ProgressStep;
+            if (m_progressCallback)
+                m_progressCallback(
+                    m_progressData, float(done * 100) / m_totalOperations, "Loading capture file...");
+        }
+        return true;
+    }
+
+    void addEvent(
+        uint8_t _marker, const char* _name, uint32_t _hash, uint32_t _value32, uint64_t _value64, uint64_t _time)
+    {
+        Event evt;
+        evt.m_marker = _marker;
+        evt.m_hash = _hash;
+        evt.m_value32 = _value32;
+        evt.m_value64 = _value64;
+        evt.m_time = _time;
+        if (_name)
+            evt.m_name = _name;
+        m_events.push_back(evt);
+    }
+
+    void addMemoryTag(char* _name, uint32_t _hash, uint32_t _parentHash)
+    {
+        addEvent(rmem::LogMarkers::RegisterTag, _name, _hash, _parentHash, 0, 0);
+    }
+
+    void addMemoryMarker(const char* _name, uint32_t _hash, uint32_t _color)
+    {
+        addEvent(rmem::LogMarkers::RegisterMarker, _name, _hash, _color, 0, 0);
+    }
+
+    void addMemoryMarkerTime(uint32_t _hash, uint64_t _threadID, uint64_t _time)
+    {
+        if (m_minMarkerTime > _time)
+            m_minMarkerTime = _time;
+        addEvent(rmem::LogMarkers::Marker, NULL, _hash, 0, _threadID, _time);
+    }
+
+    void addModule(const char* _name, uint64_t _base, uint32_t _size, uint64_t _time)
+    {
+        addEvent(rmem::LogMarkers::Module, _name, 0, _size, _base, _time);
+    }
+
+    void removeModule(const char* _name, uint64_t _base, uint32_t _size, uint64_t _time)
+    {
+        addEvent(rmem::LogMarkers::ModuleUnload, _name, 0, _size, _base, _time);
+    }
+
+    void addAllocator(const char* _name, uint64_t _handle)
+    {
+        addEvent(rmem::LogMarkers::Allocator, _name, 0, 0, _handle, 0);
+    }
+
+    /// Sets capture wide indices of stack traces, threads, heaps and previous pointers once ranges are merged
+    void resolveOperations()
+    {
+        MemoryOperations& ops = *m_operations;
+        for (uint64_t i = 0; i < m_numOperations; ++i)
+        {
+            const size_t op = (size_t)(m_firstOperation + i);
+            ops.m_stackTrace[op] = m_resolved[m_opTraces[i]];
+            ops.m_threadIndex[op] = m_threadRemap[ops.m_threadIndex[op]];
+            ops.m_heapIndex[op] = m_heapRemap[ops.m_heapIndex[op]];
+            if (ops.m_chainPrev[op] != MemoryOperations::NoOperation)
+                ops.m_chainPrev[op] += m_previousBase;
+        }
+    }
+};
+
+//--------------------------------------------------------------------------
+/// Parses a range of index entries using its own file handle and loader
+//--------------------------------------------------------------------------
+template <bool Is64, bool Swap>
+static bool parseRange(const char* _path, const CaptureIndex& _index, RangeSink& _range)
+{
+    FILE* f = openCaptureFile(_path);
+    if (!f)
+        return false;
+
+    seekCaptureFile(f, _range.m_entry->m_fileOffset);
+    _index.getTagStacks(*_range.m_entry, _range.m_tagStacks);
+    _range.m_opTraces.reserve((size_t)_range.m_maxOperations);
+
+    bool loadSuccess;
+    {
+        // ranges already run in parallel, decompress inline
+        BinLoader loader(f, _index.isCompressed(), false);
+        loadSuccess = loader.skip(_range.m_entry->m_recordOffset) && parseRecords<Is64, Swap>(loader, _range);
+    }
+
+    fclose(f);
+
+    return loadSuccess && (_range.m_numOperations == _range.m_maxOperations);
+}
+
+//--------------------------------------------------------------------------
+/// Parses ranges on up to _numThreads threads, each thread takes the next
+/// range nobody parses yet. Progress is reported by the calling thread only.
+//--------------------------------------------------------------------------
+template <bool Is64, bool Swap>
+static bool parseRanges(const char* _path,
+                        const CaptureIndex& _index,
+                        std::vector<RangeSink>& _ranges,
+                        uint32_t _numThreads,
+                        LoadProgress _progressCallback,
+                        void* _progressData)
+{
+    std::atomic<size_t> nextRange(0);
+    std::atomic<bool> failed(false);
+    auto parse = [&](uint32_t _thread) {
+        size_t r;
+        while (!failed && ((r = nextRange.fetch_add(1)) < _ranges.size()))
+        {
+            RangeSink& range = _ranges[r];
+            if (_thread == 0)
+            {
+                range.m_progressCallback = _progressCallback;
+                range.m_progressData = _progressData;
+            }
+
+            if (!parseRange<Is64, Swap>(_path, _index, range))
+                failed = true;
+        }
+    };
+
+    runParallel(_numThreads, parse);
+
+    return !failed;
+}
+
+//--------------------------------------------------------------------------
+/// Parses the capture on all cores using the chunk index. Returns false,
+/// leaving capture data untouched, if the capture can't be split or the
+/// parsed data doesn't match the index.
+//--------------------------------------------------------------------------
+template <bool Is64, bool Swap>
+bool Capture::loadOperationsParallel(const char* _path, uint64_t& _minMarkerTime)
+{
+    const std::vector<CaptureIndex::Entry>& entries = m_index.getEntries();
+    const uint64_t numOperations = m_index.getNumOperations();
+
+    uint32_t numThreads = std::thread::hardware_concurrency();
+    if (numThreads > s_maxLoadThreads)
+        numThreads = s_maxLoadThreads;
+    if (numThreads > entries.size())
+        numThreads = (uint32_t)entries.size();
+
+    if ((numThreads < 2) || (numOperations == 0) || (numOperations > MemoryOperations::MaxOperations))
+        return false;
+
+    m_operations.resize((size_t)numOperations);
+
+    std::atomic<uint64_t> progress(0);
+
+    // split entries into contiguous ranges with similar number of operations
+    std::vector<RangeSink> ranges(numThreads);
+    size_t entry = 0;
+    uint64_t firstOperation = 0;
+    for (uint32_t i = 0; i < numThreads; ++i)
+    {
+        RangeSink& range = ranges[i];
+        range.m_entry = &entries[entry];
+        range.m_operations = &m_operations;
+        range.m_firstOperation = firstOperation;
+        range.m_cancelled = &m_loadCancelled;
+        range.m_progress = &progress;
+        range.m_totalOperations = numOperations;
+
+        uint64_t endOperation = firstOperation;
+        if (i == numThreads - 1)
+        {
+            endOperation = numOperations;
+            entry = entries.size();
+        }
+        else
+        {
+            // leave at least one entry for each of the remaining ranges
+            const size_t lastEntry = entries.size() - (numThreads - i - 1);
+            const uint64_t target = numOperations * (i + 1) / numThreads;
+            do
+            {
+                endOperation += entries[entry++].m_numOperations;
+            } while ((entry < lastEntry) && (endOperation < target));
+        }
+
+        range.m_endOffset = entry < entries.size() ? entries[entry].m_fileOffset : (uint64_t)-1;
+        range.m_maxOperations = endOperation - firstOperation;
+        firstOperation = endOperation;
+    }
+
+    const bool parsed = parseRanges<Is64, Swap>(
+        _path, m_index, ranges, numThreads, m_loadProgressCallback, m_loadProgressCustomData);
+
+    if (!parsed || m_loadCancelled || !mergeRanges(ranges, numThreads, _minMarkerTime, false))
+    {
+        m_stackTracesHash.clear();
+        m_stackTracesByFrame.clear();
+        m_stackTraces.clear();
+        m_stackFrames.clear();
+        m_stackPool.reset();
+        m_operations.clear();
+        return false;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Parses every _step-th entry of the chunk index on all cores, so loaded
+/// chunks are spread evenly over the whole capture time
+//--------------------------------------------------------------------------
+template <bool Is64, bool Swap>
+bool Capture::loadOperationsSampled(const char* _path, uint32_t _step, uint64_t& _minMarkerTime)
+{
+    const std::vector<CaptureIndex::Entry>& entries = m_index.getEntries();
+
+    uint64_t numOperations = 0;
+    for (size_t i = 0; i < entries.size(); i += _step)
+        numOperations += entries[i].m_numOperations;
+
+    if ((numOperations == 0) || (numOperations > MemoryOperations::MaxOperations))
+        return false;
+
+    m_operations.resize((size_t)numOperations);
+
+    std::atomic<uint64_t> progress(0);
+
+    // every sampled entry is a range of its own
+    std::vector<RangeSink> ranges((entries.size() + _step - 1) / _step);
+    uint64_t firstOperation = 0;
+    for (size_t i = 0; i < ranges.size(); ++i)
+    {
+        const size_t entry = i * _step;
+
+        RangeSink& range = ranges[i];
+        range.m_entry = &entries[entry];
+        range.m_endOffset = entry + 1 < entries.size() ? entries[entry + 1].m_fileOffset : (uint64_t)-1;
+        range.m_operations = &m_operations;
+        range.m_firstOperation = firstOperation;
+        range.m_maxOperations = entries[entry].m_numOperations;
+        range.m_cancelled = &m_loadCancelled;
+        range.m_progress = &progress;
+        range.m_totalOperations = numOperations;
+        firstOperation += range.m_maxOperations;
+    }
+
+    uint32_t numThreads = std::thread::hardware_concurrency();
+    if (numThreads > s_maxLoadThreads)
+        numThreads = s_maxLoadThreads;
+    if (numThreads > ranges.size())
+        numThreads = (uint32_t)ranges.size();
+    if (numThreads == 0)
+        numThreads = 1;
+
+    const bool parsed = parseRanges<Is64, Swap>(
+        _path, m_index, ranges, numThreads, m_loadProgressCallback, m_loadProgressCustomData);
+
+    if (!parsed || m_loadCancelled || !mergeRanges(ranges, numThreads, _minMarkerTime, true))
+    {
+        m_stackTracesHash.clear();
+        m_stackTracesByFrame.clear();
+        m_stackTraces.clear();
+        m_stackFrames.clear();
+        m_stackPool.reset();
+        m_operations.clear();
+        return false;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Merges parsed ranges in file order, exactly as a sequential parse would.
+/// Sampled ranges may use stack traces registered in chunks that were not
+/// loaded, those get traces without frames. Otherwise returns false if a
+/// trace can't be found, leaving events and operations unresolved.
+//--------------------------------------------------------------------------
+bool Capture::mergeRanges(std::vector<RangeSink>& _ranges,
+                          uint32_t _numThreads,
+                          uint64_t& _minMarkerTime,
+                          bool _sampled)
+{
+    // unify stack traces in file order
+    for (size_t i = 0; i < _ranges.size(); ++i)
+    {
+        RangeSink& range = _ranges[i];
+        range.m_resolved.resize(range.m_traces.size());
+
+        for (size_t j = 0; j < range.m_traces.size(); ++j)
+        {
+            const RangeSink::Trace& trace = range.m_traces[j];
+            if (trace.m_numFrames == RangeSink::Unresolved)
+            {
+                StackTraceHashType::iterator it = m_stackTracesHash.find(trace.m_hash);
+                if (it != m_stackTracesHash.end())
+                    range.m_resolved[j] = it->second;
+                else if (_sampled)
+                {
+                    uint64_t noFrames = 0;
+                    range.m_resolved[j] = addStackTrace(trace.m_hash, &noFrames, 0);
+                }
+                else
+                    return false;
+            }
+            else
+                range.m_resolved[j] =
+                    addStackTrace(trace.m_hash, &range.m_frames[trace.m_frameOffset], trace.m_numFrames);
+        }
+    }
+
+    // apply events in file order
+    for (size_t i = 0; i < _ranges.size(); ++i)
+    {
+        RangeSink& range = _ranges[i];
+        if (_minMarkerTime > range.m_minMarkerTime)
+            _minMarkerTime = range.m_minMarkerTime;
+
+        for (size_t j = 0; j < range.m_events.size(); ++j)
+        {
+            RangeSink::Event& evt = range.m_events[j];
+            switch (evt.m_marker)
+            {
+                case rmem::LogMarkers::RegisterTag:
+                    addMemoryTag(&evt.m_name[0], evt.m_hash, evt.m_value32);
+                    break;
+                case rmem::LogMarkers::RegisterMarker:
+                    addMemoryMarker(evt.m_name.c_str(), evt.m_hash, evt.m_value32);
+                    break;
+                case rmem::LogMarkers::Marker:
+                    addMemoryMarkerTime(evt.m_hash, evt.m_value64, evt.m_time);
+                    break;
+                case rmem::LogMarkers::Module:
+                    addModule(evt.m_name.c_str(), evt.m_value64, evt.m_value32, evt.m_time);
+                    break;
+                case rmem::LogMarkers::ModuleUnload:
+                    removeModule(evt.m_name.c_str(), evt.m_value64, evt.m_value32, evt.m_time);
+                    break;
+                case rmem::LogMarkers::Allocator:
+                    m_Heaps[evt.m_value64] = evt.m_name;
+                    break;
+            };
+        }
+    }
+
+    // intern thread IDs and allocator handles in file order, named allocators
+    // take precedence regardless of the order they were seen in
+    for (size_t i = 0; i < _ranges.size(); ++i)
+    {
+        RangeSink& range = _ranges[i];
+
+        const std::vector<uint64_t>& threadIDs = range.m_threadIDs.m_values;
+        range.m_threadRemap.resize(threadIDs.size());
+        for (size_t j = 0; j < threadIDs.size(); ++j)
+            range.m_threadRemap[j] = m_threadIDs.intern(threadIDs[j]);
+
+        const std::vector<uint64_t>& handles = range.m_heapHandles.m_values;
+        range.m_heapRemap.resize(handles.size());
+        for (size_t j = 0; j < handles.size(); ++j)
+        {
+            range.m_heapRemap[j] = m_heapHandles.intern(handles[j]);
+            addDefaultHeapName(m_Heaps, handles[j]);
+        }
+    }
+
+    // previous pointers of reallocs follow in file order too
+    for (size_t i = 0; i < _ranges.size(); ++i)
+    {
+        RangeSink& range = _ranges[i];
+        range.m_previousBase = (uint32_t)m_operations.m_previousPointers.size();
+        m_operations.m_previousPointers.insert(
+            m_operations.m_previousPointers.end(), range.m_previousPointers.begin(), range.m_previousPointers.end());
+        range.m_previousPointers.clear();
+        range.m_previousPointers.shrink_to_fit();
+    }
+
+    std::atomic<size_t> nextRange(0);
+    auto resolve = [&_ranges, &nextRange](uint32_t) {
+        size_t r;
+        while ((r = nextRange.fetch_add(1)) < _ranges.size())
+            _ranges[r].resolveOperations();
+    };
+
+    runParallel(_numThreads, resolve);
+
+    return true;
+}
+
+Capture::LoadResult Capture::loadBin(const char* _path, bool _live)
+{
+    clearData();
+
+    m_loadedFile = _path;
+
+    // filtered load is a part of the capture, it's neither restored from nor saved to the cache
+    const bool filtered = !_live && m_loadFilter.isActive();
+
+    // capture that was fully loaded before is restored from the analysis cache
+    const bool cached = m_cacheEnabled && !_live && !filtered;
+    if (cached && loadCache(_path))
+    {
+        m_cacheValid = true;
+        return Capture::LoadSuccess;
+    }
+
+    clearData();
+    m_loadedFile = _path;
+
+    FILE* f = openCaptureFile(_path);
+    if (!f)
+        return Capture::LoadFail;
+
+#if RTM_PLATFORM_WINDOWS
+    _fseeki64(f, 0, SEEK_END);
+    uint64_t fileSize = (uint64_t)_ftelli64(f);
+    _fseeki64(f, 0, SEEK_SET);
+#elif RTM_PLATFORM_LINUX
+    fseeko64(f, 0, SEEK_END);
+    uint64_t fileSize = (uint64_t)ftello64(f);
+    fseeko64(f, 0, SEEK_SET);
+#elif RTM_PLATFORM_OSX
+    fseeko(f, 0, SEEK_END);
+    uint64_t fileSize = (uint64_t)ftello(f);
+    fseeko(f, 0, SEEK_SET);
+#else
+#error "Not implemented for target platform!"
+#endif
+
+    uint32_t compressSignature;
+    if (!fread(&compressSignature, 1, sizeof(uint32_t), f))
+        return Capture::LoadFail;
+
+#if RTM_PLATFORM_WINDOWS
+    _fseeki64(f, 0, SEEK_SET);
+#elif RTM_PLATFORM_LINUX
+    fseeko64(f, 0, SEEK_SET);
+#endif
+
+    bool isCompressed =
+        ((compressSignature == 0x23234646) || compressSignature == Endian::swap(uint32_t(0x23234646)));
+
+    // index is written on first load, later loads use it to parse chunk ranges in parallel;
+    // workers decompress their own chunks then, so this loader only needs to read the header
+    const bool indexed = !_live && !filtered && m_index.load(_path);
+    BinLoader loader(f, isCompressed, !indexed);
+
+    if (_live)
+    {
+        m_live = new LiveLoad(isCompressed);
+        m_live->m_fileSize = fileSize;
+    }
+
+    if (!loadHeader(loader, fileSize))
+    {
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    uint64_t minMarkerTime = (uint64_t)-1;
+
+    if (filtered)
+    {
+        m_filterLoad = new FilterLoad(m_loadFilter, m_CPUFrequency);
+
+        // index tells where records past the time range start, parsing stops there
+        if ((m_filterLoad->m_maxTime != (uint64_t)-1) && m_index.load(_path))
+        {
+            const std::vector<CaptureIndex::Entry>& entries = m_index.getEntries();
+            for (size_t i = entries.size(); i > 0; --i)
+            {
+                const CaptureIndex::Entry& entry = entries[i - 1];
+                if (entry.m_numOperations && (entry.m_minTime <= m_filterLoad->m_maxTime))
+                    break;
+                m_filterLoad->m_endOffset = entry.m_fileOffset;
+            }
+        }
+    }
+
+    CaptureIndex* index = NULL;
+    bool loadSuccess = false;
+    if (indexed)
+    {
+        if (m_64bit)
+            loadSuccess = m_swapEndian ? loadOperationsParallel<true, true>(_path, minMarkerTime)
+                                       : loadOperationsParallel<true, false>(_path, minMarkerTime);
+        else
+            loadSuccess = m_swapEndian ? loadOperationsParallel<false, true>(_path, minMarkerTime)
+                                       : loadOperationsParallel<false, false>(_path, minMarkerTime);
+    }
+
+    // without a usable index parse sequentially, rebuilding the index on the way;
+    // record decoders are picked once, every field layout is then known at compile time
+    if (!loadSuccess && !m_loadCancelled)
+    {
+        // live capture is incomplete and filtered one is a part of it, they get no index
+        if (!_live && !filtered && m_index.begin(_path, isCompressed))
+            index = &m_index;
+
+        if (m_64bit)
+            loadSuccess = m_swapEndian ? loadOperations<true, true>(loader, fileSize, minMarkerTime, index)
+                                       : loadOperations<true, false>(loader, fileSize, minMarkerTime, index);
+        else
+            loadSuccess = m_swapEndian ? loadOperations<false, true>(loader, fileSize, minMarkerTime, index)
+                                       : loadOperations<false, false>(loader, fileSize, minMarkerTime, index);
+    }
+
+    // records appended to a live capture refer to stack traces by hash
+    if (!_live)
+    {
+        m_stackTracesHash.clear();
+        m_stackTracesByFrame.clear();
+        m_stackFrames.releaseLookup();
+    }
+
+    // tolerate invalid data at the end of file, live capture ends with a record still being written
+    Capture::LoadResult loadResult = Capture::LoadSuccess;
+    if (_live)
+        loadSuccess = true;
+
+    if (loadSuccess == false)
+    {
+        uint64_t pos = loader.fileTell();
+        if ((fileSize - pos < 1000) || (m_operations.size() > 0))
+        {
+            loadResult = Capture::LoadPartial;
+            loadSuccess = true;
+        }
+    }
+
+    fclose(f);
+
+    // cancelled parse stopped somewhere in the middle, nothing of it is kept
+    if (m_loadCancelled)
+    {
+        if (index)
+            index->clear();
+
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    // only a complete parse describes the whole capture
+    if (index)
+    {
+        if (loadResult == Capture::LoadSuccess && loadSuccess)
+            index->save(_path);
+        else
+            index->clear();
+    }
+
+    if (loadSuccess == false)
+    {
+        if (m_loadProgressCallback)
+            m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Error reading .MTuner file!");
+
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    // live capture is opened again once it has operations
+    if (_live && m_operations.empty())
+    {
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    if (m_filterLoad)
+        m_filterLoad->addLiveBlocks(m_operations);
+
+    if (!prepareOperations(minMarkerTime))
+        return Capture::LoadFail;
+
+    delete m_filterLoad;
+    m_filterLoad = NULL;
+
+    // same as the index, only a complete load describes the whole capture, it's written while
+    // symbols are loaded and analysis waits for it before changing stack traces and tags
+    if ((loadResult == Capture::LoadSuccess) && cached)
+        m_cacheWriter = std::thread([this]() { m_cacheValid = saveCache(m_loadedFile.c_str()); });
+
+    return loadResult;
+}
+
+//--------------------------------------------------------------------------
+/// Reads capture header and module info that precede all records
+//--------------------------------------------------------------------------
+bool Capture::loadHeader(BinLoader& _loader, uint64_t _fileSize)
+{
+    uint8_t endianess;
+    uint8_t pointerSize;
+    uint8_t verHigh;
+    uint8_t verLow;
+    uint8_t toolChain;
+    uint64_t cpuFrequency;
+
+    size_t headerItems = 0;
+    headerItems += _loader.readVar(endianess);
+    headerItems += _loader.readVar(pointerSize);
+    headerItems += _loader.readVar(verHigh);
+    headerItems += _loader.readVar(verLow);
+    headerItems += _loader.readVar(toolChain);
+    headerItems += _loader.readVar(cpuFrequency);
+
+    if (headerItems != 6)
+        return false;
+
+    if (verHigh > 1)
+        return false;
+
+    if (verLow > 2)
+        return false;
+
+#if RTM_LITTLE_ENDIAN
+    m_swapEndian = (endianess == 0xff) ? true : false;
+#else
+    m_swapEndian = (endianess == 0xff) ? false : true;
+#endif
+
+    m_64bit = (pointerSize == 64) ? true : false;
+    m_toolchain = (rmem::ToolChain::Enum)toolChain;
+
+    if (m_swapEndian)
+        cpuFrequency = Endian::swap(cpuFrequency);
+    m_CPUFrequency = cpuFrequency;
+
+    printf("Load bin:\n  version %d.%d\n  %s endian\n  %sbit\n",
+           verHigh,
+           verLow,
+           m_swapEndian ? "Big" : "Little",
+           m_64bit ? "64" : "32");
+
+    if (!loadModuleInfo(_loader, _fileSize))
+        return false;
+
+    // symbols of these modules can be loaded while the records are parsed
+    if (m_modulesLoadedCallback)
+        m_modulesLoadedCallback(m_modulesLoadedCustomData, m_moduleInfos);
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Sorts and links parsed operations and calculates global stats
+//--------------------------------------------------------------------------
+bool Capture::prepareOperations(uint64_t _minMarkerTime)
+{
+    if (m_loadProgressCallback)
+        m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Sorting...");
+
+    sortOperationsByTime(m_operations);
+
+    if (m_filterLoad)
+    {
+        if (!m_filterLoad->m_threads.empty())
+            removeUnownedOperations();
+
+        if (m_operations.empty())
+        {
+            if (m_loadProgressCallback)
+                m_loadProgressCallback(
+                    m_loadProgressCustomData, 100.0f, "No operations in selected part of capture!");
+
+            clearData();
+            return false;
+        }
+    }
+
+    if (isPreview())
+        matchSampledOperations();
+
+    if (!setLinksAndFlagInvalid(_minMarkerTime))
+    {
+        if (m_loadProgressCallback)
+            m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Invalid data in .MTuner file!");
+
+        clearData();
+        return false;
+    }
+
+    if (m_loadProgressCallback)
+        m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Calculating global stats..");
+
+    calculateGlobalStats();
+
+    if (!verifyGlobalStats())
+    {
+        if (m_loadProgressCallback)
+            m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Invalid data in .MTuner file!");
+
+        clearData();
+        return false;
+    }
+
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Drops operations on blocks allocated by threads that are not selected by
+/// the load filter. Operations have to be sorted by time. Realloc of a block
+/// that isn't loaded starts a new block if a selected thread made it.
+//--------------------------------------------------------------------------
+void Capture::removeUnownedOperations()
+{
+    const robin_hood::unordered_set<uint64_t>& threads = m_filterLoad->m_threads;
+    robin_hood::unordered_set<uint64_t> blocks;
+
+    size_t numOps = 0;
+    for (size_t i = 0; i < m_operations.size(); ++i)
+    {
+        bool keep = true;
+        switch (m_operations.getType(i))
+        {
+            case rmem::LogMarkers::OpAlloc:
+            case rmem::LogMarkers::OpCalloc:
+            case rmem::LogMarkers::OpAllocAligned:
+                blocks.insert(m_operations.m_pointer[i]);
+                break;
+
+            case rmem::LogMarkers::OpRealloc:
+            case rmem::LogMarkers::OpReallocAligned:
+            {
+                const uint64_t previousPointer = m_operations.getPreviousPointer(i);
+                const bool hasBlock = previousPointer && blocks.erase(previousPointer);
+                const uint64_t threadID = m_threadIDs.m_values[m_operations.m_threadIndex[i]];
+                keep = hasBlock || (threads.find(threadID) != threads.end());
+                if (!keep)
+                    break;
+
+                if (!hasBlock)
+                    m_operations.setPreviousPointer(i, 0);
+                blocks.insert(m_operations.m_pointer[i]);
+            }
+            break;
+
+            case rmem::LogMarkers::OpFree:
+                keep = blocks.erase(m_operations.m_pointer[i]) != 0;
+                break;
+        };
+
+        if (keep)
+            m_operations.copy(numOps++, i);
+    }
+
+    m_operations.resize(numOps);
+}
+
+//--------------------------------------------------------------------------
+/// Matches operations of a sampled preview on blocks that were allocated or
+/// freed in chunks that were not loaded. Operations have to be sorted by
+/// time. A loaded block whose address is allocated again was freed in a
+/// skipped chunk, it's freed right before that. Frees and reallocs of blocks
+/// that were not loaded take over the oldest loaded block that is never freed
+/// otherwise, so usage doesn't keep growing by blocks freed in skipped chunks.
+//--------------------------------------------------------------------------
+void Capture::matchSampledOperations()
+{
+    robin_hood::unordered_map<uint64_t, uint32_t> blocks;
+    MemoryOperations ops;
+    MemoryOpArray unmatched;
+    ops.reserve(m_operations.size());
+
+    // block at the address of the operation was freed in a skipped chunk
+    auto freeReplacedBlock = [&](uint64_t _pointer, uint64_t _time) {
+        robin_hood::unordered_map<uint64_t, uint32_t>::iterator it = blocks.find(_pointer);
+        if (it == blocks.end())
+            return;
+
+        MemoryOperation free;
+        ops.get(it->second, free);
+        free.m_operationType = rmem::LogMarkers::OpFree;
+        free.m_operationTime = _time;
+        ops.add(free);
+        blocks.erase(it);
+    };
+
+    MemoryOperation op;
+    for (size_t i = 0; i < m_operations.size(); ++i)
+    {
+        m_operations.get(i, op);
+        op.m_previousPointer = m_operations.getPreviousPointer(i);
+
+        bool matched = true;
+        switch (op.m_operationType)
+        {
+            case rmem::LogMarkers::OpAlloc:
+            case rmem::LogMarkers::OpCalloc:
+            case rmem::LogMarkers::OpAllocAligned:
+                freeReplacedBlock(op.m_pointer, op.m_operationTime);
+                break;
+
+            case rmem::LogMarkers::OpRealloc:
+            case rmem::LogMarkers::OpReallocAligned:
+                // realloc of a block that wasn't loaded starts a new block if it can't be matched
+                if (op.m_previousPointer && !blocks.erase(op.m_previousPointer))
+                {
+                    op.m_previousPointer = 0;
+                    matched = false;
+                }
+                freeReplacedBlock(op.m_pointer, op.m_operationTime);
+                break;
+
+            case rmem::LogMarkers::OpFree:
+                matched = blocks.erase(op.m_pointer) != 0;
+                break;
+        };
+
+        const uint32_t index = (uint32_t)ops.size();
+        ops.add(op);
+
+        if (op.m_operationType != rmem::LogMarkers::OpFree)
+            blocks[op.m_pointer] = index;
+
+        if (!matched)
+        {
+            if (op.m_operationType == rmem::LogMarkers::OpFree)
+                ops.setInvalid(index);
+            unmatched.push_back(index);
+        }
+    }
+
+    // blocks still live at the end, in time order
+    MemoryOpArray unfreed;
+    for (uint32_t i = 0; i < (uint32_t)ops.size(); ++i)
+    {
+        robin_hood::unordered_map<uint64_t, uint32_t>::iterator it = blocks.find(ops.m_pointer[i]);
+        if ((it != blocks.end()) && (it->second == i))
+            unfreed.push_back(i);
+    }
+
+    size_t next = 0;
+    for (size_t i = 0; (i < unmatched.size()) && (next < unfreed.size()); ++i)
+    {
+        const uint32_t op = unmatched[i];
+        if (ops.m_time[unfreed[next]] > ops.m_time[op])
+            continue;
+
+        if (ops.getType(op) == rmem::LogMarkers::OpFree)
+            ops.m_pointer[op] = ops.m_pointer[unfreed[next++]];
+        else
+            ops.setPreviousPointer(op, ops.m_pointer[unfreed[next++]]);
+        ops.setValid(op);
+    }
+
+    // nothing is linked yet, invalid operations are simply left out
+    size_t numOps = 0;
+    for (size_t i = 0; i < ops.size(); ++i)
+        if (ops.isValid(i))
+            ops.copy(numOps++, i);
+    ops.resize(numOps);
+
+    m_operations.swap(ops);
+}
+
+//--------------------------------------------------------------------------
+/// Parses the whole capture once, global stats and usage graph are computed
+/// on the way. Capture index is built if there is none yet.
+//--------------------------------------------------------------------------
+Capture::LoadResult Capture::loadOverview(const char* _path)
+{
+    clearData();
+
+    m_loadedFile = _path;
+    m_overview = true;
+
+    uint64_t fileSize, fileTime;
+    if (!CaptureIndex::getCaptureInfo(_path, fileSize, fileTime))
+    {
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    FILE* f = openCaptureFile(_path);
+    if (!f)
+    {
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    uint32_t compressSignature;
+    if (!fread(&compressSignature, 1, sizeof(uint32_t), f))
+    {
+        fclose(f);
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    seekCaptureFile(f, 0);
+
+    bool isCompressed =
+        ((compressSignature == 0x23234646) || compressSignature == Endian::swap(uint32_t(0x23234646)));
+
+    bool loadSuccess = false;
+    bool hasOperations = false;
+    uint64_t pos = 0;
+    CaptureIndex* index = NULL;
+    {
+        BinLoader loader(f, isCompressed);
+
+        if (!loadHeader(loader, fileSize))
+        {
+            fclose(f);
+            clearData();
+            return Capture::LoadFail;
+        }
+
+        const bool hasIndex = m_index.load(_path);
+        if (!hasIndex && m_index.begin(_path, isCompressed))
+            index = &m_index;
+
+        OverviewSink sink(this, index, fileSize);
+        if (hasIndex)
+            sink.setIndex(m_index);
+
+        m_usageGraph.resize(1);
+
+        if (m_64bit)
+            loadSuccess = m_swapEndian ? parseRecords<true, true>(loader, sink)
+                                       : parseRecords<true, false>(loader, sink);
+        else
+            loadSuccess = m_swapEndian ? parseRecords<false, true>(loader, sink)
+                                       : parseRecords<false, false>(loader, sink);
+
+        pos = loader.fileTell();
+        hasOperations = sink.finish();
+    }
+
+    fclose(f);
+
+    // tolerate invalid data at the end of file, same as a full load
+    Capture::LoadResult loadResult = Capture::LoadSuccess;
+    if (!loadSuccess && ((fileSize - pos < 1000) || hasOperations))
+    {
+        loadResult = Capture::LoadPartial;
+        loadSuccess = true;
+    }
+
+    if (index)
+    {
+        if (!m_loadCancelled && (loadResult == Capture::LoadSuccess) && loadSuccess)
+            index->save(_path);
+        else
+            index->clear();
+    }
+
+    if (m_loadCancelled)
+    {
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    if (!loadSuccess || !hasOperations || !verifyGlobalStats())
+    {
+        if (m_loadProgressCallback)
+            m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Invalid data in .MTuner file!");
+
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    if (m_loadProgressCallback)
+        m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Loading complete!");
+
+    return loadResult;
+}
+
+//--------------------------------------------------------------------------
+/// Loads every n-th chunk of the capture in parallel. Chunks are known from
+/// the capture index only, so the capture has to be loaded once before.
+//--------------------------------------------------------------------------
+Capture::LoadResult Capture::loadPreview(const char* _path, uint32_t _sampleStep)
+{
+    clearData();
+
+    m_loadedFile = _path;
+
+    uint64_t fileSize, fileTime;
+    if (!CaptureIndex::getCaptureInfo(_path, fileSize, fileTime))
+    {
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    if (!m_index.load(_path))
+    {
+        if (m_loadProgressCallback)
+            m_loadProgressCallback(
+                m_loadProgressCustomData, 100.0f, "Capture has to be opened or overviewed once before preview!");
+
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    FILE* f = openCaptureFile(_path);
+    if (!f)
+    {
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    bool headerLoaded;
+    {
+        // only the header is read here, sampled chunks are decompressed by the workers
+        BinLoader loader(f, m_index.isCompressed(), false);
+        headerLoaded = loadHeader(loader, fileSize);
+    }
+
+    fclose(f);
+
+    if (!headerLoaded)
+    {
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    m_sampleStep = qMax(_sampleStep, 2u);
+
+    uint64_t minMarkerTime = (uint64_t)-1;
+    bool loadSuccess;
+    if (m_64bit)
+        loadSuccess = m_swapEndian ? loadOperationsSampled<true, true>(_path, m_sampleStep, minMarkerTime)
+                                   : loadOperationsSampled<true, false>(_path, m_sampleStep, minMarkerTime);
+    else
+        loadSuccess = m_swapEndian ? loadOperationsSampled<false, true>(_path, m_sampleStep, minMarkerTime)
+                                   : loadOperationsSampled<false, false>(_path, m_sampleStep, minMarkerTime);
+
+    m_stackTracesHash.clear();
+    m_stackTracesByFrame.clear();
+    m_stackFrames.releaseLookup();
+
+    if (m_loadCancelled)
+    {
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    if (!loadSuccess)
+    {
+        if (m_loadProgressCallback)
+            m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Error reading .MTuner file!");
+
+        clearData();
+        return Capture::LoadFail;
+    }
+
+    const size_t numLoaded = m_operations.size();
+
+    if (!prepareOperations(minMarkerTime))
+        return Capture::LoadFail;
+
+    // loaded chunks stand for the skipped ones as well
+    m_sampleScale = double(m_index.getNumOperations()) / double(numLoaded);
+    m_statsGlobal.scale(m_sampleScale);
+    m_statsSnapshot = m_statsGlobal;
+
+    return Capture::LoadSuccess;
+}
+
+//--------------------------------------------------------------------------
+/// Loads records received so far by the stream. Same as a live capture file
+/// it's loaded further with loadAppended, parsed data is dropped from the
+/// stream so only the record still being received is kept.
+//--------------------------------------------------------------------------
+Capture::LoadResult Capture::loadStream(CaptureStream* _stream)
+{
+    clearData();
+
+    m_loadedFile = _stream->getAddress();
+
+    _stream->receive();
+
+    // data that was received stays in the stream until it can be loaded
+    const uint64_t dataSize = _stream->getDataSize();
+    if (dataSize < sizeof(uint32_t))
+        return Capture::LoadFail;
+
+    uint32_t compressSignature;
+    memcpy(&compressSignature, _stream->getData(), sizeof(uint32_t));
+
+    bool isCompressed =
+        ((compressSignature == 0x23234646) || compressSignature == Endian::swap(uint32_t(0x23234646)));
 
-                if (m_swapEndian)
-                {
-                    modBase = Endian::swap(modBase);
-                    modSize = Endian::swap(modSize);
-                }
+    m_live = new LiveLoad(isCompressed);
+    m_live->m_stream = _stream;
 
-                addModule(modName, modBase, modSize, time);
-            }
-            break;
+    uint64_t minMarkerTime = (uint64_t)-1;
+    {
+        BinLoader loader(_stream->getData(), dataSize, isCompressed);
 
-            case rmem::LogMarkers::ModuleUnload:
-            {
-                uint8_t sz;
-                uint64_t modBase;
-                uint32_t modSize;
-                uint64_t time;
-                VERIFY_READ_SIZE(sz);
-                char modName[1024];
-                if (sz == 1)
-                {
-                    ReadString<1024>(modName, loader, m_swapEndian);
-                }
-                else
-                {
-                    char16_t modNameC[1024];
-                    ReadString<1024>(modNameC, loader, m_swapEndian);
-                    rtm::strlCpy(modName,
-                                 RTM_NUM_ELEMENTS(modName),
-                                 QString::fromUtf16(modNameC).toUtf8().constData());
-                }
+        // reads past the end of received data leave nothing to parse, header is incomplete then
+        if (!loadHeader(loader, dataSize) || loader.eof())
+        {
+            clearData();
+            return Capture::LoadFail;
+        }
 
-                VERIFY_READ_SIZE(modBase);
-                VERIFY_READ_SIZE(modSize);
-                VERIFY_READ_SIZE(time)
+        loadAppendedOperations(loader, dataSize, minMarkerTime);
+    }
 
-                if (m_swapEndian)
-                {
-                    modBase = Endian::swap(modBase);
-                    modSize = Endian::swap(modSize);
-                }
+    // stream is loaded again once it has operations
+    if (m_operations.empty())
+    {
+        clearData();
+        return Capture::LoadFail;
+    }
 
-                removeModule(modName, modBase, modSize, time);
-            }
-            break;
+    _stream->consume(m_live->m_fileOffset);
+    m_live->m_fileOffset = 0;
 
-            case rmem::LogMarkers::Allocator:
-            {
-                char allocatorName[1024];
-                uint64_t allocatorHandle;
+    if (!prepareOperations(minMarkerTime))
+        return Capture::LoadFail;
 
-                ReadString<1024>(allocatorName, loader, m_swapEndian);
-                VERIFY_READ_SIZE(allocatorHandle);
-                if (m_swapEndian)
-                    allocatorHandle = Endian::swap(allocatorHandle);
+    return Capture::LoadSuccess;
+}
 
-                m_Heaps[allocatorHandle] = allocatorName;
-            }
-            break;
+//--------------------------------------------------------------------------
+/// Parses records written to a live capture since the last load, starting
+/// with the record that was incomplete then. New operations are linked and
+/// added to stats and analysis data without touching the ones loaded before.
+//--------------------------------------------------------------------------
+uint32_t Capture::loadAppended()
+{
+    if (!m_live)
+        return 0;
 
-            default:
-                loadSuccess = false;
-                break;
-        };
-    }
+    const size_t numOps = m_operations.size();
+    const size_t numStackTraces = m_stackTraces.size();
+    const size_t numFrames = m_stackFrames.getNumNodes();
+    uint64_t minMarkerTime = (uint64_t)-1;
 
-    m_stackTracesHash.clear();
+    if (m_live->m_stream)
+    {
+        CaptureStream* stream = m_live->m_stream;
+        if (!stream->receive())
+            return 0;
 
-    // tolerate invalid data at the end of file
-    Capture::LoadResult loadResult = Capture::LoadSuccess;
-    if (loadSuccess == false)
+        {
+            BinLoader loader(stream->getData(), stream->getDataSize(), m_live->m_compressed);
+            loadAppendedOperations(loader, stream->getDataSize(), minMarkerTime);
+        }
+
+        stream->consume(m_live->m_fileOffset);
+        m_live->m_fileOffset = 0;
+
+        // record that doesn't fit into all the stream buffers means corrupted data, stop receiving
+        if (stream->getDataSize() > (uint64_t)CaptureStream::BlockSize * CaptureStream::MaxBlocks)
+            stream->close();
+    }
+    else
     {
-        uint64_t pos = loader.fileTell();
-        if ((fileSize - pos < 1000) || (m_operations.size() > 0))
+        uint64_t fileSize, fileTime;
+        if (!CaptureIndex::getCaptureInfo(m_loadedFile.c_str(), fileSize, fileTime) ||
+            (fileSize == m_live->m_fileSize))
+            return 0;
+
+        FILE* f = openCaptureFile(m_loadedFile.c_str());
+        if (!f)
+            return 0;
+
+        seekCaptureFile(f, m_live->m_fileOffset);
+
         {
-            loadResult = Capture::LoadPartial;
-            loadSuccess = true;
+            // appended data is small, decompress inline
+            BinLoader loader(f, m_live->m_compressed, false);
+            loadAppendedOperations(loader, fileSize, minMarkerTime);
         }
+
+        fclose(f);
+
+        m_live->m_fileSize = fileSize;
     }
 
-    fclose(f);
+    if (m_operations.size() == numOps)
+        return 0;
 
-    if (loadSuccess == false)
-    {
-        if (m_loadProgressCallback)
-            m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Error reading .MTuner file!");
+    appendOperations(numOps);
 
-        clearData();
-        return Capture::LoadFail;
+    if (m_live->m_symbols)
+    {
+        setupStackTraces(numStackTraces, numFrames, m_live->m_symbols);
+        addAnalyzeData(numOps);
     }
 
-    if (m_loadProgressCallback)
-        m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Sorting...");
+    return (uint32_t)(m_operations.size() - numOps);
+}
 
-#if RTM_PLATFORM_WINDOWS && RTM_COMPILER_MSVC
-    pSortOpsTime psTime(m_operations);
-    concurrency::parallel_radixsort(m_operations.begin(), m_operations.end(), psTime);
-#else
-    std::stable_sort(m_operations.begin(), m_operations.end(), psTime);
-#endif
+//--------------------------------------------------------------------------
+/// Parses records of a live capture starting at the saved resume position,
+/// loader is positioned at the chunk or record where parsing stopped before
+//--------------------------------------------------------------------------
+void Capture::loadAppendedOperations(BinLoader& _loader, uint64_t _fileSize, uint64_t& _minMarkerTime)
+{
+    if (!_loader.skip(m_live->m_recordOffset))
+        return;
+
+    // parsing stops at the record still being written, it's not an error here
+    if (m_64bit && m_swapEndian)
+        loadOperations<true, true>(_loader, _fileSize, _minMarkerTime, NULL);
+    else if (m_64bit)
+        loadOperations<true, false>(_loader, _fileSize, _minMarkerTime, NULL);
+    else if (m_swapEndian)
+        loadOperations<false, true>(_loader, _fileSize, _minMarkerTime, NULL);
+    else
+        loadOperations<false, false>(_loader, _fileSize, _minMarkerTime, NULL);
+}
+
+//--------------------------------------------------------------------------
+/// Releases parser state of a live capture. If operations arrived late they
+/// were stored out of place, capture is relinked so it's the same as if it
+/// was loaded once complete.
+//--------------------------------------------------------------------------
+bool Capture::endLive()
+{
+    LiveLoad* live = m_live;
+    m_live = NULL;
 
-    if (!setLinksAndRemoveInvalid(minMarkerTime))
+    const bool relink = live && !live->m_clampedTimes.empty();
+    if (relink)
+        relinkOperations(*live);
+
+    delete live;
+    m_stackTracesHash.clear();
+    m_stackTracesByFrame.clear();
+    m_stackFrames.releaseLookup();
+    return relink;
+}
+
+static void resetTagTree(MemoryTagTree& _tag)
+{
+    _tag.m_usage = 0;
+    _tag.m_usagePeak = 0;
+    _tag.m_overhead = 0;
+    _tag.m_overheadPeak = 0;
+    memset(_tag.m_operationCount, 0, sizeof(_tag.m_operationCount));
+    _tag.m_operations.clear();
+
+    MemoryTagTree::ChildMap::iterator it = _tag.m_children.begin();
+    for (; it != _tag.m_children.end(); ++it)
+        resetTagTree(*it->second);
+}
+
+//--------------------------------------------------------------------------
+/// Restores operations of a live capture to the state they were parsed in,
+/// then sorts, links and analyzes all of them the same as a complete load
+//--------------------------------------------------------------------------
+void Capture::relinkOperations(const LiveLoad& _live)
+{
+    MemoryOperations& ops = m_operations;
+    const size_t numOps = ops.size();
+
+    for (size_t i = 0; i < _live.m_clampedTimes.size(); ++i)
+        ops.m_time[_live.m_clampedTimes[i].first] = _live.m_clampedTimes[i].second;
+
+    for (size_t i = 0; i < numOps; ++i)
     {
-        if (m_loadProgressCallback)
-            m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Invalid data in .MTuner file!");
+        ops.m_chainPrev[i] = MemoryOperations::NoOperation;
+        ops.m_chainNext[i] = MemoryOperations::NoOperation;
+        ops.setValid(i);
 
-        clearData();
-        return Capture::LoadFail;
+        if (_live.m_untagged[i])
+            ops.m_tag[i] = 0;
+
+        // frees get their size from the block they release
+        if (ops.getType(i) == rmem::LogMarkers::OpFree)
+        {
+            ops.m_allocSize[i] = 0;
+            ops.m_overhead[i] = 0;
+        }
     }
 
-    if (m_loadProgressCallback)
-        m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Calculating global stats..");
+    for (size_t i = 0; i < _live.m_previousPointers.size(); ++i)
+        ops.setPreviousPointer(_live.m_previousPointers[i].first, _live.m_previousPointers[i].second);
+
+    uint64_t minMarkerTime = (uint64_t)-1;
+    for (size_t i = 0; i < m_memoryMarkerTimes.size(); ++i)
+        minMarkerTime = qMin(minMarkerTime, m_memoryMarkerTimes[i].m_time);
 
+    // capture had valid operations before, linking them again can't fail
+    m_operationsInvalid.clear();
+    sortOperationsByTime(ops);
+    setLinksAndFlagInvalid(minMarkerTime);
     calculateGlobalStats();
 
-    if (!verifyGlobalStats())
-    {
-        if (m_loadProgressCallback)
-            m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Invalid data in .MTuner file!");
+    if (!_live.m_symbols)
+        return;
 
-        clearData();
-        return Capture::LoadFail;
-    }
+    m_operationGroups.clear();
+    m_memoryLeaks.clear();
+    destroyStackTree(m_stackTraceTree);
+    m_stackTraceTree = StackTraceTree();
+    resetTagTree(m_tagTree);
 
-    return loadResult;
+    const size_t numFrames = m_stackFrames.getNumNodes();
+    for (size_t i = 0; i < numFrames; ++i)
+        m_stackFrames.getNode(i)->m_treeIndex[StackTrace::Global] = (uint16_t)-1;
+    for (size_t i = 0; i < m_stackTraces.size(); ++i)
+        m_stackTraces[i]->m_addedToTree[StackTrace::Global] = 0;
+
+    addAnalyzeData(0);
+
+    if (m_filteringEnabled)
+        calculateFilteredData();
 }
 
 //--------------------------------------------------------------------------
@@ -1025,38 +2980,39 @@ void Capture::setFilteringEnabled(bool inState)
 //--------------------------------------------------------------------------
 /// Returns true if operation is inside the filtering criteria
 //--------------------------------------------------------------------------
-bool Capture::isInFilter(MemoryOperation* _op)
+bool Capture::isInFilter(uint32_t _op)
 {
-    if (!_op->m_isValid)
+    if (!m_operations.isValid(_op))
         return false;
 
     if (!m_filteringEnabled)
         return true;
 
-    if ((m_currentHeap != (uint64_t)-1) && (_op->m_allocatorHandle != m_currentHeap))
+    if ((m_currentHeap != (uint64_t)-1) && (getHeapHandle(_op) != m_currentHeap))
         return false;
 
     if ((m_filter.m_histogramIndex != (uint32_t)-1) &&
-        (m_filter.m_histogramIndex != getHistogramBinIndex(_op->m_allocSize)))
+        (m_filter.m_histogramIndex != getHistogramBinIndex(m_operations.m_allocSize[_op])))
         return false;
 
-    if ((m_filter.m_tagHash != 0) && (m_filter.m_tagHash != _op->m_tag))
+    if ((m_filter.m_tagHash != 0) && (m_filter.m_tagHash != m_operations.m_tag[_op]))
         return false;
 
-    if ((m_filter.m_threadID != 0) && (m_filter.m_threadID != _op->m_threadID))
+    if ((m_filter.m_threadID != 0) && (m_filter.m_threadID != getThreadID(_op)))
         return false;
 
-    if ((_op->m_operationTime < m_filter.m_minTimeSnapshot) || (_op->m_operationTime > m_filter.m_maxTimeSnapshot))
+    const uint64_t time = m_operations.m_time[_op];
+    if ((time < m_filter.m_minTimeSnapshot) || (time > m_filter.m_maxTimeSnapshot))
         return false;
 
     if (m_currentModule)
     {
         bool moduleInStack = false;
-        const uint32_t numEntries = (uint32_t)_op->m_stackTrace->m_numFrames;
-        for (uint32_t i = 0; i < numEntries; ++i)
+        const StackTrace* st = m_stackTraces[m_operations.m_stackTrace[_op]];
+        for (const StackTraceNode* frame = st->m_frame; frame; frame = frame->m_parent)
         {
             rdebug::ModuleInfo info;
-            if (m_currentModule->checkAddress(_op->m_stackTrace->m_frames[i]))  // , _op->m_operationTime))
+            if (m_currentModule->checkAddress(frame->m_address))  // , _op->m_operationTime))
             {
                 moduleInStack = true;
                 break;
@@ -1067,7 +3023,7 @@ bool Capture::isInFilter(MemoryOperation* _op)
             return false;
     }
 
-    if (m_filter.m_leakedOnly && !isLeaked(_op))
+    if (m_filter.m_leakedOnly && !isLeaked(m_operations, _op))
         return false;
 
     return true;
@@ -1178,9 +3134,97 @@ void Capture::setSnapshot(uint64_t _minTime, uint64_t _maxTime)
 //--------------------------------------------------------------------------
 void Capture::getGraphAtTime(uint64_t _time, GraphEntry& _entry)
 {
+    // overview has no operations, usage at the end of the bucket is the closest known
+    if (m_overview)
+    {
+        const std::vector<GraphBucket>& buckets = m_usageGraph[0];
+        const uint64_t time = qMin(qMax(_time, m_minTime), m_maxTime);
+        const size_t index = (size_t)((time - m_minTime) / m_usageBucketTime);
+        const GraphBucket& bucket = buckets[qMin(index, buckets.size() - 1)];
+        _entry.m_usage = bucket.m_lastUsage;
+        _entry.m_numLiveBlocks = bucket.m_lastLiveBlocks;
+        return;
+    }
+
     uint32_t tIdx;
-    uint32_t idx = getIndexBefore(_time, tIdx);
-    _entry = m_usageGraph[idx];
+    const uint64_t idx = getIndexBefore(_time, tIdx);
+    getGraphAtIndex(idx, _entry);
+
+    if (isPreview())
+    {
+        _entry.m_usage = (uint64_t)(_entry.m_usage * m_sampleScale + 0.5);
+        _entry.m_numLiveBlocks = (uint64_t)(_entry.m_numLiveBlocks * m_sampleScale + 0.5);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Returns memory usage range for each of the consecutive time spans that
+/// evenly split given time range
+//--------------------------------------------------------------------------
+void Capture::getGraphRange(uint64_t _minTime, uint64_t _maxTime, uint32_t _numSamples, GraphBucket* _samples) const
+{
+    if (_numSamples == 0)
+        return;
+
+    if (m_usageGraph.empty())
+    {
+        memset(_samples, 0, sizeof(GraphBucket) * _numSamples);
+        return;
+    }
+
+    _minTime = qMax(_minTime, m_minTime);
+    _maxTime = qMax(qMin(_maxTime, m_maxTime), _minTime);
+
+    const double sampleTime = double(_maxTime - _minTime) / double(_numSamples);
+
+    // overview can't be zoomed in below bucket resolution
+    if (m_overview || (sampleTime >= double(m_usageBucketTime)))
+    {
+        const std::vector<GraphBucket>& buckets = m_usageGraph[0];
+        for (uint32_t i = 0; i < _numSamples; ++i)
+        {
+            const uint64_t start = _minTime + (uint64_t)(i * sampleTime);
+            const uint64_t end = qMax(start, _minTime + (uint64_t)((i + 1) * sampleTime) - 1);
+            const size_t first = (size_t)((start - m_minTime) / m_usageBucketTime);
+            const size_t last = (size_t)((end - m_minTime) / m_usageBucketTime);
+            getGraphBuckets(qMin(first, buckets.size() - 1), qMin(last, buckets.size() - 1), _samples[i]);
+            if (isPreview())
+                scaleGraphBucket(_samples[i], m_sampleScale);
+        }
+        return;
+    }
+
+    // zoomed in below bucket resolution, replay operations in view
+    const std::vector<uint64_t>& times = m_operations.m_time;
+    const size_t numOps = times.size();
+    size_t index = std::lower_bound(times.begin(), times.end(), _minTime) - times.begin();
+
+    GraphEntry entry;
+    entry.m_usage = 0;
+    entry.m_numLiveBlocks = 0;
+    if (index)
+        getGraphAtIndex(index - 1, entry);
+
+    uint64_t usage = entry.m_usage;
+    uint64_t liveBlocks = entry.m_numLiveBlocks;
+
+    for (uint32_t i = 0; i < _numSamples; ++i)
+    {
+        const uint64_t end =
+            (i == _numSamples - 1) ? _maxTime + 1 : _minTime + (uint64_t)((i + 1) * sampleTime);
+
+        initGraphBucket(_samples[i], usage, liveBlocks);
+        for (; (index < numOps) && (times[index] < end); ++index)
+        {
+            if (!m_operations.isValid(index))
+                continue;
+
+            applyGraphOperation(m_operations, index, usage, liveBlocks);
+            addToGraphBucket(_samples[i], usage, liveBlocks);
+        }
+        if (isPreview())
+            scaleGraphBucket(_samples[i], m_sampleScale);
+    }
 }
 
 //--------------------------------------------------------------------------
@@ -1220,6 +3264,10 @@ bool Capture::loadModuleInfo(BinLoader& _loader, uint64_t _fileSize)
         else
             bytesRead += ReadString<1024>(exePathA, _loader, m_swapEndian, 0x23);
 
+        // data ended, possible with a stream that is still being received
+        if (bytesRead == 0)
+            return false;
+
         if (bytesRead == sizeof(uint32_t))
             break;
 
@@ -1265,248 +3313,545 @@ bool Capture::loadModuleInfo(BinLoader& _loader, uint64_t _fileSize)
 //--------------------------------------------------------------------------
 /// Builds stack trace trees and group operations by type/call stack/size
 //--------------------------------------------------------------------------
-void Capture::buildAnalyzeData(uintptr_t _symResolver)
+void Capture::buildAnalyzeData(SymbolCache* _symbols, uint64_t _symbolsHash)
 {
-    RTM_ASSERT(_symResolver != 0, "Invalid symbol resolver!");
-
-    // get stack traces unique IDs
-    std::vector<StackTrace*>::iterator it = m_stackTraces.begin();
-    std::vector<StackTrace*>::iterator end = m_stackTraces.end();
-
-    const uint32_t numStackTraces = (uint32_t)m_stackTraces.size();
-    uint32_t nextProgressPoint = 0;
-    uint32_t numOpsOver100 = numStackTraces / 100;
-    uint32_t idx = 0;
+    RTM_ASSERT(_symbols != NULL, "Invalid symbol cache!");
 
-    robin_hood::unordered_map<uint64_t, uint64_t> address_IDs;
+    waitForCacheWriter();
 
-    while (it != end)
+    const bool useCache = m_cacheValid && (_symbolsHash != 0);
+    if (useCache && loadAnalyzeCache(_symbolsHash))
     {
-        if ((idx > nextProgressPoint) && m_loadProgressCallback)
+        setAnalyzeStageDone(AnalyzeAll);
+        if (m_loadProgressCallback)
+            m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Done!");
+        return;
+    }
+
+    // tags and groups don't need symbols, they are built while stack traces are set up
+    std::thread tags(
+        [this]()
         {
-            nextProgressPoint += numOpsOver100;
-            float percent = float(idx) / float(numOpsOver100);
-            m_loadProgressCallback(m_loadProgressCustomData, percent, "Generating unique symbol IDs...");
-        }
+            analyzeTags(0);
+            setAnalyzeStageDone(AnalyzeTags);
+        });
+    std::thread groups(
+        [this]()
+        {
+            analyzeGroups(0);
+            setAnalyzeStageDone(AnalyzeGroups);
+        });
 
-        StackTrace* st = *it;
+    setupStackTraces(0, 0, _symbols);
+    setAnalyzeStageDone(AnalyzeSymbols);
+    analyzeStackTree(0);
+    setAnalyzeStageDone(AnalyzeStackTree);
 
-        int numFrames = (int)st->m_numFrames;
+    tags.join();
+    groups.join();
 
-        for (int i = 0; i < numFrames; ++i)
-        {
-            auto itAdd = address_IDs.find(st->m_frames[i]);
-            if (itAdd != address_IDs.end())
-                st->m_frames[i + numFrames] = itAdd->second;
-            else
-            {
-                uint64_t addID = rdebug::symbolResolverGetAddressID(_symResolver, st->m_frames[i]);
-                st->m_frames[i + numFrames] = addID;
-                address_IDs[st->m_frames[i]] = addID;
-            }
-        }
+    if (m_live)
+        m_live->m_symbols = _symbols;
 
-        int skip = 0;
-        while (st->m_frames[skip + numFrames] == 0)
-            skip++;
+    if (useCache)
+        saveAnalyzeCache(_symbolsHash);
 
-        // remove mtunerdll from the top of call stack
-        if (skip)
-        {
-            const uint32_t newCount = numFrames > skip ? numFrames - skip : 1;
-            for (uint32_t i = 0; i < newCount; ++i)
-            {
-                st->m_frames[i] = st->m_frames[i + skip];
-                st->m_frames[i + newCount] = st->m_frames[i + numFrames + skip];
-            }
+    if (m_loadProgressCallback)
+        m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Done!");
+}
 
-            st->m_numFrames = newCount;
-        }
+static const size_t s_symbolBatchSize = 1024;  ///< Addresses resolved between progress reports
+
+//--------------------------------------------------------------------------
+/// Assigns unique symbol IDs to frames starting with _firstFrame and sets up
+/// stack traces starting with _first
+//--------------------------------------------------------------------------
+void Capture::setupStackTraces(size_t _first, size_t _firstFrame, SymbolCache* _symbols)
+{
+    const size_t numFrames = m_stackFrames.getNumNodes();
 
-        memset(StackTrace::getIndexArray(st), 0xff, getStackTraceIndexArraySize(st->m_numFrames));
+    // unique addresses in address order, addresses of a module are resolved together
+    std::vector<uint64_t> addresses;
+    addresses.reserve(numFrames - _firstFrame);
+    for (size_t i = _firstFrame; i < numFrames; ++i)
+        addresses.push_back(m_stackFrames.getNode(i)->m_address);
 
+    std::sort(addresses.begin(), addresses.end());
+    addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+    const size_t numAddresses = addresses.size();
+
+    // IDs of frames in GCC and Clang modules come from one batched addr2line pass
+    _symbols->resolveFrames(addresses.data(), numAddresses);
+
+    // symbol cache serializes lookups, so IDs are taken on this thread
+    std::vector<uint64_t> addressIDs(numAddresses);
+    for (size_t begin = 0; begin < numAddresses; begin += s_symbolBatchSize)
+    {
+        const size_t end = qMin(begin + s_symbolBatchSize, numAddresses);
+        for (size_t i = begin; i < end; ++i)
+            addressIDs[i] = _symbols->getAddressID(addresses[i]);
+
+        const float percent = float(end) * 100.0f / numAddresses;
+        if (m_loadProgressCallback)
+            m_loadProgressCallback(m_loadProgressCustomData, percent, "Generating unique symbol IDs...");
+        if (m_analyzeProgressCallback)
+            m_analyzeProgressCallback(m_analyzeProgressCustomData, AnalyzeSymbols, percent);
+    }
+
+    for (size_t i = _firstFrame; i < numFrames; ++i)
+    {
+        StackTraceNode* frame = m_stackFrames.getNode(i);
+        const size_t idx =
+            (size_t)(std::lower_bound(addresses.begin(), addresses.end(), frame->m_address) - addresses.begin());
+        frame->m_addressID = addressIDs[idx];
+        frame->m_treeIndex[StackTrace::Global] = (uint16_t)-1;
+    }
+
+    std::vector<StackTrace*>::iterator it = m_stackTraces.begin() + _first;
+    std::vector<StackTrace*>::iterator end = m_stackTraces.end();
+
+    while (it != end)
+    {
+        StackTrace* st = *it;
+
+        // remove mtunerdll from the top of call stack, traces of a sampled preview can have no frames
+        StackTraceNode* frame = st->m_frame;
+        while (frame && (frame->m_addressID == 0) && frame->m_parent)
+            frame = frame->m_parent;
+
+        st->m_frame = frame;
+        st->m_numFrames = frame ? frame->m_depth : 0;
         st->m_addedToTree[StackTrace::Global] = 0;
         ++it;
-        ++idx;
     }
+}
+
+//--------------------------------------------------------------------------
+/// Adds operations starting with _first to groups, stack trace and tag trees
+//--------------------------------------------------------------------------
+void Capture::addAnalyzeData(size_t _first)
+{
+    analyzeTags(_first);
+    analyzeGroups(_first);
+    analyzeStackTree(_first);
+}
+
+//--------------------------------------------------------------------------
+/// Propagates tags along operation chains and builds the tag tree, heaps
+/// and the list of leaks
+//--------------------------------------------------------------------------
+void Capture::analyzeTags(size_t _first)
+{
+    MemoryTagTree* prevTag = m_live ? m_live->m_prevTag : NULL;
+
+    const size_t numOps = m_operations.size();
+    size_t nextProgressPoint = _first;
+    size_t numOpsOver100 = numOps / 100;
 
-    MemoryTagTree* prevTag = NULL;
+    if (_first)
+    {
+        // operations appended to a live capture may free or reallocate blocks analyzed before,
+        // tag is inherited same as if the previous operation was analyzed now
+        for (size_t i = _first; i < numOps; i++)
+        {
+            if (!m_operations.isValid(i))
+                continue;
 
-    const uint32_t numOps = (uint32_t)m_operations.size();
-    nextProgressPoint = 0;
-    numOpsOver100 = numOps / 100;
+            const uint32_t prev = m_operations.m_chainPrev[i];
+            if ((prev != MemoryOperations::NoOperation) && m_operations.isValid(prev) && (m_operations.m_tag[i] == 0))
+                m_operations.m_tag[i] = m_operations.m_tag[prev];
+        }
 
-    uint64_t liveBlocks = 0;
-    uint64_t liveSize = 0;
+        const MemoryOperations& ops = m_operations;
+        m_memoryLeaks.erase(
+            std::remove_if(m_memoryLeaks.begin(),
+                           m_memoryLeaks.end(),
+                           [&ops](uint32_t _op) { return ops.m_chainNext[_op] != MemoryOperations::NoOperation; }),
+            m_memoryLeaks.end());
+    }
 
-    for (uint32_t i = 0; i < numOps; i++)
+    for (size_t i = _first; i < numOps; i++)
     {
-        if ((i > nextProgressPoint) && m_loadProgressCallback)
+        if ((i > nextProgressPoint) && m_analyzeProgressCallback)
         {
             nextProgressPoint += numOpsOver100;
             float percent = float(i) / float(numOpsOver100);
-            m_loadProgressCallback(m_loadProgressCustomData, percent, "Building analysis data...");
+            m_analyzeProgressCallback(m_analyzeProgressCustomData, AnalyzeTags, percent);
         }
 
-        MemoryOperation* op = m_operations[i];
+        if (!m_operations.isValid(i))
+            continue;
 
-        if (op->m_chainNext)
+        const uint32_t op = (uint32_t)i;
+        const uint32_t next = m_operations.m_chainNext[op];
+        if (next != MemoryOperations::NoOperation)
         {
-            if (op->m_chainNext->m_tag == 0)
-                op->m_chainNext->m_tag = op->m_tag;
+            if (m_operations.m_tag[next] == 0)
+                m_operations.m_tag[next] = m_operations.m_tag[op];
         }
         else
         {
-            if (isLeaked(op))
+            if (isLeaked(m_operations, op))
                 m_memoryLeaks.push_back(op);
         }
 
-        updateLiveBlocks(op, liveBlocks);
-        updateLiveSize(op, liveSize);
-
-        // add to memory groups
-        addToMemoryGroups(m_operationGroups, op, liveBlocks, liveSize);
-
-        // add to call stack tree
-        addToStackTraceTree(m_stackTraceTree, op, StackTrace::Global);
-
         // add to tag tree
-        tagAddOp(m_tagTree, op, prevTag);
+        tagAddOp(m_tagTree, m_operations, op, prevTag);
 
         // add to heaps list
-        addHeap(m_Heaps, op->m_allocatorHandle);
+        addHeap(m_Heaps, getHeapHandle(op));
     }
 
-    if (m_loadProgressCallback)
-        m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Done!");
+    if (m_live)
+        m_live->m_prevTag = prevTag;
 }
 
 //--------------------------------------------------------------------------
-/// Links operations that are performed on the same address/memory block
+/// Adds operations to memory groups, group peaks are tracked against the
+/// global live blocks and size
 //--------------------------------------------------------------------------
-bool Capture::setLinksAndRemoveInvalid(uint64_t inMinMarkerTime)
+void Capture::analyzeGroups(size_t _first)
 {
-    robin_hood::unordered_map<uint64_t, MemoryOperation*> opMap;
-    uint32_t numOps = (uint32_t)m_operations.size();
-    uint32_t nextProgressPoint = 0;
-    uint32_t numOpsOver100 = numOps / 100;
+    const size_t numOps = m_operations.size();
+    size_t nextProgressPoint = _first;
+    size_t numOpsOver100 = numOps / 100;
+
+    uint64_t liveBlocks = m_live ? m_live->m_liveBlocks : 0;
+    uint64_t liveSize = m_live ? m_live->m_liveSize : 0;
+
+    for (size_t i = _first; i < numOps; i++)
+    {
+        if ((i > nextProgressPoint) && m_analyzeProgressCallback)
+        {
+            nextProgressPoint += numOpsOver100;
+            float percent = float(i) / float(numOpsOver100);
+            m_analyzeProgressCallback(m_analyzeProgressCustomData, AnalyzeGroups, percent);
+        }
+
+        if (!m_operations.isValid(i))
+            continue;
+
+        const uint32_t op = (uint32_t)i;
+        updateLiveBlocks(m_operations, op, liveBlocks);
+        updateLiveSize(m_operations, op, liveSize);
+
+        // add to memory groups
+        addToMemoryGroups(m_operationGroups, op, liveBlocks, liveSize);
+    }
 
-    for (uint32_t i = 0; i < numOps; i++)
+    if (m_live)
     {
-        MemoryOperation* op = m_operations[i];
-        op->m_isValid = 1;
+        m_live->m_liveBlocks = liveBlocks;
+        m_live->m_liveSize = liveSize;
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Adds operations to the call stack tree, needs unique symbol IDs
+//--------------------------------------------------------------------------
+void Capture::analyzeStackTree(size_t _first)
+{
+    const size_t numOps = m_operations.size();
+    size_t nextProgressPoint = _first;
+    size_t numOpsOver100 = numOps / 100;
 
-        if ((i > nextProgressPoint) && m_loadProgressCallback)
+    for (size_t i = _first; i < numOps; i++)
+    {
+        if (i > nextProgressPoint)
         {
             nextProgressPoint += numOpsOver100;
             float percent = float(i) / float(numOpsOver100);
-            m_loadProgressCallback(m_loadProgressCustomData, percent, "Processing...");
+            if (m_loadProgressCallback)
+                m_loadProgressCallback(m_loadProgressCustomData, percent, "Building analysis data...");
+            if (m_analyzeProgressCallback)
+                m_analyzeProgressCallback(m_analyzeProgressCustomData, AnalyzeStackTree, percent);
         }
 
-        RTM_ASSERT(op->m_chainPrev == NULL, "");
-        RTM_ASSERT(op->m_chainNext == NULL, "");
+        // add to call stack tree
+        if (m_operations.isValid(i))
+            addToStackTraceTree(m_stackTraceTree, (uint32_t)i, StackTrace::Global);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Marks analysis stages as done, may be called from a worker thread
+//--------------------------------------------------------------------------
+void Capture::setAnalyzeStageDone(uint32_t _stages)
+{
+    m_analyzedStages.fetch_or(_stages);
+
+    if (m_analyzeProgressCallback)
+        m_analyzeProgressCallback(m_analyzeProgressCustomData, _stages, 100.0f);
+}
+
+//--------------------------------------------------------------------------
+/// Operations are linked in shards selected by pointer hash, each shard
+/// is linked independently and in time order. Realloc touches two shards,
+/// the one owning previous pointer releases the block and links the chain,
+/// the one owning new pointer only takes over the address.
+//--------------------------------------------------------------------------
+static const uint32_t s_linkAcquireOnly = 0x80000000;  ///< Shard list entry flag, realloc only takes over the address
+
+struct LinkShard
+{
+    robin_hood::unordered_map<uint64_t, uint32_t> m_opMap;
+    std::vector<uint32_t> m_invalid;  ///< Indices of invalid operations to report
+    std::vector<uint32_t> m_dropped;  ///< Indices of invalid operations that are not reported
+};
+
+static inline uint32_t getLinkShard(uint64_t _pointer, uint32_t _numShards)
+{
+    return (uint32_t)((((_pointer >> 4) * 0x9e3779b97f4a7c15ull) >> 32) % _numShards);
+}
+
+static void linkOperation(LinkShard& _shard,
+                          MemoryOperations& _ops,
+                          uint32_t _index,
+                          bool _acquireOnly,
+                          uint32_t _shardIndex,
+                          uint32_t _numShards)
+{
+    robin_hood::unordered_map<uint64_t, uint32_t>& opMap = _shard.m_opMap;
+    const uint32_t op = _index;
+    const uint64_t pointer = _ops.m_pointer[op];
 
-        switch (op->m_operationType)
+    switch (_ops.getType(op))
+    {
+        case rmem::LogMarkers::OpAlloc:
+        case rmem::LogMarkers::OpCalloc:
+        case rmem::LogMarkers::OpAllocAligned:
         {
-            case rmem::LogMarkers::OpAlloc:
-            case rmem::LogMarkers::OpCalloc:
-            case rmem::LogMarkers::OpAllocAligned:
-            {
-                robin_hood::unordered_map<uint64_t, MemoryOperation*>::iterator it = opMap.find(op->m_pointer);
-                if (it == opMap.end())
-                    opMap[op->m_pointer] = op;
-                else
-                    op->m_isValid = 0;
-            }
-            break;
+            robin_hood::unordered_map<uint64_t, uint32_t>::iterator it = opMap.find(pointer);
+            if (it == opMap.end())
+                opMap[pointer] = op;
+            else
+                _shard.m_dropped.push_back(op);
+        }
+        break;
 
-            case rmem::LogMarkers::OpRealloc:
-            case rmem::LogMarkers::OpReallocAligned:
+        case rmem::LogMarkers::OpRealloc:
+        case rmem::LogMarkers::OpReallocAligned:
+        {
+            if (!_acquireOnly)
             {
-                MemoryOperation* oldOp = 0;
+                // previous pointer is kept in a side table until the chain link replaces it
+                const uint64_t previousPointer = _ops.getPreviousPointer(op);
+                _ops.m_chainPrev[op] = MemoryOperations::NoOperation;
 
                 // ako postoji prethodni pointer onda mora da postoji op u mapi sa tim rezultatom - rezultat moze da bude isti
-                if (op->m_previousPointer)
+                if (previousPointer)
                 {
-                    robin_hood::unordered_map<uint64_t, MemoryOperation*>::iterator itP =
-                        opMap.find(op->m_previousPointer);
+                    robin_hood::unordered_map<uint64_t, uint32_t>::iterator itP = opMap.find(previousPointer);
                     if (itP == opMap.end())
-                    {
-                        m_operationsInvalid.push_back(op);
-                        op->m_isValid = 0;  // mora da postoji op u mapi sa tim rezultatom
-                    }
+                        _shard.m_invalid.push_back(op);  // mora da postoji op u mapi sa tim rezultatom
                     else
                     {
-                        oldOp = itP->second;
+                        const uint32_t oldOp = itP->second;
+                        _ops.m_chainPrev[op] = oldOp;
+                        _ops.m_chainNext[oldOp] = op;
                         opMap.erase(itP);
                     }
                 }
                 else
                 {
                     // no previous block, there can't be a block already in the map with the same address
-                    robin_hood::unordered_map<uint64_t, MemoryOperation*>::iterator itP =
-                        opMap.find(op->m_pointer);
+                    robin_hood::unordered_map<uint64_t, uint32_t>::iterator itP = opMap.find(pointer);
                     if (itP != opMap.end())
-                    {
-                        m_operationsInvalid.push_back(op);
-                        op->m_isValid = 0;  // mora da postoji op u mapi sa tim rezultatom
-                    }
+                        _shard.m_invalid.push_back(op);
                 }
+            }
+
+            if (getLinkShard(pointer, _numShards) == _shardIndex)
+                opMap[pointer] = op;
+        }
+        break;
+
+        case rmem::LogMarkers::OpFree:
+        {
+            robin_hood::unordered_map<uint64_t, uint32_t>::iterator it = opMap.find(pointer);
+            if (it == opMap.end())
+                _shard.m_invalid.push_back(op);
+            else
+            {
+                const uint32_t oldOp = it->second;
+                RTM_ASSERT(_ops.getType(oldOp) != rmem::LogMarkers::OpFree, "");
+
+                _ops.m_chainNext[oldOp] = op;
+                _ops.m_chainPrev[op] = oldOp;
+                _ops.m_allocSize[op] = _ops.m_allocSize[oldOp];
+                _ops.m_overhead[op] = _ops.m_overhead[oldOp];
 
-                if (oldOp)
+                opMap.erase(it);
+            }
+        }
+        break;
+    };
+}
+
+//--------------------------------------------------------------------------
+/// Links operations that are performed on the same address/memory block
+//--------------------------------------------------------------------------
+bool Capture::setLinksAndFlagInvalid(uint64_t inMinMarkerTime)
+{
+    const size_t numOps = m_operations.size();
+
+    if (m_live)
+        m_live->keepUnlinked(m_operations, 0);
+
+    // shard lists flag cross shard reallocs in the top index bit, larger captures are linked in a single pass
+    uint32_t numThreads = std::thread::hardware_concurrency();
+    if (numThreads > s_maxLoadThreads)
+        numThreads = s_maxLoadThreads;
+    if ((numThreads == 0) || (numOps < s_minParallelLink) || (numOps >= s_linkAcquireOnly))
+        numThreads = 1;
+
+    // more shards than threads to even out the load
+    const uint32_t numShards = numThreads > 1 ? numThreads * 4 : 1;
+
+    std::vector<LinkShard> shards(numShards);
+    std::vector<size_t> blockStart(numThreads + 1);
+    for (uint32_t b = 0; b <= numThreads; ++b)
+        blockStart[b] = (size_t)((uint64_t)numOps * b / numThreads);
+
+    // distribute operation indices to shards, every list stays in time order
+    std::vector<std::vector<uint32_t>> shardOps(numThreads * numShards);
+    auto partition = [&](uint32_t _b) {
+        std::vector<uint32_t>* lists = &shardOps[_b * numShards];
+        if (numShards > 1)
+        {
+            for (uint32_t s = 0; s < numShards; ++s)
+                lists[s].reserve((blockStart[_b + 1] - blockStart[_b]) / numShards * 5 / 4);
+        }
+
+        for (size_t i = blockStart[_b]; i < blockStart[_b + 1]; ++i)
+        {
+            RTM_ASSERT(m_operations.m_chainNext[i] == MemoryOperations::NoOperation, "");
+
+            if (numShards == 1)
+                continue;
+
+            const uint32_t shard = getLinkShard(m_operations.m_pointer[i], numShards);
+
+            const uint8_t type = m_operations.getType(i);
+            const bool isRealloc = (type == rmem::LogMarkers::OpRealloc) || (type == rmem::LogMarkers::OpReallocAligned);
+            const uint64_t previousPointer = isRealloc ? m_operations.getPreviousPointer(i) : 0;
+            if (previousPointer)
+            {
+                const uint32_t prevShard = getLinkShard(previousPointer, numShards);
+                if (prevShard != shard)
                 {
-                    op->m_chainPrev = oldOp;
-                    oldOp->m_chainNext = op;
+                    lists[prevShard].push_back((uint32_t)i);
+                    lists[shard].push_back((uint32_t)i | s_linkAcquireOnly);
+                    continue;
                 }
-
-                opMap[op->m_pointer] = op;
             }
-            break;
 
-            case rmem::LogMarkers::OpFree:
+            lists[shard].push_back((uint32_t)i);
+        }
+    };
+
+    std::atomic<uint32_t> nextShard(0);
+    std::atomic<uint64_t> linkedOps(0);
+    auto link = [&](uint32_t _thread) {
+        uint32_t s;
+        while ((s = nextShard.fetch_add(1)) < numShards)
+        {
+            LinkShard& shard = shards[s];
+            uint64_t count = 0;
+            if (numShards == 1)
             {
-                robin_hood::unordered_map<uint64_t, MemoryOperation*>::iterator it = opMap.find(op->m_pointer);
-                if (it == opMap.end())
+                for (size_t i = 0; i < numOps; ++i)
                 {
-                    m_operationsInvalid.push_back(op);
-                    op->m_isValid = 0;
+                    linkOperation(shard, m_operations, (uint32_t)i, false, 0, 1);
+
+                    if ((_thread == 0) && m_loadProgressCallback && ((i & 0xffff) == 0))
+                    {
+                        const float percent = float(i) * 100.0f / numOps;
+                        m_loadProgressCallback(m_loadProgressCustomData, percent, "Processing...");
+                    }
                 }
-                else
+                count = numOps;
+            }
+            else
+            {
+                for (uint32_t b = 0; b < numThreads; ++b)
                 {
-                    MemoryOperation* oldOp = it->second;
-                    RTM_ASSERT(oldOp->m_operationType != rmem::LogMarkers::OpFree, "");
+                    const std::vector<uint32_t>& list = shardOps[b * numShards + s];
+                    for (size_t i = 0; i < list.size(); ++i)
+                        linkOperation(shard,
+                                      m_operations,
+                                      list[i] & ~s_linkAcquireOnly,
+                                      (list[i] & s_linkAcquireOnly) != 0,
+                                      s,
+                                      numShards);
+                    count += list.size();
+                }
+            }
 
-                    oldOp->m_chainNext = op;
-                    op->m_chainPrev = oldOp;
-                    op->m_allocSize = oldOp->m_allocSize;
-                    op->m_overhead = oldOp->m_overhead;
+            // live capture links operations appended later against the blocks left in maps
+            if (!m_live)
+                shard.m_opMap.clear();
 
-                    opMap.erase(it);
-                }
+            const uint64_t done = linkedOps.fetch_add(count) + count;
+            if ((_thread == 0) && m_loadProgressCallback)
+            {
+                // cross shard reallocs are counted twice
+                const float percent = qMin(float(done) * 100.0f / numOps, 100.0f);
+                m_loadProgressCallback(m_loadProgressCustomData, percent, "Processing...");
             }
-            break;
-        };
+        }
+    };
+
+    runParallel(numThreads, partition);
+    runParallel(numThreads, link);
+
+    shardOps.clear();
+    shardOps.shrink_to_fit();
+
+    if (m_live)
+    {
+        m_live->m_opMap.clear();
+        m_live->m_opMap.swap(shards[0].m_opMap);
+        for (uint32_t s = 1; s < numShards; ++s)
+            m_live->m_opMap.insert(shards[s].m_opMap.begin(), shards[s].m_opMap.end());
     }
 
-    if (m_loadProgressCallback)
-        m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Removing invalid operations..");
+    // invalid operations stay in place and are reported in time order, same as linking in one pass would
+    std::vector<uint32_t> invalid;
+    for (uint32_t s = 0; s < numShards; ++s)
+    {
+        const LinkShard& shard = shards[s];
+        invalid.insert(invalid.end(), shard.m_invalid.begin(), shard.m_invalid.end());
+        for (size_t i = 0; i < shard.m_dropped.size(); ++i)
+            m_operations.setInvalid(shard.m_dropped[i]);
+    }
+    std::sort(invalid.begin(), invalid.end());
+
+    for (size_t i = 0; i < invalid.size(); ++i)
+    {
+        m_operations.setInvalid(invalid[i]);
+        m_operationsInvalid.push_back(invalid[i]);
+    }
 
-    /// Remove invalid operations
-    std::vector<MemoryOperation*>::iterator newEnd =
-        std::remove_if(m_operations.begin(), m_operations.end(), isInvalid);
-    size_t newSize = newEnd - m_operations.begin();
-    m_operations.resize(newSize);
+    m_operations.releasePreviousPointers();
 
     // get time range
-    numOps = (uint32_t)m_operations.size();
+    size_t firstValid = 0;
+    while ((firstValid < numOps) && !m_operations.isValid(firstValid))
+        ++firstValid;
 
-    if (numOps == 0)
+    if (firstValid == numOps)
         return false;
 
-    m_minTime = m_operations[0]->m_operationTime;
+    size_t lastValid = numOps - 1;
+    while (!m_operations.isValid(lastValid))
+        --lastValid;
+
+    m_minTime = m_operations.m_time[firstValid];
     if (m_minTime > inMinMarkerTime)
         m_minTime = inMinMarkerTime;
-    m_maxTime = m_operations[numOps - 1]->m_operationTime;
+    m_maxTime = m_operations.m_time[lastValid];
 
     m_filter.m_minTimeSnapshot = m_minTime;
     m_filter.m_maxTimeSnapshot = m_maxTime;
@@ -1517,6 +3862,62 @@ bool Capture::setLinksAndRemoveInvalid(uint64_t inMinMarkerTime)
     return true;
 }
 
+//--------------------------------------------------------------------------
+/// Links operations appended to a live capture starting with _first against
+/// blocks that are still alive and continues global stats with them
+//--------------------------------------------------------------------------
+void Capture::appendOperations(size_t _first)
+{
+    sortOperationsByTime(m_operations, _first);
+
+    // operations logged late by other threads can't go before the ones already stored,
+    // they are moved to their place once the capture ends
+    const size_t numOps = m_operations.size();
+    const uint64_t lastTime = _first ? m_operations.m_time[_first - 1] : m_maxTime;
+    for (size_t i = _first; (i < numOps) && (m_operations.m_time[i] < lastTime); ++i)
+    {
+        m_live->m_clampedTimes.push_back(std::make_pair((uint32_t)i, m_operations.m_time[i]));
+        m_operations.m_time[i] = lastTime;
+    }
+
+    m_live->keepUnlinked(m_operations, _first);
+
+    LinkShard shard;
+    shard.m_opMap.swap(m_live->m_opMap);
+
+    for (size_t i = _first; i < numOps; ++i)
+        linkOperation(shard, m_operations, (uint32_t)i, false, 0, 1);
+
+    m_live->m_opMap.swap(shard.m_opMap);
+
+    for (size_t i = 0; i < shard.m_dropped.size(); ++i)
+        m_operations.setInvalid(shard.m_dropped[i]);
+
+    for (size_t i = 0; i < shard.m_invalid.size(); ++i)
+    {
+        m_operations.setInvalid(shard.m_invalid[i]);
+        m_operationsInvalid.push_back(shard.m_invalid[i]);
+    }
+
+    m_operations.releasePreviousPointers();
+
+    // snapshot that covered the whole capture keeps covering it
+    size_t lastValid = numOps;
+    while ((lastValid > _first) && !m_operations.isValid(lastValid - 1))
+        --lastValid;
+
+    if (lastValid > _first)
+    {
+        const uint64_t prevMaxTime = m_maxTime;
+        m_maxTime = m_operations.m_time[lastValid - 1];
+        if (m_filter.m_maxTimeSnapshot == prevMaxTime)
+            m_filter.m_maxTimeSnapshot = m_maxTime;
+    }
+
+    // timed stats are taken at fixed store positions, invalid operations included
+    calculateGlobalStats(_first);
+}
+
 rdebug::Toolchain::Type convertToolchain(rmem::ToolChain::Enum _tc)
 {
     switch (_tc)
@@ -1611,31 +4012,83 @@ void Capture::removeModule(const char* _path, uint64_t inModBase, uint64_t inMod
 }
 
 //--------------------------------------------------------------------------
-/// Calculates statistics for entire binary
+/// Calculates statistics for entire binary, or continues them for operations
+/// appended to a live capture starting with _first
 //--------------------------------------------------------------------------
-void Capture::calculateGlobalStats()
+void Capture::calculateGlobalStats(size_t _first)
 {
-    if (m_loadProgressCallback)
+    if (m_loadProgressCallback && (_first == 0))
         m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Calculating stats...");
 
-    memset(&m_statsGlobal, 0, sizeof(MemoryStats));
-
     MemoryStatLocalPeak localPeak;
     memset(&localPeak, 0, sizeof(MemoryStatLocalPeak));
 
     const size_t numOps = m_operations.size();
+    const uint64_t timeRange = m_maxTime - m_minTime + 1;
+
+    size_t bucketIndex = 0;
+    size_t firstBucket = 0;  // upper pyramid levels are merged again from this bucket on
+    GraphBucket bucket;
+    initGraphBucket(bucket, 0, 0);
 
-    uint32_t timedGranularityMask = getGranularityMask(numOps);
+    if (_first == 0)
+    {
+        memset(&m_statsGlobal, 0, sizeof(MemoryStats));
+        m_timedStats.clear();
+        m_timedStatsMask = getGranularityMask(numOps);
+
+        // usage graph pyramid, level 0 gets a few operations per bucket on average
+        uint64_t numBuckets = s_minGraphBuckets;
+        while ((numBuckets < s_maxGraphBuckets) && (numBuckets * 8 < numOps))
+            numBuckets *= 2;
+
+        m_usageBucketTime = (timeRange + numBuckets - 1) / numBuckets;
+        m_usageGraph.resize(1);
+    }
+    else
+    {
+        // last timed stats close the previous range, it goes on from their local peak
+        localPeak = m_timedStats.back().m_localPeak;
+        m_timedStats.pop_back();
+
+        // keep level 0 size bounded by merging pairs of buckets as the capture grows
+        std::vector<GraphBucket>& level0 = m_usageGraph[0];
+        const size_t numLevel0 = level0.size();
+        while ((timeRange + m_usageBucketTime - 1) / m_usageBucketTime > s_maxGraphBuckets * 2)
+        {
+            for (size_t i = 0; i < level0.size(); i += 2)
+            {
+                GraphBucket merged = level0[i];
+                if (i + 1 < level0.size())
+                    mergeGraphBuckets(merged, level0[i + 1]);
+                level0[i / 2] = merged;
+            }
+            level0.resize((level0.size() + 1) / 2);
+            m_usageBucketTime *= 2;
+        }
+
+        // the last bucket is still open, it holds the operations at previous end time
+        bucketIndex = level0.size() - 1;
+        bucket = level0[bucketIndex];
+        firstBucket = (level0.size() == numLevel0) ? bucketIndex : 0;
+    }
 
-    for (size_t i = 0; i < numOps; i++)
+    const uint64_t numBuckets = (timeRange + m_usageBucketTime - 1) / m_usageBucketTime;
+    std::vector<GraphBucket>& buckets = m_usageGraph[0];
+    buckets.resize((size_t)numBuckets);
+
+    const uint32_t timedGranularityMask = m_timedStatsMask;
+
+    for (size_t i = _first; i < numOps; i++)
     {
-        MemoryOperation* op = m_operations[i];
+        const uint32_t op = (uint32_t)i;
 
+        // timed stats are taken at store positions, getGraphAtIndex replays from them
         if ((i & timedGranularityMask) == 0)
         {
             MemoryStatsTimed st;
-            st.m_time = op->m_operationTime;
-            st.m_operationIndex = (uint32_t)i;
+            st.m_time = m_operations.m_time[op];
+            st.m_operationIndex = (uint64_t)i;
             st.m_localPeak = localPeak;
             st.m_stats = m_statsGlobal;
             m_timedStats.emplace_back(st);
@@ -1644,15 +4097,18 @@ void Capture::calculateGlobalStats()
             memset(&localPeak, 0, sizeof(MemoryStatLocalPeak));
         }
 
+        if (!m_operations.isValid(op))
+            continue;
+
         ++m_statsGlobal.m_numberOfOperations;
 
-        switch (op->m_operationType)
+        switch (m_operations.getType(op))
         {
             case rmem::LogMarkers::OpAlloc:
             case rmem::LogMarkers::OpCalloc:
             case rmem::LogMarkers::OpAllocAligned:
             {
-                const uint32_t binIdx = fillStats_Alloc(op, m_statsGlobal);
+                const uint32_t binIdx = fillStats_Alloc(m_operations, op, m_statsGlobal);
 
                 // update local peak struct
                 localPeak.m_memoryUsagePeak = qMax(localPeak.m_memoryUsagePeak, m_statsGlobal.m_memoryUsage);
@@ -1674,7 +4130,7 @@ void Capture::calculateGlobalStats()
             case rmem::LogMarkers::OpRealloc:
             case rmem::LogMarkers::OpReallocAligned:
             {
-                const uint32_t binIdx = fillStats_ReAlloc(op, m_statsGlobal);
+                const uint32_t binIdx = fillStats_ReAlloc(m_operations, op, m_statsGlobal);
 
                 // update local peak struct
                 localPeak.m_memoryUsagePeak = qMax(localPeak.m_memoryUsagePeak, m_statsGlobal.m_memoryUsage);
@@ -1695,49 +4151,95 @@ void Capture::calculateGlobalStats()
 
             case rmem::LogMarkers::OpFree:
             {
-                fillStats_Free(op, m_statsGlobal);
+                fillStats_Free(m_operations, op, m_statsGlobal);
             }
             break;
         };
 
-        GraphEntry entry;
-        entry.m_usage = m_statsGlobal.m_memoryUsage;
-        entry.m_numLiveBlocks = m_statsGlobal.m_numberOfLiveBlocks;
-        m_usageGraph.emplace_back(entry);
+        // close buckets before this operation, empty ones keep the last values
+        const size_t opBucket = (size_t)((m_operations.m_time[op] - m_minTime) / m_usageBucketTime);
+        for (; bucketIndex < opBucket; ++bucketIndex)
+        {
+            buckets[bucketIndex] = bucket;
+            initGraphBucket(bucket, bucket.m_lastUsage, bucket.m_lastLiveBlocks);
+        }
+        addToGraphBucket(bucket, m_statsGlobal.m_memoryUsage, m_statsGlobal.m_numberOfLiveBlocks);
+    }
+
+    for (; bucketIndex < buckets.size(); ++bucketIndex)
+    {
+        buckets[bucketIndex] = bucket;
+        initGraphBucket(bucket, bucket.m_lastUsage, bucket.m_lastLiveBlocks);
     }
 
+    buildGraphLevels(firstBucket);
+
     MemoryStatsTimed st;
-    st.m_time = m_operations[m_operations.size() - 1]->m_operationTime;
-    st.m_operationIndex = (uint32_t)(m_operations.size() - 1);
+    st.m_time = m_operations.m_time[m_operations.size() - 1];
+    st.m_operationIndex = (uint64_t)(m_operations.size() - 1);
     st.m_localPeak = localPeak;
     st.m_stats = m_statsGlobal;
     m_timedStats.push_back(st);
 
     m_statsSnapshot = m_statsGlobal;
 
-    if (m_loadProgressCallback)
+    if (m_loadProgressCallback && (_first == 0))
         m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Loading complete!");
 }
 
+//--------------------------------------------------------------------------
+/// Builds usage graph levels above level 0, each level merges pairs of
+/// buckets from the level below. Only parents of level 0 buckets starting
+/// with _firstChanged are merged again.
+//--------------------------------------------------------------------------
+void Capture::buildGraphLevels(size_t _firstChanged)
+{
+    size_t firstChanged = _firstChanged;
+    size_t numLevels = 1;
+    while (m_usageGraph[numLevels - 1].size() > 1)
+    {
+        if (m_usageGraph.size() == numLevels)
+            m_usageGraph.emplace_back();
+
+        const std::vector<GraphBucket>& level = m_usageGraph[numLevels - 1];
+        std::vector<GraphBucket>& parent = m_usageGraph[numLevels];
+        parent.resize((level.size() + 1) / 2);
+
+        firstChanged /= 2;
+        for (size_t i = firstChanged; i < parent.size(); ++i)
+        {
+            parent[i] = level[i * 2];
+            if (i * 2 + 1 < level.size())
+                mergeGraphBuckets(parent[i], level[i * 2 + 1]);
+        }
+        ++numLevels;
+    }
+    m_usageGraph.resize(numLevels);
+}
+
+//--------------------------------------------------------------------------
+/// Counters are 64 bit wide, a set high bit means a counter went below zero
+/// because of operations that do not match the rest of the capture
+//--------------------------------------------------------------------------
 bool Capture::verifyGlobalStats()
 {
     if (m_statsGlobal.m_memoryUsage & UINT64_C(0x8000000000000000))
         return false;
     if (m_statsGlobal.m_memoryUsagePeak & UINT64_C(0x8000000000000000))
         return false;
-    if (m_statsGlobal.m_overhead & UINT32_C(0x80000000))
+    if (m_statsGlobal.m_overhead & UINT64_C(0x8000000000000000))
         return false;
-    if (m_statsGlobal.m_overheadPeak & UINT32_C(0x80000000))
+    if (m_statsGlobal.m_overheadPeak & UINT64_C(0x8000000000000000))
         return false;
-    if (m_statsGlobal.m_numberOfOperations & UINT32_C(0x80000000))
+    if (m_statsGlobal.m_numberOfOperations & UINT64_C(0x8000000000000000))
         return false;
-    if (m_statsGlobal.m_numberOfAllocations & UINT32_C(0x80000000))
+    if (m_statsGlobal.m_numberOfAllocations & UINT64_C(0x8000000000000000))
         return false;
-    if (m_statsGlobal.m_numberOfReAllocations & UINT32_C(0x80000000))
+    if (m_statsGlobal.m_numberOfReAllocations & UINT64_C(0x8000000000000000))
         return false;
-    if (m_statsGlobal.m_numberOfFrees & UINT32_C(0x80000000))
+    if (m_statsGlobal.m_numberOfFrees & UINT64_C(0x8000000000000000))
         return false;
-    if (m_statsGlobal.m_numberOfLiveBlocks & UINT32_C(0x80000000))
+    if (m_statsGlobal.m_numberOfLiveBlocks & UINT64_C(0x8000000000000000))
         return false;
 
     for (unsigned i = 0; i < MemoryStats::NUM_HISTOGRAM_BINS; ++i)
@@ -1746,13 +4248,13 @@ bool Capture::verifyGlobalStats()
             return false;
         if (m_statsGlobal.m_histogram[i].m_sizePeak & UINT64_C(0x8000000000000000))
             return false;
-        if (m_statsGlobal.m_histogram[i].m_overhead & UINT32_C(0x80000000))
+        if (m_statsGlobal.m_histogram[i].m_overhead & UINT64_C(0x8000000000000000))
             return false;
-        if (m_statsGlobal.m_histogram[i].m_overheadPeak & UINT32_C(0x80000000))
+        if (m_statsGlobal.m_histogram[i].m_overheadPeak & UINT64_C(0x8000000000000000))
             return false;
-        if (m_statsGlobal.m_histogram[i].m_count & UINT32_C(0x80000000))
+        if (m_statsGlobal.m_histogram[i].m_count & UINT64_C(0x8000000000000000))
             return false;
-        if (m_statsGlobal.m_histogram[i].m_countPeak & UINT32_C(0x80000000))
+        if (m_statsGlobal.m_histogram[i].m_countPeak & UINT64_C(0x8000000000000000))
             return false;
     }
 
@@ -1772,14 +4274,14 @@ void Capture::calculateFilteredData()
     uint32_t numOpsOver100 = numStackTraces / 100;
     uint32_t idx = 0;
 
+    const size_t numFrames = m_stackFrames.getNumNodes();
+    for (size_t i = 0; i < numFrames; ++i)
+        m_stackFrames.getNode(i)->m_treeIndex[StackTrace::Filtered] = (uint16_t)-1;
+
     while (it != end)
     {
         StackTrace* st = *it;
         st->m_addedToTree[StackTrace::Filtered] = 0;
-        // clear second half
-        memset(StackTrace::getIndexArray(st) + (getStackTraceIndexArraySize(st->m_numFrames) / 4),
-               0xff,
-               getStackTraceIndexArraySize(st->m_numFrames) / 2);
 
         ++it;
 
@@ -1794,37 +4296,37 @@ void Capture::calculateFilteredData()
 
     uint32_t minTimedIdx;
     uint32_t maxTimedIdx;
-    const uint32_t minTimeOpIndex = getIndexBefore(m_filter.m_minTimeSnapshot, minTimedIdx);
-    uint32_t maxTimeOpIndex = getIndexBefore(m_filter.m_maxTimeSnapshot, maxTimedIdx) + 1;
+    const uint64_t minTimeOpIndex = getIndexBefore(m_filter.m_minTimeSnapshot, minTimedIdx);
+    uint64_t maxTimeOpIndex = getIndexBefore(m_filter.m_maxTimeSnapshot, maxTimedIdx) + 1;
 
     if (maxTimeOpIndex >= m_operations.size())
     {
-        maxTimeOpIndex = (uint32_t)m_operations.size() - 1;
+        maxTimeOpIndex = (uint64_t)m_operations.size() - 1;
     }
 
     m_filter.m_operations.clear();
-    m_filter.m_operations.reserve(maxTimeOpIndex - minTimeOpIndex);
+    m_filter.m_operations.reserve((size_t)(maxTimeOpIndex - minTimeOpIndex));
 
     m_filter.m_operationGroups.clear();
 
     destroyStackTree(m_filter.m_stackTraceTree);
 
-    const uint32_t numOps = maxTimeOpIndex - minTimeOpIndex;
-    nextProgressPoint = minTimeOpIndex;
-    numOpsOver100 = numOps / 100;
+    const uint64_t numOps = maxTimeOpIndex - minTimeOpIndex;
+    uint64_t nextOpProgressPoint = minTimeOpIndex;
+    const uint64_t numOpsOver100Filtered = numOps / 100;
 
     MemoryTagTree* prevTag = NULL;
 
     uint64_t liveBlocks = 0;
     uint64_t liveSize = 0;
 
-    for (uint32_t i = minTimeOpIndex; i <= maxTimeOpIndex; i++)
+    for (uint64_t i = minTimeOpIndex; i <= maxTimeOpIndex; i++)
     {
-        MemoryOperation* op = m_operations[i];
+        const uint32_t op = (uint32_t)i;
 
-        if ((i > nextProgressPoint) && m_loadProgressCallback)
+        if ((i > nextOpProgressPoint) && m_loadProgressCallback)
         {
-            float percent = float(i - minTimedIdx) / float(numOpsOver100);
+            float percent = float(i - minTimedIdx) / float(numOpsOver100Filtered);
             m_loadProgressCallback(m_loadProgressCustomData, percent, "Building filtered data...");
         }
 
@@ -1833,8 +4335,8 @@ void Capture::calculateFilteredData()
 
         m_filter.m_operations.push_back(op);
 
-        updateLiveBlocks(op, liveBlocks);
-        updateLiveSize(op, liveSize);
+        updateLiveBlocks(m_operations, op, liveBlocks);
+        updateLiveSize(m_operations, op, liveSize);
 
         // add to memory groups
         addToMemoryGroups(m_filter.m_operationGroups, op, liveBlocks, liveSize);
@@ -1843,7 +4345,7 @@ void Capture::calculateFilteredData()
         addToStackTraceTree(m_filter.m_stackTraceTree, op, StackTrace::Filtered);
 
         // add to tag tree
-        tagAddOp(m_filter.m_tagTree, op, prevTag);
+        tagAddOp(m_filter.m_tagTree, m_operations, op, prevTag);
     }
 
     if (m_loadProgressCallback)
@@ -1853,7 +4355,7 @@ void Capture::calculateFilteredData()
 //--------------------------------------------------------------------------
 /// Returns the index of first operation before the given time
 //--------------------------------------------------------------------------
-uint32_t Capture::getIndexBefore(uint64_t _time, uint32_t& _outTimedIndex) const
+uint64_t Capture::getIndexBefore(uint64_t _time, uint32_t& _outTimedIndex) const
 {
     uint32_t tsIdx = 0;
     int32_t tsIdxMin = 0;
@@ -1880,23 +4382,23 @@ uint32_t Capture::getIndexBefore(uint64_t _time, uint32_t& _outTimedIndex) const
         }
     }
 
-    uint32_t startIdx = m_timedStats[tsIdx - 1].m_operationIndex;
-    uint32_t endIdx = m_timedStats[tsIdx].m_operationIndex + 1;
+    uint64_t startIdx = m_timedStats[tsIdx - 1].m_operationIndex;
+    uint64_t endIdx = m_timedStats[tsIdx].m_operationIndex + 1;
 
     _outTimedIndex = tsIdx - 1;
 
     while (endIdx > startIdx)
     {
-        uint32_t idxMid = (startIdx + endIdx) / 2;
+        uint64_t idxMid = (startIdx + endIdx) / 2;
 
-        if (m_operations[idxMid]->m_operationTime < _time)
+        if (m_operations.m_time[(size_t)idxMid] < _time)
             startIdx = idxMid;
         else
             endIdx = idxMid;
 
         if (endIdx - startIdx == 1)
         {
-            if (m_operations[startIdx]->m_operationTime >= _time)
+            if (m_operations.m_time[(size_t)startIdx] >= _time)
                 return (startIdx == 0) ? startIdx : startIdx - 1;
             else
                 return endIdx;
@@ -1907,7 +4409,51 @@ uint32_t Capture::getIndexBefore(uint64_t _time, uint32_t& _outTimedIndex) const
     return 0;
 }
 
-uint32_t Capture::getIndexAfter(uint64_t _time, uint32_t& _outTimedIndex) const
+//--------------------------------------------------------------------------
+/// Returns memory usage after given operation, replayed from closest timed stats
+//--------------------------------------------------------------------------
+void Capture::getGraphAtIndex(uint64_t _index, GraphEntry& _entry) const
+{
+    const uint32_t granularity = m_timedStatsMask + 1;
+    const MemoryStatsTimed& st = m_timedStats[_index / granularity];
+
+    uint64_t usage = st.m_stats.m_memoryUsage;
+    uint64_t liveBlocks = st.m_stats.m_numberOfLiveBlocks;
+    for (uint64_t i = st.m_operationIndex; i <= _index; ++i)
+        if (m_operations.isValid((size_t)i))
+            applyGraphOperation(m_operations, (size_t)i, usage, liveBlocks);
+
+    _entry.m_usage = usage;
+    _entry.m_numLiveBlocks = liveBlocks;
+}
+
+//--------------------------------------------------------------------------
+/// Returns combined range of level 0 buckets [_first, _last] using upper
+/// levels of usage graph pyramid
+//--------------------------------------------------------------------------
+void Capture::getGraphBuckets(size_t _first, size_t _last, GraphBucket& _bucket) const
+{
+    _bucket = m_usageGraph[0][_first];
+
+    size_t lo = _first + 1;
+    size_t hi = _last + 1;
+    for (size_t level = 0; lo < hi; ++level)
+    {
+        const std::vector<GraphBucket>& buckets = m_usageGraph[level];
+        if (lo & 1)
+            mergeGraphBuckets(_bucket, buckets[lo++]);
+        if (hi & 1)
+            mergeGraphBuckets(_bucket, buckets[--hi]);
+        lo >>= 1;
+        hi >>= 1;
+    }
+
+    // buckets are not merged in time order, last values come from the last bucket
+    _bucket.m_lastUsage = m_usageGraph[0][_last].m_lastUsage;
+    _bucket.m_lastLiveBlocks = m_usageGraph[0][_last].m_lastLiveBlocks;
+}
+
+uint64_t Capture::getIndexAfter(uint64_t _time, uint32_t& _outTimedIndex) const
 {
     uint32_t tsIdx = 0;
     int32_t tsIdxMin = 0;
@@ -1929,23 +4475,23 @@ uint32_t Capture::getIndexAfter(uint64_t _time, uint32_t& _outTimedIndex) const
         }
     }
 
-    uint32_t startIdx = m_timedStats[tsIdx - 1].m_operationIndex;
-    uint32_t endIdx = m_timedStats[tsIdx].m_operationIndex + 1;
+    uint64_t startIdx = m_timedStats[tsIdx - 1].m_operationIndex;
+    uint64_t endIdx = m_timedStats[tsIdx].m_operationIndex + 1;
 
     _outTimedIndex = tsIdx - 1;
 
     while (endIdx > startIdx)
     {
-        uint32_t idxMid = (startIdx + endIdx) / 2;
+        uint64_t idxMid = (startIdx + endIdx) / 2;
 
-        if (m_operations[idxMid]->m_operationTime < _time)
+        if (m_operations.m_time[(size_t)idxMid] < _time)
             startIdx = idxMid;
         else
             endIdx = idxMid;
 
         if (endIdx - startIdx == 1)
         {
-            if (m_operations[startIdx]->m_operationTime > _time)
+            if (m_operations.m_time[(size_t)startIdx] > _time)
                 return startIdx;
             else
                 return endIdx;
@@ -1961,10 +4507,17 @@ uint32_t Capture::getIndexAfter(uint64_t _time, uint32_t& _outTimedIndex) const
 //--------------------------------------------------------------------------
 void Capture::calculateSnapshotStats()
 {
+    // overview keeps no timed stats, snapshot stats stay the global ones
+    if (m_overview)
+    {
+        m_statsSnapshot = m_statsGlobal;
+        return;
+    }
+
     uint32_t minTimedIdx;
     uint32_t maxTimedIdx;
-    uint32_t minTimeOpIndex = getIndexBefore(m_filter.m_minTimeSnapshot, minTimedIdx);
-    uint32_t maxTimeOpIndex = getIndexAfter(m_filter.m_maxTimeSnapshot, maxTimedIdx);
+    uint64_t minTimeOpIndex = getIndexBefore(m_filter.m_minTimeSnapshot, minTimedIdx);
+    uint64_t maxTimeOpIndex = getIndexAfter(m_filter.m_maxTimeSnapshot, maxTimedIdx);
 
     if (minTimeOpIndex != 0)
         minTimeOpIndex++;
@@ -1975,7 +4528,7 @@ void Capture::calculateSnapshotStats()
     // check if it's fully manual
     if (maxTimedIdx - minTimedIdx < 2)
     {
-        const uint32_t startIndex = m_timedStats[minTimedIdx].m_operationIndex;
+        const uint64_t startIndex = m_timedStats[minTimedIdx].m_operationIndex;
         GetRangedStats(m_statsSnapshot, startIndex, minTimeOpIndex);
         m_statsSnapshot.setPeaksToCurrent();
 
@@ -1988,7 +4541,7 @@ void Capture::calculateSnapshotStats()
     }
     else
     {
-        const uint32_t startIndex1 = m_timedStats[minTimedIdx].m_operationIndex;
+        const uint64_t startIndex1 = m_timedStats[minTimedIdx].m_operationIndex;
         RTM_ASSERT(startIndex1 <= minTimeOpIndex, "");
         GetRangedStats(startStats, startIndex1, minTimeOpIndex);
         m_statsSnapshot = startStats;
@@ -2025,7 +4578,7 @@ void Capture::calculateSnapshotStats()
 
         m_statsSnapshot.setPeaksFrom(localPeak);
         MemoryStatsTimed& ts = m_timedStats[maxTimedIdx];
-        const uint32_t startIndex2 = ts.m_operationIndex;
+        const uint64_t startIndex2 = ts.m_operationIndex;
 
         m_statsSnapshot.m_memoryUsage = ts.m_stats.m_memoryUsage;
         m_statsSnapshot.m_overhead = ts.m_stats.m_overhead;
@@ -2045,37 +4598,42 @@ void Capture::calculateSnapshotStats()
 
         GetRangedStats(m_statsSnapshot, startIndex2, maxTimeOpIndex + 1);
     }
+
+    if (isPreview())
+        m_statsSnapshot.scale(m_sampleScale);
 }
 
 //--------------------------------------------------------------------------
 /// Calculates the stats inside the given range
 //--------------------------------------------------------------------------
-void Capture::GetRangedStats(MemoryStats& _stats, uint32_t _minIdx, uint32_t _maxIdx)
+void Capture::GetRangedStats(MemoryStats& _stats, uint64_t _minIdx, uint64_t _maxIdx)
 {
-    const uint32_t minIdx = _minIdx;
-    const uint32_t maxIdx = _maxIdx;
+    const size_t minIdx = (size_t)_minIdx;
+    const size_t maxIdx = (size_t)_maxIdx;
 
     for (size_t i = minIdx; i < maxIdx; i++)
     {
-        MemoryOperation* op = m_operations[i];
+        const uint32_t op = (uint32_t)i;
+        if (!m_operations.isValid(op))
+            continue;
 
         ++_stats.m_numberOfOperations;
 
-        switch (op->m_operationType)
+        switch (m_operations.getType(op))
         {
             case rmem::LogMarkers::OpAlloc:
             case rmem::LogMarkers::OpCalloc:
             case rmem::LogMarkers::OpAllocAligned:
-                fillStats_Alloc(op, _stats);
+                fillStats_Alloc(m_operations, op, _stats);
                 break;
 
             case rmem::LogMarkers::OpRealloc:
             case rmem::LogMarkers::OpReallocAligned:
-                fillStats_ReAlloc(op, _stats);
+                fillStats_ReAlloc(m_operations, op, _stats);
                 break;
 
             case rmem::LogMarkers::OpFree:
-                fillStats_Free(op, _stats);
+                fillStats_Free(m_operations, op, _stats);
                 break;
         };
     }
@@ -2093,31 +4651,80 @@ void Capture::addMemoryTag(char* _tagName, uint32_t _tagHash, uint32_t _parentTa
         delete mtt;
 }
 
+//--------------------------------------------------------------------------
+/// Returns index of stack trace with given frames, adding it if it wasn't seen before
+//--------------------------------------------------------------------------
+uint32_t Capture::addStackTrace(uint32_t _hash, uint64_t* _frames, uint32_t _numFrames)
+{
+    // capture hash is only 32 bits wide, traces are told apart by their interned frames
+    StackTraceNode* frame = m_stackFrames.intern(_frames, _numFrames);
+
+    std::pair<robin_hood::unordered_map<uintptr_t, uint32_t, uintptr_t_hash, uintptr_t_equal>::iterator, bool> it =
+        m_stackTracesByFrame.insert(std::make_pair((uintptr_t)frame, (uint32_t)m_stackTraces.size()));
+    if (it.second)
+    {
+        StackTrace* st = (StackTrace*)m_stackPool.alloc(StackTrace::calculateSize(_numFrames));
+        StackTrace::init(st, frame);
+        m_stackTraces.push_back(st);
+    }
+
+    m_stackTracesHash[_hash] = it.first->second;
+    return it.first->second;
+}
+
+//--------------------------------------------------------------------------
+/// Registers memory marker with the loader
+//--------------------------------------------------------------------------
+void Capture::addMemoryMarker(const char* _name, uint32_t _hash, uint32_t _color)
+{
+    MemoryMarkerEvent me;
+    me.m_color = _color;
+    me.m_name = _name;
+    me.m_nameHash = _hash;
+    m_memoryMarkers[_hash] = me;
+}
+
+//--------------------------------------------------------------------------
+/// Records a memory marker occurrence
+//--------------------------------------------------------------------------
+void Capture::addMemoryMarkerTime(uint32_t _hash, uint64_t _threadID, uint64_t _time)
+{
+    MemoryMarkerEvent* evt = &m_memoryMarkers[_hash];
+    RTM_ASSERT(evt != NULL, "");
+
+    MemoryMarkerTime mt;
+    mt.m_threadID = _threadID;
+    mt.m_event = evt;
+    mt.m_time = _time;
+    m_memoryMarkerTimes.push_back(mt);
+}
+
 //--------------------------------------------------------------------------
 /// Adds operation to memory groups
 //--------------------------------------------------------------------------
-void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation* _op, uint64_t _liveBlocks, uint64_t _liveSize)
+void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, uint32_t _op, uint64_t _liveBlocks, uint64_t _liveSize)
 {
-    uintptr_t groupHash;
+    const MemoryOperations& ops = m_operations;
+    uint32_t groupHash;
 
-    switch (_op->m_operationType)
+    switch (ops.getType(_op))
     {
         case rmem::LogMarkers::OpAlloc:
         case rmem::LogMarkers::OpCalloc:
         case rmem::LogMarkers::OpAllocAligned:
         {
-            groupHash = calcGroupHash(_op);
+            groupHash = calcGroupHash(ops, _op);
             MemoryOperationGroup& group = _groups[groupHash];
             group.m_operations.push_back(_op);
             group.m_count++;
             group.m_liveCount++;
 
-            group.m_minSize = qMin(group.m_minSize, _op->m_allocSize);
-            group.m_maxSize = qMax(group.m_maxSize, _op->m_allocSize);
+            group.m_minSize = qMin(group.m_minSize, ops.m_allocSize[_op]);
+            group.m_maxSize = qMax(group.m_maxSize, ops.m_allocSize[_op]);
 
-            group.m_liveSize += _op->m_allocSize;
+            group.m_liveSize += ops.m_allocSize[_op];
 
-            const uint32_t binIdx = getHistogramBinIndex(_op->m_allocSize);
+            const uint32_t binIdx = getHistogramBinIndex(ops.m_allocSize[_op]);
             group.m_histogram[binIdx]++;
             group.m_histogramPeak[binIdx] = qMax(group.m_histogram[binIdx], group.m_histogramPeak[binIdx]);
 
@@ -2128,7 +4735,7 @@ void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation*
                 group.m_peakSizeGlobal = _liveSize;
             }
 
-            uint32_t newPeakCount = qMax(group.m_liveCountPeak, group.m_liveCount);
+            uint64_t newPeakCount = qMax(group.m_liveCountPeak, group.m_liveCount);
             if (newPeakCount > group.m_liveCountPeak)
             {
                 group.m_liveCountPeak = newPeakCount;
@@ -2139,32 +4746,32 @@ void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation*
 
         case rmem::LogMarkers::OpFree:
         {
-            MemoryOperation* prevOp = _op->m_chainPrev;
+            const uint32_t prevOp = ops.m_chainPrev[_op];
             if (isInFilter(prevOp))
             {
-                groupHash = calcGroupHash(prevOp);
+                groupHash = calcGroupHash(ops, prevOp);
 
                 MemoryOperationGroup& prevGroup = _groups[groupHash];
 
                 prevGroup.m_liveCount--;
-                prevGroup.m_liveSize -= prevOp->m_allocSize;
+                prevGroup.m_liveSize -= ops.m_allocSize[prevOp];
 
-                const uint32_t prevBinIdx = getHistogramBinIndex(prevOp->m_allocSize);
+                const uint32_t prevBinIdx = getHistogramBinIndex(ops.m_allocSize[prevOp]);
                 prevGroup.m_histogram[prevBinIdx]--;
             }
 
-            groupHash = calcGroupHash(_op);
+            groupHash = calcGroupHash(ops, _op);
             MemoryOperationGroup& group = _groups[groupHash];
             group.m_operations.push_back(_op);
             group.m_count++;
 
-            group.m_minSize = qMin(group.m_minSize, _op->m_allocSize);
-            group.m_maxSize = qMax(group.m_maxSize, _op->m_allocSize);
+            group.m_minSize = qMin(group.m_minSize, ops.m_allocSize[_op]);
+            group.m_maxSize = qMax(group.m_maxSize, ops.m_allocSize[_op]);
 
-            // group.m_liveSize -= _op->m_allocSize;
+            // group.m_liveSize -= ops.m_allocSize[_op];
             group.m_peakSize = qMax(group.m_peakSize, group.m_liveSize);
 
-            const uint32_t binIdx = getHistogramBinIndex(_op->m_allocSize);
+            const uint32_t binIdx = getHistogramBinIndex(ops.m_allocSize[_op]);
             group.m_histogram[binIdx]--;
         }
         break;
@@ -2172,33 +4779,33 @@ void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation*
         case rmem::LogMarkers::OpReallocAligned:
         case rmem::LogMarkers::OpRealloc:
         {
-            MemoryOperation* prevOp = _op->m_chainPrev;
-            if (prevOp)
+            const uint32_t prevOp = ops.m_chainPrev[_op];
+            if (prevOp != MemoryOperations::NoOperation)
             {
                 if (isInFilter(prevOp))
                 {
-                    groupHash = calcGroupHash(prevOp);
+                    groupHash = calcGroupHash(ops, prevOp);
 
                     MemoryOperationGroup& prevGroup = _groups[groupHash];
 
                     prevGroup.m_liveCount--;
-                    prevGroup.m_liveSize -= prevOp->m_allocSize;
+                    prevGroup.m_liveSize -= ops.m_allocSize[prevOp];
 
-                    const uint32_t prevBinIdx = getHistogramBinIndex(prevOp->m_allocSize);
+                    const uint32_t prevBinIdx = getHistogramBinIndex(ops.m_allocSize[prevOp]);
                     prevGroup.m_histogram[prevBinIdx]--;
                 }
             }
 
-            groupHash = calcGroupHash(_op);
+            groupHash = calcGroupHash(ops, _op);
             MemoryOperationGroup& group = _groups[groupHash];
             group.m_operations.push_back(_op);
             group.m_count++;
             group.m_liveCount++;
 
-            group.m_minSize = qMin(group.m_minSize, _op->m_allocSize);
-            group.m_maxSize = qMax(group.m_maxSize, _op->m_allocSize);
+            group.m_minSize = qMin(group.m_minSize, ops.m_allocSize[_op]);
+            group.m_maxSize = qMax(group.m_maxSize, ops.m_allocSize[_op]);
 
-            group.m_liveSize += _op->m_allocSize;
+            group.m_liveSize += ops.m_allocSize[_op];
 
             int64_t newPeakSize = qMax(group.m_peakSize, group.m_liveSize);
             if (newPeakSize > group.m_peakSize)
@@ -2207,14 +4814,14 @@ void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation*
                 group.m_peakSizeGlobal = _liveSize;
             }
 
-            uint32_t newPeakCount = qMax(group.m_liveCountPeak, group.m_liveCount);
+            uint64_t newPeakCount = qMax(group.m_liveCountPeak, group.m_liveCount);
             if (newPeakCount > group.m_liveCountPeak)
             {
                 group.m_liveCountPeak = newPeakCount;
                 group.m_liveCountPeakGlobal = _liveBlocks;
             }
 
-            const uint32_t binIdx = getHistogramBinIndex(_op->m_allocSize);
+            const uint32_t binIdx = getHistogramBinIndex(ops.m_allocSize[_op]);
             group.m_histogram[binIdx]++;
             group.m_histogramPeak[binIdx] = qMax(group.m_histogram[binIdx], group.m_histogramPeak[binIdx]);
         }
@@ -2225,7 +4832,7 @@ void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation*
 static void addToTree(StackTraceTree* _root,
                       StackTrace* _trace,
                       int64_t _size,
-                      int32_t _overhead,
+                      int64_t _overhead,
                       StackTrace::Scope _offset,
                       StackTraceTree::Enum _opType,
                       uint64_t _operationTime)
@@ -2249,18 +4856,22 @@ static void addToTree(StackTraceTree* _root,
     currNode->m_maxTime = _operationTime;
 
     // add stack trace to root node
-    StackTrace::getNextArray(_trace);
     StackTrace** ar = StackTrace::getNextArray(_trace);
     ar[0] = _root->m_stackTraceList;
     _root->m_stackTraceList = _trace;
 
+    // frames are linked from the innermost one, tree is walked from the outermost one
+    StackTraceNode* path[StackTrace::MaxFrames];
+    StackTraceNode* frame = _trace->m_frame;
+    for (int32_t i = 0; i < numFrames; ++i, frame = frame->m_parent)
+        path[i] = frame;
+
     while (--currFrame >= 0)
     {
         int32_t depth = numFrames - currFrame;
 
-        const uint64_t currUniqueID = _trace->m_frames[currFrame + numFrames];
-        uint16_t* IDIdxArray = StackTrace::getIndexArray(_trace);
-        uint16_t& currUniqueIDIdx = IDIdxArray[currFrame + numFrames * _offset];
+        const uint64_t currUniqueID = path[currFrame]->m_addressID;
+        uint16_t& currUniqueIDIdx = path[currFrame]->m_treeIndex[_offset];
 
         StackTraceTree* nextNode = 0;
 
@@ -2320,53 +4931,55 @@ static void addToTree(StackTraceTree* _root,
     }
 }
 
-void Capture::addToStackTraceTree(StackTraceTree& _tree, MemoryOperation* _op, StackTrace::Scope _offset)
+void Capture::addToStackTraceTree(StackTraceTree& _tree, uint32_t _op, StackTrace::Scope _offset)
 {
-    switch (_op->m_operationType)
+    const MemoryOperations& ops = m_operations;
+
+    switch (ops.getType(_op))
     {
         case rmem::LogMarkers::OpAlloc:
         case rmem::LogMarkers::OpCalloc:
         case rmem::LogMarkers::OpAllocAligned:
         {
-            addToTree(&_tree, _op->m_stackTrace, _op->m_allocSize, _op->m_overhead, _offset, StackTraceTree::Alloc, _op->m_operationTime);
+            addToTree(&_tree, m_stackTraces[ops.m_stackTrace[_op]], ops.m_allocSize[_op], ops.m_overhead[_op], _offset, StackTraceTree::Alloc, ops.m_time[_op]);
         }
         break;
 
         case rmem::LogMarkers::OpFree:
         {
-            MemoryOperation* prevOp = _op->m_chainPrev;
-            RTM_ASSERT(prevOp != NULL, "");
+            const uint32_t prevOp = ops.m_chainPrev[_op];
+            RTM_ASSERT(prevOp != MemoryOperations::NoOperation, "");
 
             if (isInFilter(prevOp))
                 addToTree(&_tree,
-                          prevOp->m_stackTrace,
-                          -(int64_t)prevOp->m_allocSize,
-                          -(int32_t)prevOp->m_overhead,
+                          m_stackTraces[ops.m_stackTrace[prevOp]],
+                          -(int64_t)ops.m_allocSize[prevOp],
+                          -(int64_t)ops.m_overhead[prevOp],
                           _offset,
                           StackTraceTree::Free,
-                          _op->m_operationTime);
+                          ops.m_time[_op]);
             else
                 // prev op not in filter, do not reduce used memory to avoid going (possibly) negative
-                addToTree(&_tree, prevOp->m_stackTrace, 0, 0, _offset, StackTraceTree::Free, _op->m_operationTime);
+                addToTree(&_tree, m_stackTraces[ops.m_stackTrace[prevOp]], 0, 0, _offset, StackTraceTree::Free, ops.m_time[_op]);
         }
         break;
 
         case rmem::LogMarkers::OpReallocAligned:
         case rmem::LogMarkers::OpRealloc:
         {
-            MemoryOperation* prevOp = _op->m_chainPrev;
-            if (prevOp)
+            const uint32_t prevOp = ops.m_chainPrev[_op];
+            if (prevOp != MemoryOperations::NoOperation)
             {
                 if (isInFilter(prevOp))
                     addToTree(&_tree,
-                              prevOp->m_stackTrace,
-                              -(int64_t)prevOp->m_allocSize,
-                              -(int32_t)prevOp->m_overhead,
+                              m_stackTraces[ops.m_stackTrace[prevOp]],
+                              -(int64_t)ops.m_allocSize[prevOp],
+                              -(int64_t)ops.m_overhead[prevOp],
                               _offset,
                               StackTraceTree::Count,
-                              _op->m_operationTime);
+                              ops.m_time[_op]);
             }
-            addToTree(&_tree, _op->m_stackTrace, _op->m_allocSize, _op->m_overhead, _offset, StackTraceTree::Realloc, _op->m_operationTime);
+            addToTree(&_tree, m_stackTraces[ops.m_stackTrace[_op]], ops.m_allocSize[_op], ops.m_overhead[_op], _offset, StackTraceTree::Realloc, ops.m_time[_op]);
         }
         break;
     };
@@ -8,20 +8,30 @@
 
 #include <rdebug/inc/rdebug.h>
 #include <rbase/inc/cpu.h>
+#include <MTuner/src/loader/captureindex.h>
+#include <MTuner/src/loader/stacktracestore.h>
+
+#include <atomic>
+#include <thread>
 
 namespace rtm
 {
 class BinLoader;
+class CaptureStream;
+class SymbolCache;
+struct RangeSink;
 
 //--------------------------------------------------------------------------
 
 typedef void (*LoadProgress)(void* inCustomData, float inProgress, const char* inMessage);
+typedef void (*AnalyzeProgress)(void* _customData, uint32_t _stages, float _progress);
+typedef void (*ModulesLoaded)(void* _customData, const std::vector<rdebug::ModuleInfo>& _modules);
 
-typedef robin_hood::unordered_map<uint32_t, StackTrace*, uint32_t_hash, uint32_t_equal> StackTraceHashType;
-typedef robin_hood::unordered_map<uintptr_t, MemoryOperationGroup, uintptr_t_hash, uintptr_t_equal> MemoryGroupsHashType;
+typedef robin_hood::unordered_map<uint32_t, uint32_t, uint32_t_hash, uint32_t_equal> StackTraceHashType;
+typedef robin_hood::unordered_map<uint32_t, MemoryOperationGroup, uint32_t_hash, uint32_t_equal> MemoryGroupsHashType;
 typedef robin_hood::unordered_map<uint32_t, MemoryMarkerEvent, uint32_t_hash, uint32_t_equal> MemoryMarkersHashType;
 typedef robin_hood::unordered_map<uint64_t, std::string> HeapsType;
-typedef std::vector<MemoryOperation*> MemoryOpArray;
+typedef std::vector<uint32_t> MemoryOpArray;  ///< Indices into capture memory operations
 
 //--------------------------------------------------------------------------
 struct GraphEntry
@@ -30,6 +40,65 @@ struct GraphEntry
     uint64_t m_numLiveBlocks;
 };
 
+//--------------------------------------------------------------------------
+/// Range of memory usage and live blocks inside a time span, includes the
+/// values at the start of the span
+//--------------------------------------------------------------------------
+struct GraphBucket
+{
+    uint64_t m_minUsage;
+    uint64_t m_maxUsage;
+    uint64_t m_lastUsage;  ///< Usage at the end of time span
+    uint64_t m_minLiveBlocks;
+    uint64_t m_maxLiveBlocks;
+    uint64_t m_lastLiveBlocks;
+};
+
+//--------------------------------------------------------------------------
+/// Maps 64-bit values that repeat across operations, like thread IDs and
+/// allocator handles, to compact indices
+//--------------------------------------------------------------------------
+struct InternTable
+{
+    std::vector<uint64_t> m_values;
+    robin_hood::unordered_map<uint64_t, uint32_t> m_indices;
+    uint64_t m_lastValue;
+    uint32_t m_lastIndex;
+
+    InternTable()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        m_values.clear();
+        m_indices.clear();
+        m_lastValue = 0;
+        m_lastIndex = (uint32_t)-1;
+    }
+
+    inline uint32_t intern(uint64_t _value)
+    {
+        // consecutive operations mostly come from the same thread and heap
+        if ((_value == m_lastValue) && (m_lastIndex != (uint32_t)-1))
+            return m_lastIndex;
+
+        robin_hood::unordered_map<uint64_t, uint32_t>::iterator it = m_indices.find(_value);
+        if (it != m_indices.end())
+            m_lastIndex = it->second;
+        else
+        {
+            m_lastIndex = (uint32_t)m_values.size();
+            m_indices[_value] = m_lastIndex;
+            m_values.push_back(_value);
+        }
+
+        m_lastValue = _value;
+        return m_lastIndex;
+    }
+};
+
 //--------------------------------------------------------------------------
 /// Memory operation filter description
 //--------------------------------------------------------------------------
@@ -47,32 +116,66 @@ struct FilterDescription
     bool m_leakedOnly;
 };
 
+//--------------------------------------------------------------------------
+/// Part of a capture file to load. Operations outside of it are dropped while
+/// parsing, blocks allocated before the time range that are still live at its
+/// start are kept. Times are in seconds, same as operation times shown in UI.
+//--------------------------------------------------------------------------
+struct LoadFilter
+{
+    double m_minTime;                 ///< Negative to load from the start of capture
+    double m_maxTime;                 ///< Negative to load until the end of capture
+    std::vector<uint64_t> m_threads;  ///< Thread IDs that allocated loaded blocks, empty for all
+    std::vector<uint64_t> m_heaps;    ///< Allocator handles, empty for all
+
+    LoadFilter()
+        : m_minTime(-1.0)
+        , m_maxTime(-1.0)
+    {
+    }
+
+    bool isActive() const
+    {
+        return (m_minTime >= 0.0) || (m_maxTime >= 0.0) || !m_threads.empty() || !m_heaps.empty();
+    }
+};
+
 //--------------------------------------------------------------------------
 /// Memory tracking binary file loader
 //--------------------------------------------------------------------------
 class Capture
 {
 private:
+    struct LoadSink;
+    struct LiveLoad;
+    struct FilterLoad;
+    struct OverviewSink;
+
     std::string m_loadedFile;  ///< Symbol store path
     bool m_swapEndian;
     bool m_64bit;
     rmem::ToolChain::Enum m_toolchain;
-    ChunkAllocator<MemoryOperation> m_operationPool;
     StackAllocator m_stackPool;
-    MemoryOpArray m_operations;
-    MemoryOpArray m_operationsInvalid;
+    MemoryOperations m_operations;     ///< All operations in time order, including invalid ones
+    MemoryOpArray m_operationsInvalid;  ///< Invalid operations reported to the user
     MemoryStats m_statsGlobal;    ///< Memory statistics for global range
     MemoryStats m_statsSnapshot;  ///< Memory statistics for selected snapshot
     std::vector<MemoryStatsTimed> m_timedStats;
     std::vector<rdebug::ModuleInfo> m_moduleInfos;  ///< Module information data
-    StackTraceHashType m_stackTracesHash;  ///< map of stack traces, key is a stack trace hash
+    StackTraceHashType m_stackTracesHash;  ///< Stack trace indices by the hash capture records refer to them with
+    StackTraceStore m_stackFrames;         ///< Frames of all stack traces, shared between traces
+    robin_hood::unordered_map<uintptr_t, uint32_t, uintptr_t_hash, uintptr_t_equal> m_stackTracesByFrame;  ///< Stack trace indices by innermost frame
     std::vector<StackTrace*> m_stackTraces;
     MemoryGroupsHashType m_operationGroups;
-    std::vector<GraphEntry> m_usageGraph;  ///< memory usage graph data
+    std::vector<std::vector<GraphBucket>> m_usageGraph;  ///< memory usage graph pyramid, level 0 has finest buckets
+    uint64_t m_usageBucketTime;                           ///< time span of a bucket in level 0
+    uint32_t m_timedStatsMask;                            ///< timed stats are taken every (mask + 1) operations
     StackTraceTree m_stackTraceTree;       ///< stack trace tree
     MemoryTagTree m_tagTree;               ///< Global tag tree
     MemoryMarkersHashType m_memoryMarkers;
     HeapsType m_Heaps;
+    InternTable m_threadIDs;    ///< Thread IDs of memory operations
+    InternTable m_heapHandles;  ///< Allocator handles of memory operations
     uint64_t m_currentHeap;
     rdebug::ModuleInfo* m_currentModule;
     std::vector<MemoryMarkerTime> m_memoryMarkerTimes;
@@ -80,10 +183,26 @@ private:
     MemoryOpArray m_memoryLeaks;  ///< List of allocations without matching free
     LoadProgress m_loadProgressCallback;
     void* m_loadProgressCustomData;
+    std::atomic<bool> m_loadCancelled;  ///< Set from another thread to stop loading
+    AnalyzeProgress m_analyzeProgressCallback;
+    void* m_analyzeProgressCustomData;
+    ModulesLoaded m_modulesLoadedCallback;
+    void* m_modulesLoadedCustomData;
+    std::atomic<uint32_t> m_analyzedStages;  ///< Analysis stages with complete data, see AnalyzeStage
     uint64_t m_minTime;
     uint64_t m_maxTime;
     bool m_filteringEnabled;
     FilterDescription m_filter;
+    CaptureIndex m_index;       ///< Chunk index of the loaded capture
+    bool m_cacheValid;          ///< Analysis cache next to the capture holds data of the loaded capture
+    bool m_cacheEnabled;        ///< Complete loads are restored from and saved to the analysis cache
+    std::thread m_cacheWriter;  ///< Writes the analysis cache in background, joined before its data changes
+    LiveLoad* m_live;           ///< Parser state of a capture that is still being written, NULL otherwise
+    LoadFilter m_loadFilter;
+    FilterLoad* m_filterLoad;  ///< State of filtered load while parsing, NULL otherwise
+    bool m_overview;           ///< Only global stats and usage graph are loaded, no operations
+    uint32_t m_sampleStep;     ///< Preview loads only every n-th chunk, 1 otherwise
+    double m_sampleScale;      ///< Preview stats and usage are scaled up by it, 1 otherwise
 
 public:
     enum LoadResult
@@ -93,21 +212,113 @@ public:
         LoadPartial
     };
 
+    /// Parts of analysis data built by buildAnalyzeData, each one can be used as soon as it is done
+    enum AnalyzeStage
+    {
+        AnalyzeTags = 1,       ///< Tag tree, heaps and leaks
+        AnalyzeGroups = 2,     ///< Memory operation groups
+        AnalyzeSymbols = 4,    ///< Unique symbol IDs of stack trace frames
+        AnalyzeStackTree = 8,  ///< Call stack tree
+        AnalyzeAll = 15
+    };
+
     Capture();
     ~Capture();
 
-    LoadResult loadBin(const char* _path);
+    /// Live load keeps parser state so that records appended to the capture later can be loaded
+    LoadResult loadBin(const char* _path, bool _live = false);
+    /// Live load of records received by the stream, stream has to outlive the live load
+    LoadResult loadStream(CaptureStream* _stream);
+    /// Quick overview of a capture, global stats and usage graph are computed while parsing
+    /// and no operations are kept, memory needed grows with the number of live blocks only
+    LoadResult loadOverview(const char* _path);
+    bool isOverview() const
+    {
+        return m_overview;
+    }
+    /// Preview of a capture that has a chunk index, only every n-th chunk is loaded.
+    /// Stats and usage graph are scaled up to all operations of the capture and are approximate.
+    LoadResult loadPreview(const char* _path, uint32_t _sampleStep = 16);
+    bool isPreview() const
+    {
+        return m_sampleStep > 1;
+    }
+    uint32_t getSampleStep() const
+    {
+        return m_sampleStep;
+    }
+    const char* getLoadedFile() const
+    {
+        return m_loadedFile.c_str();
+    }
+    /// Loads records appended to a live capture since the last load, returns number of new operations
+    uint32_t loadAppended();
+    /// Stops following a live capture, capture data stays loaded. Returns true if operations
+    /// that arrived late were moved to their place, views showing the capture have to be refreshed.
+    bool endLive();
+    bool isLive() const
+    {
+        return m_live != NULL;
+    }
     void setLoadProgressCallback(void* _cd, LoadProgress _cb)
     {
         m_loadProgressCustomData = _cd;
         m_loadProgressCallback = _cb;
     }
+    /// Called from the loading thread once modules listed in the capture header are read,
+    /// before any records are parsed. Modules loaded later are added while parsing.
+    void setModulesLoadedCallback(void* _cd, ModulesLoaded _cb)
+    {
+        m_modulesLoadedCustomData = _cd;
+        m_modulesLoadedCallback = _cb;
+    }
     void clearData();
+    /// Restricts loadBin to a part of the capture, live loads and streams are always loaded whole.
+    /// Filtered captures are neither indexed nor cached.
+    void setLoadFilter(const LoadFilter& _filter)
+    {
+        m_loadFilter = _filter;
+    }
+    const LoadFilter& getLoadFilter() const
+    {
+        return m_loadFilter;
+    }
+    /// Complete loads of a capture are restored from the analysis cache next to it (.mtcache)
+    /// and write it in background if it's missing. Off by default.
+    void setCacheEnabled(bool _enabled)
+    {
+        m_cacheEnabled = _enabled;
+    }
+    bool isCacheEnabled() const
+    {
+        return m_cacheEnabled;
+    }
+    /// Stops loadBin running on another thread, it returns LoadFail as soon as possible
+    void cancelLoad()
+    {
+        m_loadCancelled = true;
+    }
+    bool isLoadCancelled() const
+    {
+        return m_loadCancelled;
+    }
     bool is64bit()
     {
         return m_64bit;
     }
-    void buildAnalyzeData(uintptr_t _symResolver);
+    /// Symbols hash identifies symbol inputs, analysis data is cached only if it's non zero.
+    /// Stages are built in parallel, progress of each one is reported through the analyze
+    /// progress callback from the thread building it.
+    void buildAnalyzeData(SymbolCache* _symbols, uint64_t _symbolsHash = 0);
+    void setAnalyzeProgressCallback(void* _cd, AnalyzeProgress _cb)
+    {
+        m_analyzeProgressCustomData = _cd;
+        m_analyzeProgressCallback = _cb;
+    }
+    uint32_t getAnalyzedStages() const
+    {
+        return m_analyzedStages;
+    }
 
     std::vector<rdebug::ModuleInfo>& getModuleInfos()
     {
@@ -115,9 +326,10 @@ public:
     }
 
     /// Capture file logging functions
-    bool saveLog(const char* _path, uintptr_t _symResolver);
-    bool saveGroupsLog(const char* _path, eGroupSort _sorting, uintptr_t _symResolver);
-    bool saveGroupsLogXML(const char* _path, eGroupSort _sorting, uintptr_t _symResolver);
+    bool saveLog(const char* _path, SymbolCache* _symbols);
+    bool saveGroupsLog(const char* _path, eGroupSort _sorting, SymbolCache* _symbols);
+    bool saveGroupsLogXML(const char* _path, eGroupSort _sorting, SymbolCache* _symbols);
+    bool saveOverviewLog(const char* _path);
 
     /// Capture file filtering functions
     void setFilteringEnabled(bool inState);
@@ -125,7 +337,7 @@ public:
     {
         return m_filteringEnabled;
     }
-    bool isInFilter(MemoryOperation* _op);
+    bool isInFilter(uint32_t _op);
     void selectHistogramBin(uint32_t _index);
     uint32_t getSelectHistogramBin() const
     {
@@ -155,6 +367,10 @@ public:
     {
         return m_maxTime;
     }
+    uint64_t getCPUFrequency() const
+    {
+        return m_CPUFrequency;
+    }
     float getFloatTime(uint64_t _time)
     {
         return CPU::time(_time, m_CPUFrequency);
@@ -172,6 +388,7 @@ public:
         return m_statsSnapshot;
     }
     void getGraphAtTime(uint64_t _time, GraphEntry& _entry);
+    void getGraphRange(uint64_t _minTime, uint64_t _maxTime, uint32_t _numSamples, GraphBucket* _samples) const;
     const std::vector<MemoryMarkerTime>& getMemoryMarkers() const
     {
         return m_memoryMarkerTimes;
@@ -188,14 +405,23 @@ public:
     {
         return m_filter.m_stackTraceTree;
     }
-    const MemoryOpArray& getMemoryOps() const
+    const MemoryOperations& getMemoryOps() const
     {
         return m_operations;
     }
+    StackTrace* getStackTrace(uint32_t _index) const
+    {
+        return m_stackTraces[_index];
+    }
     const MemoryOpArray& getMemoryOpsInvalid() const
     {
         return m_operationsInvalid;
     }
+    const CaptureIndex& getIndex() const
+    {
+        return m_index;
+    }
+    static std::string getCachePath(const char* _capturePath);
     const MemoryOpArray& getMemoryOpsFiltered() const
     {
         return m_filter.m_operations;
@@ -216,6 +442,14 @@ public:
     {
         return m_Heaps;
     }
+    uint64_t getThreadID(uint32_t _op) const
+    {
+        return m_threadIDs.m_values[m_operations.m_threadIndex[_op]];
+    }
+    uint64_t getHeapHandle(uint32_t _op) const
+    {
+        return m_heapHandles.m_values[m_operations.m_heapIndex[_op]];
+    }
     void setCurrentHeap(uint64_t _handle)
     {
         m_currentHeap = _handle;
@@ -226,20 +460,51 @@ public:
     }
 
 private:
+    bool loadHeader(BinLoader& _loader, uint64_t _fileSize);
     bool loadModuleInfo(BinLoader& _loader, uint64_t inFileSize);
-    bool setLinksAndRemoveInvalid(uint64_t inMinMarkerTime);
+    bool prepareOperations(uint64_t _minMarkerTime);
+    void removeUnownedOperations();
+    void matchSampledOperations();
+    void loadAppendedOperations(BinLoader& _loader, uint64_t _fileSize, uint64_t& _minMarkerTime);
+    bool loadCache(const char* _path);
+    bool saveCache(const char* _path);
+    bool loadAnalyzeCache(uint64_t _symbolsHash);
+    void saveAnalyzeCache(uint64_t _symbolsHash);
+    void waitForCacheWriter();
+    template <bool Is64, bool Swap>
+    bool loadOperations(BinLoader& _loader, uint64_t _fileSize, uint64_t& _minMarkerTime, CaptureIndex* _index);
+    template <bool Is64, bool Swap>
+    bool loadOperationsParallel(const char* _path, uint64_t& _minMarkerTime);
+    template <bool Is64, bool Swap>
+    bool loadOperationsSampled(const char* _path, uint32_t _step, uint64_t& _minMarkerTime);
+    bool mergeRanges(std::vector<RangeSink>& _ranges, uint32_t _numThreads, uint64_t& _minMarkerTime, bool _sampled);
+    uint32_t addStackTrace(uint32_t _hash, uint64_t* _frames, uint32_t _numFrames);
+    void addMemoryMarker(const char* _name, uint32_t _hash, uint32_t _color);
+    void addMemoryMarkerTime(uint32_t _hash, uint64_t _threadID, uint64_t _time);
+    bool setLinksAndFlagInvalid(uint64_t inMinMarkerTime);
     void addModule(const char* inName, uint64_t inModBase, uint64_t inModSize, uint64_t inTimeStamp);
     void removeModule(const char* _path, uint64_t inModBase, uint64_t inModSize, uint64_t inTimeStamp);
-    void calculateGlobalStats();
+    void appendOperations(size_t _first);
+    void relinkOperations(const LiveLoad& _live);
+    void calculateGlobalStats(size_t _first = 0);
+    void buildGraphLevels(size_t _firstChanged);
     void calculateSnapshotStats();
     bool verifyGlobalStats();
     void calculateFilteredData();
-    uint32_t getIndexBefore(uint64_t _time, uint32_t& outTimedIndex) const;
-    uint32_t getIndexAfter(uint64_t _time, uint32_t& outTimedIndex) const;
-    void GetRangedStats(MemoryStats& ioStats, uint32_t inMinIdx, uint32_t inMaxIdx);
+    uint64_t getIndexBefore(uint64_t _time, uint32_t& outTimedIndex) const;
+    void getGraphAtIndex(uint64_t _index, GraphEntry& _entry) const;
+    void getGraphBuckets(size_t _first, size_t _last, GraphBucket& _bucket) const;
+    uint64_t getIndexAfter(uint64_t _time, uint32_t& outTimedIndex) const;
+    void GetRangedStats(MemoryStats& ioStats, uint64_t inMinIdx, uint64_t inMaxIdx);
     void addMemoryTag(char* inTagName, uint32_t _tagHash, uint32_t _parentTagHash);
-    void addToMemoryGroups(MemoryGroupsHashType& ioGroups, MemoryOperation* _op, uint64_t _liveBlocks, uint64_t _liveSize);
-    void addToStackTraceTree(StackTraceTree& ioTree, MemoryOperation* _op, StackTrace::Scope _offset);
+    void setupStackTraces(size_t _first, size_t _firstFrame, SymbolCache* _symbols);
+    void addAnalyzeData(size_t _first);
+    void analyzeTags(size_t _first);
+    void analyzeGroups(size_t _first);
+    void analyzeStackTree(size_t _first);
+    void setAnalyzeStageDone(uint32_t _stages);
+    void addToMemoryGroups(MemoryGroupsHashType& ioGroups, uint32_t _op, uint64_t _liveBlocks, uint64_t _liveSize);
+    void addToStackTraceTree(StackTraceTree& ioTree, uint32_t _op, StackTrace::Scope _offset);
     void writeGlobalStats(FILE* inFile);
 };
 
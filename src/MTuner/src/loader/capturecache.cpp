@@ -0,0 +1,1207 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/capture.h>
+#include <MTuner/src/loader/util.h>
+#include <rbase/inc/winchar.h>
+#include <rdebug/inc/rdebug.h>
+
+namespace rtm
+{
+static const uint32_t s_cacheSignature = 0x4143544d;  // 'MTCA'
+static const uint32_t s_cacheVersion = 6;
+
+/// Size of buffer used for writing cache file
+static const size_t s_cacheWriteBuffer = 4 * 1024 * 1024;
+
+//--------------------------------------------------------------------------
+/// Analysis cache is stored next to the capture. Capture data section holds
+/// everything loadBin produces, analysis section holds everything built by
+/// buildAnalyzeData and is appended later as it depends on symbols. Pointers
+/// are stored as indices, operations are stored by columns in capture order.
+/// Columns are variable length integers, sorted ones and links as deltas.
+//--------------------------------------------------------------------------
+struct CacheHeader
+{
+    uint32_t m_signature;
+    uint32_t m_version;
+    uint64_t m_captureSize;
+    uint64_t m_captureTime;
+    uint64_t m_dataSize;     ///< Size of header and capture data section, analysis data follows
+    uint64_t m_analyzeSize;  ///< Size of analysis data section, zero if there is none
+    uint64_t m_symbolsHash;  ///< Hash of symbol inputs analysis data was built with
+    uint32_t m_statsSize;
+    uint32_t m_timedStatsSize;
+    uint32_t m_bucketSize;
+};
+
+typedef robin_hood::unordered_map<uintptr_t, uint32_t, uintptr_t_hash, uintptr_t_equal> StackTraceIndexType;
+
+static FILE* openCacheFile(const std::string& _path, const char* _mode)
+{
+#if RTM_PLATFORM_WINDOWS
+    rtm::MultiToWide path(_path.c_str());
+    rtm::MultiToWide mode(_mode);
+    return _wfopen(path.m_ptr, mode.m_ptr);
+#else
+    return fopen(_path.c_str(), _mode);
+#endif
+}
+
+static void seekCacheFile(FILE* _file, uint64_t _offset)
+{
+#if RTM_PLATFORM_WINDOWS
+    _fseeki64(_file, (int64_t)_offset, SEEK_SET);
+#elif RTM_PLATFORM_LINUX
+    fseeko64(_file, (off64_t)_offset, SEEK_SET);
+#else
+    fseeko(_file, (off_t)_offset, SEEK_SET);
+#endif
+}
+
+static void initCacheHeader(CacheHeader& _header, uint64_t _captureSize, uint64_t _captureTime)
+{
+    memset(&_header, 0, sizeof(CacheHeader));
+    _header.m_signature = s_cacheSignature;
+    _header.m_version = s_cacheVersion;
+    _header.m_captureSize = _captureSize;
+    _header.m_captureTime = _captureTime;
+    _header.m_statsSize = sizeof(MemoryStats);
+    _header.m_timedStatsSize = sizeof(MemoryStatsTimed);
+    _header.m_bucketSize = sizeof(GraphBucket);
+}
+
+static bool isCacheHeaderValid(const CacheHeader& _header, uint64_t _captureSize, uint64_t _captureTime)
+{
+    CacheHeader expected;
+    initCacheHeader(expected, _captureSize, _captureTime);
+
+    return (_header.m_signature == expected.m_signature) && (_header.m_version == expected.m_version) &&
+           (_header.m_captureSize == expected.m_captureSize) &&
+           (_header.m_captureTime == expected.m_captureTime) &&
+           (_header.m_statsSize == expected.m_statsSize) &&
+           (_header.m_timedStatsSize == expected.m_timedStatsSize) &&
+           (_header.m_bucketSize == expected.m_bucketSize) &&
+           (_header.m_dataSize >= sizeof(CacheHeader));
+}
+
+static inline uint64_t zigzagEncode(uint64_t _delta)
+{
+    return (_delta << 1) ^ (uint64_t)((int64_t)_delta >> 63);
+}
+
+static inline uint64_t zigzagDecode(uint64_t _value)
+{
+    return (_value >> 1) ^ (0 - (_value & 1));
+}
+
+//--------------------------------------------------------------------------
+/// Buffered sequential writer of cache data, without a file data is kept
+/// in the buffer
+//--------------------------------------------------------------------------
+class CacheWriter
+{
+    FILE* m_file;
+    std::vector<uint8_t> m_buffer;
+    uint64_t m_written;
+    bool m_valid;
+
+public:
+    CacheWriter(FILE* _file)
+        : m_file(_file)
+        , m_written(0)
+        , m_valid(true)
+    {
+        m_buffer.reserve(s_cacheWriteBuffer);
+    }
+
+    void write(const void* _data, size_t _size)
+    {
+        if (m_file && (m_buffer.size() + _size > s_cacheWriteBuffer))
+            flush();
+
+        if (m_file && (_size > s_cacheWriteBuffer))
+        {
+            m_valid = m_valid && (fwrite(_data, 1, _size, m_file) == _size);
+            m_written += _size;
+            return;
+        }
+
+        const uint8_t* data = (const uint8_t*)_data;
+        m_buffer.insert(m_buffer.end(), data, data + _size);
+        m_written += _size;
+    }
+
+    template <typename T>
+    void writeVar(const T& _var)
+    {
+        write(&_var, sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(const std::vector<T>& _array)
+    {
+        writeVar((uint64_t)_array.size());
+        if (_array.size())
+            write(&_array[0], _array.size() * sizeof(T));
+    }
+
+    /// 7 bits per byte, high bit is set if more bytes follow
+    void writeVarint(uint64_t _value)
+    {
+        uint8_t data[10];
+        size_t size = 0;
+        while (_value >= 0x80)
+        {
+            data[size++] = (uint8_t)(_value | 0x80);
+            _value >>= 7;
+        }
+        data[size++] = (uint8_t)_value;
+        write(data, size);
+    }
+
+    template <typename T>
+    void writeVarintArray(const std::vector<T>& _array)
+    {
+        writeVar((uint64_t)_array.size());
+        for (size_t i = 0; i < _array.size(); ++i)
+            writeVarint((uint64_t)_array[i]);
+    }
+
+    /// Stores differences of consecutive values, small for sorted and clustered columns
+    template <typename T>
+    void writeDeltaArray(const std::vector<T>& _array)
+    {
+        writeVar((uint64_t)_array.size());
+        uint64_t previous = 0;
+        for (size_t i = 0; i < _array.size(); ++i)
+        {
+            writeVarint(zigzagEncode((uint64_t)_array[i] - previous));
+            previous = (uint64_t)_array[i];
+        }
+    }
+
+    /// Operation links are stored relative to the operation, zero is no link
+    void writeLinkArray(const std::vector<uint32_t>& _links)
+    {
+        writeVar((uint64_t)_links.size());
+        for (size_t i = 0; i < _links.size(); ++i)
+        {
+            const uint32_t link = _links[i];
+            writeVarint((link == MemoryOperations::NoOperation) ? 0 : zigzagEncode((uint64_t)link - i) + 1);
+        }
+    }
+
+    void writeString(const std::string& _string)
+    {
+        writeVar((uint32_t)_string.length());
+        write(_string.c_str(), _string.length());
+    }
+
+    void flush()
+    {
+        if (m_file && m_buffer.size())
+            m_valid = m_valid && (fwrite(&m_buffer[0], 1, m_buffer.size(), m_file) == m_buffer.size());
+        m_buffer.clear();
+    }
+
+    uint64_t getWritten() const { return m_written; }
+    bool isValid() const { return m_valid; }
+    std::vector<uint8_t>& getBuffer() { return m_buffer; }
+};
+
+//--------------------------------------------------------------------------
+/// Bounds checked reader of memory mapped cache data
+//--------------------------------------------------------------------------
+class CacheReader
+{
+    const uint8_t* m_data;
+    uint64_t m_size;
+    uint64_t m_position;
+    bool m_valid;
+
+public:
+    CacheReader(const uint8_t* _data, uint64_t _size, uint64_t _position)
+        : m_data(_data)
+        , m_size(_size)
+        , m_position(_position)
+        , m_valid(_position <= _size)
+    {
+    }
+
+    /// Returns pointer to next _size bytes and moves past them, NULL if there's not enough data
+    const uint8_t* skip(uint64_t _size)
+    {
+        if (!m_valid || (m_size - m_position < _size))
+        {
+            m_valid = false;
+            return NULL;
+        }
+
+        const uint8_t* data = m_data + m_position;
+        m_position += _size;
+        return data;
+    }
+
+    bool read(void* _data, uint64_t _size)
+    {
+        const uint8_t* data = skip(_size);
+        if (data)
+            memcpy(_data, data, (size_t)_size);
+        return data != NULL;
+    }
+
+    template <typename T>
+    bool readVar(T& _var)
+    {
+        return read(&_var, sizeof(T));
+    }
+
+    template <typename T>
+    bool readArray(std::vector<T>& _array)
+    {
+        uint64_t count = 0;
+        if (!readVar(count) || (count > (m_size - m_position) / sizeof(T)))
+        {
+            m_valid = false;
+            return false;
+        }
+
+        _array.resize((size_t)count);
+        return count ? read(&_array[0], count * sizeof(T)) : true;
+    }
+
+    bool readVarint(uint64_t& _value)
+    {
+        _value = 0;
+        for (uint32_t shift = 0; m_valid && (shift < 64) && (m_position < m_size); shift += 7)
+        {
+            const uint8_t data = m_data[m_position++];
+            _value |= (uint64_t)(data & 0x7f) << shift;
+            if (!(data & 0x80))
+                return true;
+        }
+
+        m_valid = false;
+        return false;
+    }
+
+    template <typename T>
+    bool readVarintArray(std::vector<T>& _array)
+    {
+        if (!readArraySize(_array))
+            return false;
+
+        for (size_t i = 0; i < _array.size(); ++i)
+        {
+            uint64_t value = 0;
+            if (!readVarint(value) || (value > (uint64_t)(T)-1))
+                return invalidate();
+            _array[i] = (T)value;
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool readDeltaArray(std::vector<T>& _array)
+    {
+        if (!readArraySize(_array))
+            return false;
+
+        uint64_t previous = 0;
+        for (size_t i = 0; i < _array.size(); ++i)
+        {
+            uint64_t delta = 0;
+            if (!readVarint(delta))
+                return false;
+            previous += zigzagDecode(delta);
+            if (previous > (uint64_t)(T)-1)
+                return invalidate();
+            _array[i] = (T)previous;
+        }
+        return true;
+    }
+
+    /// Links are only decoded here, range is checked with the rest of operation data
+    bool readLinkArray(std::vector<uint32_t>& _links)
+    {
+        if (!readArraySize(_links))
+            return false;
+
+        for (size_t i = 0; i < _links.size(); ++i)
+        {
+            uint64_t value = 0;
+            if (!readVarint(value))
+                return false;
+            _links[i] = value ? (uint32_t)(i + zigzagDecode(value - 1)) : MemoryOperations::NoOperation;
+        }
+        return true;
+    }
+
+    bool readString(std::string& _string)
+    {
+        uint32_t length = 0;
+        const uint8_t* data = readVar(length) ? skip(length) : NULL;
+        if (data)
+            _string.assign((const char*)data, length);
+        return data != NULL;
+    }
+
+    bool isValid() const { return m_valid; }
+
+private:
+    bool invalidate()
+    {
+        m_valid = false;
+        return false;
+    }
+
+    /// Every varint takes at least a byte, larger counts can't be valid
+    template <typename T>
+    bool readArraySize(std::vector<T>& _array)
+    {
+        uint64_t count = 0;
+        if (!readVar(count) || (count > m_size - m_position))
+            return invalidate();
+
+        _array.resize((size_t)count);
+        return true;
+    }
+};
+
+//--------------------------------------------------------------------------
+/// Memory mapped cache file
+//--------------------------------------------------------------------------
+class CacheMapping
+{
+    QFile m_file;
+    uchar* m_data;
+    uint64_t m_size;
+
+public:
+    CacheMapping(const std::string& _path)
+        : m_file(QString::fromUtf8(_path.c_str()))
+        , m_data(NULL)
+        , m_size(0)
+    {
+        if (!m_file.open(QIODevice::ReadOnly))
+            return;
+
+        m_size = (uint64_t)m_file.size();
+        if (m_size >= sizeof(CacheHeader))
+            m_data = m_file.map(0, (qint64)m_size);
+    }
+
+    ~CacheMapping()
+    {
+        if (m_data)
+            m_file.unmap(m_data);
+    }
+
+    const uint8_t* getData() const { return m_data; }
+    uint64_t getSize() const { return m_data ? m_size : 0; }
+};
+
+//--------------------------------------------------------------------------
+/// Tag tree is stored depth first, children follow their parent
+//--------------------------------------------------------------------------
+static void writeTagTree(CacheWriter& _writer, const MemoryTagTree& _tag)
+{
+    _writer.writeVar(_tag.m_hash);
+    _writer.writeString(_tag.m_name);
+    _writer.writeVar(_tag.m_usage);
+    _writer.writeVar(_tag.m_usagePeak);
+    _writer.writeVar(_tag.m_overhead);
+    _writer.writeVar(_tag.m_overheadPeak);
+    _writer.write(_tag.m_operationCount, sizeof(_tag.m_operationCount));
+    _writer.writeVar((uint32_t)_tag.m_children.size());
+
+    MemoryTagTree::ChildMap::const_iterator it = _tag.m_children.begin();
+    MemoryTagTree::ChildMap::const_iterator end = _tag.m_children.end();
+    for (; it != end; ++it)
+        writeTagTree(_writer, *it->second);
+}
+
+static bool readTagTree(CacheReader& _reader, MemoryTagTree& _tag)
+{
+    uint32_t numChildren = 0;
+
+    _reader.readVar(_tag.m_hash);
+    _reader.readString(_tag.m_name);
+    _reader.readVar(_tag.m_usage);
+    _reader.readVar(_tag.m_usagePeak);
+    _reader.readVar(_tag.m_overhead);
+    _reader.readVar(_tag.m_overheadPeak);
+    _reader.read(_tag.m_operationCount, sizeof(_tag.m_operationCount));
+    _reader.readVar(numChildren);
+
+    for (uint32_t i = 0; (i < numChildren) && _reader.isValid(); ++i)
+    {
+        MemoryTagTree* child = new MemoryTagTree();
+        child->m_parent = &_tag;
+        const bool childValid = readTagTree(_reader, *child);
+        _tag.m_children[child->m_hash] = child;
+        if (!childValid)
+            return false;
+    }
+
+    return _reader.isValid();
+}
+
+//--------------------------------------------------------------------------
+/// Stack trace tree is stored depth first, stack trace lists as indices
+//--------------------------------------------------------------------------
+static void writeStackTraceTree(CacheWriter& _writer,
+                                const StackTraceTree& _node,
+                                const StackTraceIndexType& _traceIndices)
+{
+    const uint32_t traceIndex =
+        _node.m_stackTraceList ? _traceIndices.find((uintptr_t)_node.m_stackTraceList)->second + 1 : 0;
+
+    _writer.writeVar(_node.m_addressID);
+    _writer.writeVar(_node.m_memUsage);
+    _writer.writeVar(_node.m_memUsagePeak);
+    _writer.writeVar(_node.m_minTime);
+    _writer.writeVar(_node.m_maxTime);
+    _writer.writeVar(_node.m_overhead);
+    _writer.writeVar(_node.m_overheadPeak);
+    _writer.writeVar(_node.m_depth);
+    _writer.write(_node.m_opCount, sizeof(_node.m_opCount));
+    _writer.writeVar(traceIndex);
+    _writer.writeVar((uint32_t)_node.m_children.size());
+
+    for (size_t i = 0; i < _node.m_children.size(); ++i)
+        writeStackTraceTree(_writer, _node.m_children[i], _traceIndices);
+}
+
+static bool readStackTraceTree(CacheReader& _reader,
+                               StackTraceTree& _node,
+                               const std::vector<StackTrace*>& _traces)
+{
+    uint32_t traceIndex = 0;
+    uint32_t numChildren = 0;
+
+    _reader.readVar(_node.m_addressID);
+    _reader.readVar(_node.m_memUsage);
+    _reader.readVar(_node.m_memUsagePeak);
+    _reader.readVar(_node.m_minTime);
+    _reader.readVar(_node.m_maxTime);
+    _reader.readVar(_node.m_overhead);
+    _reader.readVar(_node.m_overheadPeak);
+    _reader.readVar(_node.m_depth);
+    _reader.read(_node.m_opCount, sizeof(_node.m_opCount));
+    _reader.readVar(traceIndex);
+    _reader.readVar(numChildren);
+
+    if (!_reader.isValid() || (traceIndex > _traces.size()))
+        return false;
+
+    _node.m_stackTraceList = traceIndex ? _traces[traceIndex - 1] : NULL;
+
+    // children are never added later, their addresses stay valid for parent links
+    _node.m_children.resize(numChildren);
+    for (uint32_t i = 0; i < numChildren; ++i)
+    {
+        _node.m_children[i].m_parent = &_node;
+        if (!readStackTraceTree(_reader, _node.m_children[i], _traces))
+            return false;
+    }
+
+    return true;
+}
+
+/// Collects stack trace list links of every tree node, each trace gets numFrames+1 slots.
+/// Root list gets a trace once per operation and links back into itself, only its head is kept.
+static void getStackTraceLinks(const StackTraceTree& _node,
+                               const StackTraceIndexType& _traceIndices,
+                               const std::vector<uint64_t>& _linkOffsets,
+                               std::vector<uint32_t>& _links)
+{
+    const uint32_t depth = (uint32_t)_node.m_depth;
+
+    StackTrace* trace = depth ? _node.m_stackTraceList : NULL;
+    while (trace)
+    {
+        StackTrace* next = StackTrace::getNextArray(trace)[depth];
+        const uint32_t traceIndex = _traceIndices.find((uintptr_t)trace)->second;
+        _links[(size_t)(_linkOffsets[traceIndex] + depth)] =
+            next ? _traceIndices.find((uintptr_t)next)->second + 1 : 0;
+        trace = next;
+    }
+
+    for (size_t i = 0; i < _node.m_children.size(); ++i)
+        getStackTraceLinks(_node.m_children[i], _traceIndices, _linkOffsets, _links);
+}
+
+//--------------------------------------------------------------------------
+/// Returns analysis cache path for the given capture
+//--------------------------------------------------------------------------
+std::string Capture::getCachePath(const char* _capturePath)
+{
+    return std::string(_capturePath) + ".mtcache";
+}
+
+//--------------------------------------------------------------------------
+/// Restores everything loadBin produces from the cache, fails if the cache
+/// is missing or doesn't match the capture
+//--------------------------------------------------------------------------
+bool Capture::loadCache(const char* _path)
+{
+    uint64_t captureSize, captureTime;
+    if (!CaptureIndex::getCaptureInfo(_path, captureSize, captureTime))
+        return false;
+
+    CacheMapping mapping(getCachePath(_path));
+
+    CacheHeader header;
+    CacheReader headerReader(mapping.getData(), mapping.getSize(), 0);
+    if (!headerReader.readVar(header) || !isCacheHeaderValid(header, captureSize, captureTime) ||
+        (header.m_dataSize > mapping.getSize()))
+        return false;
+
+    if (m_loadProgressCallback)
+        m_loadProgressCallback(m_loadProgressCustomData, 0.0f, "Loading cached capture data...");
+
+    CacheReader reader(mapping.getData(), header.m_dataSize, sizeof(CacheHeader));
+
+    uint8_t toolchain = 0;
+    uint8_t is64bit = 0;
+    uint8_t swapEndian = 0;
+    reader.readVar(toolchain);
+    reader.readVar(is64bit);
+    reader.readVar(swapEndian);
+    reader.readVar(m_CPUFrequency);
+    m_toolchain = (rmem::ToolChain::Enum)toolchain;
+    m_64bit = is64bit != 0;
+    m_swapEndian = swapEndian != 0;
+
+    // modules
+    uint32_t numModules = 0;
+    reader.readVar(numModules);
+    for (uint32_t i = 0; (i < numModules) && reader.isValid(); ++i)
+    {
+        uint32_t toolchainType = 0;
+        std::string path;
+        rdebug::ModuleInfo info;
+        reader.readString(path);
+        reader.readVar(info.m_baseAddress);
+        reader.readVar(info.m_size);
+        reader.readVar(info.m_loadTime);
+        reader.readVar(info.m_unloadTime);
+        reader.readVar(toolchainType);
+        info.m_toolchain.m_type = (rdebug::Toolchain::Type)toolchainType;
+        rtm::strlCpy(info.m_modulePath, RTM_NUM_ELEMENTS(info.m_modulePath), path.c_str());
+        m_moduleInfos.push_back(info);
+    }
+
+    reader.readArray(m_threadIDs.m_values);
+    reader.readArray(m_heapHandles.m_values);
+    for (size_t i = 0; i < m_threadIDs.m_values.size(); ++i)
+        m_threadIDs.m_indices[m_threadIDs.m_values[i]] = (uint32_t)i;
+    for (size_t i = 0; i < m_heapHandles.m_values.size(); ++i)
+        m_heapHandles.m_indices[m_heapHandles.m_values[i]] = (uint32_t)i;
+
+    // stack trace frames, every frame comes after its calling frame
+    uint32_t numFrames = 0;
+    uint64_t address = 0;
+    reader.readVar(numFrames);
+    for (uint32_t i = 0; (i < numFrames) && reader.isValid(); ++i)
+    {
+        uint64_t parentDistance = 0;
+        uint64_t addressDelta = 0;
+        reader.readVarint(parentDistance);
+        reader.readVarint(addressDelta);
+        if (parentDistance > i)
+            return false;
+
+        address += zigzagDecode(addressDelta);
+        StackTraceNode* parentFrame = parentDistance ? m_stackFrames.getNode(i - (size_t)parentDistance) : NULL;
+        if (parentFrame && (parentFrame->m_depth >= StackTrace::MaxFrames))
+            return false;
+
+        m_stackFrames.add(parentFrame, address);
+    }
+
+    // stack traces, stored before call stack trimming done by analysis
+    uint32_t numStackTraces = 0;
+    reader.readVar(numStackTraces);
+    m_stackTraces.reserve(reader.isValid() ? numStackTraces : 0);
+    for (uint32_t i = 0; (i < numStackTraces) && reader.isValid(); ++i)
+    {
+        uint64_t frame = 0;
+        reader.readVarint(frame);
+        if (frame > m_stackFrames.getNumNodes())
+            return false;
+
+        StackTraceNode* leaf = frame ? m_stackFrames.getNode((size_t)frame - 1) : NULL;
+        StackTrace* st = (StackTrace*)m_stackPool.alloc(StackTrace::calculateSize(leaf ? leaf->m_depth : 0));
+        StackTrace::init(st, leaf);
+        m_stackTraces.push_back(st);
+    }
+
+    // operations, links are operation indices
+    MemoryOperations& ops = m_operations;
+    reader.readDeltaArray(ops.m_time);
+    reader.readDeltaArray(ops.m_pointer);
+    reader.readVarintArray(ops.m_allocSize);
+    reader.readVarintArray(ops.m_overhead);
+    reader.readVarintArray(ops.m_stackTrace);
+    reader.readVarintArray(ops.m_threadIndex);
+    reader.readVarintArray(ops.m_heapIndex);
+    reader.readLinkArray(ops.m_chainPrev);
+    reader.readLinkArray(ops.m_chainNext);
+    reader.readVarintArray(ops.m_tag);
+    reader.readArray(ops.m_type);
+    reader.readArray(ops.m_alignment);
+    reader.readDeltaArray(m_operationsInvalid);
+
+    const size_t numOps = ops.size();
+    if (!reader.isValid() || (numOps > MemoryOperations::MaxOperations) || (ops.m_pointer.size() != numOps) ||
+        (ops.m_allocSize.size() != numOps) || (ops.m_overhead.size() != numOps) ||
+        (ops.m_stackTrace.size() != numOps) || (ops.m_threadIndex.size() != numOps) ||
+        (ops.m_heapIndex.size() != numOps) || (ops.m_chainPrev.size() != numOps) ||
+        (ops.m_chainNext.size() != numOps) || (ops.m_tag.size() != numOps) || (ops.m_type.size() != numOps) ||
+        (ops.m_alignment.size() != numOps))
+        return false;
+
+    const size_t numThreadIDs = m_threadIDs.m_values.size();
+    const size_t numHeaps = m_heapHandles.m_values.size();
+    for (size_t i = 0; i < numOps; ++i)
+    {
+        if (((ops.m_chainPrev[i] >= numOps) && (ops.m_chainPrev[i] != MemoryOperations::NoOperation)) ||
+            ((ops.m_chainNext[i] >= numOps) && (ops.m_chainNext[i] != MemoryOperations::NoOperation)) ||
+            (ops.m_stackTrace[i] >= numStackTraces) || (ops.m_threadIndex[i] >= numThreadIDs) ||
+            (ops.m_heapIndex[i] >= numHeaps))
+            return false;
+    }
+
+    for (size_t i = 0; i < m_operationsInvalid.size(); ++i)
+        if (m_operationsInvalid[i] >= numOps)
+            return false;
+
+    // global stats and usage graph
+    uint64_t numGraphLevels = 0;
+    reader.readVar(m_minTime);
+    reader.readVar(m_maxTime);
+    reader.readVar(m_statsGlobal);
+    reader.readArray(m_timedStats);
+    reader.readVar(m_usageBucketTime);
+    reader.readVar(m_timedStatsMask);
+    reader.readVar(numGraphLevels);
+    if (reader.isValid() && (numGraphLevels < 64))
+    {
+        m_usageGraph.resize((size_t)numGraphLevels);
+        for (size_t i = 0; i < m_usageGraph.size(); ++i)
+            reader.readArray(m_usageGraph[i]);
+    }
+
+    m_statsSnapshot = m_statsGlobal;
+    m_filter.m_minTimeSnapshot = m_minTime;
+    m_filter.m_maxTimeSnapshot = m_maxTime;
+
+    // memory markers, events are added first so marker times can point to them
+    uint32_t numMarkers = 0;
+    reader.readVar(numMarkers);
+    for (uint32_t i = 0; (i < numMarkers) && reader.isValid(); ++i)
+    {
+        MemoryMarkerEvent me;
+        reader.readVar(me.m_nameHash);
+        reader.readVar(me.m_color);
+        reader.readString(me.m_name);
+        m_memoryMarkers[me.m_nameHash] = me;
+    }
+
+    uint64_t numMarkerTimes = 0;
+    reader.readVar(numMarkerTimes);
+    for (uint64_t i = 0; (i < numMarkerTimes) && reader.isValid(); ++i)
+    {
+        uint32_t hash = 0;
+        MemoryMarkerTime mt;
+        reader.readVar(mt.m_threadID);
+        reader.readVar(mt.m_time);
+        reader.readVar(hash);
+
+        MemoryMarkersHashType::iterator it = m_memoryMarkers.find(hash);
+        if (it == m_memoryMarkers.end())
+            return false;
+
+        mt.m_event = &it->second;
+        m_memoryMarkerTimes.push_back(mt);
+    }
+
+    uint32_t numHeaps32 = 0;
+    reader.readVar(numHeaps32);
+    for (uint32_t i = 0; (i < numHeaps32) && reader.isValid(); ++i)
+    {
+        uint64_t handle = 0;
+        reader.readVar(handle);
+        reader.readString(m_Heaps[handle]);
+    }
+
+    if (!reader.isValid() || !readTagTree(reader, m_tagTree))
+        return false;
+
+    // chunk index is a separate sidecar, it's only used for partial loads
+    m_index.load(_path);
+
+    return numOps && (m_timedStats.size() > 1) && m_usageGraph.size();
+}
+
+//--------------------------------------------------------------------------
+/// Writes capture data section of the cache, analysis section is added
+/// by saveAnalyzeCache once symbols are available
+//--------------------------------------------------------------------------
+bool Capture::saveCache(const char* _path)
+{
+    uint64_t captureSize, captureTime;
+    if (!CaptureIndex::getCaptureInfo(_path, captureSize, captureTime))
+        return false;
+
+    const std::string cachePath = getCachePath(_path);
+    FILE* f = openCacheFile(cachePath, "wb");
+    if (!f)
+        return false;
+
+    CacheHeader header;
+    initCacheHeader(header, captureSize, captureTime);
+
+    CacheWriter writer(f);
+    writer.writeVar(header);
+
+    writer.writeVar((uint8_t)m_toolchain);
+    writer.writeVar((uint8_t)(m_64bit ? 1 : 0));
+    writer.writeVar((uint8_t)(m_swapEndian ? 1 : 0));
+    writer.writeVar(m_CPUFrequency);
+
+    // modules
+    writer.writeVar((uint32_t)m_moduleInfos.size());
+    for (size_t i = 0; i < m_moduleInfos.size(); ++i)
+    {
+        const rdebug::ModuleInfo& info = m_moduleInfos[i];
+        writer.writeString(info.m_modulePath);
+        writer.writeVar(info.m_baseAddress);
+        writer.writeVar(info.m_size);
+        writer.writeVar(info.m_loadTime);
+        writer.writeVar(info.m_unloadTime);
+        writer.writeVar((uint32_t)info.m_toolchain.m_type);
+    }
+
+    writer.writeArray(m_threadIDs.m_values);
+    writer.writeArray(m_heapHandles.m_values);
+
+    // stack trace frames, parents are stored as distance back to them so zero is no frame
+    const size_t numFrames = m_stackFrames.getNumNodes();
+    StackTraceIndexType frameIndices;
+    frameIndices.reserve(numFrames);
+    writer.writeVar((uint32_t)numFrames);
+    uint64_t address = 0;
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        const StackTraceNode* frame = m_stackFrames.getNode(i);
+        writer.writeVarint(frame->m_parent ? i - frameIndices[(uintptr_t)frame->m_parent] : 0);
+        writer.writeVarint(zigzagEncode(frame->m_address - address));
+        frameIndices[(uintptr_t)frame] = (uint32_t)i;
+        address = frame->m_address;
+    }
+
+    // stack traces
+    StackTraceIndexType traceIndices;
+    traceIndices.reserve(m_stackTraces.size());
+    writer.writeVar((uint32_t)m_stackTraces.size());
+    for (size_t i = 0; i < m_stackTraces.size(); ++i)
+    {
+        const StackTrace* st = m_stackTraces[i];
+        writer.writeVarint(st->m_frame ? frameIndices[(uintptr_t)st->m_frame] + 1 : 0);
+        traceIndices[(uintptr_t)st] = (uint32_t)i;
+    }
+
+    // operations, links are operation indices
+    const MemoryOperations& ops = m_operations;
+    writer.writeDeltaArray(ops.m_time);
+    writer.writeDeltaArray(ops.m_pointer);
+    writer.writeVarintArray(ops.m_allocSize);
+    writer.writeVarintArray(ops.m_overhead);
+    writer.writeVarintArray(ops.m_stackTrace);
+    writer.writeVarintArray(ops.m_threadIndex);
+    writer.writeVarintArray(ops.m_heapIndex);
+    writer.writeLinkArray(ops.m_chainPrev);
+    writer.writeLinkArray(ops.m_chainNext);
+    writer.writeVarintArray(ops.m_tag);
+    writer.writeArray(ops.m_type);
+    writer.writeArray(ops.m_alignment);
+    writer.writeDeltaArray(m_operationsInvalid);
+
+    // global stats and usage graph
+    writer.writeVar(m_minTime);
+    writer.writeVar(m_maxTime);
+    writer.writeVar(m_statsGlobal);
+    writer.writeArray(m_timedStats);
+    writer.writeVar(m_usageBucketTime);
+    writer.writeVar(m_timedStatsMask);
+    writer.writeVar((uint64_t)m_usageGraph.size());
+    for (size_t i = 0; i < m_usageGraph.size(); ++i)
+        writer.writeArray(m_usageGraph[i]);
+
+    // memory markers
+    writer.writeVar((uint32_t)m_memoryMarkers.size());
+    MemoryMarkersHashType::const_iterator marker = m_memoryMarkers.begin();
+    for (; marker != m_memoryMarkers.end(); ++marker)
+    {
+        writer.writeVar(marker->second.m_nameHash);
+        writer.writeVar(marker->second.m_color);
+        writer.writeString(marker->second.m_name);
+    }
+
+    writer.writeVar((uint64_t)m_memoryMarkerTimes.size());
+    for (size_t i = 0; i < m_memoryMarkerTimes.size(); ++i)
+    {
+        const MemoryMarkerTime& mt = m_memoryMarkerTimes[i];
+        writer.writeVar(mt.m_threadID);
+        writer.writeVar(mt.m_time);
+        writer.writeVar(mt.m_event->m_nameHash);
+    }
+
+    writer.writeVar((uint32_t)m_Heaps.size());
+    HeapsType::const_iterator heap = m_Heaps.begin();
+    for (; heap != m_Heaps.end(); ++heap)
+    {
+        writer.writeVar(heap->first);
+        writer.writeString(heap->second);
+    }
+
+    writeTagTree(writer, m_tagTree);
+
+    writer.flush();
+
+    // header goes last so an interrupted write is never mistaken for a valid cache
+    header.m_dataSize = writer.getWritten();
+    bool written = writer.isValid();
+    if (written)
+    {
+        seekCacheFile(f, 0);
+        written = fwrite(&header, sizeof(header), 1, f) == 1;
+    }
+
+    fclose(f);
+
+    if (!written)
+        QFile::remove(QString::fromUtf8(cachePath.c_str()));
+
+    return written;
+}
+
+static bool areIndicesValid(const std::vector<uint32_t>& _indices, size_t _count)
+{
+    for (size_t i = 0; i < _indices.size(); ++i)
+        if (_indices[i] >= _count)
+            return false;
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Restores analysis data if the cache holds it for the same symbol inputs
+//--------------------------------------------------------------------------
+bool Capture::loadAnalyzeCache(uint64_t _symbolsHash)
+{
+    uint64_t captureSize, captureTime;
+    if (!CaptureIndex::getCaptureInfo(m_loadedFile.c_str(), captureSize, captureTime))
+        return false;
+
+    CacheMapping mapping(getCachePath(m_loadedFile.c_str()));
+
+    CacheHeader header;
+    CacheReader headerReader(mapping.getData(), mapping.getSize(), 0);
+    if (!headerReader.readVar(header) || !isCacheHeaderValid(header, captureSize, captureTime) ||
+        (header.m_analyzeSize == 0) || (header.m_symbolsHash != _symbolsHash) ||
+        (header.m_dataSize + header.m_analyzeSize > mapping.getSize()))
+        return false;
+
+    if (m_loadProgressCallback)
+        m_loadProgressCallback(m_loadProgressCustomData, 0.0f, "Loading cached analysis data...");
+
+    const uint64_t analyzeEnd = header.m_dataSize + header.m_analyzeSize;
+    const size_t frameSize = sizeof(uint64_t) + sizeof(uint16_t) * 2;
+    const size_t numOps = m_operations.size();
+
+    // whole section is read into temporaries first, capture is changed only if all of it is valid
+    uint32_t numFrames = 0;
+    uint32_t numStackTraces = 0;
+    CacheReader reader(mapping.getData(), analyzeEnd, header.m_dataSize);
+    reader.readVar(numFrames);
+    if (numFrames != m_stackFrames.getNumNodes())
+        return false;
+
+    const uint8_t* frames = reader.skip((uint64_t)numFrames * frameSize);
+    reader.readVar(numStackTraces);
+    if (!frames || (numStackTraces != m_stackTraces.size()))
+        return false;
+
+    // analysis trims innermost frames without symbols
+    std::vector<uint32_t> traceFrames(numStackTraces);
+    std::vector<const uint8_t*> traceAdded(numStackTraces);
+    std::vector<uint32_t> traceLinks;
+    for (uint32_t i = 0; (i < numStackTraces) && reader.isValid(); ++i)
+    {
+        uint64_t numTraceFrames = 0;
+        reader.readVarint(numTraceFrames);
+        if (numTraceFrames > m_stackTraces[i]->m_numFrames)
+            return false;
+
+        traceFrames[i] = (uint32_t)numTraceFrames;
+        traceAdded[i] = reader.skip(sizeof(m_stackTraces[i]->m_addedToTree));
+        for (uint32_t j = 0; (j <= traceFrames[i]) && reader.isValid(); ++j)
+        {
+            uint64_t link = 0;
+            reader.readVarint(link);
+            if (link > numStackTraces)
+                return false;
+            traceLinks.push_back((uint32_t)link);
+        }
+    }
+
+    // operations, tags are inherited along chains during analysis
+    std::vector<uint16_t> tags;
+    MemoryOpArray leaks;
+    reader.readVarintArray(tags);
+    reader.readDeltaArray(leaks);
+    if (!reader.isValid() || (tags.size() != numOps) || !areIndicesValid(leaks, numOps))
+        return false;
+
+    // groups, keyed by stack trace index
+    MemoryGroupsHashType groups;
+    uint64_t numGroups = 0;
+    reader.readVar(numGroups);
+    for (uint64_t i = 0; (i < numGroups) && reader.isValid(); ++i)
+    {
+        uint64_t traceIndex = 0;
+        reader.readVarint(traceIndex);
+        if (traceIndex >= numStackTraces)
+            return false;
+
+        MemoryOperationGroup& group = groups[(uint32_t)traceIndex];
+        reader.readVar(group.m_minSize);
+        reader.readVar(group.m_maxSize);
+        reader.readVar(group.m_peakSize);
+        reader.readVar(group.m_peakSizeGlobal);
+        reader.readVar(group.m_liveSize);
+        reader.readVar(group.m_count);
+        reader.readVar(group.m_liveCount);
+        reader.readVar(group.m_liveCountPeak);
+        reader.readVar(group.m_liveCountPeakGlobal);
+        reader.read(group.m_histogram, sizeof(group.m_histogram));
+        reader.read(group.m_histogramPeak, sizeof(group.m_histogramPeak));
+        reader.readDeltaArray(group.m_operations);
+        if (!areIndicesValid(group.m_operations, numOps))
+            return false;
+    }
+
+    StackTraceTree stackTraceTree;
+    MemoryTagTree tagTree;
+    bool loaded = reader.isValid() && readStackTraceTree(reader, stackTraceTree, m_stackTraces) &&
+                  readTagTree(reader, tagTree);
+
+    HeapsType heaps;
+    uint32_t numHeaps = 0;
+    reader.readVar(numHeaps);
+    for (uint32_t i = 0; (i < numHeaps) && reader.isValid(); ++i)
+    {
+        uint64_t handle = 0;
+        reader.readVar(handle);
+        reader.readString(heaps[handle]);
+    }
+
+    if (!loaded || !reader.isValid())
+    {
+        destroyStackTree(stackTraceTree);
+        tagTreeDestroy(tagTree);
+        return false;
+    }
+
+    // commit
+    for (uint32_t i = 0; i < numFrames; ++i)
+    {
+        StackTraceNode* frame = m_stackFrames.getNode(i);
+        const uint8_t* data = frames + i * frameSize;
+        memcpy(&frame->m_addressID, data, sizeof(uint64_t));
+        memcpy(frame->m_treeIndex, data + sizeof(uint64_t), sizeof(uint16_t) * 2);
+    }
+
+    size_t link = 0;
+    for (uint32_t i = 0; i < numStackTraces; ++i)
+    {
+        StackTrace* st = m_stackTraces[i];
+        while (st->m_numFrames > traceFrames[i])
+        {
+            st->m_frame = st->m_frame->m_parent;
+            --st->m_numFrames;
+        }
+        memcpy(st->m_addedToTree, traceAdded[i], sizeof(st->m_addedToTree));
+
+        StackTrace** next = StackTrace::getNextArray(st);
+        for (uint32_t j = 0; j <= traceFrames[i]; ++j, ++link)
+            next[j] = traceLinks[link] ? m_stackTraces[traceLinks[link] - 1] : NULL;
+    }
+
+    m_operations.m_tag.swap(tags);
+    m_memoryLeaks.swap(leaks);
+    m_operationGroups.swap(groups);
+
+    // roots are moved, their children have to link back to them
+    destroyStackTree(m_stackTraceTree);
+    m_stackTraceTree = std::move(stackTraceTree);
+    for (size_t i = 0; i < m_stackTraceTree.m_children.size(); ++i)
+        m_stackTraceTree.m_children[i].m_parent = &m_stackTraceTree;
+
+    tagTreeDestroy(m_tagTree);
+    m_tagTree = std::move(tagTree);
+    MemoryTagTree::ChildMap::iterator tag = m_tagTree.m_children.begin();
+    for (; tag != m_tagTree.m_children.end(); ++tag)
+        tag->second->m_parent = &m_tagTree;
+
+    HeapsType::const_iterator heap = heaps.begin();
+    for (; heap != heaps.end(); ++heap)
+        m_Heaps[heap->first] = heap->second;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Writes analysis section in place of the one built with other symbols
+//--------------------------------------------------------------------------
+static void writeAnalyzeCache(const std::string& _capturePath,
+                              const std::vector<uint8_t>& _analyzeData,
+                              uint64_t _symbolsHash)
+{
+    uint64_t captureSize, captureTime;
+    if (!CaptureIndex::getCaptureInfo(_capturePath.c_str(), captureSize, captureTime))
+        return;
+
+    FILE* f = openCacheFile(Capture::getCachePath(_capturePath.c_str()), "r+b");
+    if (!f)
+        return;
+
+    CacheHeader header;
+    if ((fread(&header, sizeof(header), 1, f) != 1) || !isCacheHeaderValid(header, captureSize, captureTime))
+    {
+        fclose(f);
+        return;
+    }
+
+    // previous analysis data is invalid until the new one is complete
+    header.m_analyzeSize = 0;
+    seekCacheFile(f, 0);
+    bool written = fwrite(&header, sizeof(header), 1, f) == 1;
+    seekCacheFile(f, header.m_dataSize);
+
+    written = written && (fwrite(&_analyzeData[0], 1, _analyzeData.size(), f) == _analyzeData.size());
+    fflush(f);
+
+    if (written)
+    {
+        header.m_analyzeSize = _analyzeData.size();
+        header.m_symbolsHash = _symbolsHash;
+        seekCacheFile(f, 0);
+        fwrite(&header, sizeof(header), 1, f);
+    }
+
+    fclose(f);
+}
+
+//--------------------------------------------------------------------------
+/// Appends analysis section to the cache written by saveCache. Data is
+/// gathered here as filtering changes it later, file is written in background
+//--------------------------------------------------------------------------
+void Capture::saveAnalyzeCache(uint64_t _symbolsHash)
+{
+    StackTraceIndexType traceIndices;
+    traceIndices.reserve(m_stackTraces.size());
+    std::vector<uint64_t> linkOffsets(m_stackTraces.size());
+    uint64_t numLinks = 0;
+    for (size_t i = 0; i < m_stackTraces.size(); ++i)
+    {
+        traceIndices[(uintptr_t)m_stackTraces[i]] = (uint32_t)i;
+        linkOffsets[i] = numLinks;
+        numLinks += m_stackTraces[i]->m_numFrames + 1;
+    }
+
+    // only list links reachable from the tree are valid, the rest of next arrays is never read
+    std::vector<uint32_t> links((size_t)numLinks, 0);
+    getStackTraceLinks(m_stackTraceTree, traceIndices, linkOffsets, links);
+
+    CacheWriter writer(NULL);
+    const size_t numFrames = m_stackFrames.getNumNodes();
+    writer.writeVar((uint32_t)numFrames);
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        const StackTraceNode* frame = m_stackFrames.getNode(i);
+        writer.writeVar(frame->m_addressID);
+        writer.write(frame->m_treeIndex, sizeof(frame->m_treeIndex));
+    }
+
+    writer.writeVar((uint32_t)m_stackTraces.size());
+    for (size_t i = 0; i < m_stackTraces.size(); ++i)
+    {
+        StackTrace* st = m_stackTraces[i];
+        writer.writeVarint(st->m_numFrames);
+        writer.write(st->m_addedToTree, sizeof(st->m_addedToTree));
+        for (uint32_t j = 0; j <= st->m_numFrames; ++j)
+            writer.writeVarint(links[(size_t)linkOffsets[i] + j]);
+    }
+
+    // operations, tags are inherited along chains during analysis
+    writer.writeVarintArray(m_operations.m_tag);
+    writer.writeDeltaArray(m_memoryLeaks);
+
+    // groups
+    writer.writeVar((uint64_t)m_operationGroups.size());
+    MemoryGroupsHashType::const_iterator it = m_operationGroups.begin();
+    for (; it != m_operationGroups.end(); ++it)
+    {
+        const MemoryOperationGroup& group = it->second;
+        writer.writeVarint(it->first);
+        writer.writeVar(group.m_minSize);
+        writer.writeVar(group.m_maxSize);
+        writer.writeVar(group.m_peakSize);
+        writer.writeVar(group.m_peakSizeGlobal);
+        writer.writeVar(group.m_liveSize);
+        writer.writeVar(group.m_count);
+        writer.writeVar(group.m_liveCount);
+        writer.writeVar(group.m_liveCountPeak);
+        writer.writeVar(group.m_liveCountPeakGlobal);
+        writer.write(group.m_histogram, sizeof(group.m_histogram));
+        writer.write(group.m_histogramPeak, sizeof(group.m_histogramPeak));
+        writer.writeDeltaArray(group.m_operations);
+    }
+
+    writeStackTraceTree(writer, m_stackTraceTree, traceIndices);
+    writeTagTree(writer, m_tagTree);
+
+    writer.writeVar((uint32_t)m_Heaps.size());
+    HeapsType::const_iterator heap = m_Heaps.begin();
+    for (; heap != m_Heaps.end(); ++heap)
+    {
+        writer.writeVar(heap->first);
+        writer.writeString(heap->second);
+    }
+
+    waitForCacheWriter();
+
+    std::vector<uint8_t> analyzeData;
+    analyzeData.swap(writer.getBuffer());
+    m_cacheWriter = std::thread(writeAnalyzeCache, m_loadedFile, std::move(analyzeData), _symbolsHash);
+}
+
+//--------------------------------------------------------------------------
+/// Waits for the cache file to be written, data it's written from can change
+/// once it returns
+//--------------------------------------------------------------------------
+void Capture::waitForCacheWriter()
+{
+    if (m_cacheWriter.joinable())
+        m_cacheWriter.join();
+}
+
+}  // namespace rtm
@@ -0,0 +1,249 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/captureindex.h>
+#include <rbase/inc/winchar.h>
+
+namespace rtm
+{
+static const uint32_t s_indexSignature = 0x5844494d;  // 'MIDX'
+
+struct IndexHeader
+{
+    uint32_t m_signature;
+    uint32_t m_version;
+    uint64_t m_captureSize;
+    uint64_t m_captureTime;
+    uint64_t m_numOperations;
+    uint64_t m_numEntries;
+    uint64_t m_numTagStates;
+    uint32_t m_compressed;
+    uint32_t m_entrySize;
+};
+
+static FILE* openIndexFile(const std::string& _path, bool _write)
+{
+#if RTM_PLATFORM_WINDOWS
+    rtm::MultiToWide path(_path.c_str());
+    return _wfopen(path.m_ptr, _write ? L"wb" : L"rb");
+#else
+    return fopen(_path.c_str(), _write ? "wb" : "rb");
+#endif
+}
+
+CaptureIndex::CaptureIndex()
+{
+    clear();
+}
+
+void CaptureIndex::clear()
+{
+    m_entries.clear();
+    m_tagStates.clear();
+    m_captureSize = 0;
+    m_captureTime = 0;
+    m_numOperations = 0;
+    m_compressed = false;
+}
+
+bool CaptureIndex::begin(const char* _capturePath, bool _compressed)
+{
+    clear();
+    m_compressed = _compressed;
+    return getCaptureInfo(_capturePath, m_captureSize, m_captureTime);
+}
+
+bool CaptureIndex::load(const char* _capturePath)
+{
+    clear();
+
+    uint64_t captureSize, captureTime;
+    if (!getCaptureInfo(_capturePath, captureSize, captureTime))
+        return false;
+
+    const std::string indexPath = getIndexPath(_capturePath);
+    const uint64_t indexSize = (uint64_t)QFileInfo(QString::fromUtf8(indexPath.c_str())).size();
+
+    FILE* f = openIndexFile(indexPath, false);
+    if (!f)
+        return false;
+
+    IndexHeader header;
+    bool valid = (indexSize >= sizeof(header)) && (fread(&header, sizeof(header), 1, f) == 1);
+
+    valid = valid && (header.m_signature == s_indexSignature);
+    valid = valid && (header.m_version == Version);
+    valid = valid && (header.m_entrySize == sizeof(Entry));
+    valid = valid && (header.m_captureSize == captureSize);
+    valid = valid && (header.m_captureTime == captureTime);
+
+    // counts come from the file, don't allocate more than it can hold
+    if (valid)
+    {
+        const uint64_t dataSize = indexSize - sizeof(header);
+        valid = header.m_numEntries <= dataSize / sizeof(Entry);
+        valid = valid && (header.m_numTagStates <= (dataSize - header.m_numEntries * sizeof(Entry)) / sizeof(uint64_t));
+    }
+
+    if (valid)
+    {
+        m_entries.resize((size_t)header.m_numEntries);
+        m_tagStates.resize((size_t)header.m_numTagStates);
+
+        if (header.m_numEntries)
+            valid = fread(&m_entries[0], sizeof(Entry), m_entries.size(), f) == m_entries.size();
+        if (valid && header.m_numTagStates)
+            valid = fread(&m_tagStates[0], sizeof(uint64_t), m_tagStates.size(), f) == m_tagStates.size();
+    }
+
+    fclose(f);
+
+    if (!valid || !validateTagStates())
+    {
+        clear();
+        return false;
+    }
+
+    m_captureSize = captureSize;
+    m_captureTime = captureTime;
+    m_numOperations = header.m_numOperations;
+    m_compressed = header.m_compressed != 0;
+    return true;
+}
+
+bool CaptureIndex::save(const char* _capturePath) const
+{
+    if (m_entries.empty())
+        return false;
+
+    FILE* f = openIndexFile(getIndexPath(_capturePath), true);
+    if (!f)
+        return false;
+
+    IndexHeader header;
+    header.m_signature = s_indexSignature;
+    header.m_version = Version;
+    header.m_captureSize = m_captureSize;
+    header.m_captureTime = m_captureTime;
+    header.m_numOperations = m_numOperations;
+    header.m_numEntries = m_entries.size();
+    header.m_numTagStates = m_tagStates.size();
+    header.m_compressed = m_compressed ? 1 : 0;
+    header.m_entrySize = sizeof(Entry);
+
+    bool written = fwrite(&header, sizeof(header), 1, f) == 1;
+    written = written && (fwrite(&m_entries[0], sizeof(Entry), m_entries.size(), f) == m_entries.size());
+    if (written && m_tagStates.size())
+        written = fwrite(&m_tagStates[0], sizeof(uint64_t), m_tagStates.size(), f) == m_tagStates.size();
+
+    fclose(f);
+
+    // don't leave a truncated index behind, it would be rejected anyway
+    if (!written)
+        QFile::remove(QString::fromUtf8(getIndexPath(_capturePath).c_str()));
+
+    return written;
+}
+
+void CaptureIndex::addEntry(uint64_t _fileOffset, uint32_t _recordOffset, const ThreadTagStacks& _tagStacks)
+{
+    Entry entry;
+    entry.m_fileOffset = _fileOffset;
+    entry.m_recordOffset = _recordOffset;
+    entry.m_numOperations = 0;
+    entry.m_minTime = (uint64_t)-1;
+    entry.m_maxTime = 0;
+    entry.m_tagStateOffset = (uint32_t)m_tagStates.size();
+    entry.m_tagStateSize = 0;
+
+    ThreadTagStacks::const_iterator it = _tagStacks.begin();
+    ThreadTagStacks::const_iterator end = _tagStacks.end();
+    for (; it != end; ++it)
+    {
+        const std::vector<uint32_t>& stack = it->second;
+        if (stack.empty())
+            continue;
+
+        m_tagStates.push_back(it->first);
+        m_tagStates.push_back(stack.size());
+        for (size_t i = 0; i < stack.size(); ++i)
+            m_tagStates.push_back(stack[i]);
+    }
+
+    entry.m_tagStateSize = (uint32_t)(m_tagStates.size() - entry.m_tagStateOffset);
+
+    // tags change rarely, share the state with the previous entry when it's the same
+    if (m_entries.size())
+    {
+        const Entry& prev = m_entries.back();
+        if ((prev.m_tagStateSize == entry.m_tagStateSize) &&
+            (memcmp(&m_tagStates[prev.m_tagStateOffset],
+                    &m_tagStates[entry.m_tagStateOffset],
+                    entry.m_tagStateSize * sizeof(uint64_t)) == 0))
+        {
+            m_tagStates.resize(entry.m_tagStateOffset);
+            entry.m_tagStateOffset = prev.m_tagStateOffset;
+        }
+    }
+
+    m_entries.push_back(entry);
+}
+
+void CaptureIndex::getTagStacks(const Entry& _entry, ThreadTagStacks& _tagStacks) const
+{
+    _tagStacks.clear();
+
+    uint32_t pos = _entry.m_tagStateOffset;
+    const uint32_t end = _entry.m_tagStateOffset + _entry.m_tagStateSize;
+    while (pos < end)
+    {
+        std::vector<uint32_t>& stack = _tagStacks[m_tagStates[pos]];
+        const uint32_t depth = (uint32_t)m_tagStates[pos + 1];
+        pos += 2;
+        for (uint32_t i = 0; i < depth; ++i)
+            stack.push_back((uint32_t)m_tagStates[pos++]);
+    }
+}
+
+bool CaptureIndex::validateTagStates() const
+{
+    const uint64_t numTagStates = m_tagStates.size();
+    for (size_t i = 0; i < m_entries.size(); ++i)
+    {
+        const Entry& entry = m_entries[i];
+        const uint64_t end = (uint64_t)entry.m_tagStateOffset + entry.m_tagStateSize;
+        if (end > numTagStates)
+            return false;
+
+        // each stack is thread ID and depth followed by depth tag hashes
+        uint64_t pos = entry.m_tagStateOffset;
+        while (pos < end)
+        {
+            if ((end - pos < 2) || (m_tagStates[pos + 1] > end - pos - 2))
+                return false;
+            pos += 2 + m_tagStates[pos + 1];
+        }
+    }
+    return true;
+}
+
+std::string CaptureIndex::getIndexPath(const char* _capturePath)
+{
+    return std::string(_capturePath) + ".mtidx";
+}
+
+bool CaptureIndex::getCaptureInfo(const char* _capturePath, uint64_t& _size, uint64_t& _time)
+{
+    QFileInfo info(QString::fromUtf8(_capturePath));
+    if (!info.exists())
+        return false;
+
+    _size = (uint64_t)info.size();
+    _time = (uint64_t)info.lastModified().toMSecsSinceEpoch();
+    return true;
+}
+
+}  // namespace rtm
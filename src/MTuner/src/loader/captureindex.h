@@ -0,0 +1,99 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_CAPTUREINDEX_H__
+#define __RTM_MTUNER_CAPTUREINDEX_H__
+
+#include <MTuner/src/loader/mtunerlib.h>
+
+namespace rtm
+{
+/// Open tag stacks per thread, key is a thread ID
+typedef robin_hood::unordered_map<uint64_t, std::vector<uint32_t>> ThreadTagStacks;
+
+//--------------------------------------------------------------------------
+/// Seekable index of a capture file, stored next to it as a sidecar file.
+/// Compressed captures get one entry per chunk, uncompressed ones one entry
+/// per fixed size region. Each entry describes where the first record that
+/// starts inside it is and the parser state needed to start parsing there.
+//--------------------------------------------------------------------------
+class CaptureIndex
+{
+public:
+    enum
+    {
+        Version = 1,
+        RegionSize = 4 * 1024 * 1024  ///< Region size used for uncompressed captures
+    };
+
+    struct Entry
+    {
+        uint64_t m_fileOffset;      ///< Chunk header offset, or record offset for uncompressed files
+        uint32_t m_recordOffset;    ///< Offset of the first record inside decompressed chunk data
+        uint32_t m_numOperations;   ///< Number of memory operations starting in this entry
+        uint64_t m_minTime;         ///< Earliest memory operation time
+        uint64_t m_maxTime;         ///< Latest memory operation time
+        uint32_t m_tagStateOffset;  ///< Offset of open tag stacks in tag state array
+        uint32_t m_tagStateSize;    ///< Number of tag state items
+    };
+
+private:
+    std::vector<Entry> m_entries;
+    std::vector<uint64_t> m_tagStates;  ///< Thread ID, stack depth and tag hashes for each open stack
+    uint64_t m_captureSize;
+    uint64_t m_captureTime;
+    uint64_t m_numOperations;
+    bool m_compressed;
+
+public:
+    CaptureIndex();
+
+    void clear();
+    bool isEmpty() const { return m_entries.empty(); }
+
+    /// Starts building a new index for the given capture
+    bool begin(const char* _capturePath, bool _compressed);
+
+    /// Loads sidecar index, fails if it's missing or doesn't match the capture
+    bool load(const char* _capturePath);
+
+    /// Writes sidecar index next to the capture
+    bool save(const char* _capturePath) const;
+
+    /// Starts a new entry at given position, _tagStacks is the parser state at that point
+    void addEntry(uint64_t _fileOffset, uint32_t _recordOffset, const ThreadTagStacks& _tagStacks);
+
+    inline void addOperation(uint64_t _time)
+    {
+        Entry& entry = m_entries.back();
+        if (entry.m_minTime > _time)
+            entry.m_minTime = _time;
+        if (entry.m_maxTime < _time)
+            entry.m_maxTime = _time;
+        ++entry.m_numOperations;
+        ++m_numOperations;
+    }
+
+    const std::vector<Entry>& getEntries() const { return m_entries; }
+    uint64_t getNumOperations() const { return m_numOperations; }
+    bool isCompressed() const { return m_compressed; }
+
+    /// Restores open tag stacks at the start of an entry
+    void getTagStacks(const Entry& _entry, ThreadTagStacks& _tagStacks) const;
+
+    /// Returns sidecar index path for the given capture
+    static std::string getIndexPath(const char* _capturePath);
+
+    /// Retrieves capture size and modification time used to validate the index
+    static bool getCaptureInfo(const char* _capturePath, uint64_t& _size, uint64_t& _time);
+
+private:
+    /// Checks that tag stacks of every entry lie inside the tag state array
+    bool validateTagStates() const;
+};
+
+}  // namespace rtm
+
+#endif  // __RTM_MTUNER_CAPTUREINDEX_H__
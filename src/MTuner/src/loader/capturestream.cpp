@@ -0,0 +1,428 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/capturestream.h>
+
+#if RTM_PLATFORM_WINDOWS
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace rtm
+{
+static const uintptr_t s_invalidSocket = (uintptr_t)-1;
+
+/// Socket waits time out this often so that closing the stream is noticed
+static const int s_pollTimeout = 100;
+
+static void closeSocket(uintptr_t _socket)
+{
+    if (_socket == s_invalidSocket)
+        return;
+
+#if RTM_PLATFORM_WINDOWS
+    closesocket((SOCKET)_socket);
+#else
+    ::close((int)_socket);
+#endif
+}
+
+//--------------------------------------------------------------------------
+/// Waits for the socket to become readable, returns 1 if it is, 0 on timeout
+/// and -1 on error
+//--------------------------------------------------------------------------
+static int waitReadable(uintptr_t _socket, int _timeout)
+{
+#if RTM_PLATFORM_WINDOWS
+    WSAPOLLFD pfd;
+    pfd.fd = (SOCKET)_socket;
+    pfd.events = POLLRDNORM;
+    pfd.revents = 0;
+    int ret = WSAPoll(&pfd, 1, _timeout);
+#else
+    struct pollfd pfd;
+    pfd.fd = (int)_socket;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int ret = poll(&pfd, 1, _timeout);
+    if ((ret < 0) && (errno == EINTR))
+        return 0;
+#endif
+
+    if (ret < 0)
+        return -1;
+
+    return ret ? 1 : 0;
+}
+
+//--------------------------------------------------------------------------
+/// Returns true if address names a TCP port, _host is empty for loopback.
+/// IPv6 hosts are given in brackets, as in [::1]:port.
+//--------------------------------------------------------------------------
+static bool parseTCPAddress(const char* _address, std::string& _host, std::string& _port)
+{
+    const char* host = _address;
+    size_t hostLen = 0;
+    const char* port = _address;
+
+    if (*_address == '[')
+    {
+        const char* hostEnd = strchr(_address, ']');
+        if (!hostEnd || (hostEnd[1] != ':'))
+            return false;
+
+        host = _address + 1;
+        hostLen = (size_t)(hostEnd - host);
+        port = hostEnd + 2;
+    }
+    else if (const char* colon = strrchr(_address, ':'))
+    {
+        hostLen = (size_t)(colon - _address);
+        port = colon + 1;
+    }
+
+    if (*port == 0)
+        return false;
+
+    for (const char* c = port; *c; ++c)
+        if ((*c < '0') || (*c > '9'))
+            return false;
+
+    _host.assign(host, hostLen);
+    _port = port;
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Captures are only received from this machine
+//--------------------------------------------------------------------------
+static bool isLoopback(const struct sockaddr* _address)
+{
+    if (_address->sa_family == AF_INET)
+    {
+        const struct sockaddr_in* addr = (const struct sockaddr_in*)_address;
+        return (ntohl(addr->sin_addr.s_addr) >> 24) == 127;
+    }
+
+    if (_address->sa_family == AF_INET6)
+    {
+        const struct sockaddr_in6* addr = (const struct sockaddr_in6*)_address;
+        return IN6_IS_ADDR_LOOPBACK(&addr->sin6_addr) != 0;
+    }
+
+    return false;
+}
+
+static uintptr_t listenTCP(const std::string& _host, const std::string& _port)
+{
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    struct addrinfo* addresses = NULL;
+    if (getaddrinfo(_host.empty() ? "127.0.0.1" : _host.c_str(), _port.c_str(), &hints, &addresses) != 0)
+        return s_invalidSocket;
+
+    uintptr_t listenSocket = s_invalidSocket;
+    for (struct addrinfo* addr = addresses; addr; addr = addr->ai_next)
+    {
+        if (!isLoopback(addr->ai_addr))
+            continue;
+
+#if RTM_PLATFORM_WINDOWS
+        SOCKET s = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (s == INVALID_SOCKET)
+            continue;
+#else
+        int s = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (s < 0)
+            continue;
+
+        // port of a previous stream may still be in TIME_WAIT
+        int reuse = 1;
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+
+        if ((bind(s, addr->ai_addr, (int)addr->ai_addrlen) == 0) && (listen(s, 1) == 0))
+        {
+            listenSocket = (uintptr_t)s;
+            break;
+        }
+
+        closeSocket((uintptr_t)s);
+    }
+
+    freeaddrinfo(addresses);
+    return listenSocket;
+}
+
+static uintptr_t listenUnix(const char* _path)
+{
+#if RTM_PLATFORM_WINDOWS
+    RTM_UNUSED(_path);
+    return s_invalidSocket;
+#else
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(_path) >= sizeof(addr.sun_path))
+        return s_invalidSocket;
+    strcpy(addr.sun_path, _path);
+
+    int s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s < 0)
+        return s_invalidSocket;
+
+    // socket file left behind by a previous stream
+    unlink(_path);
+
+    if ((bind(s, (struct sockaddr*)&addr, sizeof(addr)) != 0) || (listen(s, 1) != 0))
+    {
+        ::close(s);
+        return s_invalidSocket;
+    }
+
+    return (uintptr_t)s;
+#endif
+}
+
+CaptureStream::CaptureStream()
+    : m_dataOffset(0)
+    , m_listenSocket(s_invalidSocket)
+    , m_connected(false)
+    , m_ended(false)
+    , m_stop(false)
+    , m_unixSocket(false)
+{
+}
+
+CaptureStream::~CaptureStream()
+{
+    close();
+}
+
+bool CaptureStream::open(const char* _address)
+{
+    close();
+
+#if RTM_PLATFORM_WINDOWS
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+        return false;
+#endif
+
+    m_address = _address;
+
+    std::string host, port;
+    m_unixSocket = !parseTCPAddress(_address, host, port);
+    m_listenSocket = m_unixSocket ? listenUnix(_address) : listenTCP(host, port);
+
+    if (m_listenSocket == s_invalidSocket)
+    {
+        close();
+        return false;
+    }
+
+    m_connected = false;
+    m_ended = false;
+    m_stop = false;
+    m_thread = std::thread(&CaptureStream::receiveThread, this);
+    return true;
+}
+
+void CaptureStream::close()
+{
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_blockFreed.notify_all();
+        m_thread.join();
+    }
+    else if (m_listenSocket != s_invalidSocket)
+    {
+        closeSocket(m_listenSocket);
+        m_listenSocket = s_invalidSocket;
+    }
+
+#if RTM_PLATFORM_WINDOWS
+    if (!m_address.empty())
+        WSACleanup();
+#else
+    if (m_unixSocket && !m_address.empty())
+        unlink(m_address.c_str());
+#endif
+
+    for (size_t i = 0; i < m_blocks.size(); ++i)
+        delete[] m_blocks[i];
+
+    m_blocks.clear();
+    m_blockSizes.clear();
+    m_data.clear();
+    m_dataOffset = 0;
+    m_address.clear();
+    m_unixSocket = false;
+}
+
+bool CaptureStream::isConnected()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_connected;
+}
+
+bool CaptureStream::receive()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_blocks.empty())
+        return false;
+
+    // consumed data is dropped once it's most of the buffer, so each byte is moved once at most
+    if (m_dataOffset > m_data.size() / 2)
+    {
+        m_data.erase(m_data.begin(), m_data.begin() + m_dataOffset);
+        m_dataOffset = 0;
+    }
+
+    for (size_t i = 0; i < m_blocks.size(); ++i)
+    {
+        m_data.insert(m_data.end(), m_blocks[i], m_blocks[i] + m_blockSizes[i]);
+        delete[] m_blocks[i];
+    }
+
+    m_blocks.clear();
+    m_blockSizes.clear();
+    m_blockFreed.notify_all();
+    return true;
+}
+
+bool CaptureStream::hasEnded()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ended && m_blocks.empty();
+}
+
+void CaptureStream::consume(uint64_t _size)
+{
+    if (_size > getDataSize())
+        _size = getDataSize();
+
+    m_dataOffset += (size_t)_size;
+}
+
+//--------------------------------------------------------------------------
+/// Accepts the sender and receives data until it disconnects or the stream
+/// is closed
+//--------------------------------------------------------------------------
+void CaptureStream::receiveThread()
+{
+    uintptr_t dataSocket = s_invalidSocket;
+
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop)
+                break;
+        }
+
+        int ready = waitReadable(m_listenSocket, s_pollTimeout);
+        if (ready < 0)
+            break;
+
+        if (ready)
+        {
+#if RTM_PLATFORM_WINDOWS
+            SOCKET s = accept((SOCKET)m_listenSocket, NULL, NULL);
+            if (s != INVALID_SOCKET)
+                dataSocket = (uintptr_t)s;
+#else
+            int s = accept((int)m_listenSocket, NULL, NULL);
+            if (s >= 0)
+                dataSocket = (uintptr_t)s;
+#endif
+            break;
+        }
+    }
+
+    // only one sender per stream
+    closeSocket(m_listenSocket);
+    m_listenSocket = s_invalidSocket;
+
+    if (dataSocket != s_invalidSocket)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_connected = true;
+        }
+
+        uint8_t* block = NULL;
+        for (;;)
+        {
+            {
+                // sender is throttled by the socket while parsing falls behind
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_blockFreed.wait(lock, [this] { return m_stop || (m_blocks.size() < MaxBlocks); });
+                if (m_stop)
+                    break;
+            }
+
+            int ready = waitReadable(dataSocket, s_pollTimeout);
+            if (ready < 0)
+                break;
+            if (!ready)
+                continue;
+
+            if (!block)
+                block = new uint8_t[BlockSize];
+
+            // fill the block with whatever is already available before handing it over
+            bool closed = false;
+            int32_t blockSize = 0;
+            do
+            {
+                int received = (int)recv(dataSocket, (char*)block + blockSize, BlockSize - blockSize, 0);
+                if (received <= 0)
+                {
+                    closed = true;
+                    break;
+                }
+                blockSize += received;
+            } while ((blockSize < BlockSize) && (waitReadable(dataSocket, 0) > 0));
+
+            if (blockSize)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_blocks.push_back(block);
+                m_blockSizes.push_back((uint32_t)blockSize);
+                block = NULL;
+            }
+
+            if (closed)
+                break;
+        }
+
+        delete[] block;
+        closeSocket(dataSocket);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ended = true;
+}
+
+}  // namespace rtm
@@ -0,0 +1,80 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_CAPTURESTREAM_H__
+#define __RTM_MTUNER_CAPTURESTREAM_H__
+
+#include <MTuner/src/loader/mtunerlib.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace rtm
+{
+//--------------------------------------------------------------------------
+/// Receives capture records over a local socket instead of reading them from
+/// a file. A background thread accepts a single connection and receives data
+/// into a bounded queue of blocks, so a sender that is faster than the parser
+/// is throttled by the socket. The thread that parses moves received blocks
+/// into a parse buffer and consumes it from the front, consumed data is only
+/// dropped once it takes up most of the buffer.
+//--------------------------------------------------------------------------
+class CaptureStream
+{
+public:
+    enum
+    {
+        BlockSize = 1024 * 1024,  ///< Largest amount of data received at once
+        MaxBlocks = 64            ///< Received blocks waiting to be parsed before receiving stops
+    };
+
+private:
+    std::string m_address;
+    std::vector<uint8_t*> m_blocks;  ///< Received blocks, in order
+    std::vector<uint32_t> m_blockSizes;
+    std::vector<uint8_t> m_data;     ///< Received data, parsed data is dropped from the front in bulk
+    size_t m_dataOffset;             ///< Start of data not parsed yet
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_blockFreed;
+    uintptr_t m_listenSocket;
+    bool m_connected;
+    bool m_ended;  ///< Sender closed the connection or an error occurred
+    bool m_stop;
+    bool m_unixSocket;
+
+public:
+    CaptureStream();
+    ~CaptureStream();
+
+    /// Starts listening and receiving on a background thread. Address is a port,
+    /// host:port or [IPv6 host]:port for TCP on a loopback interface, or a path
+    /// for Unix-domain socket.
+    bool open(const char* _address);
+    void close();
+
+    const char* getAddress() const { return m_address.c_str(); }
+    bool isConnected();
+
+    /// Moves received blocks to the parse buffer, returns false if there were none
+    bool receive();
+
+    /// True once the sender is gone and all received data was moved to the parse buffer
+    bool hasEnded();
+
+    const uint8_t* getData() const { return m_data.data() + m_dataOffset; }
+    uint64_t getDataSize() const { return (uint64_t)(m_data.size() - m_dataOffset); }
+
+    /// Drops _size parsed bytes from the front of the parse buffer
+    void consume(uint64_t _size);
+
+private:
+    void receiveThread();
+};
+
+}  // namespace rtm
+
+#endif  // __RTM_MTUNER_CAPTURESTREAM_H__
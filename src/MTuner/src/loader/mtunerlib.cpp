@@ -75,6 +75,187 @@ void MemoryStats::setPeaksFrom(MemoryStatLocalPeak& _peaks)
 	}
 }
 
+template <typename T>
+static inline void scaleStat(T& _value, double _factor)
+{
+	_value = (T)(_value * _factor + 0.5);
+}
+
+void MemoryStats::scale(double _factor)
+{
+	scaleStat(m_memoryUsage,			_factor);
+	scaleStat(m_memoryUsagePeak,		_factor);
+	scaleStat(m_overhead,				_factor);
+	scaleStat(m_overheadPeak,			_factor);
+	scaleStat(m_numberOfOperations,		_factor);
+	scaleStat(m_numberOfAllocations,	_factor);
+	scaleStat(m_numberOfReAllocations,	_factor);
+	scaleStat(m_numberOfFrees,			_factor);
+	scaleStat(m_numberOfLiveBlocks,		_factor);
+	scaleStat(m_numberOfLiveBlocksPeak,	_factor);
+	for (uint32_t i=0; i<NUM_HISTOGRAM_BINS; i++)
+	{
+		scaleStat(m_histogram[i].m_size,			_factor);
+		scaleStat(m_histogram[i].m_sizePeak,		_factor);
+		scaleStat(m_histogram[i].m_overhead,		_factor);
+		scaleStat(m_histogram[i].m_overheadPeak,	_factor);
+		scaleStat(m_histogram[i].m_count,			_factor);
+		scaleStat(m_histogram[i].m_countPeak,		_factor);
+	}
+}
+
+void MemoryOperations::resize(size_t _size)
+{
+	m_time.resize(_size, 0);
+	m_pointer.resize(_size, 0);
+	m_allocSize.resize(_size, 0);
+	m_overhead.resize(_size, 0);
+	m_stackTrace.resize(_size, 0);
+	m_threadIndex.resize(_size, 0);
+	m_heapIndex.resize(_size, 0);
+	m_chainPrev.resize(_size, NoOperation);
+	m_chainNext.resize(_size, NoOperation);
+	m_tag.resize(_size, 0);
+	m_type.resize(_size, 0);
+	m_alignment.resize(_size, 0);
+}
+
+void MemoryOperations::reserve(size_t _size)
+{
+	m_time.reserve(_size);
+	m_pointer.reserve(_size);
+	m_allocSize.reserve(_size);
+	m_overhead.reserve(_size);
+	m_stackTrace.reserve(_size);
+	m_threadIndex.reserve(_size);
+	m_heapIndex.reserve(_size);
+	m_chainPrev.reserve(_size);
+	m_chainNext.reserve(_size);
+	m_tag.reserve(_size);
+	m_type.reserve(_size);
+	m_alignment.reserve(_size);
+}
+
+void MemoryOperations::clear()
+{
+	MemoryOperations empty;
+	swap(empty);
+}
+
+void MemoryOperations::swap(MemoryOperations& _other)
+{
+	m_time.swap(_other.m_time);
+	m_pointer.swap(_other.m_pointer);
+	m_allocSize.swap(_other.m_allocSize);
+	m_overhead.swap(_other.m_overhead);
+	m_stackTrace.swap(_other.m_stackTrace);
+	m_threadIndex.swap(_other.m_threadIndex);
+	m_heapIndex.swap(_other.m_heapIndex);
+	m_chainPrev.swap(_other.m_chainPrev);
+	m_chainNext.swap(_other.m_chainNext);
+	m_tag.swap(_other.m_tag);
+	m_type.swap(_other.m_type);
+	m_alignment.swap(_other.m_alignment);
+	m_previousPointers.swap(_other.m_previousPointers);
+}
+
+//--------------------------------------------------------------------------
+/// Adds a valid operation, previous pointer of a realloc is kept until
+/// operations are linked
+//--------------------------------------------------------------------------
+void MemoryOperations::add(const MemoryOperation& _op)
+{
+	const size_t index = size();
+	resize(index + 1);
+	set(index, _op);
+	setPreviousPointer(index, _op.m_previousPointer);
+}
+
+//--------------------------------------------------------------------------
+/// Writes a valid unlinked operation, previous pointer is not stored so
+/// operations can be written from multiple threads
+//--------------------------------------------------------------------------
+void MemoryOperations::set(size_t _index, const MemoryOperation& _op)
+{
+	m_time[_index]			= _op.m_operationTime;
+	m_pointer[_index]		= _op.m_pointer;
+	m_allocSize[_index]		= _op.m_allocSize;
+	m_overhead[_index]		= _op.m_overhead;
+	m_stackTrace[_index]	= _op.m_stackTrace;
+	m_threadIndex[_index]	= _op.m_threadIndex;
+	m_heapIndex[_index]		= _op.m_heapIndex;
+	m_chainPrev[_index]		= NoOperation;
+	m_chainNext[_index]		= NoOperation;
+	m_tag[_index]			= _op.m_tag;
+	m_type[_index]			= (uint8_t)(_op.m_operationType | ValidFlag);
+	m_alignment[_index]		= _op.m_alignment;
+}
+
+//--------------------------------------------------------------------------
+/// Reads an operation, previous pointer is left out as links replace it
+//--------------------------------------------------------------------------
+void MemoryOperations::get(size_t _index, MemoryOperation& _op) const
+{
+	_op.m_operationTime		= m_time[_index];
+	_op.m_pointer			= m_pointer[_index];
+	_op.m_previousPointer	= 0;
+	_op.m_allocSize			= m_allocSize[_index];
+	_op.m_overhead			= m_overhead[_index];
+	_op.m_stackTrace		= m_stackTrace[_index];
+	_op.m_threadIndex		= m_threadIndex[_index];
+	_op.m_heapIndex			= m_heapIndex[_index];
+	_op.m_tag				= m_tag[_index];
+	_op.m_operationType		= getType(_index);
+	_op.m_alignment			= m_alignment[_index];
+}
+
+//--------------------------------------------------------------------------
+/// Copies operation inside the store, links are copied as they are
+//--------------------------------------------------------------------------
+void MemoryOperations::copy(size_t _dst, size_t _src)
+{
+	m_time[_dst]		= m_time[_src];
+	m_pointer[_dst]		= m_pointer[_src];
+	m_allocSize[_dst]	= m_allocSize[_src];
+	m_overhead[_dst]	= m_overhead[_src];
+	m_stackTrace[_dst]	= m_stackTrace[_src];
+	m_threadIndex[_dst]	= m_threadIndex[_src];
+	m_heapIndex[_dst]	= m_heapIndex[_src];
+	m_chainPrev[_dst]	= m_chainPrev[_src];
+	m_chainNext[_dst]	= m_chainNext[_src];
+	m_tag[_dst]			= m_tag[_src];
+	m_type[_dst]		= m_type[_src];
+	m_alignment[_dst]	= m_alignment[_src];
+}
+
+//--------------------------------------------------------------------------
+/// Sets previous pointer of an operation that is not linked yet
+//--------------------------------------------------------------------------
+void MemoryOperations::setPreviousPointer(size_t _index, uint64_t _pointer)
+{
+	if (!_pointer)
+	{
+		m_chainPrev[_index] = NoOperation;
+		return;
+	}
+
+	if (m_chainPrev[_index] == NoOperation)
+	{
+		m_chainPrev[_index] = (uint32_t)m_previousPointers.size();
+		m_previousPointers.push_back(_pointer);
+	}
+	else
+		m_previousPointers[m_chainPrev[_index]] = _pointer;
+}
+
+//--------------------------------------------------------------------------
+/// Frees previous pointers once chain links have replaced them
+//--------------------------------------------------------------------------
+void MemoryOperations::releasePreviousPointers()
+{
+	std::vector<uint64_t>().swap(m_previousPointers);
+}
+
 //--------------------------------------------------------------------------
 /// Finds memory tag in the tree
 //--------------------------------------------------------------------------
@@ -135,7 +316,7 @@ bool tagInsert(MemoryTagTree* _rootTag, MemoryTagTree* _tag, uint32_t _parentTag
 	}
 }
 
-static inline void addOpToTag(MemoryTagTree* _tag, int64_t _size, int64_t _overhead, MemoryOperation* _op)
+static inline void addOpToTag(MemoryTagTree* _tag, int64_t _size, int64_t _overhead, uint8_t _type)
 {
 	_tag->m_usage += _size;
 	if (_tag->m_usage > _tag->m_usagePeak)
@@ -145,21 +326,22 @@ static inline void addOpToTag(MemoryTagTree* _tag, int64_t _size, int64_t _overh
 	if (_tag->m_overhead > _tag->m_overheadPeak)
 		_tag->m_overheadPeak = _tag->m_overhead;
 
-	_tag->m_operationCount[_op->m_operationType]++;
+	_tag->m_operationCount[_type]++;
 
 	if (_tag->m_parent)
-		addOpToTag(_tag->m_parent, _size, _overhead, _op);
+		addOpToTag(_tag->m_parent, _size, _overhead, _type);
 }
 
-void tagAddOp(MemoryTagTree& _rootTag, MemoryOperation* _op, MemoryTagTree*& _prevTag)
+void tagAddOp(MemoryTagTree& _rootTag, const MemoryOperations& _ops, uint32_t _index, MemoryTagTree*& _prevTag)
 {
 	MemoryTagTree* tag;
-	tagFind(_rootTag, _op->m_tag, tag, _prevTag);
+	tagFind(_rootTag, _ops.m_tag[_index], tag, _prevTag);
 
-	int64_t size = _op->m_allocSize;
-	int64_t overhead = _op->m_overhead;
+	int64_t size = _ops.m_allocSize[_index];
+	int64_t overhead = _ops.m_overhead[_index];
 
-	switch (_op->m_operationType)
+	const uint8_t type = _ops.getType(_index);
+	switch (type)
 	{
 		case rmem::LogMarkers::OpAlloc:
 		case rmem::LogMarkers::OpCalloc:
@@ -177,23 +359,24 @@ void tagAddOp(MemoryTagTree& _rootTag, MemoryOperation* _op, MemoryTagTree*& _pr
 		case rmem::LogMarkers::OpRealloc:
 			{
 				MemoryTagTree* tagPrev;
-				if (_op->m_chainPrev)
+				const uint32_t prev = _ops.m_chainPrev[_index];
+				if (prev != MemoryOperations::NoOperation)
 				{
-					tagFind(_rootTag, _op->m_chainPrev->m_tag, tagPrev, _prevTag);
+					tagFind(_rootTag, _ops.m_tag[prev], tagPrev, _prevTag);
 
-					int64_t sizePrev = _op->m_chainPrev->m_allocSize;
-					int64_t overheadPrev = _op->m_chainPrev->m_overhead;
+					int64_t sizePrev = _ops.m_allocSize[prev];
+					int64_t overheadPrev = _ops.m_overhead[prev];
 
 					sizePrev = -sizePrev;
 					overheadPrev = -overheadPrev;
 
-					addOpToTag(tagPrev, sizePrev, overheadPrev, _op->m_chainPrev);
+					addOpToTag(tagPrev, sizePrev, overheadPrev, _ops.getType(prev));
 				}
 			}
 			break;
 	};
 
-	addOpToTag(tag, size, overhead, _op);
+	addOpToTag(tag, size, overhead, type);
 }
 
 void tagTreeDestroy(MemoryTagTree& _rootTag)
@@ -55,27 +55,98 @@ public:
 };
 
 //--------------------------------------------------------------------------
-/// Structure adding information on top of memory operation
+/// Single memory operation as parsed from a capture, operations added to
+/// a capture are kept in MemoryOperations
 //--------------------------------------------------------------------------
 struct MemoryOperation
 {
-    uint64_t m_allocatorHandle;  //< Allocator handle
-    uint64_t m_threadID;         //< Thread ID
     uint64_t m_pointer;          //< Allocated/freed pointer
     uint64_t m_previousPointer;  //< Valid for realloc operations
-    MemoryOperation* m_chainPrev;
-    MemoryOperation* m_chainNext;
-    StackTrace* m_stackTrace;
     uint64_t m_operationTime;
-    uint32_t m_indexMapping;
+    uint32_t m_stackTrace;   //< Index of stack trace, see Capture::getStackTrace
+    uint32_t m_threadIndex;  //< Index of thread ID, see Capture::getThreadID
+    uint32_t m_heapIndex;    //< Index of allocator handle, see Capture::getHeapHandle
     uint32_t m_allocSize;
     uint32_t m_overhead;
     uint16_t m_tag;
-    uint8_t m_operationType : 7;
-    uint8_t m_isValid : 1;
+    uint8_t m_operationType;
     uint8_t m_alignment;
 };
 
+//--------------------------------------------------------------------------
+/// Memory operations stored by columns. Operations are referred to by their
+/// index, valid and invalid operations share the same index space.
+//--------------------------------------------------------------------------
+struct MemoryOperations
+{
+    enum
+    {
+        NoOperation = 0xffffffff,   ///< Index of a missing link
+        MaxOperations = 0xfffffffe  ///< Every index but NoOperation
+    };
+
+    enum
+    {
+        TypeMask = 0x7f,
+        ValidFlag = 0x80
+    };
+
+    std::vector<uint64_t> m_time;
+    std::vector<uint64_t> m_pointer;
+    std::vector<uint32_t> m_allocSize;
+    std::vector<uint32_t> m_overhead;
+    std::vector<uint32_t> m_stackTrace;
+    std::vector<uint32_t> m_threadIndex;
+    std::vector<uint32_t> m_heapIndex;
+    std::vector<uint32_t> m_chainPrev;  ///< Until operations are linked, index of previous pointer for reallocs
+    std::vector<uint32_t> m_chainNext;
+    std::vector<uint16_t> m_tag;
+    std::vector<uint8_t> m_type;  ///< Operation type and valid flag
+    std::vector<uint8_t> m_alignment;
+    std::vector<uint64_t> m_previousPointers;  ///< Previous pointers of reallocs, released once linked
+
+    inline size_t size() const
+    {
+        return m_time.size();
+    }
+    inline bool empty() const
+    {
+        return m_time.empty();
+    }
+    inline uint8_t getType(size_t _index) const
+    {
+        return m_type[_index] & TypeMask;
+    }
+    inline bool isValid(size_t _index) const
+    {
+        return (m_type[_index] & ValidFlag) != 0;
+    }
+    inline void setValid(size_t _index)
+    {
+        m_type[_index] |= ValidFlag;
+    }
+    inline void setInvalid(size_t _index)
+    {
+        m_type[_index] &= TypeMask;
+    }
+    inline uint64_t getPreviousPointer(size_t _index) const
+    {
+        const uint32_t prev = m_chainPrev[_index];
+        return prev == NoOperation ? 0 : m_previousPointers[prev];
+    }
+
+    void resize(size_t _size);
+    void reserve(size_t _size);
+    void clear();
+    void swap(MemoryOperations& _other);
+    void add(const MemoryOperation& _op);
+    void set(size_t _index, const MemoryOperation& _op);
+    void get(size_t _index, MemoryOperation& _op) const;
+    void copy(size_t _dst, size_t _src);
+    void setPreviousPointer(size_t _index, uint64_t _pointer);
+    void releasePreviousPointers();
+};
+
 //--------------------------------------------------------------------------
 /// Methods of sorting memory operations
 //--------------------------------------------------------------------------
@@ -102,10 +173,10 @@ struct HistogramBin
 {
     uint64_t m_size;          ///< Memory usage at the end of time slice
     uint64_t m_sizePeak;      ///< Peak memory usage inside the time slice
-    uint32_t m_overhead;      ///< Overhead at the end of time slice
-    uint32_t m_overheadPeak;  ///< Peak overhead inside the time slice
-    uint32_t m_count;         ///< Number of surviving memory blocks at the end of time slice
-    uint32_t m_countPeak;     ///< Peak number of live blocks inside the time slice
+    uint64_t m_overhead;      ///< Overhead at the end of time slice
+    uint64_t m_overheadPeak;  ///< Peak overhead inside the time slice
+    uint64_t m_count;         ///< Number of surviving memory blocks at the end of time slice
+    uint64_t m_countPeak;     ///< Peak number of live blocks inside the time slice
 };
 
 //--------------------------------------------------------------------------
@@ -122,14 +193,14 @@ struct MemoryStats
 
     uint64_t m_memoryUsage;            ///< Memory usage at the end of time slice
     uint64_t m_memoryUsagePeak;        ///< Peak memory usage inside the time slice
-    uint32_t m_overhead;               ///< Allocation overhead at the end of time slice
-    uint32_t m_overheadPeak;           ///< Peak allocation overhead inside the time slice
-    uint32_t m_numberOfOperations;     ///< Number of operations inside the time slice
-    uint32_t m_numberOfAllocations;    ///< Number of allocations inside the time slice
-    uint32_t m_numberOfReAllocations;  ///< Number of reallocations inside the time slice
-    uint32_t m_numberOfFrees;          ///< Number of frees inside the time slice
-    uint32_t m_numberOfLiveBlocks;  ///< Memory blocks allocated but not freed inside the time slice - Memory leaks!
-    uint32_t m_numberOfLiveBlocksPeak;
+    uint64_t m_overhead;               ///< Allocation overhead at the end of time slice
+    uint64_t m_overheadPeak;           ///< Peak allocation overhead inside the time slice
+    uint64_t m_numberOfOperations;     ///< Number of operations inside the time slice
+    uint64_t m_numberOfAllocations;    ///< Number of allocations inside the time slice
+    uint64_t m_numberOfReAllocations;  ///< Number of reallocations inside the time slice
+    uint64_t m_numberOfFrees;          ///< Number of frees inside the time slice
+    uint64_t m_numberOfLiveBlocks;  ///< Memory blocks allocated but not freed inside the time slice - Memory leaks!
+    uint64_t m_numberOfLiveBlocksPeak;
     HistogramBin m_histogram[NUM_HISTOGRAM_BINS];
 
     void reset()
@@ -139,6 +210,7 @@ struct MemoryStats
 
     void setPeaksToCurrent();
     void setPeaksFrom(MemoryStatLocalPeak& _peaks);
+    void scale(double _factor);
 };
 
 //--------------------------------------------------------------------------
@@ -151,17 +223,17 @@ struct MemoryOperationGroup
         INDEX_MAPPINGS = 11
     };
 
-    typedef std::vector<MemoryOperation*> MemoryOpArray;
+    typedef std::vector<uint32_t> MemoryOpArray;  ///< Indices into capture memory operations
 
     uint32_t m_minSize;        ///< single allocation size
     uint32_t m_maxSize;        ///< single allocation size
     int64_t m_peakSize;        ///< group size
     int64_t m_peakSizeGlobal;  ///< total memory usage at the time of group peak size
     int64_t m_liveSize;        ///< group size
-    uint32_t m_count;
-    uint32_t m_liveCount;
-    uint32_t m_liveCountPeak;
-    uint32_t m_liveCountPeakGlobal;
+    uint64_t m_count;
+    uint64_t m_liveCount;
+    uint64_t m_liveCountPeak;
+    uint64_t m_liveCountPeakGlobal;
     MemoryOpArray m_operations;
     uint32_t m_indexMappings[INDEX_MAPPINGS];
     uint32_t m_histogram[rtm::MemoryStats::NUM_HISTOGRAM_BINS];
@@ -191,8 +263,8 @@ struct MemoryOperationGroup
 struct HistogramBinPeak
 {
     uint64_t m_sizePeak;
-    uint32_t m_overheadPeak;
-    uint32_t m_countPeak;
+    uint64_t m_overheadPeak;
+    uint64_t m_countPeak;
 };
 
 //--------------------------------------------------------------------------
@@ -201,8 +273,8 @@ struct HistogramBinPeak
 struct MemoryStatLocalPeak
 {
     uint64_t m_memoryUsagePeak;
-    uint32_t m_overheadPeak;
-    uint32_t m_numberOfLiveBlocksPeak;
+    uint64_t m_overheadPeak;
+    uint64_t m_numberOfLiveBlocksPeak;
     HistogramBinPeak m_HistogramPeak[MemoryStats::NUM_HISTOGRAM_BINS];
 };
 
@@ -212,11 +284,24 @@ struct MemoryStatLocalPeak
 struct MemoryStatsTimed
 {
     uint64_t m_time;
-    uint32_t m_operationIndex;
+    uint64_t m_operationIndex;
     MemoryStatLocalPeak m_localPeak;
     MemoryStats m_stats;
 };
 
+//--------------------------------------------------------------------------
+/// Single frame of a call stack. Frames are stored once for every distinct
+/// path from the outermost frame, call stacks with a common start share them.
+//--------------------------------------------------------------------------
+struct StackTraceNode
+{
+    uint64_t m_address;
+    uint64_t m_addressID;      ///< Unique symbol ID, set up once symbols are available
+    StackTraceNode* m_parent;  ///< Calling frame, NULL for the outermost frame
+    uint32_t m_depth;          ///< Number of frames up to and including this one
+    uint16_t m_treeIndex[2];   ///< Index of stack trace tree child for this frame, per scope
+};
+
 //--------------------------------------------------------------------------
 /// Structure representing a single call stack
 //--------------------------------------------------------------------------
@@ -228,14 +313,22 @@ struct StackTrace
         Filtered
     };
 
+    enum
+    {
+        MaxFrames = 512
+    };
+
+    StackTraceNode* m_frame;  ///< Innermost frame, the rest are reached through parents
     uint32_t m_numFrames;
     int16_t m_addedToTree[2];
-    uint64_t m_frames[1];
+    StackTrace* m_next[1];  ///< Links of stack trace lists in tree nodes, numFrames + 1 of them
 
     static uint32_t calculateSize(uint32_t numFrames);
-    static void init(StackTrace* st, uint32_t numFrames);
-    static uint16_t* getIndexArray(StackTrace* st);
+    static void init(StackTrace* st, StackTraceNode* _frame);
     static StackTrace** getNextArray(StackTrace* st);
+
+    /// Returns frame at given depth, 1 is the outermost frame
+    static const StackTraceNode* getFrame(const StackTrace* st, uint32_t _depth);
 };
 
 //--------------------------------------------------------------------------
@@ -259,10 +352,10 @@ struct StackTraceTree
     int64_t m_memUsagePeak;
     uint64_t m_minTime;
     uint64_t m_maxTime;
-    int32_t m_overhead;
-    int32_t m_overheadPeak;
+    int64_t m_overhead;
+    int64_t m_overheadPeak;
     int32_t m_depth;
-    int32_t m_opCount[StackTraceTree::Count];
+    int64_t m_opCount[StackTraceTree::Count];
     StackTraceTree* m_parent;
     StackTrace* m_stackTraceList;
     ChildNodes m_children;
@@ -279,7 +372,7 @@ struct StackTraceTree
         , m_parent(NULL)
         , m_stackTraceList(NULL)
     {
-        memset(&m_opCount[0], 0, sizeof(int32_t) * StackTraceTree::Count);
+        memset(&m_opCount[0], 0, sizeof(int64_t) * StackTraceTree::Count);
     }
 };
 
@@ -291,7 +384,7 @@ void destroyStackTree(StackTraceTree& _tree);
 struct MemoryTagTree
 {
     typedef robin_hood::unordered_map<uint32_t, MemoryTagTree*> ChildMap;
-    typedef std::vector<MemoryOperation*> OpList;
+    typedef std::vector<uint32_t> OpList;
 
     std::string m_name;
     uint32_t m_hash;
@@ -299,7 +392,7 @@ struct MemoryTagTree
     uint64_t m_usagePeak;
     uint64_t m_overhead;
     uint64_t m_overheadPeak;
-    uint32_t m_operationCount[rmem::LogMarkers::OpCount];
+    uint64_t m_operationCount[rmem::LogMarkers::OpCount];
     MemoryTagTree* m_parent;
     ChildMap m_children;
     OpList m_operations;
@@ -321,7 +414,7 @@ struct MemoryTagTree
 
 bool tagFind(MemoryTagTree& _rootTag, uint32_t _hash, MemoryTagTree*& ioResult, MemoryTagTree*& _prevTag);
 bool tagInsert(MemoryTagTree* _rootTag, MemoryTagTree* _tag, uint32_t _parentTagHash);
-void tagAddOp(MemoryTagTree& _rootTag, MemoryOperation* _op, MemoryTagTree*& _prevTag);
+void tagAddOp(MemoryTagTree& _rootTag, const MemoryOperations& _ops, uint32_t _index, MemoryTagTree*& _prevTag);
 void tagTreeDestroy(MemoryTagTree& _rootTag);
 
 struct MemoryMarkerEvent
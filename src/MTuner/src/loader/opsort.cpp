@@ -0,0 +1,455 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/opsort.h>
+#include <MTuner/src/loader/parallel.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace rtm
+{
+/// Below this many operations sorting is done on a single thread
+static const size_t s_minParallelSort = 64 * 1024;
+
+/// Upper bound on threads used for sorting
+static const uint32_t s_maxSortThreads = 16;
+
+/// Threads tracked per block, more than this falls back to radix sort
+static const uint32_t s_maxRunThreads = 64;
+
+/// Monotonic runs that are still cheaper to merge than to radix sort
+static const size_t s_maxMergeRuns = 1024;
+
+/// Radix digit width for LSD passes
+static const uint32_t s_radixBits = 11;
+static const uint32_t s_radixBuckets = 1 << s_radixBits;
+
+/// Sort key, index is the position in the input and breaks ties between equal times.
+/// Time is split in halves so the key takes 12 bytes, keys and the merge or radix
+/// buffer are all the memory sorting needs on top of the operations.
+struct SortKey
+{
+    uint32_t m_timeLow;
+    uint32_t m_timeHigh;
+    uint32_t m_index;
+
+    inline uint64_t getTime() const { return ((uint64_t)m_timeHigh << 32) | m_timeLow; }
+    inline void setTime(uint64_t _time)
+    {
+        m_timeLow = (uint32_t)_time;
+        m_timeHigh = (uint32_t)(_time >> 32);
+    }
+};
+
+static inline bool keyLess(const SortKey& _k1, const SortKey& _k2)
+{
+    const uint64_t t1 = _k1.getTime();
+    const uint64_t t2 = _k2.getTime();
+    return (t1 < t2) || ((t1 == t2) && (_k1.m_index < _k2.m_index));
+}
+
+//--------------------------------------------------------------------------
+/// Non-decreasing sequence of operations from one thread inside a block
+//--------------------------------------------------------------------------
+struct SortRun
+{
+    size_t m_offset;  ///< Start of run in run ordered key array
+    size_t m_size;
+};
+
+//--------------------------------------------------------------------------
+/// Contiguous part of the input processed by one sorting thread
+//--------------------------------------------------------------------------
+struct SortBlock
+{
+    size_t m_begin;
+    size_t m_end;
+    uint64_t m_minTime;
+    uint64_t m_maxTime;
+    std::vector<SortRun> m_runs;
+    bool m_mergeable;  ///< False if too many threads or runs were found
+
+    /// Assigns each operation to a run of its thread, a new run starts when time goes back
+    void findRuns(const uint64_t* _times, const uint32_t* _threads, uint32_t* _runIds)
+    {
+        uint32_t threadIndices[s_maxRunThreads];
+        uint32_t threadRuns[s_maxRunThreads];
+        uint64_t threadTimes[s_maxRunThreads];
+        uint32_t numThreads = 0;
+        uint32_t lastThread = 0;
+
+        m_minTime = (uint64_t)-1;
+        m_maxTime = 0;
+        m_mergeable = true;
+
+        for (size_t i = m_begin; i < m_end; ++i)
+        {
+            const uint64_t time = _times[i];
+            const uint32_t thread = _threads[i];
+
+            if (m_minTime > time)
+                m_minTime = time;
+            if (m_maxTime < time)
+                m_maxTime = time;
+
+            if (!m_mergeable)
+                continue;
+
+            // consecutive operations often come from the same thread
+            uint32_t t = lastThread;
+            if ((t >= numThreads) || (threadIndices[t] != thread))
+            {
+                for (t = 0; t < numThreads; ++t)
+                    if (threadIndices[t] == thread)
+                        break;
+
+                if (t == numThreads)
+                {
+                    if (numThreads == s_maxRunThreads)
+                    {
+                        m_mergeable = false;
+                        continue;
+                    }
+
+                    threadIndices[t] = thread;
+                    threadTimes[t] = 0;
+                    threadRuns[t] = (uint32_t)m_runs.size();
+                    m_runs.push_back(SortRun());
+                    m_runs.back().m_size = 0;
+                    ++numThreads;
+                }
+                lastThread = t;
+            }
+
+            if (time < threadTimes[t])
+            {
+                if (m_runs.size() == s_maxMergeRuns)
+                {
+                    m_mergeable = false;
+                    continue;
+                }
+
+                threadRuns[t] = (uint32_t)m_runs.size();
+                m_runs.push_back(SortRun());
+                m_runs.back().m_size = 0;
+            }
+
+            threadTimes[t] = time;
+            _runIds[i] = threadRuns[t];
+            ++m_runs[threadRuns[t]].m_size;
+        }
+    }
+};
+
+//--------------------------------------------------------------------------
+/// Merges runs with a binary heap, each run is already sorted by key
+//--------------------------------------------------------------------------
+struct MergeCursor
+{
+    const SortKey* m_pos;
+    const SortKey* m_end;
+};
+
+static inline bool cursorGreater(const MergeCursor& _c1, const MergeCursor& _c2)
+{
+    return keyLess(*_c2.m_pos, *_c1.m_pos);
+}
+
+static void mergeRuns(std::vector<MergeCursor>& _cursors, SortKey* _out)
+{
+    std::vector<MergeCursor> heap;
+    heap.reserve(_cursors.size());
+    for (size_t i = 0; i < _cursors.size(); ++i)
+        if (_cursors[i].m_pos != _cursors[i].m_end)
+            heap.push_back(_cursors[i]);
+
+    std::make_heap(heap.begin(), heap.end(), cursorGreater);
+
+    while (heap.size() > 1)
+    {
+        std::pop_heap(heap.begin(), heap.end(), cursorGreater);
+        MergeCursor& c = heap.back();
+        *_out++ = *c.m_pos++;
+        if (c.m_pos != c.m_end)
+            std::push_heap(heap.begin(), heap.end(), cursorGreater);
+        else
+            heap.pop_back();
+    }
+
+    if (heap.size())
+        std::copy(heap[0].m_pos, heap[0].m_end, _out);
+}
+
+//--------------------------------------------------------------------------
+/// Merges per-thread runs, output is split by key ranges so that each
+/// sorting thread merges an independent part
+//--------------------------------------------------------------------------
+static void sortByMerge(const uint64_t* _times,
+                        size_t _numOps,
+                        std::vector<SortBlock>& _blocks,
+                        std::vector<uint32_t>& _runIds,
+                        SortKey* _keys,
+                        std::vector<SortKey>& _out,
+                        uint32_t _numThreads)
+{
+    std::vector<MergeCursor> runs;
+
+    size_t offset = 0;
+    for (size_t b = 0; b < _blocks.size(); ++b)
+    {
+        for (size_t r = 0; r < _blocks[b].m_runs.size(); ++r)
+        {
+            SortRun& run = _blocks[b].m_runs[r];
+            run.m_offset = offset;
+            offset += run.m_size;
+
+            MergeCursor c;
+            c.m_pos = _keys + run.m_offset;
+            c.m_end = c.m_pos + run.m_size;
+            runs.push_back(c);
+        }
+    }
+
+    // gather keys into runs, each block fills only its own runs
+    runParallel((uint32_t)_blocks.size(), [&](uint32_t _b) {
+        const SortBlock& block = _blocks[_b];
+        std::vector<size_t> pos(block.m_runs.size());
+        for (size_t r = 0; r < block.m_runs.size(); ++r)
+            pos[r] = block.m_runs[r].m_offset;
+
+        for (size_t i = block.m_begin; i < block.m_end; ++i)
+        {
+            SortKey& key = _keys[pos[_runIds[i]]++];
+            key.setTime(_times[i]);
+            key.m_index = (uint32_t)i;
+        }
+    });
+
+    // run ids are gathered into keys, their memory goes to the merge output
+    _runIds.clear();
+    _runIds.shrink_to_fit();
+    _out.resize(_numOps);
+
+    // pick splitters from a sample of all runs
+    std::vector<SortKey> samples;
+    const size_t sampleStep = (_numOps / (_numThreads * 64)) + 1;
+    for (size_t r = 0; r < runs.size(); ++r)
+        for (const SortKey* k = runs[r].m_pos; k < runs[r].m_end; k += sampleStep)
+            samples.push_back(*k);
+    std::sort(samples.begin(), samples.end(), keyLess);
+
+    // split points of every run for each output part
+    const uint32_t numParts = _numThreads;
+    std::vector<const SortKey*> splits((numParts + 1) * runs.size());
+    for (size_t r = 0; r < runs.size(); ++r)
+    {
+        splits[r] = runs[r].m_pos;
+        splits[numParts * runs.size() + r] = runs[r].m_end;
+        for (uint32_t p = 1; p < numParts; ++p)
+        {
+            const SortKey& splitter = samples[samples.size() * p / numParts];
+            splits[p * runs.size() + r] = std::lower_bound(runs[r].m_pos, runs[r].m_end, splitter, keyLess);
+        }
+    }
+
+    runParallel(numParts, [&](uint32_t _p) {
+        size_t outOffset = 0;
+        std::vector<MergeCursor> cursors(runs.size());
+        for (size_t r = 0; r < runs.size(); ++r)
+        {
+            outOffset += (size_t)(splits[_p * runs.size() + r] - runs[r].m_pos);
+            cursors[r].m_pos = splits[_p * runs.size() + r];
+            cursors[r].m_end = splits[(_p + 1) * runs.size() + r];
+        }
+        mergeRuns(cursors, &_out[outOffset]);
+    });
+}
+
+//--------------------------------------------------------------------------
+/// Parallel LSD radix sort on time relative to the earliest operation.
+/// Every pass is stable so equal times stay in input order.
+//--------------------------------------------------------------------------
+static SortKey* sortByRadix(const uint64_t* _times,
+                            size_t _numOps,
+                            std::vector<SortBlock>& _blocks,
+                            uint64_t _minTime,
+                            uint64_t _maxTime,
+                            SortKey* _keys,
+                            std::vector<SortKey>& _temp)
+{
+    const uint32_t numBlocks = (uint32_t)_blocks.size();
+    _temp.resize(_numOps);
+
+    runParallel(numBlocks, [&](uint32_t _b) {
+        const SortBlock& block = _blocks[_b];
+        for (size_t i = block.m_begin; i < block.m_end; ++i)
+        {
+            _keys[i].setTime(_times[i] - _minTime);
+            _keys[i].m_index = (uint32_t)i;
+        }
+    });
+
+    uint32_t numBits = 0;
+    for (uint64_t range = _maxTime - _minTime; range; range >>= 1)
+        ++numBits;
+
+    std::vector<size_t> histograms(numBlocks * s_radixBuckets);
+
+    SortKey* src = _keys;
+    SortKey* dst = &_temp[0];
+    for (uint32_t shift = 0; shift < numBits; shift += s_radixBits)
+    {
+        runParallel(numBlocks, [&](uint32_t _b) {
+            const SortBlock& block = _blocks[_b];
+            size_t* histogram = &histograms[_b * s_radixBuckets];
+            memset(histogram, 0, sizeof(size_t) * s_radixBuckets);
+            for (size_t i = block.m_begin; i < block.m_end; ++i)
+                ++histogram[(src[i].getTime() >> shift) & (s_radixBuckets - 1)];
+        });
+
+        // bucket major, block minor offsets keep the scatter stable
+        size_t offset = 0;
+        for (uint32_t d = 0; d < s_radixBuckets; ++d)
+        {
+            for (uint32_t b = 0; b < numBlocks; ++b)
+            {
+                size_t count = histograms[b * s_radixBuckets + d];
+                histograms[b * s_radixBuckets + d] = offset;
+                offset += count;
+            }
+        }
+
+        runParallel(numBlocks, [&](uint32_t _b) {
+            const SortBlock& block = _blocks[_b];
+            size_t* offsets = &histograms[_b * s_radixBuckets];
+            for (size_t i = block.m_begin; i < block.m_end; ++i)
+                dst[offsets[(src[i].getTime() >> shift) & (s_radixBuckets - 1)]++] = src[i];
+        });
+
+        std::swap(src, dst);
+    }
+
+    return src;
+}
+
+/// Reorders a column by sorted keys, _temp has room for one element per key.
+/// Every thread only reads keys of its own block, so blocks are gathered in parallel.
+template <typename T>
+static void gatherColumn(std::vector<T>& _column,
+                         size_t _first,
+                         const SortKey* _sorted,
+                         void* _temp,
+                         const std::vector<SortBlock>& _blocks)
+{
+    T* column = &_column[_first];
+    T* temp = (T*)_temp;
+
+    runParallel((uint32_t)_blocks.size(), [&](uint32_t _b) {
+        for (size_t i = _blocks[_b].m_begin; i < _blocks[_b].m_end; ++i)
+            temp[i] = column[_sorted[i].m_index];
+    });
+
+    runParallel((uint32_t)_blocks.size(), [&](uint32_t _b) {
+        memcpy(column + _blocks[_b].m_begin, temp + _blocks[_b].m_begin,
+               sizeof(T) * (_blocks[_b].m_end - _blocks[_b].m_begin));
+    });
+}
+
+void sortOperationsByTime(MemoryOperations& _ops, size_t _first)
+{
+    // keys index operations with 32 bits, the store never holds more than that
+    const size_t numOps = _ops.size() - _first;
+    RTM_ASSERT(numOps <= MemoryOperations::MaxOperations, "Too many operations to sort");
+    if (numOps < 2)
+        return;
+
+    const uint64_t* times = &_ops.m_time[_first];
+    const uint32_t* threads = &_ops.m_threadIndex[_first];
+
+    // a stable sort of operations already in order leaves them as they are
+    if (std::is_sorted(times, times + numOps))
+        return;
+
+    uint32_t numThreads = std::thread::hardware_concurrency();
+    if (numThreads > s_maxSortThreads)
+        numThreads = s_maxSortThreads;
+    if ((numThreads == 0) || (numOps < s_minParallelSort))
+        numThreads = 1;
+
+    std::vector<SortBlock> blocks(numThreads);
+    for (uint32_t b = 0; b < numThreads; ++b)
+    {
+        blocks[b].m_begin = numOps * b / numThreads;
+        blocks[b].m_end = numOps * (b + 1) / numThreads;
+    }
+
+    std::vector<SortKey> keys(numOps);
+    std::vector<SortKey> temp;
+    SortKey* sorted;
+
+    if (numThreads == 1)
+    {
+        // keys break ties by index, a plain sort is stable
+        for (size_t i = 0; i < numOps; ++i)
+        {
+            keys[i].setTime(times[i]);
+            keys[i].m_index = (uint32_t)i;
+        }
+
+        std::sort(keys.begin(), keys.end(), keyLess);
+        temp.resize(numOps);
+        sorted = &keys[0];
+    }
+    else
+    {
+        std::vector<uint32_t> runIds(numOps);
+        runParallel(numThreads, [&](uint32_t _b) { blocks[_b].findRuns(times, threads, &runIds[0]); });
+
+        bool mergeable = true;
+        size_t numRuns = 0;
+        uint64_t minTime = (uint64_t)-1;
+        uint64_t maxTime = 0;
+        for (uint32_t b = 0; b < numThreads; ++b)
+        {
+            mergeable = mergeable && blocks[b].m_mergeable;
+            numRuns += blocks[b].m_runs.size();
+            minTime = blocks[b].m_minTime < minTime ? blocks[b].m_minTime : minTime;
+            maxTime = blocks[b].m_maxTime > maxTime ? blocks[b].m_maxTime : maxTime;
+        }
+
+        if (mergeable && (numRuns <= s_maxMergeRuns))
+        {
+            sortByMerge(times, numOps, blocks, runIds, &keys[0], temp, numThreads);
+            sorted = &temp[0];
+        }
+        else
+        {
+            runIds.clear();
+            runIds.shrink_to_fit();
+            sorted = sortByRadix(times, numOps, blocks, minTime, maxTime, &keys[0], temp);
+        }
+    }
+
+    // the key array not holding the sorted keys is free, it takes 12 bytes per operation
+    // and serves as the gather buffer of every column in turn
+    void* gather = (sorted == &keys[0]) ? (void*)&temp[0] : (void*)&keys[0];
+
+    gatherColumn(_ops.m_time, _first, sorted, gather, blocks);
+    gatherColumn(_ops.m_pointer, _first, sorted, gather, blocks);
+    gatherColumn(_ops.m_allocSize, _first, sorted, gather, blocks);
+    gatherColumn(_ops.m_overhead, _first, sorted, gather, blocks);
+    gatherColumn(_ops.m_stackTrace, _first, sorted, gather, blocks);
+    gatherColumn(_ops.m_threadIndex, _first, sorted, gather, blocks);
+    gatherColumn(_ops.m_heapIndex, _first, sorted, gather, blocks);
+    gatherColumn(_ops.m_chainPrev, _first, sorted, gather, blocks);
+    gatherColumn(_ops.m_chainNext, _first, sorted, gather, blocks);
+    gatherColumn(_ops.m_tag, _first, sorted, gather, blocks);
+    gatherColumn(_ops.m_type, _first, sorted, gather, blocks);
+    gatherColumn(_ops.m_alignment, _first, sorted, gather, blocks);
+}
+
+}  // namespace rtm
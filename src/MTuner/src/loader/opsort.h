@@ -0,0 +1,23 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_OPSORT_H__
+#define __RTM_MTUNER_OPSORT_H__
+
+#include <MTuner/src/loader/mtunerlib.h>
+
+namespace rtm
+{
+//--------------------------------------------------------------------------
+/// Stable sort of memory operations by operation time, starting at _first.
+/// Operations with equal time keep their relative order, same as std::stable_sort.
+/// Operations in the range must not be linked yet and there may be at most
+/// MemoryOperations::MaxOperations of them.
+//--------------------------------------------------------------------------
+void sortOperationsByTime(MemoryOperations& _ops, size_t _first = 0);
+
+}  // namespace rtm
+
+#endif  // __RTM_MTUNER_OPSORT_H__
@@ -0,0 +1,33 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_PARALLEL_H__
+#define __RTM_MTUNER_PARALLEL_H__
+
+#include <thread>
+#include <vector>
+
+namespace rtm
+{
+//--------------------------------------------------------------------------
+/// Calls _func(threadIndex) on _numThreads threads and waits for all of them.
+/// Index 0 runs on the calling thread, so it's the one to report progress from.
+//--------------------------------------------------------------------------
+template <typename Func>
+inline void runParallel(uint32_t _numThreads, Func _func)
+{
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < _numThreads; ++i)
+        workers.emplace_back(_func, i);
+
+    _func(0);
+
+    for (size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+}
+
+}  // namespace rtm
+
+#endif  // __RTM_MTUNER_PARALLEL_H__
@@ -0,0 +1,92 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/stacktracestore.h>
+
+namespace rtm
+{
+/// Hash of the path to a frame, made from hash of the path to calling frame
+static inline uint64_t getPathHash(uint64_t _parentHash, uint64_t _address)
+{
+    uint64_t hash = _parentHash * 0x9e3779b97f4a7c15ull + _address;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+StackTraceStore::StackTraceStore()
+    : m_numNodes(0)
+{
+}
+
+StackTraceStore::~StackTraceStore()
+{
+    clear();
+}
+
+void StackTraceStore::clear()
+{
+    for (size_t i = 0; i < m_blocks.size(); ++i)
+        delete[] m_blocks[i];
+
+    m_blocks.clear();
+    m_numNodes = 0;
+    m_nodeMap.clear();
+}
+
+StackTraceNode* StackTraceStore::intern(const uint64_t* _frames, uint32_t _numFrames)
+{
+    StackTraceNode* node = NULL;
+    uint64_t hash = 0;
+
+    for (uint32_t i = _numFrames; i-- > 0;)
+    {
+        hash = getPathHash(hash, _frames[i]);
+
+        NodeMap::iterator it = m_nodeMap.find(hash);
+        if (it != m_nodeMap.end())
+        {
+            StackTraceNode* found = it->second;
+            if ((found->m_parent == node) && (found->m_address == _frames[i]))
+            {
+                node = found;
+                continue;
+            }
+
+            // different path with the same hash keeps the entry, this frame is not shared
+            node = add(node, _frames[i]);
+            continue;
+        }
+
+        node = add(node, _frames[i]);
+        m_nodeMap[hash] = node;
+    }
+
+    return node;
+}
+
+StackTraceNode* StackTraceStore::add(StackTraceNode* _parent, uint64_t _address)
+{
+    if (m_numNodes == m_blocks.size() * BlockSize)
+        m_blocks.push_back(new StackTraceNode[BlockSize]);
+
+    StackTraceNode* node = getNode(m_numNodes++);
+    node->m_address = _address;
+    node->m_addressID = 0;
+    node->m_parent = _parent;
+    node->m_depth = _parent ? _parent->m_depth + 1 : 1;
+    node->m_treeIndex[StackTrace::Global] = (uint16_t)-1;
+    node->m_treeIndex[StackTrace::Filtered] = (uint16_t)-1;
+    return node;
+}
+
+void StackTraceStore::releaseLookup()
+{
+    NodeMap empty;
+    m_nodeMap.swap(empty);
+}
+
+}  // namespace rtm
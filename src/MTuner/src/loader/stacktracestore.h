@@ -0,0 +1,52 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_STACKTRACESTORE_H__
+#define __RTM_MTUNER_STACKTRACESTORE_H__
+
+#include <MTuner/src/loader/mtunerlib.h>
+
+namespace rtm
+{
+//--------------------------------------------------------------------------
+/// Stores frames of all call stacks as a prefix tree rooted at the outermost
+/// frames. Frames are looked up by a 64-bit hash of the path leading to them,
+/// so a call stack that starts like one added before reuses its frames.
+//--------------------------------------------------------------------------
+class StackTraceStore
+{
+    enum
+    {
+        BlockSize = 4096  ///< Frames allocated at once, frame addresses never change
+    };
+
+    typedef robin_hood::unordered_map<uint64_t, StackTraceNode*> NodeMap;
+
+    std::vector<StackTraceNode*> m_blocks;
+    size_t m_numNodes;
+    NodeMap m_nodeMap;  ///< Key is a hash of the frame addresses from the outermost one
+
+public:
+    StackTraceStore();
+    ~StackTraceStore();
+
+    void clear();
+
+    /// Returns innermost frame of the call stack, frames are ordered innermost first
+    StackTraceNode* intern(const uint64_t* _frames, uint32_t _numFrames);
+
+    /// Adds a frame that is not shared, used to restore frames in their original order
+    StackTraceNode* add(StackTraceNode* _parent, uint64_t _address);
+
+    /// Drops lookup data once no more call stacks are added
+    void releaseLookup();
+
+    size_t getNumNodes() const { return m_numNodes; }
+    StackTraceNode* getNode(size_t _index) const { return &m_blocks[_index / BlockSize][_index % BlockSize]; }
+};
+
+}  // namespace rtm
+
+#endif  // __RTM_MTUNER_STACKTRACESTORE_H__
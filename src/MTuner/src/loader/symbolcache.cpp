@@ -0,0 +1,654 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/symbolcache.h>
+#include <rbase/inc/hash.h>
+#include <rbase/inc/winchar.h>
+
+namespace rtm
+{
+static const uint32_t s_symbolCacheSignature = 0x5953544d;  // 'MTSY'
+static const size_t s_frameBatchSize = 4096;                 ///< Addresses sent to addr2line at once
+
+struct SymbolCacheHeader
+{
+    uint32_t m_signature;
+    uint32_t m_version;
+    uint64_t m_key;
+    uint32_t m_numStrings;
+    uint32_t m_numSymbols;
+    uint32_t m_symbolSize;
+};
+
+static FILE* openSymbolFile(const std::string& _path, bool _write)
+{
+#if RTM_PLATFORM_WINDOWS
+    rtm::MultiToWide path(_path.c_str());
+    return _wfopen(path.m_ptr, _write ? L"wb" : L"rb");
+#else
+    return fopen(_path.c_str(), _write ? "wb" : "rb");
+#endif
+}
+
+static bool replaceSymbolFile(const std::string& _from, const std::string& _to)
+{
+    QFile::remove(QString::fromUtf8(_to.c_str()));
+#if RTM_PLATFORM_WINDOWS
+    rtm::MultiToWide from(_from.c_str());
+    rtm::MultiToWide to(_to.c_str());
+    return _wrename(from.m_ptr, to.m_ptr) == 0;
+#else
+    return rename(_from.c_str(), _to.c_str()) == 0;
+#endif
+}
+
+/// Loaded files are marked as recently used, the least recently used ones are pruned
+static void touchSymbolFile(const std::string& _path)
+{
+    QFile file(QString::fromUtf8(_path.c_str()));
+    if (file.open(QIODevice::ReadWrite))
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+}
+
+static void appendKeyData(std::string& _data, const void* _ptr, size_t _size)
+{
+    _data.append((const char*)_ptr, _size);
+}
+
+static bool isKnownString(const char* _string)
+{
+    return (_string[0] != '\0') && (strcmp(_string, "??") != 0) && (strcmp(_string, "Unknown") != 0);
+}
+
+/// Frames without function or source location (no debug info, no PDB found) aren't
+/// written to module files, a later open with symbols available resolves them again
+static bool isFrameResolved(const rdebug::StackFrame& _frame)
+{
+    return isKnownString(_frame.m_func) && isKnownString(_frame.m_file);
+}
+
+/// Address ID of a frame resolved through addr2line, one per source line. Frames
+/// of the MTuner library get ID 0 so they are removed from the top of call stacks
+static bool getFrameAddressID(const rdebug::StackFrame& _frame, uint64_t& _addressID)
+{
+    if (!isFrameResolved(_frame))
+        return false;
+
+    if (strstr(_frame.m_moduleName, "MTunerDLL"))
+    {
+        _addressID = 0;
+        return true;
+    }
+
+    std::string key = _frame.m_moduleName;
+    key.append(1, '\0');
+    key.append(_frame.m_func);
+    key.append(1, '\0');
+    key.append(_frame.m_file);
+    appendKeyData(key, &_frame.m_line, sizeof(_frame.m_line));
+
+    _addressID = rtm::hashCity64(key.c_str(), (uint32_t)key.size());
+    if (_addressID == 0)
+        _addressID = 1;
+    return true;
+}
+
+SymbolCache::SymbolCache()
+    : m_callback(NULL)
+    , m_callbackData(NULL)
+    , m_resolver(0)
+    , m_resolverCreated(true)
+    , m_frameHits(0)
+    , m_frameMisses(0)
+{
+}
+
+SymbolCache::~SymbolCache()
+{
+    clear();
+}
+
+void SymbolCache::init(const rdebug::Toolchain& _toolchain,
+                       const std::string& _executable,
+                       const std::vector<rdebug::ModuleInfo>& _modules,
+                       const std::string& _cacheDir,
+                       rdebug::module_load_cb _callback,
+                       void* _data)
+{
+    clear();
+
+    m_moduleInfos = _modules;
+    m_executable = _executable;
+    m_callback = _callback;
+    m_callbackData = _data;
+    m_resolverCreated = false;
+    m_addr2line.init(_toolchain);
+
+    // symbols depend on toolchain and symbol source as well as on the binary
+    std::string toolchainKey;
+    appendKeyData(toolchainKey, &_toolchain.m_type, sizeof(_toolchain.m_type));
+    toolchainKey.append(_toolchain.m_toolchainPath);
+    toolchainKey.append(_toolchain.m_toolchainPrefix);
+
+    robin_hood::unordered_map<uint64_t, uint32_t> moduleIndices;
+    for (size_t i = 0; i < _modules.size(); ++i)
+    {
+        const rdebug::ModuleInfo& info = _modules[i];
+
+        Range range;
+        range.m_baseAddress = info.m_baseAddress;
+        range.m_size = info.m_size;
+        range.m_module = (uint32_t)-1;
+
+        // without the binary there is nothing to tell a rebuilt module from the cached one
+        QFileInfo file(QString::fromUtf8(info.m_modulePath));
+        if (!_cacheDir.empty() && file.exists())
+        {
+            const uint64_t fileSize = (uint64_t)file.size();
+            const uint64_t fileTime = (uint64_t)file.lastModified().toMSecsSinceEpoch();
+
+            std::string key = toolchainKey;
+            key.append(info.m_modulePath);
+            appendKeyData(key, &info.m_size, sizeof(info.m_size));
+            appendKeyData(key, &fileSize, sizeof(fileSize));
+            appendKeyData(key, &fileTime, sizeof(fileTime));
+            const uint64_t moduleKey = rtm::hashCity64(key.c_str(), (uint32_t)key.size());
+
+            robin_hood::unordered_map<uint64_t, uint32_t>::iterator it = moduleIndices.find(moduleKey);
+            if (it == moduleIndices.end())
+            {
+                char name[32];
+                snprintf(name, sizeof(name), "/%016llx.mtsym", (unsigned long long)moduleKey);
+
+                m_modules.emplace_back();
+                Module& module = m_modules.back();
+                module.m_key = moduleKey;
+                module.m_cachePath = _cacheDir + name;
+                module.m_modified = false;
+                if (!loadModule(module))
+                {
+                    module.m_symbols.clear();
+                    module.m_strings.clear();
+                    module.m_stringIndices.clear();
+                }
+
+                it = moduleIndices.insert(std::make_pair(moduleKey, (uint32_t)(m_modules.size() - 1))).first;
+            }
+
+            range.m_module = it->second;
+        }
+
+        m_ranges.push_back(range);
+    }
+}
+
+void SymbolCache::clear()
+{
+    if (m_resolver)
+        rdebug::symbolResolverDelete(m_resolver);
+
+    m_resolver = 0;
+    m_resolverCreated = true;
+    m_addr2line.clear();
+    m_modules.clear();
+    m_ranges.clear();
+    m_moduleInfos.clear();
+
+    for (uint32_t i = 0; i < NumFrameShards; ++i)
+        m_frameShards[i].m_frames.clear();
+    m_frameStrings.clear();
+    m_frameHits = 0;
+    m_frameMisses = 0;
+}
+
+void SymbolCache::save()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < m_modules.size(); ++i)
+    {
+        Module& module = m_modules[i];
+        if (!module.m_modified)
+            continue;
+
+        saveModule(module);
+        module.m_modified = false;
+    }
+}
+
+uint64_t SymbolCache::getAddressID(uint64_t _address)
+{
+    uint64_t baseAddress = 0, size = 0;
+    Module* module = findModule(_address, baseAddress, size);
+    const uint64_t offset = _address - baseAddress;
+
+    if (module)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        robin_hood::unordered_map<uint64_t, Symbol>::iterator it = module->m_symbols.find(offset);
+        if ((it != module->m_symbols.end()) && (it->second.m_flags & HasAddressID))
+            return (it->second.m_flags & RelativeID) ? baseAddress + it->second.m_addressID : it->second.m_addressID;
+    }
+
+    // frames resolved in a batch by addr2line already carry their ID
+    {
+        FrameShard& shard = getFrameShard(_address);
+        std::lock_guard<std::mutex> lock(shard.m_mutex);
+        robin_hood::unordered_map<uint64_t, Frame>::iterator it = shard.m_frames.find(_address);
+        if ((it != shard.m_frames.end()) && it->second.m_hasAddressID)
+            return it->second.m_addressID;
+    }
+
+    const uintptr_t resolver = getResolver();
+    if (!resolver)
+        return 0;
+
+    uint64_t addressID;
+    {
+        std::lock_guard<std::mutex> lock(m_resolverMutex);
+        addressID = rdebug::symbolResolverGetAddressID(resolver, _address);
+    }
+
+    if (module && addressID)
+    {
+        // IDs that are addresses inside the module stay valid when it's loaded elsewhere
+        const bool relative = (addressID >= baseAddress) && (addressID - baseAddress < size);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Symbol empty = {};
+        Symbol& symbol = module->m_symbols.emplace(offset, empty).first->second;
+        symbol.m_addressID = relative ? addressID - baseAddress : addressID;
+        symbol.m_flags = (symbol.m_flags & HasFrame) | HasAddressID | (relative ? RelativeID : 0);
+        module->m_modified = true;
+    }
+
+    return addressID;
+}
+
+bool SymbolCache::lookupFrame(uint64_t _address, rdebug::StackFrame& _frame)
+{
+    FrameShard& shard = getFrameShard(_address);
+    std::lock_guard<std::mutex> lock(shard.m_mutex);
+    robin_hood::unordered_map<uint64_t, Frame>::iterator it = shard.m_frames.find(_address);
+    if (it == shard.m_frames.end())
+        return false;
+
+    const Frame& frame = it->second;
+    rtm::strlCpy(_frame.m_moduleName, RTM_NUM_ELEMENTS(_frame.m_moduleName), frame.m_module);
+    rtm::strlCpy(_frame.m_func, RTM_NUM_ELEMENTS(_frame.m_func), frame.m_func);
+    rtm::strlCpy(_frame.m_file, RTM_NUM_ELEMENTS(_frame.m_file), frame.m_file);
+    _frame.m_line = frame.m_line;
+    return true;
+}
+
+bool SymbolCache::findFrame(uint64_t _address, rdebug::StackFrame& _frame)
+{
+    const bool found = lookupFrame(_address, _frame);
+    if (found)
+        ++m_frameHits;
+    else
+        ++m_frameMisses;
+
+    return found;
+}
+
+void SymbolCache::getFrame(uint64_t _address, rdebug::StackFrame& _frame)
+{
+    if (findFrame(_address, _frame))
+        return;
+
+    if (resolveFrame(_address, _frame))
+        addFrame(_address, _frame);
+}
+
+void SymbolCache::resolveFrames(const uint64_t* _addresses, size_t _count)
+{
+    if (!m_addr2line.isValid())
+        return;
+
+    // addresses that are neither in memory nor in module files, by module range
+    std::vector<std::pair<uint32_t, uint64_t>> missing;
+    for (size_t i = 0; i < _count; ++i)
+    {
+        const uint64_t address = _addresses[i];
+        const uint32_t range = findRange(address);
+        if ((range == (uint32_t)-1) || hasFrame(address, range))
+            continue;
+
+        missing.push_back(std::make_pair(range, address));
+    }
+
+    std::sort(missing.begin(), missing.end());
+    missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+    m_frameMisses += missing.size();
+
+    std::vector<uint64_t> addresses;
+    std::vector<rdebug::StackFrame> frames;
+    for (size_t i = 0; i < missing.size();)
+    {
+        const uint32_t range = missing[i].first;
+
+        addresses.clear();
+        for (; (i < missing.size()) && (missing[i].first == range) && (addresses.size() < s_frameBatchSize); ++i)
+            addresses.push_back(missing[i].second);
+
+        frames.resize(addresses.size());
+        if (!m_addr2line.resolve(m_moduleInfos[range].m_modulePath,
+                                 m_ranges[range].m_baseAddress,
+                                 addresses.data(),
+                                 addresses.size(),
+                                 frames.data()))
+            continue;
+
+        for (size_t j = 0; j < addresses.size(); ++j)
+        {
+            uint64_t addressID = 0;
+            const bool hasAddressID = getFrameAddressID(frames[j], addressID);
+            addModuleFrame(range, addresses[j], frames[j], hasAddressID, addressID);
+            addFrame(addresses[j], frames[j], hasAddressID, addressID);
+        }
+    }
+}
+
+bool SymbolCache::resolveFrame(uint64_t _address, rdebug::StackFrame& _frame)
+{
+    uint64_t baseAddress = 0, size = 0;
+    Module* module = findModule(_address, baseAddress, size);
+    const uint64_t offset = _address - baseAddress;
+
+    if (module)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        robin_hood::unordered_map<uint64_t, Symbol>::iterator it = module->m_symbols.find(offset);
+        if ((it != module->m_symbols.end()) && (it->second.m_flags & HasFrame))
+        {
+            const Symbol& symbol = it->second;
+            rtm::strlCpy(_frame.m_moduleName,
+                         RTM_NUM_ELEMENTS(_frame.m_moduleName),
+                         module->m_strings[symbol.m_module].c_str());
+            rtm::strlCpy(_frame.m_func, RTM_NUM_ELEMENTS(_frame.m_func), module->m_strings[symbol.m_func].c_str());
+            rtm::strlCpy(_frame.m_file, RTM_NUM_ELEMENTS(_frame.m_file), module->m_strings[symbol.m_file].c_str());
+            _frame.m_line = symbol.m_line;
+            return true;
+        }
+    }
+
+    // modules built with GCC or Clang are asked through a running addr2line first
+    const uint32_t range = findRange(_address);
+    const bool resolved = (range != (uint32_t)-1) && m_addr2line.resolve(m_moduleInfos[range].m_modulePath,
+                                                                         m_ranges[range].m_baseAddress,
+                                                                         &_address,
+                                                                         1,
+                                                                         &_frame);
+    uint64_t addressID = 0;
+    const bool hasAddressID = resolved && getFrameAddressID(_frame, addressID);
+    if (!resolved)
+    {
+        const uintptr_t resolver = getResolver();
+        if (!resolver)
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_resolverMutex);
+        rdebug::symbolResolverGetFrame(resolver, _address, &_frame);
+    }
+
+    if (range != (uint32_t)-1)
+        addModuleFrame(range, _address, _frame, hasAddressID, addressID);
+
+    return true;
+}
+
+bool SymbolCache::hasFrame(uint64_t _address, uint32_t _range)
+{
+    {
+        FrameShard& shard = getFrameShard(_address);
+        std::lock_guard<std::mutex> lock(shard.m_mutex);
+        if (shard.m_frames.find(_address) != shard.m_frames.end())
+            return true;
+    }
+
+    const Range& range = m_ranges[_range];
+    if (range.m_module == (uint32_t)-1)
+        return false;
+
+    const Module& module = m_modules[range.m_module];
+    std::lock_guard<std::mutex> lock(m_mutex);
+    robin_hood::unordered_map<uint64_t, Symbol>::const_iterator it =
+        module.m_symbols.find(_address - range.m_baseAddress);
+    return (it != module.m_symbols.end()) && (it->second.m_flags & HasFrame);
+}
+
+void SymbolCache::addFrame(uint64_t _address,
+                           const rdebug::StackFrame& _frame,
+                           bool _hasAddressID,
+                           uint64_t _addressID)
+{
+    Frame frame;
+    frame.m_module = internFrameString(_frame.m_moduleName);
+    frame.m_func = internFrameString(_frame.m_func);
+    frame.m_file = internFrameString(_frame.m_file);
+    frame.m_line = _frame.m_line;
+    frame.m_addressID = _addressID;
+    frame.m_hasAddressID = _hasAddressID;
+
+    FrameShard& shard = getFrameShard(_address);
+    std::lock_guard<std::mutex> lock(shard.m_mutex);
+    shard.m_frames[_address] = frame;
+}
+
+void SymbolCache::addModuleFrame(uint32_t _range,
+                                 uint64_t _address,
+                                 const rdebug::StackFrame& _frame,
+                                 bool _hasAddressID,
+                                 uint64_t _addressID)
+{
+    const Range& range = m_ranges[_range];
+    if ((range.m_module == (uint32_t)-1) || !isFrameResolved(_frame))
+        return;
+
+    Module& module = m_modules[range.m_module];
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Symbol empty = {};
+    Symbol& symbol = module.m_symbols.emplace(_address - range.m_baseAddress, empty).first->second;
+    symbol.m_module = internString(module, _frame.m_moduleName);
+    symbol.m_func = internString(module, _frame.m_func);
+    symbol.m_file = internString(module, _frame.m_file);
+    symbol.m_line = _frame.m_line;
+    symbol.m_flags |= HasFrame;
+    if (_hasAddressID && _addressID)
+    {
+        symbol.m_addressID = _addressID;
+        symbol.m_flags = (symbol.m_flags & ~RelativeID) | HasAddressID;
+    }
+    module.m_modified = true;
+}
+
+const char* SymbolCache::internFrameString(const char* _string)
+{
+    std::lock_guard<std::mutex> lock(m_frameStringsMutex);
+    return m_frameStrings.insert(_string).first->c_str();
+}
+
+void SymbolCache::preload()
+{
+    // addresses outside of known modules can only be resolved by the resolver
+    bool cached = !m_ranges.empty();
+    for (const Range& range : m_ranges)
+        if ((range.m_module == (uint32_t)-1) || m_modules[range.m_module].m_symbols.empty())
+            cached = false;
+
+    if (!cached)
+        getResolver();
+}
+
+uintptr_t SymbolCache::getResolver()
+{
+    if (m_resolverCreated)
+        return m_resolver;
+
+    std::lock_guard<std::mutex> lock(m_resolverMutex);
+    if (!m_resolverCreated)
+    {
+        m_resolver = rdebug::symbolResolverCreate(m_moduleInfos.data(),
+                                                  (uint32_t)m_moduleInfos.size(),
+                                                  m_executable.c_str(),
+                                                  m_callback,
+                                                  m_callbackData);
+        m_resolverCreated = true;
+    }
+
+    return m_resolver;
+}
+
+uint32_t SymbolCache::findRange(uint64_t _address) const
+{
+    for (size_t i = 0; i < m_ranges.size(); ++i)
+    {
+        const Range& range = m_ranges[i];
+        if ((_address >= range.m_baseAddress) && (_address - range.m_baseAddress < range.m_size))
+            return (uint32_t)i;
+    }
+
+    return (uint32_t)-1;
+}
+
+SymbolCache::Module* SymbolCache::findModule(uint64_t _address, uint64_t& _baseAddress, uint64_t& _size)
+{
+    const uint32_t index = findRange(_address);
+    if (index == (uint32_t)-1)
+        return NULL;
+
+    const Range& range = m_ranges[index];
+    if (range.m_module == (uint32_t)-1)
+        return NULL;
+
+    _baseAddress = range.m_baseAddress;
+    _size = range.m_size;
+    return &m_modules[range.m_module];
+}
+
+uint32_t SymbolCache::internString(Module& _module, const char* _string)
+{
+    robin_hood::unordered_map<std::string, uint32_t>::iterator it = _module.m_stringIndices.find(_string);
+    if (it != _module.m_stringIndices.end())
+        return it->second;
+
+    const uint32_t index = (uint32_t)_module.m_strings.size();
+    _module.m_strings.push_back(_string);
+    _module.m_stringIndices[_module.m_strings.back()] = index;
+    return index;
+}
+
+bool SymbolCache::loadModule(Module& _module)
+{
+    FILE* f = openSymbolFile(_module.m_cachePath, false);
+    if (!f)
+        return false;
+
+    // counts and lengths are checked against bytes left so a damaged file can't allocate more than its size
+    const uint64_t symbolEntrySize = sizeof(uint64_t) + sizeof(Symbol);
+    uint64_t bytesLeft = (uint64_t)QFileInfo(QString::fromUtf8(_module.m_cachePath.c_str())).size();
+
+    SymbolCacheHeader header;
+    bool valid = (bytesLeft >= sizeof(header)) && (fread(&header, sizeof(header), 1, f) == 1);
+    valid = valid && (header.m_signature == s_symbolCacheSignature);
+    valid = valid && (header.m_version == Version);
+    valid = valid && (header.m_key == _module.m_key);
+    valid = valid && (header.m_symbolSize == sizeof(Symbol));
+
+    if (valid)
+    {
+        bytesLeft -= sizeof(header);
+        valid = (uint64_t)header.m_numStrings * sizeof(uint32_t) <= bytesLeft;
+    }
+
+    if (valid)
+    {
+        _module.m_strings.reserve(header.m_numStrings);
+        for (uint32_t i = 0; (i < header.m_numStrings) && valid; ++i)
+        {
+            uint32_t length = 0;
+            valid = (bytesLeft >= sizeof(length)) && (fread(&length, sizeof(length), 1, f) == 1);
+            if (valid)
+                bytesLeft -= sizeof(length);
+            valid = valid && (length <= bytesLeft);
+
+            std::string str(valid ? length : 0, '\0');
+            valid = valid && ((length == 0) || (fread(&str[0], length, 1, f) == 1));
+            if (valid)
+                bytesLeft -= length;
+
+            _module.m_stringIndices[str] = i;
+            _module.m_strings.push_back(str);
+        }
+
+        valid = valid && ((uint64_t)header.m_numSymbols * symbolEntrySize == bytesLeft);
+    }
+
+    if (valid)
+    {
+        _module.m_symbols.reserve(header.m_numSymbols);
+        for (uint32_t i = 0; (i < header.m_numSymbols) && valid; ++i)
+        {
+            uint64_t offset = 0;
+            Symbol symbol = {};
+            valid = (fread(&offset, sizeof(offset), 1, f) == 1) && (fread(&symbol, sizeof(symbol), 1, f) == 1);
+
+            // string indices of a frame are only set once the frame is resolved
+            if ((symbol.m_flags & HasFrame) &&
+                ((symbol.m_module >= header.m_numStrings) || (symbol.m_func >= header.m_numStrings) ||
+                 (symbol.m_file >= header.m_numStrings)))
+                valid = false;
+
+            if (valid)
+                _module.m_symbols[offset] = symbol;
+        }
+    }
+
+    fclose(f);
+
+    if (valid)
+        touchSymbolFile(_module.m_cachePath);
+
+    return valid;
+}
+
+void SymbolCache::saveModule(const Module& _module)
+{
+    const std::string tempPath = _module.m_cachePath + ".tmp";
+    FILE* f = openSymbolFile(tempPath, true);
+    if (!f)
+        return;
+
+    SymbolCacheHeader header;
+    header.m_signature = s_symbolCacheSignature;
+    header.m_version = Version;
+    header.m_key = _module.m_key;
+    header.m_numStrings = (uint32_t)_module.m_strings.size();
+    header.m_numSymbols = (uint32_t)_module.m_symbols.size();
+    header.m_symbolSize = sizeof(Symbol);
+
+    bool written = fwrite(&header, sizeof(header), 1, f) == 1;
+    for (size_t i = 0; (i < _module.m_strings.size()) && written; ++i)
+    {
+        const std::string& str = _module.m_strings[i];
+        const uint32_t length = (uint32_t)str.size();
+        written = fwrite(&length, sizeof(length), 1, f) == 1;
+        written = written && ((length == 0) || (fwrite(str.c_str(), length, 1, f) == 1));
+    }
+
+    robin_hood::unordered_map<uint64_t, Symbol>::const_iterator it = _module.m_symbols.begin();
+    for (; (it != _module.m_symbols.end()) && written; ++it)
+        written = (fwrite(&it->first, sizeof(it->first), 1, f) == 1) &&
+                  (fwrite(&it->second, sizeof(it->second), 1, f) == 1);
+
+    written = (fclose(f) == 0) && written;
+
+    // a partially written file is never left in place of a valid one
+    if (!written || !replaceSymbolFile(tempPath, _module.m_cachePath))
+        QFile::remove(QString::fromUtf8(tempPath.c_str()));
+}
+
+}  // namespace rtm
@@ -0,0 +1,175 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_SYMBOLCACHE_H__
+#define __RTM_MTUNER_SYMBOLCACHE_H__
+
+#include <MTuner/src/loader/addr2line.h>
+#include <MTuner/src/loader/mtunerlib.h>
+#include <rdebug/inc/rdebug.h>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+
+namespace rtm
+{
+//--------------------------------------------------------------------------
+/// Resolves symbols through rdebug, frames and address IDs of GCC and Clang
+/// modules through addr2line, and keeps the results on disk, one file per
+/// module. A module file is keyed by module path, size and time stamp of the binary and by
+/// the toolchain, so repeated opens of captures made with the same binaries
+/// don't resolve already seen addresses again. The symbol resolver is only
+/// created once an address is missing from the cache. Frames looked up by
+/// views and logs are kept in memory in front of that, split into shards by
+/// address so lookups from many threads rarely wait.
+//--------------------------------------------------------------------------
+class SymbolCache
+{
+public:
+    enum
+    {
+        Version = 4,
+        NumFrameShards = 16
+    };
+
+private:
+    enum Flags
+    {
+        HasAddressID = 1,
+        HasFrame = 2,
+        RelativeID = 4  ///< Address ID is an address inside the module, stored as offset
+    };
+
+    struct Symbol
+    {
+        uint64_t m_addressID;
+        uint32_t m_module;  ///< String indices of frame data
+        uint32_t m_func;
+        uint32_t m_file;
+        uint32_t m_line;
+        uint32_t m_flags;
+    };
+
+    struct Module
+    {
+        uint64_t m_key;  ///< Hash of module and toolchain identity
+        std::string m_cachePath;
+        bool m_modified;
+        robin_hood::unordered_map<uint64_t, Symbol> m_symbols;  ///< Key is an offset into the module
+        std::vector<std::string> m_strings;
+        robin_hood::unordered_map<std::string, uint32_t> m_stringIndices;
+    };
+
+    /// Address range of a loaded module, module can be loaded more than once
+    struct Range
+    {
+        uint64_t m_baseAddress;
+        uint64_t m_size;
+        uint32_t m_module;  ///< Index of cached module, -1 if module binary wasn't found
+    };
+
+    /// Resolved frame, strings are interned and live as long as the cache
+    struct Frame
+    {
+        const char* m_module;
+        const char* m_func;
+        const char* m_file;
+        uint32_t m_line;
+        uint64_t m_addressID;
+        bool m_hasAddressID;  ///< Address ID was derived from a frame resolved by addr2line
+    };
+
+    struct FrameShard
+    {
+        std::mutex m_mutex;
+        robin_hood::unordered_map<uint64_t, Frame> m_frames;  ///< Key is an address
+    };
+
+    std::vector<Module> m_modules;
+    std::vector<Range> m_ranges;
+    std::mutex m_mutex;  ///< Guards module symbols, addresses are resolved from many threads
+
+    std::vector<rdebug::ModuleInfo> m_moduleInfos;
+    std::string m_executable;
+    rdebug::module_load_cb m_callback;
+    void* m_callbackData;
+    uintptr_t m_resolver;
+    std::atomic<bool> m_resolverCreated;
+    std::mutex m_resolverMutex;  ///< Guards resolver creation and calls into it, resolvers aren't thread safe
+    Addr2Line m_addr2line;       ///< Batched symbolization of GCC and Clang modules, used before the resolver
+
+    FrameShard m_frameShards[NumFrameShards];
+    std::unordered_set<std::string> m_frameStrings;  ///< Node based, interned strings never move
+    std::mutex m_frameStringsMutex;
+    std::atomic<uint64_t> m_frameHits;
+    std::atomic<uint64_t> m_frameMisses;
+
+public:
+    SymbolCache();
+    ~SymbolCache();
+
+    /// Loads cached symbols of modules, resolver gets created on first cache miss
+    void init(const rdebug::Toolchain& _toolchain,
+              const std::string& _executable,
+              const std::vector<rdebug::ModuleInfo>& _modules,
+              const std::string& _cacheDir,
+              rdebug::module_load_cb _callback,
+              void* _data);
+
+    /// Releases the resolver and cached symbols, doesn't save them
+    void clear();
+
+    /// Creates the resolver ahead of lookups if some module has no cached symbols,
+    /// loading debug info is the slow part and can overlap other work this way
+    void preload();
+
+    /// Writes symbols resolved since init to cache files of their modules
+    void save();
+
+    uint64_t getAddressID(uint64_t _address);
+    void getFrame(uint64_t _address, rdebug::StackFrame& _frame);
+
+    /// Resolves frames of many addresses at once where the toolchain allows it,
+    /// frames and their address IDs are then served from memory
+    void resolveFrames(const uint64_t* _addresses, size_t _count);
+
+    /// Fills the frame only if it was resolved before, never waits for the resolver
+    bool findFrame(uint64_t _address, rdebug::StackFrame& _frame);
+
+    /// Frame lookups, including ones made by views and batches, served from memory
+    /// and ones that went to module files, addr2line or the resolver
+    uint64_t getFrameHits() const { return m_frameHits; }
+    uint64_t getFrameMisses() const { return m_frameMisses; }
+
+private:
+    bool lookupFrame(uint64_t _address, rdebug::StackFrame& _frame);
+    bool resolveFrame(uint64_t _address, rdebug::StackFrame& _frame);
+    bool hasFrame(uint64_t _address, uint32_t _range);
+    void addFrame(uint64_t _address,
+                  const rdebug::StackFrame& _frame,
+                  bool _hasAddressID = false,
+                  uint64_t _addressID = 0);
+    void addModuleFrame(uint32_t _range,
+                        uint64_t _address,
+                        const rdebug::StackFrame& _frame,
+                        bool _hasAddressID = false,
+                        uint64_t _addressID = 0);
+    const char* internFrameString(const char* _string);
+    FrameShard& getFrameShard(uint64_t _address)
+    {
+        return m_frameShards[(_address * 0x9e3779b97f4a7c15ull) >> 60];
+    }
+    uintptr_t getResolver();
+    uint32_t findRange(uint64_t _address) const;
+    Module* findModule(uint64_t _address, uint64_t& _baseAddress, uint64_t& _size);
+    uint32_t internString(Module& _module, const char* _string);
+    bool loadModule(Module& _module);
+    void saveModule(const Module& _module);
+};
+
+}  // namespace rtm
+
+#endif  // __RTM_MTUNER_SYMBOLCACHE_H__
@@ -18,18 +18,6 @@ static inline bool isAlloc(uint16_t _op)
 	return (_op != rmem::LogMarkers::OpFree);
 }
 
-/// Sets memory operation to invalid state
-static inline void setInvalid(MemoryOperation* _op)
-{
-	_op->m_isValid = 0;
-}
-
-/// Returns true if operation is invalid
-static inline bool isInvalid(MemoryOperation* _op)
-{
-	return _op->m_isValid == 0;
-}
-
 //--------------------------------------------------------------------------
 /// Returns the index of the histogram bin based on allocation size
 //--------------------------------------------------------------------------
@@ -45,12 +33,15 @@ static inline uint8_t getHistogramBinIndex(uint32_t _size)
 //--------------------------------------------------------------------------
 /// Fills memory statistics structure for alloc family of functions
 //--------------------------------------------------------------------------
-static inline uint32_t fillStats_Alloc(MemoryOperation* _op, MemoryStats& _stats)
+static inline uint32_t fillStats_Alloc(const MemoryOperations& _ops, uint32_t _index, MemoryStats& _stats)
 {
-	_stats.m_memoryUsage		+= _op->m_allocSize;
+	const uint32_t allocSize	= _ops.m_allocSize[_index];
+	const uint32_t overhead		= _ops.m_overhead[_index];
+
+	_stats.m_memoryUsage		+= allocSize;
 	_stats.m_memoryUsagePeak	= qMax(_stats.m_memoryUsage, _stats.m_memoryUsagePeak);
 
-	_stats.m_overhead			+= _op->m_overhead;
+	_stats.m_overhead			+= overhead;
 	_stats.m_overheadPeak		= qMax(_stats.m_overhead, _stats.m_overheadPeak);
 
 	++_stats.m_numberOfLiveBlocks;
@@ -58,11 +49,11 @@ static inline uint32_t fillStats_Alloc(MemoryOperation* _op, MemoryStats& _stats
 
 	++_stats.m_numberOfAllocations;
 
-	const uint32_t binIdx = getHistogramBinIndex(_op->m_allocSize);
+	const uint32_t binIdx = getHistogramBinIndex(allocSize);
 
 	_stats.m_histogram[binIdx].m_count		+= 1;
-	_stats.m_histogram[binIdx].m_size		+= _op->m_allocSize;
-	_stats.m_histogram[binIdx].m_overhead	+= _op->m_overhead;
+	_stats.m_histogram[binIdx].m_size		+= allocSize;
+	_stats.m_histogram[binIdx].m_overhead	+= overhead;
 
 	_stats.m_histogram[binIdx].m_countPeak		= qMax(_stats.m_histogram[binIdx].m_countPeak, _stats.m_histogram[binIdx].m_count);
 	_stats.m_histogram[binIdx].m_sizePeak		= qMax(_stats.m_histogram[binIdx].m_sizePeak, _stats.m_histogram[binIdx].m_size);
@@ -74,40 +65,43 @@ static inline uint32_t fillStats_Alloc(MemoryOperation* _op, MemoryStats& _stats
 //--------------------------------------------------------------------------
 /// Fills memory statistics structure for realloc family of functions
 //--------------------------------------------------------------------------
-static inline uint32_t fillStats_ReAlloc(MemoryOperation* _op, MemoryStats& _stats)
+static inline uint32_t fillStats_ReAlloc(const MemoryOperations& _ops, uint32_t _index, MemoryStats& _stats)
 {
-	MemoryOperation* prevOp = _op->m_chainPrev;
-
-	_stats.m_memoryUsage		+= _op->m_allocSize;
-	if (prevOp)
-		_stats.m_memoryUsage	-= prevOp->m_allocSize;
+	const uint32_t allocSize	= _ops.m_allocSize[_index];
+	const uint32_t overhead		= _ops.m_overhead[_index];
+	const uint32_t prevOp		= _ops.m_chainPrev[_index];
+	const bool hasPrev			= prevOp != MemoryOperations::NoOperation;
+
+	_stats.m_memoryUsage		+= allocSize;
+	if (hasPrev)
+		_stats.m_memoryUsage	-= _ops.m_allocSize[prevOp];
 	_stats.m_memoryUsagePeak	= qMax(_stats.m_memoryUsage, _stats.m_memoryUsagePeak);
 
-	_stats.m_overhead			+= _op->m_overhead;
-	if (prevOp)
-		_stats.m_overhead		-= prevOp->m_overhead;
+	_stats.m_overhead			+= overhead;
+	if (hasPrev)
+		_stats.m_overhead		-= _ops.m_overhead[prevOp];
 	_stats.m_overheadPeak		= qMax(_stats.m_overhead, _stats.m_overheadPeak);
 
 	++_stats.m_numberOfReAllocations;
 
-	const uint32_t binIdx = getHistogramBinIndex(_op->m_allocSize);
+	const uint32_t binIdx = getHistogramBinIndex(allocSize);
 
 	_stats.m_histogram[binIdx].m_count			+= 1;
-	_stats.m_histogram[binIdx].m_size			+= _op->m_allocSize;
-	_stats.m_histogram[binIdx].m_overhead		+= _op->m_overhead;
+	_stats.m_histogram[binIdx].m_size			+= allocSize;
+	_stats.m_histogram[binIdx].m_overhead		+= overhead;
 
-	if (prevOp)
+	if (hasPrev)
 	{
-		const uint32_t binIdxPrev = getHistogramBinIndex(prevOp->m_allocSize);
+		const uint32_t binIdxPrev = getHistogramBinIndex(_ops.m_allocSize[prevOp]);
 
 		_stats.m_histogram[binIdxPrev].m_count		-= 1;
-		_stats.m_histogram[binIdxPrev].m_size		-= prevOp->m_allocSize;
-		_stats.m_histogram[binIdxPrev].m_overhead	-= prevOp->m_overhead;
+		_stats.m_histogram[binIdxPrev].m_size		-= _ops.m_allocSize[prevOp];
+		_stats.m_histogram[binIdxPrev].m_overhead	-= _ops.m_overhead[prevOp];
 	}
 	else
 	{
 		// if there is no previous block or if we didn't free the block using realloc - increase live count
-		if (_op->m_pointer != 0)
+		if (_ops.m_pointer[_index] != 0)
 		{
 			++_stats.m_numberOfLiveBlocks;
 			_stats.m_numberOfLiveBlocksPeak = qMax(_stats.m_numberOfLiveBlocks, _stats.m_numberOfLiveBlocksPeak);
@@ -124,19 +118,22 @@ static inline uint32_t fillStats_ReAlloc(MemoryOperation* _op, MemoryStats& _sta
 //--------------------------------------------------------------------------
 /// Fills memory statistics structure for free function
 //--------------------------------------------------------------------------
-static inline void fillStats_Free(MemoryOperation* _op, MemoryStats& _stats)
+static inline void fillStats_Free(const MemoryOperations& _ops, uint32_t _index, MemoryStats& _stats)
 {
-	_stats.m_memoryUsage	-= _op->m_allocSize;
-	_stats.m_overhead		-= _op->m_overhead;
+	const uint32_t allocSize	= _ops.m_allocSize[_index];
+	const uint32_t overhead		= _ops.m_overhead[_index];
+
+	_stats.m_memoryUsage	-= allocSize;
+	_stats.m_overhead		-= overhead;
 				
 	++_stats.m_numberOfFrees;
 	--_stats.m_numberOfLiveBlocks;
 
-	const uint32_t binIdx = getHistogramBinIndex(_op->m_allocSize);
+	const uint32_t binIdx = getHistogramBinIndex(allocSize);
 	
 	_stats.m_histogram[binIdx].m_count		-= 1;
-	_stats.m_histogram[binIdx].m_size		-= _op->m_allocSize;
-	_stats.m_histogram[binIdx].m_overhead	-= _op->m_overhead;
+	_stats.m_histogram[binIdx].m_size		-= allocSize;
+	_stats.m_histogram[binIdx].m_overhead	-= overhead;
 }
 
 } // namespace rtm
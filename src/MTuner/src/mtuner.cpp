@@ -25,6 +25,7 @@
 #include <MTuner/src/tagtreewidget.h>
 #include <MTuner/src/version.h>
 #include <MTuner/src/welcome.h>
+#include <MTuner/src/loader/capturestream.h>
 
 #include <rbase/inc/thread.h>
 #include <rqt/inc/rqt.h>
@@ -33,6 +34,9 @@
 #define WIN32_LEAN_AND_MEAN
 #include <Shlobj.h>
 #include <versionhelpers.h>
+#else
+#include <errno.h>
+#include <signal.h>
 #endif  // RTM_PLATFORM_WINDOWS
 
 namespace rqt
@@ -52,17 +56,20 @@ QString getDirFromFile(const QString& _file)
 
 void resolverCallBack(const char* _name, void* _customData);
 
-void setupLoaderToolchain(CaptureContext* _context,
-                          const QString& _file,
-                          GCCSetup* _gccSetup,
-                          QFileDialog* _fileDialog,
-                          MTuner* _mtuner,
-                          const QString& _symSource,
-                          rdebug::module_load_cb _callBack)
+//--------------------------------------------------------------------------
+/// Picks the toolchain and the symbol source for a loaded capture, asking the
+/// user when running the GUI. Must be called on the UI thread.
+//--------------------------------------------------------------------------
+void selectLoaderToolchain(CaptureContext* _context,
+                           const std::vector<rdebug::ModuleInfo>& _modules,
+                           const QString& _file,
+                           GCCSetup* _gccSetup,
+                           QFileDialog* _fileDialog,
+                           MTuner* _mtuner,
+                           const QString& _symSource,
+                           rdebug::Toolchain& _toolchain,
+                           std::string& _executable)
 {
-    rdebug::Toolchain tc;
-    std::string executable;
-
     // if not a MSVC toolchain - locate the executable
     if (_context->m_capture->getToolchain() != rmem::ToolChain::Win_MSVC)
     {
@@ -104,12 +111,12 @@ void setupLoaderToolchain(CaptureContext* _context,
         bool symSrcFound = false;
         if (_context->m_capture->getToolchain() == rmem::ToolChain::Win_gcc)
         {
-            const char* exe = _context->m_capture->getModuleInfos()[0].m_modulePath;
+            const char* exe = _modules[0].m_modulePath;
             if (strstr(exe, ".exe") || strstr(exe, ".elf"))
             {
                 if (QFileInfo(QString::fromUtf8(exe)).exists())
                 {
-                    executable = exe;
+                    _executable = exe;
                     symSrcFound = true;
                 }
             }
@@ -121,13 +128,13 @@ void setupLoaderToolchain(CaptureContext* _context,
             QString dir = getDirFromFile(_file);
             QString fileName =
                 _fileDialog->getOpenFileName(_mtuner, QObject::tr("select symbol source"), dir, extensions);
-            executable = fileName.toUtf8().constData();
+            _executable = fileName.toUtf8().constData();
         }
         else if (!symSrcFound)
         {
             // cmd
-            executable = _symSource.toUtf8().constData();
-            if (executable.length() == 0)
+            _executable = _symSource.toUtf8().constData();
+            if (_executable.length() == 0)
                 rtm::Console::info("No symbol source specified, symbols will not be resolved!\n");
         }
 
@@ -158,20 +165,74 @@ void setupLoaderToolchain(CaptureContext* _context,
             }
         }
 
-        tc = _gccSetup->getToolchainInfo(_context->m_capture->getToolchain(), _context->m_capture->is64bit());
+        _toolchain = _gccSetup->getToolchainInfo(_context->m_capture->getToolchain(), _context->m_capture->is64bit());
     }
     else
     {
-        tc.m_type = rdebug::Toolchain::MSVC;
-        strcpy(tc.m_toolchainPath, _symSource.toUtf8());
-        std::vector<rdebug::ModuleInfo>& modInfos = _context->m_capture->getModuleInfos();
-        if (modInfos.size())
-            executable = _context->m_capture->getModuleInfos()[0].m_modulePath;
+        _toolchain.m_type = rdebug::Toolchain::MSVC;
+        strcpy(_toolchain.m_toolchainPath, _symSource.toUtf8());
+        if (_modules.size())
+            _executable = _modules[0].m_modulePath;
     }
+}
+
+void setupLoaderToolchain(CaptureContext* _context,
+                          const QString& _file,
+                          GCCSetup* _gccSetup,
+                          QFileDialog* _fileDialog,
+                          MTuner* _mtuner,
+                          const QString& _symSource,
+                          rdebug::module_load_cb _callBack)
+{
+    // symbol source may have been picked already, when the capture header was loaded
+    rdebug::Toolchain tc;
+    std::string executable;
+    if (_context->m_symbolSourceSelected)
+    {
+        tc = _context->m_symbolToolchain;
+        executable = _context->m_symbolExecutable;
+    }
+    else
+        selectLoaderToolchain(_context,
+                              _context->m_capture->getModuleInfos(),
+                              _file,
+                              _gccSetup,
+                              _fileDialog,
+                              _mtuner,
+                              _symSource,
+                              tc,
+                              executable);
 
     _context->setupResolver(tc, executable, _callBack, _mtuner);
 }
 
+//--------------------------------------------------------------------------
+/// Picks the toolchain once modules from the capture header are known and
+/// starts loading their symbols while the capture is still being loaded.
+/// Must be called on the UI thread.
+//--------------------------------------------------------------------------
+void preloadLoaderSymbols(CaptureContext* _context,
+                          const std::vector<rdebug::ModuleInfo>& _modules,
+                          const QString& _file,
+                          GCCSetup* _gccSetup,
+                          QFileDialog* _fileDialog,
+                          MTuner* _mtuner,
+                          const QString& _symSource,
+                          rdebug::module_load_cb _callBack)
+{
+    rdebug::Toolchain tc;
+    std::string executable;
+    if (_context->m_symbolSourceSelected)
+    {
+        tc = _context->m_symbolToolchain;
+        executable = _context->m_symbolExecutable;
+    }
+    else
+        selectLoaderToolchain(_context, _modules, _file, _gccSetup, _fileDialog, _mtuner, _symSource, tc, executable);
+
+    _context->preloadSymbols(tc, executable, _modules, _callBack, _mtuner);
+}
+
 MTuner::MTuner(QWidget* _parent, Qt::WindowFlags _flags)
     : QMainWindow(_parent, _flags)
 {
@@ -186,7 +247,15 @@ MTuner::MTuner(QWidget* _parent, Qt::WindowFlags _flags)
     connect(m_projectsManager, SIGNAL(captureStartMonitoring()), this, SLOT(startCaptureStatusTimer()));
 
     m_watchTimer = NULL;
+    m_watchTicks = 0;
     m_capturePid = 0;
+    m_liveOpened = false;
+    m_stream = NULL;
+    m_streamTimer = NULL;
+    m_streamOpened = false;
+    m_liveThread = NULL;
+    m_liveResult = rtm::Capture::LoadFail;
+    m_liveChanged = false;
 
     m_loadingProgressBar = new QProgressBar();
     m_loadingProgressBar->setRange(0, 10000);
@@ -195,9 +264,22 @@ MTuner::MTuner(QWidget* _parent, Qt::WindowFlags _flags)
     m_loadingProgressBar->setVisible(false);
     statusBar()->insertPermanentWidget(0, m_loadingProgressBar);
 
+    m_loadCancelButton = new QToolButton();
+    m_loadCancelButton->setText(tr("Cancel"));
+    m_loadCancelButton->setToolTip(tr("Stop loading the capture"));
+    m_loadCancelButton->setVisible(false);
+    statusBar()->insertPermanentWidget(1, m_loadCancelButton);
+    connect(m_loadCancelButton, SIGNAL(clicked()), this, SLOT(cancelLoad()));
+
+    m_loadThread = NULL;
+    m_loadContext = NULL;
+    m_loadResult = rtm::Capture::LoadFail;
+    m_loadSelectingSymbols = false;
+    m_loadFinishDeferred = false;
+
     m_statusBarRedDot = new QLabel();
     m_statusBarRedDot->setPixmap(QPixmap(":/MTuner/resources/images/red_dot.png"));
-    statusBar()->insertPermanentWidget(1, m_statusBarRedDot);
+    statusBar()->insertPermanentWidget(2, m_statusBarRedDot);
     m_statusBarRedDot->setVisible(false);
 
     m_fileDialog = new QFileDialog(this);
@@ -291,6 +373,19 @@ void MTuner::changeEvent(QEvent* _event)
 void MTuner::closeEvent(QCloseEvent*)
 {
     writeSettings();
+
+    // capture being loaded is dropped, analysis can't be stopped midway so wait for it
+    if (m_loadThread)
+    {
+        m_loadContext->m_capture->cancelLoad();
+        m_loadThread->wait();
+    }
+
+    if (m_liveThread)
+        m_liveThread->wait();
+
+    for (QThread* thread : m_releaseThreads)
+        thread->wait();
 }
 
 void MTuner::openFile()
@@ -301,6 +396,145 @@ void MTuner::openFile()
     openFileFromPath(fileName);
 }
 
+static QString getIDListString(const std::vector<uint64_t>& _ids)
+{
+    QStringList ids;
+    for (size_t i = 0; i < _ids.size(); ++i)
+        ids.append(QString("0x") + QString::number(_ids[i], 16));
+    return ids.join(", ");
+}
+
+static bool getIDList(const QString& _text, std::vector<uint64_t>& _ids)
+{
+    _ids.clear();
+
+    QStringList ids = _text.split(QRegularExpression("[,\\s]+"), Qt::SkipEmptyParts);
+    for (int i = 0; i < ids.size(); ++i)
+    {
+        bool ok = false;
+        uint64_t id = ids[i].toULongLong(&ok, 0);
+        if (!ok)
+            return false;
+        _ids.push_back(id);
+    }
+    return true;
+}
+
+static bool getTime(const QString& _text, double& _time)
+{
+    if (_text.trimmed().isEmpty())
+    {
+        _time = -1.0;
+        return true;
+    }
+
+    bool ok = false;
+    _time = _text.toDouble(&ok);
+    return ok && (_time >= 0.0);
+}
+
+//--------------------------------------------------------------------------
+/// Asks for the part of a capture to load, returns false if cancelled
+//--------------------------------------------------------------------------
+static bool editLoadFilter(QWidget* _parent, rtm::LoadFilter& _filter)
+{
+    QDialog dialog(_parent);
+    dialog.setWindowTitle(QObject::tr("Load filter"));
+
+    QLineEdit* minTime = new QLineEdit();
+    QLineEdit* maxTime = new QLineEdit();
+    // all digits so that times read back convert to the same clock values
+    if (_filter.m_minTime >= 0.0)
+        minTime->setText(QString::number(_filter.m_minTime, 'g', 17));
+    if (_filter.m_maxTime >= 0.0)
+        maxTime->setText(QString::number(_filter.m_maxTime, 'g', 17));
+    QLineEdit* threads = new QLineEdit(getIDListString(_filter.m_threads));
+    QLineEdit* heaps = new QLineEdit(getIDListString(_filter.m_heaps));
+    minTime->setPlaceholderText(QObject::tr("start of capture"));
+    maxTime->setPlaceholderText(QObject::tr("end of capture"));
+    threads->setPlaceholderText(QObject::tr("all threads"));
+    heaps->setPlaceholderText(QObject::tr("all heaps"));
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    QObject::connect(buttons, SIGNAL(accepted()), &dialog, SLOT(accept()));
+    QObject::connect(buttons, SIGNAL(rejected()), &dialog, SLOT(reject()));
+
+    QFormLayout* layout = new QFormLayout(&dialog);
+    layout->addRow(QObject::tr("Start time (seconds)"), minTime);
+    layout->addRow(QObject::tr("End time (seconds)"), maxTime);
+    layout->addRow(QObject::tr("Thread IDs"), threads);
+    layout->addRow(QObject::tr("Heap handles"), heaps);
+    layout->addRow(buttons);
+
+    for (;;)
+    {
+        if (dialog.exec() != QDialog::Accepted)
+            return false;
+
+        rtm::LoadFilter filter;
+        if (getTime(minTime->text(), filter.m_minTime) && getTime(maxTime->text(), filter.m_maxTime) &&
+            getIDList(threads->text(), filter.m_threads) && getIDList(heaps->text(), filter.m_heaps))
+        {
+            _filter = filter;
+            return true;
+        }
+
+        QMessageBox::warning(&dialog,
+                             QObject::tr("Load filter"),
+                             QObject::tr("Times have to be positive numbers, thread IDs and heap handles "
+                                         "decimal or 0x prefixed hexadecimal numbers separated by commas"));
+    }
+}
+
+void MTuner::openFileFiltered()
+{
+    m_fileDialog->setFileMode(QFileDialog::ExistingFile);
+    QString fileName =
+        m_fileDialog->getOpenFileName(this, tr("select a capture file"), getCaptureLocation(), "MTuner files (*.MTuner)");
+    if (fileName.isEmpty() || !editLoadFilter(this, m_loadFilter))
+        return;
+
+    openFileFromPath(fileName, m_loadFilter);
+}
+
+void MTuner::openFileOverview()
+{
+    m_fileDialog->setFileMode(QFileDialog::ExistingFile);
+    QString fileName =
+        m_fileDialog->getOpenFileName(this, tr("select a capture file"), getCaptureLocation(), "MTuner files (*.MTuner)");
+    openFileFromPath(fileName, rtm::LoadFilter(), LoadOverview);
+}
+
+void MTuner::openFilePreview()
+{
+    m_fileDialog->setFileMode(QFileDialog::ExistingFile);
+    QString fileName =
+        m_fileDialog->getOpenFileName(this, tr("select a capture file"), getCaptureLocation(), "MTuner files (*.MTuner)");
+    openFileFromPath(fileName, rtm::LoadFilter(), LoadPreview);
+}
+
+//--------------------------------------------------------------------------
+/// Loads time range selected in the graph of current capture in full, the
+/// usual way to continue from a preview or overview
+//--------------------------------------------------------------------------
+void MTuner::loadSelectedRange()
+{
+    BinLoaderView* view = m_centralWidget->getCurrentView();
+    CaptureContext* context = view ? view->getContext() : NULL;
+    if (!context)
+        return;
+
+    // float seconds can't hold clock values of a long running process
+    rtm::Capture* capture = context->m_capture;
+    const double frequency = (double)capture->getCPUFrequency();
+    m_loadFilter.m_minTime = (double)capture->getSnapshotTimeMin() / frequency;
+    m_loadFilter.m_maxTime = (double)capture->getSnapshotTimeMax() / frequency;
+    if (!editLoadFilter(this, m_loadFilter))
+        return;
+
+    openFileFromPath(QString::fromUtf8(capture->getLoadedFile()), m_loadFilter);
+}
+
 void MTuner::closeFile()
 {
     m_centralWidget->removeCurrentTab();
@@ -596,11 +830,10 @@ void MTuner::setWidgetSources(CaptureContext* _context)
 
     CaptureContext* ctx = _context;
     BinLoaderView* binView = _context ? _context->m_binLoaderView : NULL;
-    m_stats->setContext(ctx);
-    m_graph->setContext(ctx, binView);
-    m_histogramWidget->setContext(ctx, binView);
-    m_tagTree->setContext(ctx);
-    m_heapsWidget->setContext(ctx);
+
+    // live capture being updated on another thread is shown in docks once that's done
+    const bool updating = binView && binView->isUpdating();
+    setDockContexts(updating ? NULL : ctx);
     m_modulesWidget->setContext(ctx);
     m_stackAndSource->setContext(ctx);
     m_modulesWidget->setContext(ctx);
@@ -623,6 +856,22 @@ void MTuner::setWidgetSources(CaptureContext* _context)
     emit binLoaded(binView != NULL);
 }
 
+//--------------------------------------------------------------------------
+/// Points docks that show capture data at the given capture, NULL clears them
+//--------------------------------------------------------------------------
+void MTuner::setDockContexts(CaptureContext* _context)
+{
+    CaptureContext* ctx = _context;
+    BinLoaderView* binView = _context ? _context->m_binLoaderView : NULL;
+    m_stats->setContext(ctx);
+    m_graph->setContext(ctx, binView);
+    m_histogramWidget->setContext(ctx, binView);
+    // tag tree and heaps are shown once analysis has built them
+    const bool tagsAnalyzed = ctx && (ctx->m_capture->getAnalyzedStages() & rtm::Capture::AnalyzeTags);
+    m_tagTree->setContext(tagsAnalyzed ? ctx : NULL);
+    m_heapsWidget->setContext(tagsAnalyzed ? ctx : NULL);
+}
+
 void MTuner::suicide()
 {
     close();
@@ -670,6 +919,9 @@ void MTuner::setStatusBarText(const QString& _text)
 
 static const uint32_t g_watchInterval = 230;
 
+/// Capture in progress is loaded further every this many watch intervals
+static const uint32_t g_liveRefreshTicks = 4;
+
 void MTuner::startCaptureStatusTimer()
 {
     if (m_watchTimer)
@@ -685,6 +937,8 @@ void MTuner::captureStarted(const QString& _file)
 {
     setStatusBarText(QString(tr("Created ")) + _file);
     m_watchedFile = _file;
+    m_watchTicks = 0;
+    m_liveOpened = false;
 
     startCaptureStatusTimer();
 }
@@ -703,9 +957,10 @@ bool isProcessRunning(uint64_t _pid)
     return ret == WAIT_TIMEOUT;
 }
 #else
-bool isProcessRunning(uint64_t)
+bool isProcessRunning(uint64_t _pid)
 {
-    return false;
+    // signal 0 only checks that the process exists, EPERM means it belongs to another user
+    return (kill((pid_t)_pid, 0) == 0) || (errno == EPERM);
 }
 #endif
 
@@ -718,13 +973,38 @@ void MTuner::checkCaptureStatus()
         captureSetProcessID(0);
         m_statusBarRedDot->setVisible(false);
 
-        openFileFromPath(m_watchedFile);
+        // live capture step that is still running has to finish before the capture is ended
+        if (m_liveThread)
+        {
+            if (m_watchTimer)
+                m_watchTimer->start();
+            return;
+        }
+
+        // tab that followed the capture loads the rest of it instead of opening it again
+        if (m_liveView)
+        {
+            endLiveCapture(m_liveView);
+            m_liveView = NULL;
+        }
+        else if (!m_liveOpened)
+            openFileFromPath(m_watchedFile);
+
         m_watchedFile = "";
         if (m_watchTimer)
             m_watchTimer->start();
     }
     else
     {
+        // refresh is skipped while the previous live capture step is still running
+        if (((++m_watchTicks % g_liveRefreshTicks) == 0) && !m_liveThread)
+        {
+            if (m_liveView)
+                refreshLiveCapture(m_liveView);
+            else if (!m_liveOpened && !m_watchedFile.isEmpty())
+                openLiveCapture(m_watchedFile);
+        }
+
         m_statusBarRedDot->setVisible(!m_statusBarRedDot->isVisible());
         statusBar()->showMessage(tr("Capture in progress") + QString(" - ") + m_watchedFile, g_watchInterval);
         if (m_watchTimer)
@@ -732,6 +1012,188 @@ void MTuner::checkCaptureStatus()
     }
 }
 
+//--------------------------------------------------------------------------
+/// Runs a step of following a live capture on a worker thread, one at a time.
+/// Views of the capture, if given, are frozen until _done runs on the UI thread.
+//--------------------------------------------------------------------------
+void MTuner::startLiveThread(BinLoaderView* _view,
+                             const std::function<void()>& _work,
+                             const std::function<void()>& _done)
+{
+    if (_view)
+    {
+        _view->setUpdating(true);
+        if (m_centralWidget->getCurrentView() == _view)
+            setDockContexts(NULL);
+    }
+
+    m_liveThread = QThread::create(_work);
+    connect(m_liveThread,
+            &QThread::finished,
+            this,
+            [this, _done]()
+            {
+                m_liveThread = NULL;
+                _done();
+            });
+    connect(m_liveThread, &QThread::finished, m_liveThread, &QObject::deleteLater);
+    m_liveThread->start();
+}
+
+//--------------------------------------------------------------------------
+/// Loads records appended to the capture in progress and updates its views
+//--------------------------------------------------------------------------
+void MTuner::refreshLiveCapture(BinLoaderView* _view)
+{
+    BinLoaderView* view = _view;
+    rtm::Capture* capture = view->getContext()->m_capture;
+    const uint64_t prevMaxTime = capture->getMaxTime();
+
+    startLiveThread(
+        view,
+        [this, capture]() { m_liveChanged = capture->loadAppended() != 0; },
+        [this, view, prevMaxTime]() { updateLiveViews(view, m_liveChanged, prevMaxTime); });
+}
+
+//--------------------------------------------------------------------------
+/// Loads the rest of a capture that was in progress, operations that arrived
+/// late are moved to their place the same as when loading complete capture.
+/// Stream the capture was received from, if any, is deleted once it's done.
+//--------------------------------------------------------------------------
+void MTuner::endLiveCapture(BinLoaderView* _view, rtm::CaptureStream* _stream)
+{
+    BinLoaderView* view = _view;
+    rtm::Capture* capture = view->getContext()->m_capture;
+    const uint64_t prevMaxTime = capture->getMaxTime();
+
+    startLiveThread(
+        view,
+        [this, capture]()
+        {
+            const bool appended = capture->loadAppended() != 0;
+            m_liveChanged = capture->endLive() || appended;
+        },
+        [this, view, prevMaxTime, _stream]()
+        {
+            updateLiveViews(view, m_liveChanged, prevMaxTime);
+            delete _stream;
+        });
+}
+
+//--------------------------------------------------------------------------
+/// Shows a live capture again once a step on the worker thread is done,
+/// views are set up anew if capture data changed
+//--------------------------------------------------------------------------
+void MTuner::updateLiveViews(BinLoaderView* _view, bool _changed, uint64_t _prevMaxTime)
+{
+    BinLoaderView* view = _view;
+    CaptureContext* ctx = view->getContext();
+    view->setUpdating(false);
+
+    if (_changed)
+    {
+        // zoomed graph keeps its range unless it was showing the end of capture
+        const uint64_t minTime = view->getMinTime();
+        const uint64_t maxTime = view->getMaxTime();
+        view->setContext(ctx);
+        view->setMinTime(minTime);
+        if (maxTime != _prevMaxTime)
+            view->setMaxTime(maxTime);
+
+        if (view->getFilteringEnabled())
+            view->setFilteringEnabled(true);
+    }
+
+    if (m_centralWidget->getCurrentView() != view)
+        return;
+
+    setDockContexts(ctx);
+
+    GraphWidget* graphWidget = m_graph->getGraphWidget();
+    graphWidget->setMinTime(view->getMinTime());
+    graphWidget->setMaxTime(view->getMaxTime());
+}
+
+void MTuner::openStream()
+{
+    if (m_stream)
+    {
+        QMessageBox::information(this,
+                                 tr("Capture stream"),
+                                 tr("Capture stream is already open at ") + QString::fromUtf8(m_stream->getAddress()));
+        return;
+    }
+
+    bool accepted = false;
+    QString address = QInputDialog::getText(this,
+                                            tr("Open capture stream"),
+                                            tr("Port, host:port or Unix socket path to receive the capture on"),
+                                            QLineEdit::Normal,
+                                            m_streamAddress,
+                                            &accepted);
+    if (!accepted || address.isEmpty())
+        return;
+
+    m_streamAddress = address;
+
+    m_stream = new rtm::CaptureStream();
+    if (!m_stream->open(address.toUtf8().constData()))
+    {
+        delete m_stream;
+        m_stream = NULL;
+        QMessageBox::critical(this, tr("Capture stream"), tr("Could not listen on ") + address);
+        return;
+    }
+
+    m_streamOpened = false;
+    statusBar()->showMessage(tr("Waiting for capture stream on ") + address, 3000);
+
+    if (!m_streamTimer)
+    {
+        m_streamTimer = new QTimer(this);
+        m_streamTimer->setInterval(g_watchInterval * g_liveRefreshTicks);
+        connect(m_streamTimer, SIGNAL(timeout()), this, SLOT(checkStreamStatus()));
+    }
+    m_streamTimer->start();
+}
+
+void MTuner::checkStreamStatus()
+{
+    // stream is checked again once the previous live capture step is done
+    if (!m_stream || m_liveThread)
+        return;
+
+    // checked first, data received until then is loaded below
+    const bool ended = m_stream->hasEnded();
+
+    if (m_streamView && !ended)
+        refreshLiveCapture(m_streamView);
+    else if (!m_streamOpened)
+    {
+        // stream that has ended is opened only once, with the data it received
+        m_streamOpened = ended;
+        openLiveCapture(QString::fromUtf8(m_stream->getAddress()), m_stream);
+    }
+    else if (ended || !m_streamView)
+    {
+        // stream is closed once the sender is gone or its tab was closed, the tab
+        // loads the rest of received data first and the stream is deleted after that
+        rtm::CaptureStream* stream = m_stream;
+        m_stream = NULL;
+        m_streamTimer->stop();
+
+        if (m_streamView)
+        {
+            endLiveCapture(m_streamView, stream);
+            m_streamView = NULL;
+        }
+        else
+            delete stream;
+
+        statusBar()->showMessage(tr("Capture stream ended"), 3000);
+    }
+}
+
 void MTuner::setFilteringState(bool _checked, bool _enabled)
 {
     emit setFilterState(_checked);
@@ -828,6 +1290,9 @@ void MTuner::readSettings()
         m_externalEditor->setEditorArgs(settings.value("editorArgs").toString());
     }
 
+    // analysis cache
+    ui.action_Cache_captures->setChecked(settings.value("CacheCaptures", false).toBool());
+
     // Symbol store
     QString str;
     str = settings.value("SymLocalStore").toString();
@@ -897,6 +1362,9 @@ void MTuner::writeSettings()
     settings.setValue("editorExe", m_externalEditor->getEditorPath());
     settings.setValue("editorArgs", m_externalEditor->getEditorArgs());
 
+    // analysis cache
+    settings.setValue("CacheCaptures", ui.action_Cache_captures->isChecked());
+
     // Symbol store
     settings.setValue("SymLocalStore", m_symbolStore->getLocalStore());
     settings.setValue("SymPublicStore", m_symbolStore->getPublicStore());
@@ -919,85 +1387,385 @@ uint32_t MTuner::makeVersion(uint8_t _major, uint8_t _minor, uint8_t _detail)
 void loadProgression(void* _customData, float _progress, const char* _message)
 {
     MTuner* mt = (MTuner*)_customData;
-    mt->setLoadingProgress(_progress, QString::fromUtf8(_message));
+    QString message = QString::fromUtf8(_message);
+
+    // captures are loaded on a worker thread
+    QMetaObject::invokeMethod(mt, [mt, _progress, message]() { mt->setLoadingProgress(_progress, message); });
 }
 
-void MTuner::openFileFromPath(const QString& _file)
+void modulesLoaded(void* _customData, const std::vector<rdebug::ModuleInfo>& _modules)
 {
-    QFileInfo info(_file);
-    QString name = info.completeBaseName();
+    MTuner* mt = (MTuner*)_customData;
+
+    // symbol source is picked on the UI thread, symbols are then loaded in parallel with the capture
+    QMetaObject::invokeMethod(mt, [mt, _modules]() { mt->loadModulesKnown(_modules); });
+}
+
+void analyzeProgression(void* _customData, uint32_t _stages, float _progress)
+{
+    BinLoaderView* view = (BinLoaderView*)_customData;
+
+    // analysis stages are built on worker threads
+    QMetaObject::invokeMethod(view,
+                              [view, _stages, _progress]() { view->setAnalyzeProgress(_stages, _progress); });
+}
+
+void MTuner::openFileFromPath(const QString& _file, const rtm::LoadFilter& _filter, LoadMode _mode)
+{
+    if (_file.size() == 0)
+        return;
 
-    if (_file.size() != 0)
+    // one capture is loaded at a time, the rest wait for it
+    if (m_loadContext)
     {
-        CaptureContext* ctx = new CaptureContext();
-        ctx->m_capture->setLoadProgressCallback(this, loadProgression);
-        std::string fn;
+        QueuedLoad load;
+        load.m_file = _file;
+        load.m_filter = _filter;
+        load.m_mode = _mode;
+        m_loadQueue.append(load);
+        return;
+    }
 
-        fn += _file.toUtf8().constData();
+    CaptureContext* ctx = new CaptureContext();
+    ctx->m_capture->setLoadProgressCallback(this, loadProgression);
+    if (_mode != LoadOverview)
+        ctx->m_capture->setModulesLoadedCallback(this, modulesLoaded);
+    ctx->m_capture->setLoadFilter(_filter);
+    ctx->m_capture->setCacheEnabled(ui.action_Cache_captures->isChecked());
+    std::string fn;
 
-        // pass symbol store
-        QString symStore = m_symbolStore->getSymbolStoreString();
+    fn += _file.toUtf8().constData();
 
-        if (!symStore.isEmpty())
-        {
-            std::wstring storePathW = symStore.toStdWString();
-            rdebug::symbolSetServerSource(storePathW.c_str());
-        }
-        else
-        {
-            rdebug::symbolSetServerSource(L"");
-        }
+    // pass symbol store
+    QString symStore = m_symbolStore->getSymbolStoreString();
 
-        statusBar()->showMessage(tr("Loading, please wait..."));
+    if (!symStore.isEmpty())
+    {
+        std::wstring storePathW = symStore.toStdWString();
+        rdebug::symbolSetServerSource(storePathW.c_str());
+    }
+    else
+    {
+        rdebug::symbolSetServerSource(L"");
+    }
 
-        // load binary
-        rtm::Capture::LoadResult res = rtm::Capture::LoadFail;
+    statusBar()->showMessage(tr("Loading, please wait..."));
 
-        QTime preLoadTime = QTime::currentTime();
-        // process may still be alive and keeping lock on capture file
-        res = ctx->m_capture->loadBin(fn.c_str());
-        if (res == rtm::Capture::LoadFail)
+    m_loadContext = ctx;
+    m_loadFile = _file;
+    m_loadResult = rtm::Capture::LoadFail;
+    m_loadCancelButton->setEnabled(true);
+    m_loadCancelButton->setVisible(true);
+
+    // load binary
+    startLoadThread(
+        [this, ctx, fn, _mode]()
         {
-            QTime postLoadTime = QTime::currentTime();
-            // give it a moment
-            if (postLoadTime.msecsSinceStartOfDay() - preLoadTime.msecsSinceStartOfDay() < 500.0f)
+            QElapsedTimer loadTimer;
+            loadTimer.start();
+
+            auto load = [ctx, &fn, _mode]()
+            {
+                switch (_mode)
+                {
+                    case LoadOverview:
+                        return ctx->m_capture->loadOverview(fn.c_str());
+                    case LoadPreview:
+                        return ctx->m_capture->loadPreview(fn.c_str());
+                    default:
+                        return ctx->m_capture->loadBin(fn.c_str());
+                };
+            };
+
+            // process may still be alive and keeping lock on capture file
+            m_loadResult = load();
+            if ((m_loadResult == rtm::Capture::LoadFail) && !ctx->m_capture->isLoadCancelled())
             {
-                rtm::Thread::sleep(1000);
-                res = ctx->m_capture->loadBin(fn.c_str());
+                // give it a moment
+                if (loadTimer.elapsed() < 500)
+                {
+                    rtm::Thread::sleep(1000);
+                    m_loadResult = load();
+                }
             }
-        }
+        },
+        &MTuner::captureLoaded);
+}
+
+void MTuner::startLoadThread(const std::function<void()>& _work, void (MTuner::*_done)())
+{
+    m_loadThread = QThread::create(_work);
+    connect(m_loadThread, &QThread::finished, this, _done);
+    connect(m_loadThread, &QThread::finished, m_loadThread, &QObject::deleteLater);
+    m_loadThread->start();
+}
+
+void MTuner::loadModulesKnown(const std::vector<rdebug::ModuleInfo>& _modules)
+{
+    CaptureContext* ctx = m_loadContext;
+    if (!ctx || m_loadSelectingSymbols || ctx->m_capture->isLoadCancelled())
+        return;
+
+    // dialogs run their own event loop, capture may finish loading in the meantime
+    m_loadSelectingSymbols = true;
+    QString symStore = m_symbolStore->getSymbolStoreString();
+    preloadLoaderSymbols(ctx, _modules, m_loadFile, m_gccSetup, m_fileDialog, this, symStore, resolverCallBack);
+    m_loadSelectingSymbols = false;
+
+    if (m_loadFinishDeferred)
+    {
+        m_loadFinishDeferred = false;
+        captureLoaded();
+    }
+}
+
+void MTuner::captureLoaded()
+{
+    if (m_loadSelectingSymbols)
+    {
+        m_loadFinishDeferred = true;
+        return;
+    }
 
+    m_loadThread = NULL;
+    CaptureContext* ctx = m_loadContext;
+
+    if (ctx->m_capture->isLoadCancelled())
+    {
+        finishLoad(tr("Loading cancelled"));
+        return;
+    }
+
+    if (m_loadResult == rtm::Capture::LoadFail)
+    {
+        statusBar()->showMessage(tr("Error loading!"), 3000);
+        QMessageBox info_dlg(QMessageBox::Information,
+                             tr("Failed to load file!"),
+                             tr("File may be corrupted, try to repeat the capture"),
+                             QMessageBox::Ok);
+        info_dlg.setWindowIcon(this->windowIcon());
+        info_dlg.exec();
+        finishLoad(tr("Error loading!"));
+        return;
+    }
+
+    if (m_loadResult == rtm::Capture::LoadPartial)
+        statusBar()->showMessage(tr("Capture file was only partially loaded!\nInformation may be missing from the profile!"),
+                                 2300);
+    else
         statusBar()->showMessage(tr("Creating symbol resolver and downloading symbols, please wait..."), 230);
 
-        if (res != rtm::Capture::LoadFail)
+    // timeline and global stats are ready, the rest of the views fill in as analysis stages
+    // finish; analysis can't be cancelled and the tab owns the capture from now on
+    m_loadCancelButton->setVisible(false);
+    QString tabName = QFileInfo(m_loadFile).completeBaseName();
+    if (ctx->m_capture->isOverview())
+        tabName += tr(" (overview)");
+    else if (ctx->m_capture->isPreview())
+        tabName += tr(" (preview, 1/%1 of chunks)").arg(ctx->m_capture->getSampleStep());
+    else if (ctx->m_capture->getLoadFilter().isActive())
+        tabName += tr(" (filtered)");
+    m_centralWidget->addTab(ctx, tabName);
+
+    // overview has nothing to analyze, stats and graph are all it shows
+    if (ctx->m_capture->isOverview())
+    {
+        m_loadContext = NULL;
+        finishLoad(tr("Loaded overview of ") + m_loadFile);
+        return;
+    }
+
+    connect(ctx->m_binLoaderView,
+            SIGNAL(analyzedStagesChanged(uint32_t)),
+            this,
+            SLOT(analyzedStagesChanged(uint32_t)));
+    ctx->m_capture->setAnalyzeProgressCallback(ctx->m_binLoaderView, analyzeProgression);
+
+    // if not a windows toolchain - locate the executable, unless it was done while loading
+    rdebug::Toolchain tc;
+    std::string executable;
+    if (ctx->m_symbolSourceSelected)
+    {
+        tc = ctx->m_symbolToolchain;
+        executable = ctx->m_symbolExecutable;
+    }
+    else
+    {
+        QString symStore = m_symbolStore->getSymbolStoreString();
+        selectLoaderToolchain(ctx,
+                              ctx->m_capture->getModuleInfos(),
+                              m_loadFile,
+                              m_gccSetup,
+                              m_fileDialog,
+                              this,
+                              symStore,
+                              tc,
+                              executable);
+    }
+
+    startLoadThread(
+        [this, ctx, tc, executable]()
         {
-            if (res == rtm::Capture::LoadPartial)
-                statusBar()->showMessage(tr("Capture file was only partially loaded!\nInformation may be missing from the profile!"),
-                                         2300);
+            ctx->setupResolver(tc, executable, resolverCallBack, this);
+            ctx->m_capture->buildAnalyzeData(&ctx->m_symbols, ctx->m_symbolsHash);
+        },
+        &MTuner::captureAnalyzed);
+}
 
-            // if not a windows toolchain - locate the executable
-            setupLoaderToolchain(ctx, _file, m_gccSetup, m_fileDialog, this, symStore, resolverCallBack);
+void MTuner::captureAnalyzed()
+{
+    m_loadThread = NULL;
+    m_loadContext = NULL;
+    finishLoad(tr("Loaded ") + m_loadFile);
+}
+
+//--------------------------------------------------------------------------
+/// Shows data of analysis stages that finished in the docks, if the capture
+/// is the current one
+//--------------------------------------------------------------------------
+void MTuner::analyzedStagesChanged(uint32_t _stages)
+{
+    BinLoaderView* view = qobject_cast<BinLoaderView*>(sender());
+    if (!view || (m_centralWidget->getCurrentView() != view))
+        return;
+
+    if (_stages & rtm::Capture::AnalyzeTags)
+    {
+        m_tagTree->setContext(view->getContext());
+        m_heapsWidget->setContext(view->getContext());
+    }
 
-            ctx->m_capture->buildAnalyzeData(ctx->m_symbolResolver);
+    emit setFilterButtonEnabled(view->isAnalyzed());
+}
 
-            QString ld(tr("Loaded "));
+void MTuner::finishLoad(const QString& _message)
+{
+    if (m_loadContext)
+        releaseContext(m_loadContext);
+    m_loadContext = NULL;
 
-            statusBar()->showMessage(ld + QString::fromUtf8(fn.c_str()), 3000);
+    m_loadCancelButton->setVisible(false);
+    m_loadingProgressBar->setVisible(false);
+    statusBar()->showMessage(_message, 3000);
 
-            m_centralWidget->addTab(ctx, name);
-        }
-        else
-        {
-            statusBar()->showMessage(tr("Error loading!"), 3000);
-            QMessageBox info_dlg(QMessageBox::Information,
-                                 tr("Failed to load file!"),
-                                 tr("File may be corrupted, try to repeat the capture"),
-                                 QMessageBox::Ok);
-            info_dlg.setWindowIcon(this->windowIcon());
-            info_dlg.exec();
-            delete ctx;
-        }
+    if (!m_loadQueue.isEmpty())
+    {
+        QueuedLoad next = m_loadQueue.takeFirst();
+        openFileFromPath(next.m_file, next.m_filter, next.m_mode);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Deletes a context of a capture that wasn't opened, its symbol loader may
+/// still be creating the resolver so it is waited for on a worker thread
+//--------------------------------------------------------------------------
+void MTuner::releaseContext(CaptureContext* _context)
+{
+    QThread* thread = QThread::create([_context]() { _context->waitForSymbols(); });
+    m_releaseThreads.append(thread);
+    connect(thread,
+            &QThread::finished,
+            this,
+            [this, thread, _context]()
+            {
+                m_releaseThreads.removeOne(thread);
+                delete _context;
+            });
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    thread->start();
+}
+
+void MTuner::cancelLoad()
+{
+    if (!m_loadContext)
+        return;
+
+    m_loadContext->m_capture->cancelLoad();
+    m_loadCancelButton->setEnabled(false);
+    statusBar()->showMessage(tr("Cancelling..."));
+}
+
+//--------------------------------------------------------------------------
+/// Opens a capture in progress in a tab that follows it. Capture is loaded
+/// and analyzed on the live capture thread, if it has no operations yet it's
+/// tried again on the next refresh.
+//--------------------------------------------------------------------------
+void MTuner::openLiveCapture(const QString& _file, rtm::CaptureStream* _stream)
+{
+    QFileInfo info(_file);
+    QString name = _stream ? tr("Stream") + QString(" ") + _file : info.completeBaseName();
+
+    CaptureContext* ctx = new CaptureContext();
+    std::string fn;
+
+    fn += _file.toUtf8().constData();
+
+    // pass symbol store
+    QString symStore = m_symbolStore->getSymbolStoreString();
+
+    if (!symStore.isEmpty())
+    {
+        std::wstring storePathW = symStore.toStdWString();
+        rdebug::symbolSetServerSource(storePathW.c_str());
     }
+    else
+    {
+        rdebug::symbolSetServerSource(L"");
+    }
+
+    startLiveThread(
+        NULL,
+        [this, ctx, fn, _stream]()
+        {
+            m_liveResult = _stream ? ctx->m_capture->loadStream(_stream) : ctx->m_capture->loadBin(fn.c_str(), true);
+        },
+        [this, ctx, name, _file, _stream, symStore]()
+        {
+            if (m_liveResult == rtm::Capture::LoadFail)
+            {
+                delete ctx;
+                return;
+            }
+
+            // toolchain dialogs run on the UI thread, resolver is created with analysis data
+            rdebug::Toolchain tc;
+            std::string executable;
+            selectLoaderToolchain(ctx,
+                                  ctx->m_capture->getModuleInfos(),
+                                  _stream ? getCaptureLocation() : _file,
+                                  m_gccSetup,
+                                  m_fileDialog,
+                                  this,
+                                  symStore,
+                                  tc,
+                                  executable);
+
+            // views fill in as analysis stages finish, same as for a capture that was loaded whole
+            m_centralWidget->addTab(ctx, name);
+            BinLoaderView* view = ctx->m_binLoaderView;
+            connect(view, SIGNAL(analyzedStagesChanged(uint32_t)), this, SLOT(analyzedStagesChanged(uint32_t)));
+            ctx->m_capture->setAnalyzeProgressCallback(view, analyzeProgression);
+
+            if (_stream)
+            {
+                m_streamView = view;
+                m_streamOpened = true;
+            }
+            else
+            {
+                m_liveView = view;
+                m_liveOpened = true;
+            }
+
+            startLiveThread(
+                NULL,
+                [this, ctx, tc, executable]()
+                {
+                    ctx->setupResolver(tc, executable, resolverCallBack, this);
+                    ctx->m_capture->buildAnalyzeData(&ctx->m_symbols, ctx->m_symbolsHash);
+                },
+                []() {});
+        });
 }
 
 void MTuner::dragEnterEvent(QDragEnterEvent* _event)
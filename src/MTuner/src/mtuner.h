@@ -23,6 +23,11 @@ class BinLoaderView;
 class TagTreeWidget;
 class GCCSetup;
 
+namespace rtm
+{
+class CaptureStream;
+}
+
 class DockWidget : public QDockWidget
 {
     Q_OBJECT
@@ -72,11 +77,30 @@ class MTuner : public QMainWindow
 {
     Q_OBJECT
 
+public:
+    enum LoadMode
+    {
+        LoadFull,
+        LoadOverview,  ///< Only global stats and usage graph, capture is not analyzed
+        LoadPreview    ///< Only every n-th chunk, stats are approximate
+    };
+
 private:
     ProjectsManager* m_projectsManager;
     QString m_watchedFile;
     QTimer* m_watchTimer;
+    uint32_t m_watchTicks;
     uint64_t m_capturePid;
+    QPointer<BinLoaderView> m_liveView;  ///< Tab following the capture in progress
+    bool m_liveOpened;                   ///< Capture in progress was opened in a tab
+    rtm::CaptureStream* m_stream;        ///< Receives a capture over a socket, NULL if not open
+    QTimer* m_streamTimer;
+    QPointer<BinLoaderView> m_streamView;  ///< Tab following the capture stream
+    bool m_streamOpened;                   ///< Capture stream was opened in a tab
+    QString m_streamAddress;
+    QThread* m_liveThread;                 ///< Loads, updates or ends a live capture, NULL when idle
+    rtm::Capture::LoadResult m_liveResult;
+    bool m_liveChanged;  ///< Live capture step changed capture data
     SymbolStore* m_symbolStore;
     GCCSetup* m_gccSetup;
     DockWidget* m_graphDock;
@@ -87,6 +111,22 @@ private:
     DockWidget* m_heapsDock;
     DockWidget* m_modulesDock;
     QProgressBar* m_loadingProgressBar;
+    QToolButton* m_loadCancelButton;
+    QThread* m_loadThread;             ///< Loads and analyzes a capture, NULL when idle
+    CaptureContext* m_loadContext;     ///< Capture being loaded by the load thread
+    QList<QThread*> m_releaseThreads;  ///< Wait for symbol loaders of dropped captures
+    QString m_loadFile;
+    rtm::Capture::LoadResult m_loadResult;
+    bool m_loadSelectingSymbols;  ///< Symbol source dialogs are open while the capture loads
+    bool m_loadFinishDeferred;    ///< Capture was loaded while those dialogs were open
+    struct QueuedLoad
+    {
+        QString m_file;
+        rtm::LoadFilter m_filter;
+        LoadMode m_mode;
+    };
+    QList<QueuedLoad> m_loadQueue;  ///< Files opened while another one was loading
+    rtm::LoadFilter m_loadFilter;   ///< Last load filter entered in open dialog
     QLabel* m_statusBarRedDot;
     CentralWidget* m_centralWidget;
     QFileDialog* m_fileDialog;
@@ -110,15 +150,24 @@ public:
 
     void show();
     void setLoadingProgress(float _progress, const QString& _message);
+    void loadModulesKnown(const std::vector<rdebug::ModuleInfo>& _modules);
     void changeEvent(QEvent* _event);
     void closeEvent(QCloseEvent* _event);
-    void openFileFromPath(const QString& _file);
+    void openFileFromPath(const QString& _file,
+                          const rtm::LoadFilter& _filter = rtm::LoadFilter(),
+                          LoadMode _mode = LoadFull);
+    void openLiveCapture(const QString& _file, rtm::CaptureStream* _stream = NULL);
     bool handleFile(const QString& _file);
 
 public Q_SLOTS:
 
     // File
     void openFile();
+    void openFileFiltered();
+    void openFileOverview();
+    void openFilePreview();
+    void loadSelectedRange();
+    void openStream();
     void closeFile();
     void openCaptureLocation();
     QString getCaptureLocation();
@@ -154,6 +203,9 @@ public Q_SLOTS:
     void startCaptureStatusTimer();
     void captureStarted(const QString&);
     void captureSetProcessID(uint64_t);
+    void checkStreamStatus();
+    void cancelLoad();
+    void analyzedStagesChanged(uint32_t);
 
     void setFilteringState(bool, bool);
 
@@ -171,6 +223,18 @@ private:
     void showWelcomeDialog();
     void setDockWindowIcon(DockWidget* _widget, const QString& _icon);
     void setupDockWindows();
+    void refreshLiveCapture(BinLoaderView* _view);
+    void endLiveCapture(BinLoaderView* _view, rtm::CaptureStream* _stream = NULL);
+    void updateLiveViews(BinLoaderView* _view, bool _changed, uint64_t _prevMaxTime);
+    void startLiveThread(BinLoaderView* _view,
+                         const std::function<void()>& _work,
+                         const std::function<void()>& _done);
+    void setDockContexts(CaptureContext* _context);
+    void startLoadThread(const std::function<void()>& _work, void (MTuner::*_done)());
+    void captureLoaded();
+    void captureAnalyzed();
+    void finishLoad(const QString& _message);
+    void releaseContext(CaptureContext* _context);
     void readSettings();
     void writeSettings();
 
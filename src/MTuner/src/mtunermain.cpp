@@ -12,6 +12,8 @@
 #include <rbase/inc/console.h>
 #include <rbase/inc/hash.h>
 #include <rbase/inc/path.h>
+#include <rbase/inc/thread.h>
+#include <MTuner/src/loader/capturestream.h>
 #include <MTuner/src/loader/util.h>
 
 #include <rqt/inc/rqt.h>
@@ -35,6 +37,15 @@ void setupLoaderToolchain(CaptureContext* _context,
                           const QString& _symSource,
                           rdebug::module_load_cb _callBack);
 
+void preloadLoaderSymbols(CaptureContext* _context,
+                          const std::vector<rdebug::ModuleInfo>& _modules,
+                          const QString& _file,
+                          GCCSetup* _gccSetup,
+                          QFileDialog* _fileDialog,
+                          MTuner* _mtuner,
+                          const QString& _symSource,
+                          rdebug::module_load_cb _callBack);
+
 extern void getStoragePath(wchar_t _path[512]);
 
 void err(const char* _message)
@@ -126,9 +137,143 @@ bool handleInject(rtm::CommandLine& _cmdLine)
 void resolverCallBack(const char* _name, void* _customData)
 {
     MTuner* mt = (MTuner*)_customData;
+    QString message = QString("Loading symbols for: ") + QString(_name);
+
+    // symbols of a capture opened in the GUI are loaded on a worker thread
+    QMetaObject::invokeMethod(mt,
+                              [mt, message]()
+                              {
+                                  mt->statusBar()->showMessage(message, 2300);
+                                  mt->statusBar()->repaint();
+                              });
+}
+
+/// Symbol source of a capture loaded from the command line
+struct SymbolPreload
+{
+    CaptureContext* m_context;
+    GCCSetup* m_gccSetup;
+    const char* m_file;
+    const char* m_symSource;
+};
+
+static void modulesLoaded(void* _customData, const std::vector<rdebug::ModuleInfo>& _modules)
+{
+    SymbolPreload* preload = (SymbolPreload*)_customData;
+
+    // nothing to ask, symbols of header modules load while the rest of the capture does
+    preloadLoaderSymbols(preload->m_context,
+                         _modules,
+                         QString::fromUtf8(preload->m_file),
+                         preload->m_gccSetup,
+                         NULL,
+                         NULL,
+                         preload->m_symSource ? QString(preload->m_symSource) : QString(""),
+                         resolverCallBack);
+}
+
+/// Status of a capture stream is printed this often, in milliseconds
+static const uint32_t g_streamStatusInterval = 1000;
+
+/// Number of largest groups by live size printed with capture stream status
+static const uint32_t g_streamTopGroups = 5;
+
+static void printStreamStatus(rtm::Capture* _capture)
+{
+    const rtm::MemoryStats& stats = _capture->getGlobalStats();
+    rtm::Console::print("\n%llu operations, usage %llu bytes, peak %llu bytes, %llu live blocks\n",
+                        (unsigned long long)stats.m_numberOfOperations,
+                        (unsigned long long)stats.m_memoryUsage,
+                        (unsigned long long)stats.m_memoryUsagePeak,
+                        (unsigned long long)stats.m_numberOfLiveBlocks);
+
+    std::vector<const rtm::MemoryOperationGroup*> groups;
+    const rtm::MemoryGroupsHashType& srcGroups = _capture->getMemoryGroups();
+    for (rtm::MemoryGroupsHashType::const_iterator it = srcGroups.begin(); it != srcGroups.end(); ++it)
+        groups.push_back(&it->second);
+
+    const size_t numTop = groups.size() < g_streamTopGroups ? groups.size() : g_streamTopGroups;
+    std::partial_sort(groups.begin(),
+                      groups.begin() + numTop,
+                      groups.end(),
+                      [](const rtm::MemoryOperationGroup* _g1, const rtm::MemoryOperationGroup* _g2)
+                      { return _g1->m_liveSize > _g2->m_liveSize; });
+
+    for (size_t i = 0; i < numTop; ++i)
+        rtm::Console::print("   %12lld bytes live in %8llu blocks of %u - %u bytes\n",
+                            (long long)groups[i]->m_liveSize,
+                            (unsigned long long)groups[i]->m_liveCount,
+                            groups[i]->m_minSize,
+                            groups[i]->m_maxSize);
+}
+
+//--------------------------------------------------------------------------
+/// Loads capture received by the stream, printing usage and top groups by
+/// live size while it is being received
+//--------------------------------------------------------------------------
+static bool receiveStream(CaptureContext& _context,
+                          rtm::CaptureStream& _stream,
+                          GCCSetup* _gccSetup,
+                          const char* _symSource)
+{
+    rtm::Capture* capture = _context.m_capture;
 
-    mt->statusBar()->showMessage(QString("Loading symbols for: ") + QString(_name), 2300);
-    mt->statusBar()->repaint();
+    rtm::Console::print("Waiting for capture stream on %s\n", _stream.getAddress());
+
+    for (;;)
+    {
+        const bool ended = _stream.hasEnded();
+        if (capture->loadStream(&_stream) != rtm::Capture::LoadFail)
+            break;
+        if (ended)
+            return false;
+        rtm::Thread::sleep(g_streamStatusInterval);
+    }
+
+    setupLoaderToolchain(&_context,
+                         QString(),
+                         _gccSetup,
+                         NULL,
+                         NULL,
+                         _symSource ? QString(_symSource) : QString(""),
+                         resolverCallBack);
+
+    rtm::Console::debug("Building analysis data...\n");
+    capture->buildAnalyzeData(&_context.m_symbols, _context.m_symbolsHash);
+
+    for (;;)
+    {
+        // checked first, data received until then is loaded below
+        const bool ended = _stream.hasEnded();
+        capture->loadAppended();
+        printStreamStatus(capture);
+        if (ended)
+            break;
+        rtm::Thread::sleep(g_streamStatusInterval);
+    }
+
+    capture->endLive();
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Parses comma separated list of decimal or hexadecimal (0x prefixed) IDs
+//--------------------------------------------------------------------------
+static void parseIDList(const char* _list, std::vector<uint64_t>& _ids)
+{
+    while (*_list)
+    {
+        char* end = NULL;
+        uint64_t id = strtoull(_list, &end, 0);
+        if (end == _list)
+            err("ERROR: Invalid thread ID or heap handle list!");
+
+        _ids.push_back(id);
+
+        _list = end;
+        while ((*_list == ',') || (*_list == ' '))
+            ++_list;
+    }
 }
 
 int handleCommandLine(int argc, char const* argv[])
@@ -152,6 +297,10 @@ int handleCommandLine(int argc, char const* argv[])
                             "   -w [PATH]   Working directory for instrumented executable\n"
                             "   -c [ARGS]   Command line arguments for the instrumented executable\n"
                             "   -i [FILE]   Specify input (.MTuner) file\n"
+                            "   -stream [ADDRESS]\n"
+                            "               Receive input over a socket instead of reading a file,\n"
+                            "               address is a port, host:port or Unix socket path.\n"
+                            "               Usage and largest groups are printed while receiving.\n"
                             "   -o [FILE]   Specify output file with profile results\n"
                             "   -l          Outputs only live allocations (leaks)\n"
                             "   -tag [TAG]  Filter operations by tag\n"
@@ -159,12 +308,29 @@ int handleCommandLine(int argc, char const* argv[])
                             "               between the next and previous power of two nearest to given\n"
                             "               size. For input size of 192 operations with sizes between\n"
                             "               128 and 256 will be included.\n"
-                            "   -ts [TIME]  Set start (minimum) time for operation filtering\n"
-                            "   -te [TIME]  Set end (maximum) time for operation filtering\n"
+                            "   -ts [TIME]  Set start (minimum) time for operation filtering, operations\n"
+                            "               before it are not loaded except for blocks still live then\n"
+                            "   -te [TIME]  Set end (maximum) time for operation filtering, operations\n"
+                            "               after it are not loaded\n"
+                            "   -threads [IDS]\n"
+                            "               Load only blocks allocated by given threads, IDs are\n"
+                            "               separated by commas\n"
+                            "   -heaps [HANDLES]\n"
+                            "               Load only operations on given heaps / allocators, handles\n"
+                            "               are separated by commas\n"
                             "   -ss         Sort memory operations by size\n"
                             "   -sc         Sort memory operations by count\n"
                             "   -st         Sort memory operations by size*count\n"
                             "   -xml        Output as XML file\n"
+                            "   -overview   Output only global stats and size histogram, computed while\n"
+                            "               loading without keeping memory operations. Much faster and\n"
+                            "               needs less memory for large captures, can't be filtered.\n"
+                            "   -preview [N]\n"
+                            "               Load only every N-th chunk of a capture that was loaded or\n"
+                            "               overviewed before. Stats are scaled to the whole capture\n"
+                            "               and approximate, groups are from loaded chunks only.\n"
+                            "   -cache      Restore capture from analysis cache (.mtcache) next to it,\n"
+                            "               the cache is written if missing or out of date\n"
                             "\n");
 
         int numTCs = gcc_setup.getNumToolchains();
@@ -213,7 +379,10 @@ int handleCommandLine(int argc, char const* argv[])
         rtm::Console::print("\n"
                             "Examples:\n"
                             "   MTuner.com: -l -xml -tag \"Tag name\" -h 256 -i \"Capture.MTuner\" -o \"Log.xml\"\n"
-                            "   MTuner.com: -p \"D:\\Project Dir\\bin\\ProjectExe.exe\"\n");
+                            "   MTuner.com: -p \"D:\\Project Dir\\bin\\ProjectExe.exe\"\n"
+                            "   MTuner.com: -stream 47311 -o \"Log.txt\"\n"
+                            "   MTuner.com: -overview -i \"Capture.MTuner\" -o \"Overview.txt\"\n"
+                            "   MTuner.com: -preview 16 -i \"Capture.MTuner\" -o \"Preview.txt\"\n");
 
         return 0;
     }
@@ -231,13 +400,16 @@ int handleCommandLine(int argc, char const* argv[])
         return 0;
     }
 
+    const char* streamAddress = NULL;
+    cmdLine.getArg("stream", streamAddress);
+
     const char* filePath = NULL;
-    char inFilePath[1024];
-    if (!cmdLine.getArg('i', filePath))
+    char inFilePath[1024] = "";
+    if (!streamAddress && !cmdLine.getArg('i', filePath))
     {
         err("ERROR: Input file must be specified!");
     }
-    else
+    else if (filePath)
     {
 #if RTM_PLATFORM_WINDOWS
         if ((strstr(filePath, "/") == 0) && (strstr(filePath, "\\") == 0))
@@ -311,17 +483,88 @@ int handleCommandLine(int argc, char const* argv[])
         enableFiltering = true;
     }
 
+    // time range, threads and heaps are applied while loading, only selected operations are kept
+    rtm::LoadFilter loadFilter;
+    loadFilter.m_minTime = timeMin;
+    loadFilter.m_maxTime = timeMax;
+
+    const char* threadsArg = NULL;
+    if (cmdLine.getArg("threads", threadsArg))
+        parseIDList(threadsArg, loadFilter.m_threads);
+
+    const char* heapsArg = NULL;
+    if (cmdLine.getArg("heaps", heapsArg))
+        parseIDList(heapsArg, loadFilter.m_heaps);
+
     bool leakedOnly = cmdLine.hasArg("l");
     enableFiltering = enableFiltering || leakedOnly;
 
     bool doXML = cmdLine.hasArg("xml");
 
+    bool overview = cmdLine.hasArg("overview");
+    if (overview && (streamAddress || enableFiltering || loadFilter.isActive() || doXML))
+    {
+        err("ERROR: Overview can't be filtered, received over a stream or saved as XML!");
+    }
+
+    uint32_t sampleStep = 0;
+    const char* previewArg = NULL;
+    if (cmdLine.getArg("preview", previewArg))
+    {
+        sampleStep = (uint32_t)atoi(previewArg);
+        if (sampleStep < 2)
+            err("ERROR: Preview has to skip chunks, N must be at least 2!");
+
+        if (streamAddress || overview || loadFilter.isActive())
+            err("ERROR: Preview can't be combined with stream, overview, time, thread or heap filters!");
+    }
+
+    bool useCache = cmdLine.hasArg("cache");
+
     rtm::mtunerLoaderInit(false);
 
     {
         CaptureContext context;
 
-        if (context.m_capture->loadBin(inFilePath) == rtm::Capture::LoadResult::LoadSuccess)
+        rtm::CaptureStream stream;
+        bool loaded = false;
+
+        if (streamAddress)
+        {
+            if (!stream.open(streamAddress))
+                err("ERROR: Could not listen on stream address!");
+
+            loaded = receiveStream(context, stream, &gcc_setup, symSource);
+        }
+        else if (overview)
+        {
+            loaded = context.m_capture->loadOverview(inFilePath) == rtm::Capture::LoadSuccess;
+        }
+        else
+        {
+            SymbolPreload preload;
+            preload.m_context = &context;
+            preload.m_gccSetup = &gcc_setup;
+            preload.m_file = inFilePath;
+            preload.m_symSource = symSource;
+            context.m_capture->setModulesLoadedCallback(&preload, modulesLoaded);
+
+            if (sampleStep)
+            {
+                loaded = context.m_capture->loadPreview(inFilePath, sampleStep) == rtm::Capture::LoadSuccess;
+            }
+            else
+            {
+                context.m_capture->setLoadFilter(loadFilter);
+                context.m_capture->setCacheEnabled(useCache);
+                loaded = context.m_capture->loadBin(inFilePath) == rtm::Capture::LoadSuccess;
+            }
+
+            context.m_capture->setModulesLoadedCallback(NULL, NULL);
+        }
+
+        // overview has no operations to analyze
+        if (loaded && !streamAddress && !overview)
         {
             setupLoaderToolchain(&context,
                                  inFilePath,
@@ -332,8 +575,11 @@ int handleCommandLine(int argc, char const* argv[])
                                  resolverCallBack);
 
             rtm::Console::debug("Building analysis data...\n");
-            context.m_capture->buildAnalyzeData(context.m_symbolResolver);
+            context.m_capture->buildAnalyzeData(&context.m_symbols, context.m_symbolsHash);
+        }
 
+        if (loaded)
+        {
             if (enableFiltering)
             {
                 rtm::Console::debug("Filtering enabled\n");
@@ -378,21 +624,35 @@ int handleCommandLine(int argc, char const* argv[])
             if (sortByTotal)
                 sorting = rtm::GROUP_SORT_TOTAL_SIZE;
 
-            if (doXML)
+            if (overview)
+            {
+                if (!context.m_capture->saveOverviewLog(outFilePath))
+                {
+                    err("ERROR: Could not save output file!");
+                }
+            }
+            else if (doXML)
             {
-                if (!context.m_capture->saveGroupsLogXML(outFilePath, sorting, context.m_symbolResolver))
+                if (!context.m_capture->saveGroupsLogXML(outFilePath, sorting, &context.m_symbols))
                 {
                     err("ERROR: Could not save output XML file!");
                 }
             }
-            else if (!context.m_capture->saveGroupsLog(outFilePath, sorting, context.m_symbolResolver))
+            else if (!context.m_capture->saveGroupsLog(outFilePath, sorting, &context.m_symbols))
             {
                 err("ERROR: Could not save output file!");
             }
+
+            const uint64_t frameHits = context.m_symbols.getFrameHits();
+            const uint64_t frameMisses = context.m_symbols.getFrameMisses();
+            if (frameHits + frameMisses)
+                rtm::Console::debug("Symbol frames: %llu lookups, %.1f%% served from memory\n",
+                                    (unsigned long long)(frameHits + frameMisses),
+                                    double(frameHits) * 100.0 / double(frameHits + frameMisses));
         }
         else
         {
-            err("ERROR: Could not load input file!");
+            err(streamAddress ? "ERROR: Could not load capture stream!" : "ERROR: Could not load input file!");
         }
     }
 
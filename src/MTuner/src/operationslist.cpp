@@ -38,9 +38,21 @@ static bool __uncaught_exception()
 struct Mapping
 {
     std::vector<uint32_t> m_sortedIndex;
-    const std::vector<rtm::MemoryOperation*>* m_allOps;
+    std::vector<uint32_t> m_rowIndex;  ///< Row of each listed operation
+    const std::vector<uint32_t>* m_allOps;
 };
 
+/// Table items are operation indices offset by one, so no item is NULL
+static inline void* getOpItem(uint32_t _op)
+{
+    return (void*)((uintptr_t)_op + 1);
+}
+
+static inline uint32_t getItemOp(void* _item)
+{
+    return (uint32_t)((uintptr_t)_item - 1);
+}
+
 struct OperationColumn
 {
     enum Enum
@@ -69,7 +81,9 @@ public:
     uint32_t m_currentColumn;
     bool m_valid;
     Qt::SortOrder m_sortOrder;
-    const std::vector<rtm::MemoryOperation*>* m_allOps;
+    const rtm::MemoryOperations* m_ops;
+    const std::vector<uint32_t>* m_allOps;
+    std::vector<uint32_t> m_validOps;
 
 public:
     OperationTableSource(CaptureContext* _context, bool _valid, OperationsList* _list, bool _leaksOnly);
@@ -110,109 +124,120 @@ struct pSetIndex
 // ThreadID
 struct pSortThreadID
 {
-    const std::vector<rtm::MemoryOperation*>* m_allOps;
-    pSortThreadID(const std::vector<rtm::MemoryOperation*>* _ops)
+    const std::vector<uint32_t>* m_allOps;
+    const rtm::Capture* m_capture;
+    pSortThreadID(const std::vector<uint32_t>* _ops, const rtm::Capture* _capture)
         : m_allOps(_ops)
+        , m_capture(_capture)
     {
     }
 
     inline uint64_t operator()(const uint32_t _val1, const uint32_t _val2) const
     {
-        return m_allOps->operator[](_val1)->m_threadID < m_allOps->operator[](_val2)->m_threadID;
+        return m_capture->getThreadID(m_allOps->operator[](_val1)) <
+               m_capture->getThreadID(m_allOps->operator[](_val2));
     }
 };
 
 // Heap
 struct pSortHeap
 {
-    const std::vector<rtm::MemoryOperation*>* m_allOps;
-    pSortHeap(const std::vector<rtm::MemoryOperation*>* _ops)
+    const std::vector<uint32_t>* m_allOps;
+    const rtm::Capture* m_capture;
+    pSortHeap(const std::vector<uint32_t>* _ops, const rtm::Capture* _capture)
         : m_allOps(_ops)
+        , m_capture(_capture)
     {
     }
 
     inline uint64_t operator()(const uint32_t _val1, const uint32_t _val2) const
     {
-        return m_allOps->operator[](_val1)->m_allocatorHandle < m_allOps->operator[](_val2)->m_allocatorHandle;
+        return m_capture->getHeapHandle(m_allOps->operator[](_val1)) <
+               m_capture->getHeapHandle(m_allOps->operator[](_val2));
     }
 };
 
 // Address
 struct pSortAddress
 {
-    const std::vector<rtm::MemoryOperation*>* m_allOps;
-    pSortAddress(const std::vector<rtm::MemoryOperation*>* _ops)
-        : m_allOps(_ops)
+    const std::vector<uint32_t>* m_allOps;
+    const rtm::MemoryOperations* m_ops;
+    pSortAddress(const std::vector<uint32_t>* _allOps, const rtm::MemoryOperations* _ops)
+        : m_allOps(_allOps)
+        , m_ops(_ops)
     {
     }
 
     inline uint64_t operator()(const uint32_t _val1, const uint32_t _val2) const
     {
-        return m_allOps->operator[](_val1)->m_pointer < m_allOps->operator[](_val2)->m_pointer;
+        return m_ops->m_pointer[m_allOps->operator[](_val1)] < m_ops->m_pointer[m_allOps->operator[](_val2)];
     }
 };
 
 // Type
 struct pSortOpType
 {
-    const std::vector<rtm::MemoryOperation*>* m_allOps;
-    pSortOpType(const std::vector<rtm::MemoryOperation*>* _ops)
-        : m_allOps(_ops)
+    const std::vector<uint32_t>* m_allOps;
+    const rtm::MemoryOperations* m_ops;
+    pSortOpType(const std::vector<uint32_t>* _allOps, const rtm::MemoryOperations* _ops)
+        : m_allOps(_allOps)
+        , m_ops(_ops)
     {
     }
 
     inline uint8_t operator()(const uint32_t _val1, const uint32_t _val2) const
     {
-        return m_allOps->operator[](_val1)->m_operationType < m_allOps->operator[](_val2)->m_operationType;
+        return m_ops->getType(m_allOps->operator[](_val1)) < m_ops->getType(m_allOps->operator[](_val2));
     }
 };
 
 // Size
 struct pSortOpSize
 {
-    const std::vector<rtm::MemoryOperation*>* m_allOps;
-    pSortOpSize(const std::vector<rtm::MemoryOperation*>* _ops)
-        : m_allOps(_ops)
+    const std::vector<uint32_t>* m_allOps;
+    const rtm::MemoryOperations* m_ops;
+    pSortOpSize(const std::vector<uint32_t>* _allOps, const rtm::MemoryOperations* _ops)
+        : m_allOps(_allOps)
+        , m_ops(_ops)
     {
     }
 
     inline uint32_t operator()(const uint32_t _val1, const uint32_t _val2) const
     {
-        return m_allOps->operator[](_val1)->m_allocSize < m_allOps->operator[](_val2)->m_allocSize;
+        return m_ops->m_allocSize[m_allOps->operator[](_val1)] < m_ops->m_allocSize[m_allOps->operator[](_val2)];
     }
 };
 
 // Alignment
 struct pSortOpAlignment
 {
-    const std::vector<rtm::MemoryOperation*>* m_allOps;
-    pSortOpAlignment(const std::vector<rtm::MemoryOperation*>* _ops)
-        : m_allOps(_ops)
+    const std::vector<uint32_t>* m_allOps;
+    const rtm::MemoryOperations* m_ops;
+    pSortOpAlignment(const std::vector<uint32_t>* _allOps, const rtm::MemoryOperations* _ops)
+        : m_allOps(_allOps)
+        , m_ops(_ops)
     {
     }
 
     inline uint32_t operator()(const uint32_t _val1, const uint32_t _val2) const
     {
-        return m_allOps->operator[](_val1)->m_alignment < m_allOps->operator[](_val2)->m_alignment;
+        return m_ops->m_alignment[m_allOps->operator[](_val1)] < m_ops->m_alignment[m_allOps->operator[](_val2)];
     }
 };
 
 struct pSetOpMappings
 {
-    const std::vector<rtm::MemoryOperation*>* m_allOps;
-    const Mapping* m_mapping;
+    Mapping* m_mapping;
 
-    pSetOpMappings(const std::vector<rtm::MemoryOperation*>* _ops, const Mapping& _mapping)
-        : m_allOps(_ops)
-        , m_mapping(&_mapping)
+    pSetOpMappings(Mapping& _mapping)
+        : m_mapping(&_mapping)
     {
     }
 
-    inline void operator()(const uint32_t _index) const
+    inline void operator()(const uint32_t& _index) const
     {
-        uint32_t idx = m_mapping->m_sortedIndex[_index];
-        rtm::MemoryOperation* op = (*m_allOps)[idx];
-        op->m_indexMapping = _index;
+        uint32_t row = (uint32_t)(&_index - &m_mapping->m_sortedIndex[0]);
+        m_mapping->m_rowIndex[_index] = row;
     }
 };
 
@@ -229,10 +254,21 @@ OperationTableSource::OperationTableSource(CaptureContext* _context, bool _valid
 void OperationTableSource::prepareData(bool /*_onlyLeaks*/)
 {
     bool filterEnabled = m_list->getFilteringState();
-    const std::vector<rtm::MemoryOperation*>& _ops =
-        (m_valid == false) ? m_context->m_capture->getMemoryOpsInvalid()
-                           : filterEnabled ? m_context->m_capture->getMemoryOpsFiltered()
-                                           : m_context->m_capture->getMemoryOps();
+    m_ops = &m_context->m_capture->getMemoryOps();
+
+    // capture keeps invalid operations in place, unfiltered list holds the valid ones
+    m_validOps.clear();
+    if (m_valid && !filterEnabled)
+    {
+        m_validOps.reserve(m_ops->size());
+        for (uint32_t i = 0; i < (uint32_t)m_ops->size(); ++i)
+            if (m_ops->isValid(i))
+                m_validOps.push_back(i);
+    }
+
+    const std::vector<uint32_t>& _ops = (m_valid == false) ? m_context->m_capture->getMemoryOpsInvalid()
+                                        : filterEnabled    ? m_context->m_capture->getMemoryOpsFiltered()
+                                                           : m_validOps;
 
     m_numRows = (uint32_t)_ops.size();
     m_sortOrder = Qt::AscendingOrder;
@@ -242,12 +278,13 @@ void OperationTableSource::prepareData(bool /*_onlyLeaks*/)
     const uint32_t numItems = m_numRows;
 
     m_mapping.m_sortedIndex.resize(numItems);
+    m_mapping.m_rowIndex.resize(numItems);
     m_mapping.m_allOps = m_allOps;
 
     pSetIndex psSetIdx(m_mapping.m_sortedIndex);
     RTM_PARALLEL_FOR_EACH(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psSetIdx);
 
-    pSetOpMappings psMap(m_allOps, m_mapping);
+    pSetOpMappings psMap(m_mapping);
     RTM_PARALLEL_FOR_EACH(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psMap);
 
     m_currentColumn = OperationColumn::Time;
@@ -271,18 +308,18 @@ uint32_t OperationTableSource::getNumberOfRows()
     return m_numRows;
 }
 
-static bool isLeakedBlock(const rtm::MemoryOperation* _op)
+static bool isLeakedBlock(const rtm::MemoryOperations& _ops, uint32_t _op)
 {
-    switch (_op->m_operationType)
+    switch (_ops.getType(_op))
     {
         case rmem::LogMarkers::OpAlloc:
         case rmem::LogMarkers::OpAllocAligned:
         case rmem::LogMarkers::OpCalloc:
         case rmem::LogMarkers::OpRealloc:
         case rmem::LogMarkers::OpReallocAligned:
-            if (!_op->m_chainNext)
+            if (_ops.m_chainNext[_op] == rtm::MemoryOperations::NoOperation)
                 return true;
-            return isLeakedBlock(_op->m_chainNext);
+            return isLeakedBlock(_ops, _ops.m_chainNext[_op]);
 
         case rmem::LogMarkers::OpFree:
             return false;
@@ -298,9 +335,10 @@ QString OperationTableSource::getItem(uint32_t _index, int32_t _column, QColor*
         index = m_numRows - index - 1;
 
     uint32_t idx = m_mapping.m_sortedIndex[index];
-    const rtm::MemoryOperation* op = m_mapping.m_allOps->operator[](idx);
+    const uint32_t op = m_mapping.m_allOps->operator[](idx);
+    const rtm::MemoryOperations& ops = *m_ops;
 
-    bool leaked = isLeakedBlock(op);
+    bool leaked = isLeakedBlock(ops, op);
     if (_color)
     {
         *_color = QColor(255, 169, 40);
@@ -311,20 +349,21 @@ QString OperationTableSource::getItem(uint32_t _index, int32_t _column, QColor*
     switch (_column)
     {
         case OperationColumn::ThreadID:
-            return "0x" + QString::number(op->m_threadID, 16);
+            return "0x" + QString::number(m_context->m_capture->getThreadID(op), 16);
 
         case OperationColumn::Heap:
         {
             rtm::HeapsType& heaps = m_context->m_capture->getHeaps();
-            rtm::HeapsType::iterator it = heaps.find(op->m_allocatorHandle);
+            const uint64_t handle = m_context->m_capture->getHeapHandle(op);
+            rtm::HeapsType::iterator it = heaps.find(handle);
             if (it != heaps.end())
                 return it->second.c_str();
             else
-                return "0x" + QString::number(op->m_allocatorHandle, 16);
+                return "0x" + QString::number(handle, 16);
         }
 
         case OperationColumn::Address:
-            return "0x" + QString::number(op->m_pointer, 16);
+            return "0x" + QString::number(ops.m_pointer[op], 16);
 
         case OperationColumn::Type:
         {
@@ -335,25 +374,25 @@ QString OperationTableSource::getItem(uint32_t _index, int32_t _column, QColor*
                                                                   QObject::tr("Realloc"),
                                                                   QObject::tr("Realloc aligned")};
 
-            return typeName[op->m_operationType];
+            return typeName[ops.getType(op)];
         }
 
         case OperationColumn::Size:
         {
             QLocale locale;
-            return locale.toString(op->m_allocSize);
+            return locale.toString(ops.m_allocSize[op]);
         }
 
         case OperationColumn::Alignment:
         {
-            if (op->m_alignment == 255)
+            if (ops.m_alignment[op] == 255)
                 return QObject::tr("Default");
             else
-                return QString::number(1 << op->m_alignment);
+                return QString::number(1 << ops.m_alignment[op]);
         }
 
         case OperationColumn::Time:
-            return getTimeString(m_context->m_capture->getFloatTime(op->m_operationTime));
+            return getTimeString(m_context->m_capture->getFloatTime(ops.m_time[op]));
     };
 
     return "";
@@ -368,8 +407,7 @@ void OperationTableSource::getItem(uint32_t _index, void** _pointer)
     if (m_sortOrder == Qt::DescendingOrder)
         index = m_numRows - index - 1;
     uint32_t idx = m_mapping.m_sortedIndex[index];
-    const rtm::MemoryOperation* op = m_mapping.m_allOps->operator[](idx);
-    *_pointer = (void*)(op);
+    *_pointer = getOpItem(m_mapping.m_allOps->operator[](idx));
 }
 
 Qt::AlignmentFlag OperationTableSource::getAlignment(uint32_t _index)
@@ -387,7 +425,13 @@ Qt::AlignmentFlag OperationTableSource::getAlignment(uint32_t _index)
 
 uint32_t OperationTableSource::getItemIndex(void* _item)
 {
-    uint32_t index = ((rtm::MemoryOperation*)_item)->m_indexMapping;
+    // listed operations are in capture order
+    const uint32_t op = getItemOp(_item);
+    std::vector<uint32_t>::const_iterator it = std::lower_bound(m_allOps->begin(), m_allOps->end(), op);
+    if (it == m_allOps->end())
+        return 0;
+
+    uint32_t index = m_mapping.m_rowIndex[(size_t)(it - m_allOps->begin())];
     if (m_sortOrder == Qt::DescendingOrder)
         index = m_numRows - index - 1;
     return index;
@@ -402,42 +446,42 @@ void OperationTableSource::sortColumn(uint32_t _columnIndex, Qt::SortOrder _sort
     {
         case OperationColumn::ThreadID:
         {
-            pSortThreadID psThreadID(m_allOps);
+            pSortThreadID psThreadID(m_allOps, m_context->m_capture);
             RTM_PARALLEL_SORT(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psThreadID);
         }
         break;
 
         case OperationColumn::Heap:
         {
-            pSortHeap psHeap(m_allOps);
+            pSortHeap psHeap(m_allOps, m_context->m_capture);
             RTM_PARALLEL_SORT(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psHeap);
         }
         break;
 
         case OperationColumn::Address:
         {
-            pSortAddress psAddress(m_allOps);
+            pSortAddress psAddress(m_allOps, m_ops);
             RTM_PARALLEL_SORT(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psAddress);
         }
         break;
 
         case OperationColumn::Type:
         {
-            pSortOpType psType(m_allOps);
+            pSortOpType psType(m_allOps, m_ops);
             RTM_PARALLEL_SORT(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psType);
         }
         break;
 
         case OperationColumn::Size:
         {
-            pSortOpSize psSize(m_allOps);
+            pSortOpSize psSize(m_allOps, m_ops);
             RTM_PARALLEL_SORT(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psSize);
         }
         break;
 
         case OperationColumn::Alignment:
         {
-            pSortOpAlignment psAlignment(m_allOps);
+            pSortOpAlignment psAlignment(m_allOps, m_ops);
             RTM_PARALLEL_SORT(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psAlignment);
         }
         break;
@@ -448,7 +492,7 @@ void OperationTableSource::sortColumn(uint32_t _columnIndex, Qt::SortOrder _sort
         break;
     };
 
-    pSetOpMappings psMap(m_allOps, m_mapping);
+    pSetOpMappings psMap(m_mapping);
     RTM_PARALLEL_FOR_EACH(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psMap);
 
     m_currentColumn = _columnIndex;
@@ -461,9 +505,9 @@ void* OperationTableSource::FindNextByAddress(uint64_t _address, uint32_t _start
     for (uint32_t i = _startIndex + 1; i < numItems; ++i)
     {
         uint32_t index = m_mapping.m_sortedIndex[i];
-        rtm::MemoryOperation* op = m_allOps->operator[](index);
-        if (op->m_pointer == _address)
-            return op;
+        const uint32_t op = m_allOps->operator[](index);
+        if (m_ops->m_pointer[op] == _address)
+            return getOpItem(op);
     }
 
     return NULL;
@@ -475,9 +519,9 @@ void* OperationTableSource::FindNextBySize(uint64_t _size, uint32_t _startIndex)
     for (uint32_t i = _startIndex + 1; i < numItems; ++i)
     {
         uint32_t index = m_mapping.m_sortedIndex[i];
-        rtm::MemoryOperation* op = m_allOps->operator[](index);
-        if (op->m_allocSize == _size)
-            return op;
+        const uint32_t op = m_allOps->operator[](index);
+        if (m_ops->m_allocSize[op] == _size)
+            return getOpItem(op);
     }
 
     return NULL;
@@ -493,7 +537,8 @@ OperationsList::OperationsList(QWidget* _parent, Qt::WindowFlags _flags)
     : QWidget(_parent, _flags)
 {
     m_context = NULL;
-    m_currentItem = NULL;
+    m_currentOp = rtm::MemoryOperations::NoOperation;
+    m_currentTrace = NULL;
     m_tableSource = NULL;
     m_enableFiltering = false;
 
@@ -579,42 +624,47 @@ void OperationsList::saveState(QSettings& _settings)
 
 void OperationsList::selectionChanged(void* _item)
 {
-    m_currentItem = (rtm::MemoryOperation*)_item;
-    emit setStackTrace(&m_currentItem->m_stackTrace, 1);
+    const rtm::MemoryOperations& ops = m_context->m_capture->getMemoryOps();
+
+    m_currentOp = getItemOp(_item);
+    m_currentTrace = m_context->m_capture->getStackTrace(ops.m_stackTrace[m_currentOp]);
+    emit setStackTrace(&m_currentTrace, 1);
 
-    m_operationSearch->setAddress(m_currentItem->m_pointer);
+    m_operationSearch->setAddress(ops.m_pointer[m_currentOp]);
 
+    const uint32_t prevOp = ops.m_chainPrev[m_currentOp];
     bool enablePrev = false;
-    if (m_currentItem->m_chainPrev)
+    if (prevOp != rtm::MemoryOperations::NoOperation)
         enablePrev = (m_context->m_capture->getFilteringEnabled() == false) ||
-                     m_context->m_capture->isInFilter(m_currentItem->m_chainPrev);
+                     m_context->m_capture->isInFilter(prevOp);
     m_operationSearch->setPrevEnabled(enablePrev);
 
+    const uint32_t nextOp = ops.m_chainNext[m_currentOp];
     bool enableNext = false;
-    if (m_currentItem->m_chainNext)
+    if (nextOp != rtm::MemoryOperations::NoOperation)
         enableNext = (m_context->m_capture->getFilteringEnabled() == false) ||
-                     m_context->m_capture->isInFilter(m_currentItem->m_chainNext);
+                     m_context->m_capture->isInFilter(nextOp);
     m_operationSearch->setNextEnabled(enableNext);
 
-    emit highlightTime(m_currentItem->m_operationTime);
+    emit highlightTime(ops.m_time[m_currentOp]);
 }
 
 void OperationsList::selectPrevious()
 {
-    m_operationList->select(m_currentItem->m_chainPrev);
+    m_operationList->select(getOpItem(m_context->m_capture->getMemoryOps().m_chainPrev[m_currentOp]));
 }
 
 void OperationsList::selectNext()
 {
-    m_operationList->select(m_currentItem->m_chainNext);
+    m_operationList->select(getOpItem(m_context->m_capture->getMemoryOps().m_chainNext[m_currentOp]));
 }
 
 void OperationsList::selectNextByAddress(uint64_t _address)
 {
     void* item = NULL;
-    if (m_currentItem)
+    if (m_currentOp != rtm::MemoryOperations::NoOperation)
     {
-        uint32_t index = m_tableSource->getItemIndex(m_currentItem);
+        uint32_t index = m_tableSource->getItemIndex(getOpItem(m_currentOp));
         item = m_tableSource->FindNextByAddress(_address, index);
     }
     else
@@ -632,9 +682,9 @@ void OperationsList::selectNextByAddress(uint64_t _address)
 void OperationsList::selectNextBySize(uint64_t _size)
 {
     void* item = NULL;
-    if (m_currentItem)
+    if (m_currentOp != rtm::MemoryOperations::NoOperation)
     {
-        uint32_t index = m_tableSource->getItemIndex(m_currentItem);
+        uint32_t index = m_tableSource->getItemIndex(getOpItem(m_currentOp));
         item = m_tableSource->FindNextBySize(_size, index);
     }
     else
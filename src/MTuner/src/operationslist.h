@@ -20,7 +20,8 @@ private:
     BigTable* m_operationList;
     OperationSearch* m_operationSearch;
     OperationTableSource* m_tableSource;
-    rtm::MemoryOperation* m_currentItem;
+    uint32_t m_currentOp;
+    rtm::StackTrace* m_currentTrace;
     bool m_enableFiltering;
 
     int m_savedColumn;
@@ -7,6 +7,7 @@
 #include <MTuner/src/mtuner.h>
 #include <MTuner/src/stacktrace.h>
 #include <MTuner/src/capturecontext.h>
+#include <MTuner/src/symbolservice.h>
 
 extern QString QStringColor(const QString& _string, const char* _color, bool _addColon = true);
 
@@ -131,7 +132,13 @@ void StackTrace::contextMenuEvent(QContextMenuEvent* _event)
 
 void StackTrace::setContext(CaptureContext* _context)
 {
+    if (m_context)
+        disconnect(m_context->m_symbolService, 0, this, 0);
+
     m_context = _context;
+    if (m_context)
+        connect(m_context->m_symbolService, &SymbolService::framesResolved, this, &StackTrace::framesResolved);
+
     m_currentTrace = 0;
     updateView();
 }
@@ -212,31 +219,22 @@ void StackTrace::updateView()
     m_table->setRowCount(rows);
     uint32_t selectedRow = rows;
 
-    for (uint32_t i = 0; i < rows; ++i)
+    const rtm::StackTraceNode* node = m_currentTrace[m_currentTraceIdx]->m_frame;
+    for (uint32_t i = 0; i < rows; ++i, node = node->m_parent)
     {
-        uint64_t address = m_currentTrace[m_currentTraceIdx]->m_frames[i];
-        rdebug::StackFrame frame;
-        m_context->resolveStackFrame(address, frame);
-
-        QString func = QString::fromUtf8(frame.m_func);
-        QString symStoreDir = QString::fromUtf8(m_context->getSymbolStoreDir().c_str());
-
-        QTableWidgetItem* item = new QTableWidgetItem(frame.m_moduleName);
-        item->setToolTip(frame.m_moduleName);
-
-        // module, file, line, function, Path
-        m_table->setItem(i, StackTraceColumns::Module, makeItemWithTooltip(frame.m_moduleName));
-        m_table->setItem(i, StackTraceColumns::Function, makeItemWithTooltip(func));
-        m_table->setItem(i,
-                         StackTraceColumns::File,
-                         makeItemWithTooltip(QString::fromUtf8(rtm::pathGetFileName(frame.m_file))));
-        m_table->setItem(i, StackTraceColumns::Line, new QTableWidgetItem(QString::number(frame.m_line)));
-        m_table->setItem(i, StackTraceColumns::Path, makeItemWithTooltip(QString::fromUtf8(frame.m_file)));
-
+        QString func = setFrame(i, node->m_address);
         if (m_selectedFunc.compare(func) == 0)
             selectedRow = i;
     }
 
+    // next stack trace is likely to be looked at as well
+    if (m_currentTraceIdx + 1 < m_currentTraceCnt)
+    {
+        node = m_currentTrace[m_currentTraceIdx + 1]->m_frame;
+        for (; node; node = node->m_parent)
+            m_context->m_symbolService->request(node->m_address, false);
+    }
+
     m_table->update();
     m_table->setCurrentIndex(QModelIndex());
     if (selectedRow != rows)
@@ -249,6 +247,54 @@ void StackTrace::updateView()
     emit openFile("", 0, 0);
 }
 
+QString StackTrace::setFrame(uint32_t _row, uint64_t _address)
+{
+    rdebug::StackFrame frame;
+    if (!m_context->m_symbolService->findFrame(_address, frame))
+    {
+        // shown as an address until the symbol service resolves it
+        QString address = QString("0x") + QString::number(_address, 16);
+        m_table->setItem(_row, StackTraceColumns::Module, new QTableWidgetItem());
+        m_table->setItem(_row, StackTraceColumns::Function, makeItemWithTooltip(address));
+        m_table->setItem(_row, StackTraceColumns::File, new QTableWidgetItem());
+        m_table->setItem(_row, StackTraceColumns::Line, new QTableWidgetItem());
+        m_table->setItem(_row, StackTraceColumns::Path, new QTableWidgetItem());
+        m_context->m_symbolService->request(_address, true);
+        return address;
+    }
+
+    QString func = QString::fromUtf8(frame.m_func);
+
+    // module, file, line, function, Path
+    m_table->setItem(_row, StackTraceColumns::Module, makeItemWithTooltip(frame.m_moduleName));
+    m_table->setItem(_row, StackTraceColumns::Function, makeItemWithTooltip(func));
+    m_table->setItem(_row,
+                     StackTraceColumns::File,
+                     makeItemWithTooltip(QString::fromUtf8(rtm::pathGetFileName(frame.m_file))));
+    m_table->setItem(_row, StackTraceColumns::Line, new QTableWidgetItem(QString::number(frame.m_line)));
+    m_table->setItem(_row, StackTraceColumns::Path, makeItemWithTooltip(QString::fromUtf8(frame.m_file)));
+    return func;
+}
+
+void StackTrace::framesResolved(const std::vector<uint64_t>& _addresses)
+{
+    if (!m_currentTrace)
+        return;
+
+    const uint32_t rows = m_currentTrace[m_currentTraceIdx]->m_numFrames;
+    const rtm::StackTraceNode* node = m_currentTrace[m_currentTraceIdx]->m_frame;
+    for (uint32_t i = 0; i < rows; ++i, node = node->m_parent)
+    {
+        if (!std::binary_search(_addresses.begin(), _addresses.end(), node->m_address))
+            continue;
+
+        // frames without symbols stay shown as addresses
+        rdebug::StackFrame frame;
+        if (m_context->m_symbolService->findFrame(node->m_address, frame))
+            setFrame(i, node->m_address);
+    }
+}
+
 void StackTrace::loadState(QSettings& _settings, const QString& _name, bool _resetGeometries)
 {
     m_settingsGroupName = _name;
@@ -77,12 +77,14 @@ public Q_SLOTS:
     void copy();
     void copyAll();
     void copyResetIndex();
+    void framesResolved(const std::vector<uint64_t>& _addresses);
 
 Q_SIGNALS:
     void openFile(const QString& _file, int _row, int _column);
 
 private:
     void setCount(uint32_t _cnt);
+    QString setFrame(uint32_t _row, uint64_t _address);
     Ui::StackTrace ui;
 };
 
@@ -6,6 +6,7 @@
 #include <MTuner_pch.h>
 #include <MTuner/src/stacktreewidget.h>
 #include <MTuner/src/capturecontext.h>
+#include <MTuner/src/symbolservice.h>
 
 struct Header
 {
@@ -49,6 +50,11 @@ public:
     {
         return m_depth;
     }
+    uint64_t getAddress() const
+    {
+        return rtm::StackTrace::getFrame(m_tree->m_stackTraceList, m_depth)->m_address;
+    }
+    void setFrame(const rdebug::StackFrame& _frame) const;
 
     int m_depth;
     std::vector<TreeItem*> m_children;
@@ -61,6 +67,7 @@ public:
     mutable QString m_func;
     mutable int m_line;
     mutable bool m_resolved;
+    mutable bool m_requested;
 };
 
 // SORTING by func
@@ -306,7 +313,9 @@ TreeItem::TreeItem(CaptureContext* _context,
                    const rtm::StackTraceTree* _root,
                    int _depth)
 {
+    m_line = 0;
     m_resolved = false;
+    m_requested = false;
     m_context = _context;
     m_tree = _tree;
     m_root = _root;
@@ -393,22 +402,12 @@ QVariant TreeItem::data(int _column) const
     {
         if (!m_resolved)
         {
+            // frames not resolved yet are shown as addresses until the symbol service is done
             rdebug::StackFrame frame;
-            m_context->resolveStackFrame(m_tree->m_stackTraceList->m_frames[m_tree->m_stackTraceList->m_numFrames - m_depth],
-                                         frame);
-
-            QString file = QString::fromUtf8(frame.m_file);
-
-            QString srcpath = QDir(file).path();
-            if (!QDir::isRelativePath(srcpath))
-                m_file = QDir(srcpath).absolutePath();
-            else
-                m_file = srcpath;
-
-            m_module = QString::fromUtf8(frame.m_moduleName);
-            m_func = QString::fromUtf8(frame.m_func);
-            m_line = frame.m_line;
-            m_resolved = true;
+            if (m_context->m_symbolService->findFrame(getAddress(), frame))
+                setFrame(frame);
+            else if (m_func.isEmpty())
+                m_func = QString("0x") + QString::number(getAddress(), 16);
         }
 
         switch (_column)
@@ -443,6 +442,22 @@ QVariant TreeItem::data(int _column) const
     }
 }
 
+void TreeItem::setFrame(const rdebug::StackFrame& _frame) const
+{
+    QString file = QString::fromUtf8(_frame.m_file);
+
+    QString srcpath = QDir(file).path();
+    if (!QDir::isRelativePath(srcpath))
+        m_file = QDir(srcpath).absolutePath();
+    else
+        m_file = srcpath;
+
+    m_module = QString::fromUtf8(_frame.m_moduleName);
+    m_func = QString::fromUtf8(_frame.m_func);
+    m_line = _frame.m_line;
+    m_resolved = true;
+}
+
 TreeItem* TreeItem::parent()
 {
     return m_parent;
@@ -530,10 +545,17 @@ TreeModel::TreeModel(CaptureContext* _context, QObject* _parent)
 {
     m_context = _context;
     updateData();
+
+    m_framesConnection =
+        connect(m_context->m_symbolService, &SymbolService::framesResolved, this, &TreeModel::framesResolved);
 }
 
 TreeModel::~TreeModel()
 {
+    // pending items are deleted with the tree, frames resolved later must not reach them
+    disconnect(m_framesConnection);
+    m_pendingItems.clear();
+
     beginResetModel();
     delete m_rootItem;
     endResetModel();
@@ -629,7 +651,15 @@ QVariant TreeModel::data(const QModelIndex& _index, int _role) const
 
     TreeItem* item = static_cast<TreeItem*>(_index.internalPointer());
 
-    return item->data(_index.column());
+    QVariant data = item->data(_index.column());
+    if (!item->m_resolved && !item->m_requested)
+    {
+        item->m_requested = true;
+        m_context->m_symbolService->request(item->getAddress(), true);
+        m_pendingItems.push_back(item);
+    }
+
+    return data;
 }
 
 Qt::ItemFlags TreeModel::flags(const QModelIndex& _index) const
@@ -695,6 +725,50 @@ int TreeModel::rowCount(const QModelIndex& _parent) const
     return parentItem->childCount();
 }
 
+void TreeModel::prefetch(const QModelIndex& _index)
+{
+    if (!_index.isValid())
+        return;
+
+    TreeItem* item = static_cast<TreeItem*>(_index.internalPointer());
+    if (!item->m_resolved && !item->m_requested)
+        m_context->m_symbolService->request(item->getAddress(), false);
+}
+
+void TreeModel::prefetchChildren(const QModelIndex& _index)
+{
+    TreeItem* parentItem = _index.isValid() ? static_cast<TreeItem*>(_index.internalPointer()) : m_rootItem;
+
+    for (TreeItem* item : parentItem->m_children)
+        if (!item->m_resolved && !item->m_requested)
+            m_context->m_symbolService->request(item->getAddress(), false);
+}
+
+void TreeModel::framesResolved(const std::vector<uint64_t>& _addresses)
+{
+    size_t numPending = 0;
+    for (TreeItem* item : m_pendingItems)
+    {
+        const uint64_t address = item->getAddress();
+        if (!std::binary_search(_addresses.begin(), _addresses.end(), address))
+        {
+            m_pendingItems[numPending++] = item;
+            continue;
+        }
+
+        // frame can be missing if there are no symbols, the address stays shown then
+        rdebug::StackFrame frame;
+        if (m_context->m_symbolService->findFrame(address, frame))
+            item->setFrame(frame);
+        item->m_resolved = true;
+
+        const int row = item->row();
+        emit dataChanged(createIndex(row, Header::Name, item), createIndex(row, Header::Line, item));
+    }
+
+    m_pendingItems.resize(numPending);
+}
+
 void TreeModel::updateData()
 {
     const rtm::StackTraceTree* tree = 0;
@@ -736,11 +810,14 @@ StackTreeWidget::StackTreeWidget(QWidget* _parent, Qt::WindowFlags _flags)
     m_enableFiltering = false;
     m_tree = findChild<QTreeView*>("treeWidget");
     m_tree->setItemDelegate(new ProgressBarDelegate());
+
+    connect(m_tree, &QTreeView::expanded, this, &StackTreeWidget::itemExpanded);
+    connect(m_tree->verticalScrollBar(), &QScrollBar::valueChanged, this, &StackTreeWidget::prefetchSymbols);
 }
 
 StackTreeWidget::~StackTreeWidget()
 {
-    m_tree->setModel(0);
+    setModel(NULL);
 }
 
 void StackTreeWidget::changeEvent(QEvent* _event)
@@ -771,10 +848,15 @@ void StackTreeWidget::loadState(QSettings& _settings, const QString& _name, bool
 void StackTreeWidget::saveState(QSettings& _settings)
 {
     TreeModel* model = (TreeModel*)m_tree->model();
+    if (model)
+    {
+        m_savedColumn = model->m_savedColumn;
+        m_savedOrder = model->m_savedOrder;
+    }
 
     _settings.beginGroup(m_settingsGroupName);
-    _settings.setValue("stackTreeSortColumn", model->m_savedColumn);
-    _settings.setValue("stackTreeSortOrder", (int)model->m_savedOrder);
+    _settings.setValue("stackTreeSortColumn", m_savedColumn);
+    _settings.setValue("stackTreeSortOrder", (int)m_savedOrder);
     _settings.setValue("stackTreeHeaderState", m_tree->header()->saveState());
     _settings.endGroup();
 }
@@ -786,6 +868,8 @@ void StackTreeWidget::setContext(CaptureContext* _context)
     m_context = _context;
     if (m_context)
         setupTree();
+    else
+        setModel(NULL);
 
     m_tree->setSortingEnabled(true);
     m_tree->sortByColumn(m_savedColumn, m_savedOrder);
@@ -804,10 +888,23 @@ bool StackTreeWidget::getFilteringState() const
     return m_enableFiltering;
 }
 
+//--------------------------------------------------------------------------
+/// Shows a new model, the previous one and its selection model are deleted
+//--------------------------------------------------------------------------
+void StackTreeWidget::setModel(TreeModel* _model)
+{
+    QAbstractItemModel* oldModel = m_tree->model();
+    QItemSelectionModel* oldSelection = m_tree->selectionModel();
+
+    m_tree->setModel(_model);
+
+    delete oldSelection;
+    delete oldModel;
+}
+
 void StackTreeWidget::setupTree()
 {
-    TreeModel* model = new TreeModel(m_context);
-    m_tree->setModel(model);
+    setModel(new TreeModel(m_context, this));
 
     if (!m_headerStateRestored)
     {
@@ -845,3 +942,31 @@ void StackTreeWidget::rowClicked(const QModelIndex& _index)
 
     emit setStackTrace(m_stackTraces.data(), (int)m_stackTraces.size());
 }
+
+void StackTreeWidget::itemExpanded(const QModelIndex& _index)
+{
+    TreeModel* model = (TreeModel*)m_tree->model();
+    model->prefetchChildren(_index);
+}
+
+void StackTreeWidget::prefetchSymbols()
+{
+    TreeModel* model = (TreeModel*)m_tree->model();
+    if (!model)
+        return;
+
+    // rows of the next page, visible rows request their frames when they are drawn
+    const int height = m_tree->viewport()->height();
+    QModelIndex index = m_tree->indexAt(QPoint(0, height - 1));
+    if (!index.isValid())
+        return;
+
+    const int rowHeight = std::max(m_tree->visualRect(index).height(), 1);
+    for (int rows = height / rowHeight; rows > 0; --rows)
+    {
+        index = m_tree->indexBelow(index);
+        if (!index.isValid())
+            break;
+        model->prefetch(index);
+    }
+}
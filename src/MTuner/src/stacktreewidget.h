@@ -18,6 +18,8 @@ class TreeModel : public QAbstractItemModel
 private:
     CaptureContext* m_context;
     TreeItem* m_rootItem;
+    mutable std::vector<TreeItem*> m_pendingItems;  ///< Shown items waiting for their frames
+    QMetaObject::Connection m_framesConnection;      ///< Symbol service notifications for pending items
 
 public:
     int m_savedColumn;
@@ -35,6 +37,11 @@ public:
     int columnCount(const QModelIndex& _parent = QModelIndex()) const;
     void sort(int _column, Qt::SortOrder _order);
     void updateData();
+    void prefetch(const QModelIndex& _index);
+    void prefetchChildren(const QModelIndex& _index);
+
+public Q_SLOTS:
+    void framesResolved(const std::vector<uint64_t>& _addresses);
 
 private:
     void setupModelData(const rtm::StackTraceTree& _tree, TreeItem* _parent, const rtm::StackTraceTree* _root, int _depth);
@@ -82,11 +89,15 @@ public:
 
 public Q_SLOTS:
     void rowClicked(const QModelIndex&);
+    void itemExpanded(const QModelIndex& _index);
+    void prefetchSymbols();
 
 Q_SIGNALS:
     void setStackTrace(rtm::StackTrace**, int);
 
 private:
+    void setModel(TreeModel* _model);
+
     Ui::stackTree ui;
 };
 
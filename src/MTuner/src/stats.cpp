@@ -47,25 +47,25 @@ void Stats::updateUI()
 
     m_table->item(0, 0)->setText(locale.toString(qulonglong(globalStats.m_memoryUsage)));
     m_table->item(1, 0)->setText(locale.toString(qulonglong(globalStats.m_memoryUsagePeak)));
-    m_table->item(2, 0)->setText(locale.toString(globalStats.m_numberOfOperations));
-    m_table->item(3, 0)->setText(locale.toString(globalStats.m_numberOfAllocations));
-    m_table->item(4, 0)->setText(locale.toString(globalStats.m_numberOfReAllocations));
-    m_table->item(5, 0)->setText(locale.toString(globalStats.m_numberOfFrees));
-    m_table->item(6, 0)->setText(locale.toString(globalStats.m_numberOfLiveBlocks));
-    m_table->item(7, 0)->setText(locale.toString(globalStats.m_overhead));
-    m_table->item(8, 0)->setText(locale.toString(globalStats.m_overheadPeak));
+    m_table->item(2, 0)->setText(locale.toString(qulonglong(globalStats.m_numberOfOperations)));
+    m_table->item(3, 0)->setText(locale.toString(qulonglong(globalStats.m_numberOfAllocations)));
+    m_table->item(4, 0)->setText(locale.toString(qulonglong(globalStats.m_numberOfReAllocations)));
+    m_table->item(5, 0)->setText(locale.toString(qulonglong(globalStats.m_numberOfFrees)));
+    m_table->item(6, 0)->setText(locale.toString(qulonglong(globalStats.m_numberOfLiveBlocks)));
+    m_table->item(7, 0)->setText(locale.toString(qulonglong(globalStats.m_overhead)));
+    m_table->item(8, 0)->setText(locale.toString(qulonglong(globalStats.m_overheadPeak)));
 
     const rtm::MemoryStats& snapshotStats = m_context->m_capture->getSnapshotStats();
 
     m_table->item(0, 1)->setText(locale.toString(qulonglong(snapshotStats.m_memoryUsage)));
     m_table->item(1, 1)->setText(locale.toString(qulonglong(snapshotStats.m_memoryUsagePeak)));
-    m_table->item(2, 1)->setText(locale.toString(snapshotStats.m_numberOfOperations));
-    m_table->item(3, 1)->setText(locale.toString(snapshotStats.m_numberOfAllocations));
-    m_table->item(4, 1)->setText(locale.toString(snapshotStats.m_numberOfReAllocations));
-    m_table->item(5, 1)->setText(locale.toString(snapshotStats.m_numberOfFrees));
-    m_table->item(6, 1)->setText(locale.toString(snapshotStats.m_numberOfLiveBlocks));
-    m_table->item(7, 1)->setText(locale.toString(snapshotStats.m_overhead));
-    m_table->item(8, 1)->setText(locale.toString(snapshotStats.m_overheadPeak));
+    m_table->item(2, 1)->setText(locale.toString(qulonglong(snapshotStats.m_numberOfOperations)));
+    m_table->item(3, 1)->setText(locale.toString(qulonglong(snapshotStats.m_numberOfAllocations)));
+    m_table->item(4, 1)->setText(locale.toString(qulonglong(snapshotStats.m_numberOfReAllocations)));
+    m_table->item(5, 1)->setText(locale.toString(qulonglong(snapshotStats.m_numberOfFrees)));
+    m_table->item(6, 1)->setText(locale.toString(qulonglong(snapshotStats.m_numberOfLiveBlocks)));
+    m_table->item(7, 1)->setText(locale.toString(qulonglong(snapshotStats.m_overhead)));
+    m_table->item(8, 1)->setText(locale.toString(qulonglong(snapshotStats.m_overheadPeak)));
 }
 
 void Stats::clear()
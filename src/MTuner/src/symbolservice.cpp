@@ -0,0 +1,111 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/symbolservice.h>
+#include <MTuner/src/loader/symbolcache.h>
+
+SymbolService::SymbolService(rtm::SymbolCache* _symbols, QObject* _parent)
+    : QObject(_parent)
+    , m_symbols(_symbols)
+    , m_quit(false)
+{
+}
+
+SymbolService::~SymbolService()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_requested.notify_one();
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+bool SymbolService::findFrame(uint64_t _address, rdebug::StackFrame& _frame)
+{
+    return m_symbols->findFrame(_address, _frame);
+}
+
+void SymbolService::request(uint64_t _address, bool _visible)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const bool added = m_queued.insert(_address).second;
+
+        // a visible address that was prefetched moves ahead, the stale entry is skipped later
+        if (_visible)
+            m_queue.push_front(_address);
+        else if (added)
+            m_queue.push_back(_address);
+        else
+            return;
+
+        if (!m_thread.joinable())
+            m_thread = std::thread(&SymbolService::run, this);
+    }
+    m_requested.notify_one();
+}
+
+void SymbolService::run()
+{
+    uint64_t batch[BatchSize];
+
+    for (;;)
+    {
+        size_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_requested.wait(lock, [this] { return m_quit || !m_queue.empty(); });
+            if (m_quit)
+                return;
+
+            while (!m_queue.empty() && (count < BatchSize))
+            {
+                const uint64_t address = m_queue.front();
+                m_queue.pop_front();
+                if (m_queued.erase(address))
+                    batch[count++] = address;
+            }
+        }
+
+        // whole batch goes to the resolver at once where the toolchain supports it
+        m_symbols->resolveFrames(batch, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            rdebug::StackFrame frame;
+            m_symbols->getFrame(batch[i], frame);
+        }
+
+        if (count)
+            post(batch, count);
+    }
+}
+
+void SymbolService::post(const uint64_t* _addresses, size_t _count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // one delivery is pending at most, later batches are appended to it
+    const bool pending = !m_resolved.empty();
+    m_resolved.insert(m_resolved.end(), _addresses, _addresses + _count);
+    if (!pending)
+        QMetaObject::invokeMethod(this, [this]() { deliver(); }, Qt::QueuedConnection);
+}
+
+void SymbolService::deliver()
+{
+    std::vector<uint64_t> resolved;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        resolved.swap(m_resolved);
+    }
+
+    std::sort(resolved.begin(), resolved.end());
+    emit framesResolved(resolved);
+}
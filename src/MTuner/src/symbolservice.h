@@ -0,0 +1,62 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2024 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_MTUNER_SYMBOLSERVICE_H
+#define RTM_MTUNER_SYMBOLSERVICE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace rtm
+{
+class SymbolCache;
+}
+
+//--------------------------------------------------------------------------
+/// Resolves frames requested by views on a background thread so the UI
+/// thread never waits for the symbol resolver. Resolved addresses are
+/// collected and handed back to the UI thread in batches through the
+/// framesResolved signal, frames are then read from the symbol cache.
+//--------------------------------------------------------------------------
+class SymbolService : public QObject
+{
+    Q_OBJECT
+
+    enum
+    {
+        BatchSize = 64  ///< Addresses resolved before views are notified
+    };
+
+    rtm::SymbolCache* m_symbols;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_requested;
+    std::deque<uint64_t> m_queue;                 ///< Visible addresses at the front, prefetched ones at the back
+    robin_hood::unordered_set<uint64_t> m_queued;  ///< Addresses in the queue that are not resolved yet
+    std::vector<uint64_t> m_resolved;             ///< Resolved addresses not posted to views yet
+    bool m_quit;
+
+public:
+    SymbolService(rtm::SymbolCache* _symbols, QObject* _parent = 0);
+    ~SymbolService();
+
+    /// Fills the frame if it was resolved before, returns false otherwise
+    bool findFrame(uint64_t _address, rdebug::StackFrame& _frame);
+
+    /// Queues the address for resolving, visible ones are resolved before prefetched ones
+    void request(uint64_t _address, bool _visible);
+
+Q_SIGNALS:
+    void framesResolved(const std::vector<uint64_t>& _addresses);
+
+private:
+    void run();
+    void post(const uint64_t* _addresses, size_t _count);
+    void deliver();
+};
+
+#endif  // RTM_MTUNER_SYMBOLSERVICE_H
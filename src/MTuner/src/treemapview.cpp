@@ -320,7 +320,7 @@ void TreeMapView::mouseReleaseEvent(QMouseEvent* _event)
                 repaint();
             }
 
-            const uint32_t numOps = m_highlightNode->m_tree->m_opCount[rtm::StackTraceTree::Alloc] +
+            const uint64_t numOps = m_highlightNode->m_tree->m_opCount[rtm::StackTraceTree::Alloc] +
                                     m_highlightNode->m_tree->m_opCount[rtm::StackTraceTree::Free] +
                                     m_highlightNode->m_tree->m_opCount[rtm::StackTraceTree::Realloc];
             if (numOps == 1)